@@ -0,0 +1,890 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+// bmcweb-scale-bench: Redfish handler scale test against a synthetic D-Bus.
+//
+// Launches a private dbus-daemon, and in a child process populates it with a
+// generated object model (ObjectMapper, sensors, inventory, logging and
+// software) at a configurable scale.  The parent process then replays Redfish
+// GETs through the real route handlers, and reports per route the handler
+// latency, the number of D-Bus method calls each request made, and the peak
+// resident memory of the bmcweb side.  With --sensor-updates the sensor
+// Values change while the GETs are replayed, as they do on a live BMC.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <app.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <redfish.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+#include <sdbusplus/server/manager.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+namespace scale
+{
+
+using Clock = std::chrono::steady_clock;
+
+constexpr const char* mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* mapperPath = "/xyz/openbmc_project/object_mapper";
+constexpr const char* inventoryService =
+    "xyz.openbmc_project.Inventory.Manager";
+constexpr const char* loggingService = "xyz.openbmc_project.Logging";
+constexpr const char* softwareService =
+    "xyz.openbmc_project.Software.BMC.Updater";
+constexpr const char* chassisPath =
+    "/xyz/openbmc_project/inventory/system/chassis";
+constexpr const char* boardPath =
+    "/xyz/openbmc_project/inventory/system/chassis/motherboard";
+
+struct Config
+{
+    size_t sensors = 500;
+    // Sensor Value changes per second, spread over all sensors
+    size_t sensorUpdates = 0;
+    size_t dimms = 64;
+    size_t logEntries = 10000;
+    size_t firmware = 4;
+    size_t powerSupplies = 2;
+    size_t iterations = 20;
+    std::string dbusDaemon = "dbus-daemon";
+    std::vector<std::string> routes;
+};
+
+using Properties =
+    boost::container::flat_map<std::string, dbus::utility::DbusVariantType>;
+
+struct Object
+{
+    std::string service;
+    std::string path;
+    std::map<std::string, Properties> interfaces;
+};
+
+/**
+ * The generated object model, and the ObjectMapper view of it.
+ */
+struct Model
+{
+    std::vector<Object> objects;
+    // service -> paths which implement org.freedesktop.DBus.ObjectManager
+    std::map<std::string, std::vector<std::string>> managers;
+    // path -> service -> interfaces, as the ObjectMapper would report it
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>
+        index;
+
+    void add(Object&& object)
+    {
+        std::vector<std::string>& ifaces =
+            index[object.path][object.service];
+        for (const auto& [iface, properties] : object.interfaces)
+        {
+            ifaces.emplace_back(iface);
+        }
+        objects.emplace_back(std::move(object));
+    }
+
+    void addAssociation(const std::string& path,
+                        std::vector<std::string> endpoints)
+    {
+        add(Object{mapperService,
+                   path,
+                   {{"xyz.openbmc_project.Association",
+                     {{"endpoints", std::move(endpoints)}}}}});
+    }
+
+    void addManager(const std::string& service, const std::string& path)
+    {
+        managers[service].emplace_back(path);
+        index[path][service].emplace_back(
+            "org.freedesktop.DBus.ObjectManager");
+    }
+
+    // Mapper semantics: a depth of 0 is unlimited, and the subtree root
+    // itself is never part of the result
+    static bool inSubtree(const std::string& path, const std::string& root,
+                          int32_t depth)
+    {
+        std::string prefix = root;
+        if (prefix.empty() || prefix.back() != '/')
+        {
+            prefix += '/';
+        }
+        if (path.compare(0, prefix.size(), prefix) != 0)
+        {
+            return false;
+        }
+        if (depth <= 0)
+        {
+            return true;
+        }
+        int64_t levels = std::count(path.begin() +
+                                        static_cast<std::ptrdiff_t>(
+                                            prefix.size()),
+                                    path.end(), '/') +
+                         1;
+        return levels <= depth;
+    }
+
+    static bool hasInterface(const std::vector<std::string>& ifaces,
+                             const std::vector<std::string>& wanted)
+    {
+        if (wanted.empty())
+        {
+            return true;
+        }
+        for (const std::string& iface : wanted)
+        {
+            if (std::find(ifaces.begin(), ifaces.end(), iface) !=
+                ifaces.end())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>
+        getSubTree(const std::string& root, int32_t depth,
+                   const std::vector<std::string>& wanted) const
+    {
+        std::map<std::string, std::map<std::string, std::vector<std::string>>>
+            ret;
+        for (const auto& [path, services] : index)
+        {
+            if (!inSubtree(path, root, depth))
+            {
+                continue;
+            }
+            for (const auto& [service, ifaces] : services)
+            {
+                if (hasInterface(ifaces, wanted))
+                {
+                    ret[path][service] = ifaces;
+                }
+            }
+        }
+        return ret;
+    }
+
+    std::vector<std::string>
+        getSubTreePaths(const std::string& root, int32_t depth,
+                        const std::vector<std::string>& wanted) const
+    {
+        std::vector<std::string> ret;
+        for (const auto& [path, services] : getSubTree(root, depth, wanted))
+        {
+            ret.emplace_back(path);
+        }
+        return ret;
+    }
+
+    std::map<std::string, std::vector<std::string>>
+        getObject(const std::string& path,
+                  const std::vector<std::string>& wanted) const
+    {
+        std::map<std::string, std::vector<std::string>> ret;
+        auto it = index.find(path);
+        if (it != index.end())
+        {
+            for (const auto& [service, ifaces] : it->second)
+            {
+                if (hasInterface(ifaces, wanted))
+                {
+                    ret[service] = ifaces;
+                }
+            }
+        }
+        if (ret.empty())
+        {
+            throw sdbusplus::exception::SdBusError(
+                ENOENT, "xyz.openbmc_project.Common.Error.ResourceNotFound");
+        }
+        return ret;
+    }
+};
+
+struct SensorType
+{
+    const char* type;
+    const char* service;
+    const char* unit;
+    double value;
+    // Share of the total sensor count, in percent
+    size_t share;
+};
+
+constexpr std::array<SensorType, 5> sensorTypes{{
+    {"temperature", "xyz.openbmc_project.HwmonTempSensor",
+     "xyz.openbmc_project.Sensor.Value.Unit.DegreesC", 42.0, 40},
+    {"fan_tach", "xyz.openbmc_project.FanSensor",
+     "xyz.openbmc_project.Sensor.Value.Unit.RPMS", 8000.0, 20},
+    {"voltage", "xyz.openbmc_project.ADCSensor",
+     "xyz.openbmc_project.Sensor.Value.Unit.Volts", 12.0, 25},
+    {"current", "xyz.openbmc_project.PSUSensor",
+     "xyz.openbmc_project.Sensor.Value.Unit.Amperes", 20.0, 5},
+    {"power", "xyz.openbmc_project.PSUSensor",
+     "xyz.openbmc_project.Sensor.Value.Unit.Watts", 240.0, 10},
+}};
+
+inline Model generateModel(const Config& config)
+{
+    Model model;
+
+    model.add(Object{inventoryService,
+                     chassisPath,
+                     {{"xyz.openbmc_project.Inventory.Item.Chassis", {}},
+                      {"xyz.openbmc_project.Inventory.Item",
+                       {{"PrettyName", std::string("chassis")},
+                        {"Present", true}}}}});
+    model.add(Object{inventoryService,
+                     boardPath,
+                     {{"xyz.openbmc_project.Inventory.Item.Board", {}},
+                      {"xyz.openbmc_project.Inventory.Item",
+                       {{"PrettyName", std::string("motherboard")},
+                        {"Present", true}}}}});
+    model.addManager(inventoryService, "/xyz/openbmc_project/inventory");
+
+    std::vector<std::string> psuPaths;
+    for (size_t i = 0; i < config.powerSupplies; i++)
+    {
+        std::string path =
+            std::string(boardPath) + "/powersupply" + std::to_string(i);
+        model.add(Object{
+            inventoryService,
+            path,
+            {{"xyz.openbmc_project.Inventory.Item.PowerSupply", {}},
+             {"xyz.openbmc_project.Inventory.Item",
+              {{"PrettyName", "powersupply" + std::to_string(i)},
+               {"Present", true}}},
+             {"xyz.openbmc_project.Inventory.Decorator.Asset",
+              {{"Manufacturer", std::string("OpenBMC")},
+               {"Model", std::string("PSU-1600")},
+               {"PartNumber", std::string("PN-0001")},
+               {"SerialNumber", "SN" + std::to_string(i)}}},
+             {"xyz.openbmc_project.State.Decorator.OperationalStatus",
+              {{"Functional", true}}}}});
+        psuPaths.emplace_back(std::move(path));
+    }
+
+    std::vector<std::string> allSensors;
+    std::map<std::string, bool> sensorServices;
+    for (const SensorType& type : sensorTypes)
+    {
+        size_t count = config.sensors * type.share / 100;
+        for (size_t i = 0; i < count; i++)
+        {
+            std::string path = std::string("/xyz/openbmc_project/sensors/") +
+                               type.type + "/" + type.type + "_" +
+                               std::to_string(i);
+            model.add(Object{
+                type.service,
+                path,
+                {{"xyz.openbmc_project.Sensor.Value",
+                  {{"Value", type.value + static_cast<double>(i % 10)},
+                   {"MaxValue", type.value * 4},
+                   {"MinValue", 0.0},
+                   {"Unit", std::string(type.unit)}}},
+                 {"xyz.openbmc_project.State.Decorator.OperationalStatus",
+                  {{"Functional", true}}},
+                 {"xyz.openbmc_project.State.Decorator.Availability",
+                  {{"Available", true}}}}});
+            model.addAssociation(path + "/chassis", {chassisPath});
+            if (std::string_view(type.service) ==
+                    "xyz.openbmc_project.PSUSensor" &&
+                !psuPaths.empty())
+            {
+                model.addAssociation(path + "/inventory",
+                                     {psuPaths[i % psuPaths.size()]});
+            }
+            allSensors.emplace_back(std::move(path));
+        }
+        sensorServices[type.service] = true;
+    }
+    for (const auto& [service, unused] : sensorServices)
+    {
+        model.addManager(service, "/xyz/openbmc_project/sensors");
+    }
+    model.addAssociation(std::string(chassisPath) + "/all_sensors",
+                         allSensors);
+    model.addAssociation(std::string(boardPath) + "/all_sensors",
+                         std::move(allSensors));
+
+    for (size_t i = 0; i < config.dimms; i++)
+    {
+        model.add(Object{
+            inventoryService,
+            std::string(boardPath) + "/dimm" + std::to_string(i),
+            {{"xyz.openbmc_project.Inventory.Item.Dimm",
+              {{"MemorySizeInKB", uint32_t(32 * 1024 * 1024)},
+               {"MemoryDataWidth", uint16_t(64)},
+               {"MemoryType",
+                std::string(
+                    "xyz.openbmc_project.Inventory.Item.Dimm.DeviceType.DDR4")},
+               {"MemoryConfiguredSpeedInMhz", uint16_t(3200)}}},
+             {"xyz.openbmc_project.Inventory.Item",
+              {{"PrettyName", "dimm" + std::to_string(i)}, {"Present", true}}},
+             {"xyz.openbmc_project.Inventory.Decorator.Asset",
+              {{"Manufacturer", std::string("OpenBMC")},
+               {"PartNumber", std::string("DIMM-0001")},
+               {"SerialNumber", "DIMM" + std::to_string(i)}}},
+             {"xyz.openbmc_project.State.Decorator.OperationalStatus",
+              {{"Functional", true}}}}});
+    }
+
+    for (size_t i = 1; i <= config.logEntries; i++)
+    {
+        uint64_t timestamp = 1600000000000ULL + i * 1000ULL;
+        model.add(Object{
+            loggingService,
+            "/xyz/openbmc_project/logging/entry/" + std::to_string(i),
+            {{"xyz.openbmc_project.Logging.Entry",
+              {{"Id", static_cast<uint32_t>(i)},
+               {"Message", std::string("xyz.openbmc_project.Common.Error."
+                                       "InternalFailure")},
+               {"Severity",
+                std::string(i % 10 == 0 ? "xyz.openbmc_project.Logging.Entry."
+                                          "Level.Critical"
+                                        : "xyz.openbmc_project.Logging.Entry."
+                                          "Level.Informational")},
+               {"Timestamp", timestamp},
+               {"UpdateTimestamp", timestamp},
+               {"Resolved", false}}}}});
+    }
+    model.addManager(loggingService, "/xyz/openbmc_project/logging");
+
+    std::vector<std::string> functional;
+    for (size_t i = 0; i < config.firmware; i++)
+    {
+        std::string path =
+            "/xyz/openbmc_project/software/" + std::to_string(1000 + i);
+        model.add(Object{
+            softwareService,
+            path,
+            {{"xyz.openbmc_project.Software.Version",
+              {{"Version", "2.10.0-dev-" + std::to_string(i)},
+               {"Purpose", std::string("xyz.openbmc_project.Software."
+                                       "Version.VersionPurpose.BMC")}}},
+             {"xyz.openbmc_project.Software.Activation",
+              {{"Activation", std::string("xyz.openbmc_project.Software."
+                                          "Activation.Activations.Active")},
+               {"RequestedActivation",
+                std::string("xyz.openbmc_project.Software.Activation."
+                            "RequestedActivations.None")}}}}});
+        if (functional.empty())
+        {
+            functional.emplace_back(path);
+        }
+    }
+    if (!functional.empty())
+    {
+        model.addAssociation("/xyz/openbmc_project/software/functional",
+                             std::move(functional));
+    }
+    model.addManager(softwareService, "/xyz/openbmc_project/software");
+
+    model.addManager(mapperService, "/");
+    model.index[mapperPath][mapperService].emplace_back(
+        "xyz.openbmc_project.ObjectMapper");
+    return model;
+}
+
+/**
+ * A private dbus-daemon, torn down with this object.
+ */
+class DbusDaemon
+{
+  public:
+    bool start(const std::string& binary)
+    {
+        std::array<int, 2> fds{};
+        if (pipe(fds.data()) != 0)
+        {
+            return false;
+        }
+        pid = fork();
+        if (pid == 0)
+        {
+            dup2(fds[1], STDOUT_FILENO);
+            close(fds[0]);
+            close(fds[1]);
+            execlp(binary.c_str(), binary.c_str(), "--session", "--nofork",
+                   "--nopidfile", "--print-address", nullptr);
+            _exit(127);
+        }
+        close(fds[1]);
+        if (pid < 0)
+        {
+            close(fds[0]);
+            return false;
+        }
+
+        char c = '\0';
+        while (read(fds[0], &c, 1) == 1 && c != '\n')
+        {
+            address += c;
+        }
+        close(fds[0]);
+        return !address.empty();
+    }
+
+    ~DbusDaemon()
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+
+    std::string address;
+    pid_t pid = -1;
+};
+
+/**
+ * Serves the model.  Runs in its own process, so its memory and CPU time are
+ * kept apart from what is measured on the bmcweb side.
+ */
+/**
+ * Changes the Value of the sensors round-robin, at updatesPerSecond in
+ * total, the way sensor daemons do as they poll their hardware.
+ */
+class SensorUpdater
+{
+  public:
+    SensorUpdater(
+        boost::asio::io_context& io,
+        std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> valuesIn,
+        size_t updatesPerSecond) :
+        timer(io),
+        values(std::move(valuesIn)), perTick(updatesPerSecond / ticksPerSecond)
+    {
+        if (perTick == 0)
+        {
+            perTick = 1;
+        }
+    }
+
+    void start()
+    {
+        if (values.empty())
+        {
+            return;
+        }
+        timer.expires_after(std::chrono::milliseconds(1000 / ticksPerSecond));
+        timer.async_wait([this](const boost::system::error_code& ec) {
+            if (ec)
+            {
+                return;
+            }
+            for (size_t i = 0; i < perTick; i++)
+            {
+                next = (next + 1) % values.size();
+                round += next == 0 ? 1 : 0;
+                values[next]->set_property(
+                    "Value", 40.0 + static_cast<double>((round + next) % 20));
+            }
+            start();
+        });
+    }
+
+  private:
+    static constexpr size_t ticksPerSecond = 100;
+    boost::asio::steady_timer timer;
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> values;
+    size_t perTick;
+    size_t next = 0;
+    size_t round = 0;
+};
+
+inline int serveModel(const Model& model, size_t sensorUpdates, int readyFd)
+{
+    boost::asio::io_context io;
+    std::map<std::string, std::shared_ptr<sdbusplus::asio::connection>>
+        connections;
+    std::vector<std::unique_ptr<sdbusplus::asio::object_server>> servers;
+    std::vector<std::unique_ptr<sdbusplus::server::manager::manager>> managers;
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> interfaces;
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> values;
+    std::map<std::string, sdbusplus::asio::object_server*> serverByService;
+
+    auto getServer = [&](const std::string& service) {
+        auto it = serverByService.find(service);
+        if (it != serverByService.end())
+        {
+            return it->second;
+        }
+        auto conn = std::make_shared<sdbusplus::asio::connection>(io);
+        conn->request_name(service.c_str());
+        connections[service] = conn;
+        servers.emplace_back(
+            std::make_unique<sdbusplus::asio::object_server>(conn));
+        serverByService[service] = servers.back().get();
+        return servers.back().get();
+    };
+
+    for (const Object& object : model.objects)
+    {
+        sdbusplus::asio::object_server* server = getServer(object.service);
+        for (const auto& [ifaceName, properties] : object.interfaces)
+        {
+            std::shared_ptr<sdbusplus::asio::dbus_interface> iface =
+                server->add_interface(object.path, ifaceName);
+            for (const auto& [name, value] : properties)
+            {
+                std::visit(
+                    [&iface, &name](const auto& v) {
+                        iface->register_property(name, v);
+                    },
+                    value);
+            }
+            iface->initialize();
+            if (ifaceName == "xyz.openbmc_project.Sensor.Value")
+            {
+                values.emplace_back(iface);
+            }
+            interfaces.emplace_back(std::move(iface));
+        }
+    }
+
+    sdbusplus::asio::object_server* mapper = getServer(mapperService);
+    std::shared_ptr<sdbusplus::asio::dbus_interface> mapperIface =
+        mapper->add_interface(mapperPath, "xyz.openbmc_project.ObjectMapper");
+    mapperIface->register_method(
+        "GetSubTree", [&model](const std::string& path, int32_t depth,
+                               const std::vector<std::string>& ifaces) {
+            return model.getSubTree(path, depth, ifaces);
+        });
+    mapperIface->register_method(
+        "GetSubTreePaths", [&model](const std::string& path, int32_t depth,
+                                    const std::vector<std::string>& ifaces) {
+            return model.getSubTreePaths(path, depth, ifaces);
+        });
+    mapperIface->register_method(
+        "GetObject", [&model](const std::string& path,
+                              const std::vector<std::string>& ifaces) {
+            return model.getObject(path, ifaces);
+        });
+    mapperIface->initialize();
+
+    for (const auto& [service, paths] : model.managers)
+    {
+        sdbusplus::bus::bus& bus = *connections[service];
+        for (const std::string& path : paths)
+        {
+            managers.emplace_back(
+                std::make_unique<sdbusplus::server::manager::manager>(
+                    bus, path.c_str()));
+        }
+    }
+
+    char ready = 'r';
+    if (write(readyFd, &ready, 1) != 1)
+    {
+        return EXIT_FAILURE;
+    }
+    close(readyFd);
+
+    SensorUpdater updater(io, std::move(values), sensorUpdates);
+    if (sensorUpdates > 0)
+    {
+        updater.start();
+    }
+    io.run();
+    return EXIT_SUCCESS;
+}
+
+// Replies received by bmcweb's connection, one per completed method call
+static size_t methodCallCount = 0;
+
+inline int countReplies(sd_bus_message* m, void*, sd_bus_error*)
+{
+    uint8_t type = 0;
+    if (sd_bus_message_get_type(m, &type) >= 0 &&
+        (type == SD_BUS_MESSAGE_METHOD_RETURN ||
+         type == SD_BUS_MESSAGE_METHOD_ERROR))
+    {
+        methodCallCount++;
+    }
+    return 0;
+}
+
+inline void resetPeakRss()
+{
+    // Writing 5 to clear_refs resets VmHWM to the current RSS
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+}
+
+inline size_t readPeakRssKib()
+{
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::strtoul(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    return 0;
+}
+
+struct RouteResult
+{
+    std::vector<std::chrono::nanoseconds> latencies;
+    std::vector<size_t> calls;
+    unsigned status = 0;
+    size_t bodyBytes = 0;
+};
+
+inline RouteResult replay(App& app, boost::asio::io_context& io,
+                          const std::string& route, size_t iterations)
+{
+    RouteResult result;
+    for (size_t i = 0; i < iterations; i++)
+    {
+        boost::beast::http::request<boost::beast::http::string_body> beastReq(
+            boost::beast::http::verb::get, route, 11);
+        beastReq.set(boost::beast::http::field::host, "localhost");
+        crow::Request req(std::move(beastReq));
+        req.urlView = boost::urls::url_view(req.target());
+        req.url = req.urlView.encoded_path();
+        req.urlParams = req.urlView.params();
+        req.ioService = &io;
+
+        crow::Response res;
+        bool done = false;
+        res.setCompleteRequestHandler([&done] { done = true; });
+
+        size_t callsBefore = methodCallCount;
+        Clock::time_point start = Clock::now();
+        {
+            auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
+            app.handle(req, asyncResp);
+        }
+        while (!done)
+        {
+            io.run_one();
+        }
+        result.latencies.emplace_back(Clock::now() - start);
+        result.calls.emplace_back(methodCallCount - callsBefore);
+        result.status = res.resultInt();
+        result.bodyBytes = res.jsonValue.dump().size();
+    }
+    return result;
+}
+
+inline double toUs(std::chrono::nanoseconds ns)
+{
+    return std::chrono::duration<double, std::micro>(ns).count();
+}
+
+inline void printResult(const std::string& route, RouteResult& result,
+                        size_t peakRssKib)
+{
+    std::sort(result.latencies.begin(), result.latencies.end());
+    auto pct = [&result](double fraction) {
+        size_t index = static_cast<size_t>(
+            fraction * static_cast<double>(result.latencies.size() - 1) + 0.5);
+        return toUs(result.latencies[index]);
+    };
+    size_t totalCalls = 0;
+    for (size_t calls : result.calls)
+    {
+        totalCalls += calls;
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << route << ": status=" << result.status
+              << " iterations=" << result.latencies.size()
+              << " body_bytes=" << result.bodyBytes << "\n";
+    std::cout << "  latency_us p50=" << pct(0.5) << " p90=" << pct(0.9)
+              << " max=" << toUs(result.latencies.back()) << "\n";
+    std::cout << "  dbus_calls_per_request="
+              << static_cast<double>(totalCalls) /
+                     static_cast<double>(result.calls.size())
+              << " peak_rss_kib=" << peakRssKib << "\n";
+}
+
+inline bool parseArgs(int argc, char** argv, Config& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        size_t eq = arg.find('=');
+        if (eq == std::string_view::npos)
+        {
+            return false;
+        }
+        std::string_view key = arg.substr(0, eq);
+        std::string value(arg.substr(eq + 1));
+        size_t number = std::strtoul(value.c_str(), nullptr, 10);
+        if (key == "--sensors")
+        {
+            config.sensors = number;
+        }
+        else if (key == "--sensor-updates")
+        {
+            config.sensorUpdates = number;
+        }
+        else if (key == "--dimms")
+        {
+            config.dimms = number;
+        }
+        else if (key == "--log-entries")
+        {
+            config.logEntries = number;
+        }
+        else if (key == "--firmware")
+        {
+            config.firmware = number;
+        }
+        else if (key == "--iterations" && number > 0)
+        {
+            config.iterations = number;
+        }
+        else if (key == "--route")
+        {
+            config.routes.emplace_back(std::move(value));
+        }
+        else if (key == "--dbus-daemon")
+        {
+            config.dbusDaemon = std::move(value);
+        }
+        else
+        {
+            return false;
+        }
+    }
+    if (config.routes.empty())
+    {
+        config.routes = {
+            "/redfish/v1/Chassis/chassis/Thermal",
+            "/redfish/v1/Chassis/chassis/Power",
+            "/redfish/v1/Chassis/chassis/Sensors",
+            "/redfish/v1/Chassis/chassis/Sensors/temperature_0",
+            "/redfish/v1/Systems/system/Memory",
+            "/redfish/v1/Systems/system/Memory/dimm0",
+            "/redfish/v1/Systems/system/LogServices/EventLog/Entries",
+            "/redfish/v1/UpdateService/FirmwareInventory",
+        };
+    }
+    return true;
+}
+
+} // namespace scale
+} // namespace bench
+
+int main(int argc, char** argv)
+{
+    bench::scale::Config config;
+    if (!bench::scale::parseArgs(argc, argv, config))
+    {
+        std::cerr << "Usage: bmcweb-scale-bench [--sensors=<n>] [--dimms=<n>] "
+                     "[--log-entries=<n>]\n"
+                     "         [--firmware=<n>] [--sensor-updates=<n>] "
+                     "[--iterations=<n>]\n"
+                     "         [--route=<url>]... [--dbus-daemon=<path>]\n";
+        return EXIT_FAILURE;
+    }
+
+    bench::scale::DbusDaemon daemon;
+    if (!daemon.start(config.dbusDaemon))
+    {
+        std::cerr << "Failed to start " << config.dbusDaemon << "\n";
+        return EXIT_FAILURE;
+    }
+    // Both sides of the test talk to the private daemon as their system bus
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", daemon.address.c_str(), 1);
+
+    std::array<int, 2> readyPipe{};
+    if (pipe(readyPipe.data()) != 0)
+    {
+        return EXIT_FAILURE;
+    }
+    pid_t modelPid = fork();
+    if (modelPid == 0)
+    {
+        close(readyPipe[0]);
+        bench::scale::Model model = bench::scale::generateModel(config);
+        _exit(bench::scale::serveModel(model, config.sensorUpdates,
+                                       readyPipe[1]));
+    }
+    close(readyPipe[1]);
+    char ready = '\0';
+    if (modelPid < 0 || read(readyPipe[0], &ready, 1) != 1)
+    {
+        std::cerr << "Object model failed to start\n";
+        return EXIT_FAILURE;
+    }
+    close(readyPipe[0]);
+
+    crow::Logger::setLogLevel(crow::LogLevel::Critical);
+
+    auto io = std::make_shared<boost::asio::io_context>();
+    App app(io);
+    crow::connections::systemBus =
+        std::make_shared<crow::connections::Bus>(*io);
+    sd_bus_add_filter(crow::connections::systemBus->get(), nullptr,
+                      bench::scale::countReplies, nullptr);
+
+    redfish::RedfishService redfish(app);
+    app.validate();
+
+    std::cout << "model: sensors=" << config.sensors
+              << " dimms=" << config.dimms
+              << " log_entries=" << config.logEntries
+              << " firmware=" << config.firmware
+              << " sensor_updates=" << config.sensorUpdates << "\n";
+    for (const std::string& route : config.routes)
+    {
+        bench::scale::resetPeakRss();
+        bench::scale::RouteResult result =
+            bench::scale::replay(app, *io, route, config.iterations);
+        bench::scale::printResult(route, result,
+                                  bench::scale::readPeakRssKib());
+    }
+
+    crow::connections::systemBus.reset();
+    kill(modelPid, SIGTERM);
+    waitpid(modelPid, nullptr, 0);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,932 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+// bmcweb-bench: in-process HTTP load generator.
+//
+// Starts a crow::App with a handful of stub routes on loopback, then drives
+// it with keep-alive client connections (plain and/or TLS) from the same
+// io_context.  By default only Connection, Router and response serialization
+// are on the measured path: the stub routes are whitelisted like static
+// assets, so no D-Bus or authentication backend is required.  With
+// --auth-user, every request instead carries the X-Auth-Token of a session
+// for that user, and goes through authentication and the GetUserInfo
+// privilege lookup, which needs the system bus and User.Manager of a BMC.
+//
+// With --tree, instead measures fetching a whole stub inventory collection:
+// once by walking it the way a client without $expand has to, one GET per
+// member, and once with a single GET using $expand.
+
+#include <app.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/ssl/context.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/write.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/core/tcp_stream.hpp>
+#include <boost/beast/http/read.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/beast/ssl/ssl_stream.hpp>
+#include <dbus_singleton.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sessions.hpp>
+#include <ssl_key_handler.hpp>
+#include <webroutes.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace bench
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Config
+{
+    std::string route = "/bench/json";
+    size_t connections = 16;
+    size_t requests = 2000;
+    size_t pipeline = 1;
+    size_t members = 32;
+    size_t tree = 0;
+    size_t memberDelayUs = 500;
+    size_t timeoutSeconds = 120;
+    bool plain = true;
+    bool tls = true;
+    // Authenticate as this user rather than whitelist the stub routes
+    std::string authUser;
+    std::string authToken;
+};
+
+struct Stats
+{
+    std::vector<std::chrono::nanoseconds> latencies;
+    size_t errors = 0;
+    size_t bytes = 0;
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+inline void printUsage()
+{
+    std::cerr
+        << "Usage: bmcweb-bench [options]\n"
+           "  --route=<url>        Route to request (default /bench/json)\n"
+           "                       /bench/empty, /bench/json, "
+           "/bench/param/<str>\n"
+           "  --connections=<n>    Concurrent keep-alive connections\n"
+           "  --requests=<n>       Requests per connection\n"
+           "  --pipeline=<n>       Requests in flight per connection\n"
+           "  --members=<n>        Members in the /bench/json document\n"
+           "  --tree=<n>           Fetch an <n> member inventory tree, "
+           "walking it\n"
+           "                       and with $expand (needs "
+           "-Dredfish-expand=enabled)\n"
+           "  --member-delay-us=<n> Time each tree member takes to build\n"
+           "  --timeout=<seconds>  Abort a phase that takes longer\n"
+           "  --auth-user=<name>   Authenticate requests with a session for\n"
+           "                       <name> (needs D-Bus and User.Manager)\n"
+           "  --plain-only         Only run the non-TLS phase\n"
+           "  --tls-only           Only run the TLS phase\n";
+}
+
+inline bool parseSize(std::string_view value, size_t& out)
+{
+    char* end = nullptr;
+    std::string str(value);
+    unsigned long long parsed = std::strtoull(str.c_str(), &end, 10);
+    if (str.empty() || end == nullptr || *end != '\0' || parsed == 0)
+    {
+        return false;
+    }
+    out = static_cast<size_t>(parsed);
+    return true;
+}
+
+inline bool parseArgs(int argc, char** argv, Config& config)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+        size_t eq = arg.find('=');
+        std::string_view key = arg.substr(0, eq);
+        std::string_view value;
+        if (eq != std::string_view::npos)
+        {
+            value = arg.substr(eq + 1);
+        }
+
+        bool ok = true;
+        if (key == "--route")
+        {
+            config.route = std::string(value);
+            ok = !config.route.empty();
+        }
+        else if (key == "--connections")
+        {
+            ok = parseSize(value, config.connections);
+        }
+        else if (key == "--requests")
+        {
+            ok = parseSize(value, config.requests);
+        }
+        else if (key == "--pipeline")
+        {
+            ok = parseSize(value, config.pipeline);
+        }
+        else if (key == "--members")
+        {
+            ok = parseSize(value, config.members);
+        }
+        else if (key == "--tree")
+        {
+            ok = parseSize(value, config.tree);
+        }
+        else if (key == "--member-delay-us")
+        {
+            ok = parseSize(value, config.memberDelayUs);
+        }
+        else if (key == "--timeout")
+        {
+            ok = parseSize(value, config.timeoutSeconds);
+        }
+        else if (key == "--auth-user")
+        {
+            config.authUser = std::string(value);
+            ok = !config.authUser.empty();
+        }
+        else if (key == "--plain-only")
+        {
+            config.tls = false;
+        }
+        else if (key == "--tls-only")
+        {
+            config.plain = false;
+        }
+        else
+        {
+            ok = false;
+        }
+        if (!ok)
+        {
+            std::cerr << "Invalid argument " << arg << "\n";
+            return false;
+        }
+    }
+#ifndef BMCWEB_ENABLE_SSL
+    config.tls = false;
+#endif
+    return config.plain || config.tls;
+}
+
+constexpr const char* treeRoute = "/redfish/v1/BenchInventory";
+
+inline std::string treeMember(size_t index)
+{
+    return std::string(treeRoute) + "/chassis" + std::to_string(index);
+}
+
+// A GET of target, with the session token when requests are authenticated
+inline std::string makeRequest(const Config& config, std::string_view target)
+{
+    std::string request = "GET ";
+    request += target;
+    request += " HTTP/1.1\r\nHost: localhost\r\nAccept: application/json\r\n";
+    if (!config.authToken.empty())
+    {
+        request += "X-Auth-Token: ";
+        request += config.authToken;
+        request += "\r\n";
+    }
+    request += "\r\n";
+    return request;
+}
+
+inline void requestRoutes(App& app, const Config& config)
+{
+    BMCWEB_ROUTE(app, "/bench/empty")
+        .privileges({{"Login"}})
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>&) {});
+
+    // Shaped like a typical Redfish collection, so that serialization cost is
+    // representative of real responses
+    BMCWEB_ROUTE(app, "/bench/json")
+        .privileges({{"Login"}})
+        .methods(boost::beast::http::verb::get)(
+            [members{config.members}](
+                const crow::Request&,
+                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                nlohmann::json& json = asyncResp->res.jsonValue;
+                json["@odata.type"] = "#SensorCollection.SensorCollection";
+                json["@odata.id"] = "/bench/json";
+                json["Name"] = "Bench Collection";
+                nlohmann::json& memberArray = json["Members"];
+                memberArray = nlohmann::json::array();
+                for (size_t i = 0; i < members; i++)
+                {
+                    std::string id = "/bench/json/member" + std::to_string(i);
+                    memberArray.push_back({{"@odata.id", std::move(id)},
+                                           {"Reading", 42.5},
+                                           {"Status",
+                                            {{"Health", "OK"},
+                                             {"State", "Enabled"}}}});
+                }
+                json["Members@odata.count"] = members;
+            });
+
+    BMCWEB_ROUTE(app, "/bench/param/<str>")
+        .privileges({{"Login"}})
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+               const std::string& param) {
+                asyncResp->res.jsonValue["Id"] = param;
+            });
+
+    // An inventory collection whose members each take memberDelayUs to
+    // build, standing in for the D-Bus reads of a real resource
+    BMCWEB_ROUTE(app, "/redfish/v1/BenchInventory")
+        .privileges({{"Login"}})
+        .methods(boost::beast::http::verb::get)(
+            [members{config.tree}](
+                const crow::Request&,
+                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                nlohmann::json& json = asyncResp->res.jsonValue;
+                json["@odata.type"] = "#ChassisCollection.ChassisCollection";
+                json["@odata.id"] = treeRoute;
+                json["Name"] = "Bench Inventory";
+                nlohmann::json& memberArray = json["Members"];
+                memberArray = nlohmann::json::array();
+                for (size_t i = 0; i < members; i++)
+                {
+                    memberArray.push_back({{"@odata.id", treeMember(i)}});
+                }
+                json["Members@odata.count"] = members;
+            });
+
+    BMCWEB_ROUTE(app, "/redfish/v1/BenchInventory/<str>")
+        .privileges({{"Login"}})
+        .methods(boost::beast::http::verb::get)(
+            [delay{std::chrono::microseconds(config.memberDelayUs)}](
+                const crow::Request& req,
+                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                const std::string& id) {
+                auto timer =
+                    std::make_shared<boost::asio::steady_timer>(*req.ioService);
+                timer->expires_after(delay);
+                timer->async_wait([timer, asyncResp,
+                                   id](const boost::system::error_code&) {
+                    nlohmann::json& json = asyncResp->res.jsonValue;
+                    json["@odata.type"] = "#Chassis.v1_14_0.Chassis";
+                    json["@odata.id"] = std::string(treeRoute) + "/" + id;
+                    json["Id"] = id;
+                    json["Name"] = "Bench Chassis";
+                    json["ChassisType"] = "RackMount";
+                    json["Manufacturer"] = "OpenBMC";
+                    json["SerialNumber"] = "0123456789";
+                    json["PowerState"] = "On";
+                    json["Status"] = {{"Health", "OK"}, {"State", "Enabled"}};
+                });
+            });
+
+    if (!config.authUser.empty())
+    {
+        return;
+    }
+    // Without --auth-user, the stub routes are served without
+    // authentication, the same way static assets are, so no PAM or
+    // User.Manager backend is needed
+    crow::webroutes::routes.insert(config.route);
+    crow::webroutes::routes.insert("/bench/empty");
+    crow::webroutes::routes.insert("/bench/json");
+    crow::webroutes::routes.insert(treeRoute);
+    for (size_t i = 0; i < config.tree; i++)
+    {
+        crow::webroutes::routes.insert(treeMember(i));
+    }
+}
+
+template <typename Stream>
+class Client : public std::enable_shared_from_this<Client<Stream>>
+{
+  public:
+    Client(Stream&& streamIn, const Config& configIn, Stats& statsIn,
+           std::function<void()>&& onDoneIn) :
+        stream(std::move(streamIn)),
+        config(configIn), stats(statsIn), onDone(std::move(onDoneIn))
+    {
+        request = makeRequest(config, config.route);
+    }
+
+    void start(const boost::asio::ip::tcp::endpoint& endpoint)
+    {
+        boost::beast::get_lowest_layer(stream).async_connect(
+            endpoint,
+            [self(this->shared_from_this())](boost::system::error_code ec) {
+                if (ec)
+                {
+                    self->fail("connect", ec);
+                    return;
+                }
+                self->doHandshake();
+            });
+    }
+
+  private:
+    void doHandshake()
+    {
+        if constexpr (std::is_same_v<Stream, boost::beast::ssl_stream<
+                                                 boost::beast::tcp_stream>>)
+        {
+            stream.async_handshake(
+                boost::asio::ssl::stream_base::client,
+                [self(this->shared_from_this())](boost::system::error_code ec) {
+                    if (ec)
+                    {
+                        self->fail("handshake", ec);
+                        return;
+                    }
+                    self->doWrite();
+                });
+        }
+        else
+        {
+            doWrite();
+        }
+    }
+
+    void doWrite()
+    {
+        if (sent == config.requests)
+        {
+            finish();
+            return;
+        }
+        size_t batch = std::min(config.pipeline, config.requests - sent);
+        outstanding = batch;
+        sent += batch;
+        writeBuffer.clear();
+        for (size_t i = 0; i < batch; i++)
+        {
+            writeBuffer += request;
+        }
+        batchStart = Clock::now();
+        boost::asio::async_write(
+            stream, boost::asio::buffer(writeBuffer),
+            [self(this->shared_from_this())](boost::system::error_code ec,
+                                             size_t) {
+                if (ec)
+                {
+                    self->fail("write", ec);
+                    return;
+                }
+                self->doRead();
+            });
+    }
+
+    void doRead()
+    {
+        response.emplace();
+        response->body_limit(std::numeric_limits<uint64_t>::max());
+        boost::beast::http::async_read(
+            stream, readBuffer, *response,
+            [self(this->shared_from_this())](boost::system::error_code ec,
+                                             size_t bytesTransferred) {
+                if (ec)
+                {
+                    self->fail("read", ec);
+                    return;
+                }
+                self->stats.latencies.emplace_back(Clock::now() -
+                                                   self->batchStart);
+                self->stats.bytes += bytesTransferred;
+                if (self->response->get().result() !=
+                    boost::beast::http::status::ok)
+                {
+                    self->stats.errors++;
+                }
+                self->outstanding--;
+                if (self->outstanding > 0)
+                {
+                    self->doRead();
+                    return;
+                }
+                self->doWrite();
+            });
+    }
+
+    void fail(std::string_view what, const boost::system::error_code& ec)
+    {
+        std::cerr << "Client " << what << " failed: " << ec.message() << "\n";
+        stats.errors += config.requests - (sent - outstanding);
+        finish();
+    }
+
+    void finish()
+    {
+        boost::system::error_code ec;
+        boost::beast::get_lowest_layer(stream).socket().close(ec);
+        if (onDone)
+        {
+            std::function<void()> done = std::move(onDone);
+            onDone = nullptr;
+            done();
+        }
+    }
+
+    Stream stream;
+    const Config& config;
+    Stats& stats;
+    std::function<void()> onDone;
+
+    std::string request;
+    std::string writeBuffer;
+    boost::beast::flat_buffer readBuffer;
+    std::optional<boost::beast::http::response_parser<
+        boost::beast::http::string_body>>
+        response;
+    size_t sent = 0;
+    size_t outstanding = 0;
+    Clock::time_point batchStart;
+};
+
+// Fetches the whole stub inventory tree, config.requests times.  Without
+// expand, the way a client has to: the collection, then each of its members
+// in turn.  With expand, config.route is expected to ask for $expand, and a
+// response whose members weren't expanded counts as an error.  Records the
+// time of each complete fetch.
+template <typename Stream>
+class TreeClient : public std::enable_shared_from_this<TreeClient<Stream>>
+{
+  public:
+    TreeClient(Stream&& streamIn, const Config& configIn, Stats& statsIn,
+               std::function<void()>&& onDoneIn, bool expandIn) :
+        stream(std::move(streamIn)),
+        config(configIn), stats(statsIn), onDone(std::move(onDoneIn)),
+        expand(expandIn)
+    {}
+
+    void start(const boost::asio::ip::tcp::endpoint& endpoint)
+    {
+        boost::beast::get_lowest_layer(stream).async_connect(
+            endpoint,
+            [self(this->shared_from_this())](boost::system::error_code ec) {
+                if (ec)
+                {
+                    self->fail("connect", ec);
+                    return;
+                }
+                self->doHandshake();
+            });
+    }
+
+  private:
+    void doHandshake()
+    {
+        if constexpr (std::is_same_v<Stream, boost::beast::ssl_stream<
+                                                 boost::beast::tcp_stream>>)
+        {
+            stream.async_handshake(
+                boost::asio::ssl::stream_base::client,
+                [self(this->shared_from_this())](boost::system::error_code ec) {
+                    if (ec)
+                    {
+                        self->fail("handshake", ec);
+                        return;
+                    }
+                    self->nextFetch();
+                });
+        }
+        else
+        {
+            nextFetch();
+        }
+    }
+
+    void nextFetch()
+    {
+        if (fetched == config.requests)
+        {
+            finish();
+            return;
+        }
+        fetched++;
+        fetchStart = Clock::now();
+        listing = true;
+        get(config.route);
+    }
+
+    void get(const std::string& target)
+    {
+        writeBuffer = makeRequest(config, target);
+        boost::asio::async_write(
+            stream, boost::asio::buffer(writeBuffer),
+            [self(this->shared_from_this())](boost::system::error_code ec,
+                                             size_t) {
+                if (ec)
+                {
+                    self->fail("write", ec);
+                    return;
+                }
+                self->doRead();
+            });
+    }
+
+    void doRead()
+    {
+        response.emplace();
+        response->body_limit(std::numeric_limits<uint64_t>::max());
+        boost::beast::http::async_read(
+            stream, readBuffer, *response,
+            [self(this->shared_from_this())](boost::system::error_code ec,
+                                             size_t bytesTransferred) {
+                if (ec)
+                {
+                    self->fail("read", ec);
+                    return;
+                }
+                self->stats.bytes += bytesTransferred;
+                self->onResponse();
+            });
+    }
+
+    void onResponse()
+    {
+        const auto& message = response->get();
+        if (message.result() != boost::beast::http::status::ok)
+        {
+            stats.errors++;
+        }
+        if (listing)
+        {
+            listing = false;
+            readMembers(message.body());
+        }
+        if (!toFetch.empty())
+        {
+            std::string next = std::move(toFetch.back());
+            toFetch.pop_back();
+            get(next);
+            return;
+        }
+        stats.latencies.emplace_back(Clock::now() - fetchStart);
+        completed++;
+        nextFetch();
+    }
+
+    void readMembers(const std::string& body)
+    {
+        nlohmann::json json = nlohmann::json::parse(body, nullptr, false);
+        nlohmann::json::iterator members = json.find("Members");
+        if (json.is_discarded() || members == json.end() ||
+            !members->is_array())
+        {
+            stats.errors++;
+            return;
+        }
+        for (const nlohmann::json& member : *members)
+        {
+            bool expanded = member.size() > 1;
+            if (expand)
+            {
+                if (!expanded)
+                {
+                    stats.errors++;
+                }
+                continue;
+            }
+            toFetch.emplace_back(member.value("@odata.id", ""));
+        }
+    }
+
+    void fail(std::string_view what, const boost::system::error_code& ec)
+    {
+        std::cerr << "Client " << what << " failed: " << ec.message() << "\n";
+        stats.errors += config.requests - completed;
+        finish();
+    }
+
+    void finish()
+    {
+        boost::system::error_code ec;
+        boost::beast::get_lowest_layer(stream).socket().close(ec);
+        if (onDone)
+        {
+            std::function<void()> done = std::move(onDone);
+            onDone = nullptr;
+            done();
+        }
+    }
+
+    Stream stream;
+    const Config& config;
+    Stats& stats;
+    std::function<void()> onDone;
+    bool expand;
+
+    std::string writeBuffer;
+    boost::beast::flat_buffer readBuffer;
+    std::optional<boost::beast::http::response_parser<
+        boost::beast::http::string_body>>
+        response;
+    size_t fetched = 0;
+    size_t completed = 0;
+    bool listing = false;
+    std::vector<std::string> toFetch;
+    Clock::time_point fetchStart;
+};
+
+inline std::chrono::nanoseconds percentile(
+    const std::vector<std::chrono::nanoseconds>& sorted, double fraction)
+{
+    if (sorted.empty())
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    size_t index = static_cast<size_t>(
+        fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+inline void printStats(std::string_view phase, const Config& config,
+                       Stats& stats)
+{
+    std::sort(stats.latencies.begin(), stats.latencies.end());
+    double seconds =
+        std::chrono::duration<double>(stats.end - stats.start).count();
+    auto toUs = [](std::chrono::nanoseconds ns) {
+        return std::chrono::duration<double, std::micro>(ns).count();
+    };
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << phase << ": route=" << config.route
+              << " auth=" << (config.authUser.empty() ? "none" : "session")
+              << " connections=" << config.connections
+              << " pipeline=" << config.pipeline
+              << " requests=" << stats.latencies.size() << "\n";
+    std::cout << "  throughput_rps=" << (seconds > 0.0 ?
+                                             static_cast<double>(
+                                                 stats.latencies.size()) /
+                                                 seconds
+                                                       : 0.0)
+              << " bytes=" << stats.bytes << " errors=" << stats.errors
+              << "\n";
+    std::cout << "  latency_us p50=" << toUs(percentile(stats.latencies, 0.50))
+              << " p90=" << toUs(percentile(stats.latencies, 0.90))
+              << " p99=" << toUs(percentile(stats.latencies, 0.99))
+              << " p999=" << toUs(percentile(stats.latencies, 0.999))
+              << " max="
+              << toUs(stats.latencies.empty() ? std::chrono::nanoseconds(0)
+                                              : stats.latencies.back())
+              << "\n";
+}
+
+// Runs config.connections clients of type ClientType<Stream> to completion.
+// Clients are constructed with clientArgs following the usual arguments.
+template <typename Stream, template <typename> class ClientType = Client,
+          typename MakeStream, typename... ClientArgs>
+void runPhase(boost::asio::io_context& io, const Config& config,
+              const boost::asio::ip::tcp::endpoint& endpoint,
+              MakeStream&& makeStream, Stats& stats,
+              std::function<void()>&& onDone, const ClientArgs&... clientArgs)
+{
+    stats.latencies.reserve(config.connections * config.requests);
+    stats.start = Clock::now();
+
+    auto timer = std::make_shared<boost::asio::steady_timer>(io);
+    auto remaining = std::make_shared<size_t>(config.connections);
+    auto done = std::make_shared<std::function<void()>>(std::move(onDone));
+    timer->expires_after(std::chrono::seconds(config.timeoutSeconds));
+    timer->async_wait([&io](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        std::cerr << "Benchmark phase timed out\n";
+        io.stop();
+        std::exit(EXIT_FAILURE);
+    });
+
+    for (size_t i = 0; i < config.connections; i++)
+    {
+        auto client = std::make_shared<ClientType<Stream>>(
+            makeStream(), config, stats,
+            [&stats, timer, remaining, done]() {
+                if (--(*remaining) > 0)
+                {
+                    return;
+                }
+                stats.end = Clock::now();
+                timer->cancel();
+                (*done)();
+            },
+            clientArgs...);
+        client->start(endpoint);
+    }
+}
+
+// A benchmark phase, given the function that starts the next one
+using Phase = std::function<void(std::function<void()>)>;
+
+struct PhaseConfigs
+{
+    const Config& load;
+    const Config& walk;
+    const Config& expand;
+};
+
+// Adds the phases run over one transport: the load phase, or with --tree the
+// walk and $expand phases
+template <typename Stream, typename MakeStream>
+void addPhases(std::vector<Phase>& phases, std::list<Stats>& stats,
+               boost::asio::io_context& io, const PhaseConfigs& configs,
+               const std::string& name,
+               const boost::asio::ip::tcp::endpoint& endpoint,
+               MakeStream makeStream)
+{
+    if (configs.load.tree == 0)
+    {
+        Stats& load = stats.emplace_back();
+        phases.emplace_back([&io, &configs, &load, name, endpoint,
+                             makeStream](std::function<void()> next) {
+            runPhase<Stream>(io, configs.load, endpoint, makeStream, load,
+                             [&configs, &load, name, next]() {
+                                 printStats(name, configs.load, load);
+                                 next();
+                             });
+        });
+        return;
+    }
+
+    Stats& walk = stats.emplace_back();
+    phases.emplace_back([&io, &configs, &walk, name, endpoint,
+                         makeStream](std::function<void()> next) {
+        runPhase<Stream, TreeClient>(
+            io, configs.walk, endpoint, makeStream, walk,
+            [&configs, &walk, name, next]() {
+                printStats(name + " walk", configs.walk, walk);
+                next();
+            },
+            false);
+    });
+    Stats& expand = stats.emplace_back();
+    phases.emplace_back([&io, &configs, &expand, name, endpoint,
+                         makeStream](std::function<void()> next) {
+        runPhase<Stream, TreeClient>(
+            io, configs.expand, endpoint, makeStream, expand,
+            [&configs, &expand, name, next]() {
+                printStats(name + " expand", configs.expand, expand);
+                next();
+            },
+            true);
+    });
+}
+
+template <typename Adaptor>
+std::unique_ptr<crow::Server<App, Adaptor>>
+    startServer(App& app, const std::shared_ptr<boost::asio::io_context>& io,
+                const std::shared_ptr<boost::asio::ssl::context>& ctx,
+                boost::asio::ip::tcp::endpoint& endpoint)
+{
+    auto acceptor = std::make_unique<boost::asio::ip::tcp::acceptor>(
+        *io, boost::asio::ip::tcp::endpoint(
+                 boost::asio::ip::make_address("127.0.0.1"), 0));
+    endpoint = acceptor->local_endpoint();
+    auto server = std::make_unique<crow::Server<App, Adaptor>>(
+        &app, std::move(acceptor), ctx, io);
+    server->run();
+    return server;
+}
+
+} // namespace bench
+
+int main(int argc, char** argv)
+{
+    bench::Config config;
+    if (!bench::parseArgs(argc, argv, config))
+    {
+        bench::printUsage();
+        return EXIT_FAILURE;
+    }
+
+    crow::Logger::setLogLevel(crow::LogLevel::Critical);
+
+    auto io = std::make_shared<boost::asio::io_context>();
+    App app(io);
+    if (!config.authUser.empty())
+    {
+        // Privileges of the session user are looked up over D-Bus per
+        // request, as in bmcweb
+        crow::connections::systemBus =
+            std::make_shared<crow::connections::Bus>(*io);
+        std::shared_ptr<persistent_data::UserSession> session =
+            persistent_data::SessionStore::getInstance().generateUserSession(
+                config.authUser, "127.0.0.1", "bmcweb-bench");
+        if (session == nullptr)
+        {
+            std::cerr << "Failed to create a session\n";
+            return EXIT_FAILURE;
+        }
+        config.authToken = session->sessionToken;
+    }
+    bench::requestRoutes(app, config);
+    app.validate();
+
+    boost::asio::ip::tcp::endpoint plainEndpoint;
+    auto plainServer =
+        bench::startServer<boost::asio::ip::tcp::socket>(
+            app, io, nullptr, plainEndpoint);
+
+#ifdef BMCWEB_ENABLE_SSL
+    // A throwaway certificate, so the benchmark never touches the BMC's real
+    // certificate store
+    std::string pemFile =
+        (std::filesystem::temp_directory_path() / "bmcweb-bench.pem").string();
+    ensuressl::generateSslCertificate(pemFile, "localhost");
+    std::shared_ptr<boost::asio::ssl::context> serverCtx =
+        ensuressl::getSslContext(pemFile);
+    boost::asio::ssl::context clientCtx(boost::asio::ssl::context::tls_client);
+    clientCtx.set_verify_mode(boost::asio::ssl::verify_none);
+
+    boost::asio::ip::tcp::endpoint tlsEndpoint;
+    auto tlsServer = bench::startServer<App::ssl_socket_t>(app, io, serverCtx,
+                                                           tlsEndpoint);
+#endif
+
+    bench::Config walkConfig = config;
+    walkConfig.route = bench::treeRoute;
+    bench::Config expandConfig = config;
+    expandConfig.route = std::string(bench::treeRoute) + "?$expand=.";
+    bench::PhaseConfigs configs{config, walkConfig, expandConfig};
+
+    std::list<bench::Stats> stats;
+    std::vector<bench::Phase> phases;
+    if (config.plain)
+    {
+        bench::addPhases<boost::beast::tcp_stream>(
+            phases, stats, *io, configs, "plain", plainEndpoint,
+            [&]() { return boost::beast::tcp_stream(*io); });
+    }
+#ifdef BMCWEB_ENABLE_SSL
+    if (config.tls)
+    {
+        bench::addPhases<boost::beast::ssl_stream<boost::beast::tcp_stream>>(
+            phases, stats, *io, configs, "tls", tlsEndpoint, [&]() {
+                return boost::beast::ssl_stream<boost::beast::tcp_stream>(
+                    *io, clientCtx);
+            });
+    }
+#endif
+
+    size_t nextPhase = 0;
+    std::function<void()> runNext = [&]() {
+        if (nextPhase == phases.size())
+        {
+            io->stop();
+            return;
+        }
+        phases[nextPhase++](runNext);
+    };
+    runNext();
+
+    io->run();
+
+#ifdef BMCWEB_ENABLE_SSL
+    std::error_code ec;
+    std::filesystem::remove(pemFile, ec);
+#endif
+    crow::connections::systemBus.reset();
+    size_t errors = 0;
+    for (const bench::Stats& phaseStats : stats)
+    {
+        errors += phaseStats.errors;
+    }
+    return errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+
+// bmcweb-kernels-bench: google-benchmark microbenchmarks of the utility
+// routines on the request hot path.  Inputs are fixed so that results are
+// comparable from one run to the next.
+
+#include <benchmark/benchmark.h>
+
+#include <event_service_manager.hpp>
+#include <json_html_serializer.hpp>
+#include <logging.hpp>
+#include <registries/privilege_registry.hpp>
+#include <routing.hpp>
+#include <utility.hpp>
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+namespace kernels
+{
+
+inline std::string makeBinary(size_t size)
+{
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++)
+    {
+        data[i] = static_cast<char>((i * 131) & 0xFF);
+    }
+    return data;
+}
+
+static void base64Encode(benchmark::State& state)
+{
+    std::string data = makeBinary(static_cast<size_t>(state.range(0)));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(crow::utility::base64encode(data));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            state.range(0));
+}
+BENCHMARK(base64Encode)->Arg(16)->Arg(1024)->Arg(64 * 1024);
+
+static void base64Decode(benchmark::State& state)
+{
+    std::string encoded = crow::utility::base64encode(
+        makeBinary(static_cast<size_t>(state.range(0))));
+    std::string decoded;
+    for (auto _ : state)
+    {
+        decoded.clear();
+        benchmark::DoNotOptimize(
+            crow::utility::base64Decode(encoded, decoded));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(encoded.size()));
+}
+BENCHMARK(base64Decode)->Arg(16)->Arg(1024)->Arg(64 * 1024);
+
+// Roughly the shape of a sensor collection response
+inline nlohmann::json makeDocument(size_t members)
+{
+    nlohmann::json doc;
+    doc["@odata.id"] = "/redfish/v1/Chassis/chassis/Thermal";
+    doc["@odata.type"] = "#Thermal.v1_4_0.Thermal";
+    doc["Name"] = "Thermal";
+    nlohmann::json& temps = doc["Temperatures"];
+    temps = nlohmann::json::array();
+    for (size_t i = 0; i < members; i++)
+    {
+        temps.push_back(
+            {{"@odata.id", "/redfish/v1/Chassis/chassis/Thermal#/"
+                           "Temperatures/" +
+                               std::to_string(i)},
+             {"MemberId", "temperature_" + std::to_string(i)},
+             {"Name", "temperature " + std::to_string(i)},
+             {"ReadingCelsius", 40.5 + static_cast<double>(i % 10)},
+             {"UpperThresholdCritical", 95},
+             {"Status", {{"Health", "OK"}, {"State", "Enabled"}}}});
+    }
+    return doc;
+}
+
+static void jsonHtmlDump(benchmark::State& state)
+{
+    nlohmann::json doc = makeDocument(static_cast<size_t>(state.range(0)));
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        json_html_util::dump(out, doc);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(out.size()));
+}
+BENCHMARK(jsonHtmlDump)->Arg(8)->Arg(128);
+
+// A representative subset of the registered Redfish routes
+inline crow::Trie makeTrie()
+{
+    static const std::vector<std::string> routes = {
+        "/redfish/",
+        "/redfish/v1/",
+        "/redfish/v1/Chassis/",
+        "/redfish/v1/Chassis/<str>/",
+        "/redfish/v1/Chassis/<str>/Power/",
+        "/redfish/v1/Chassis/<str>/Thermal/",
+        "/redfish/v1/Chassis/<str>/Sensors/",
+        "/redfish/v1/Chassis/<str>/Sensors/<str>/",
+        "/redfish/v1/Managers/",
+        "/redfish/v1/Managers/bmc/",
+        "/redfish/v1/Managers/bmc/EthernetInterfaces/<str>/",
+        "/redfish/v1/Systems/",
+        "/redfish/v1/Systems/system/",
+        "/redfish/v1/Systems/system/Memory/",
+        "/redfish/v1/Systems/system/Memory/<str>/",
+        "/redfish/v1/Systems/system/Processors/<str>/",
+        "/redfish/v1/Systems/system/LogServices/EventLog/Entries/",
+        "/redfish/v1/Systems/system/LogServices/EventLog/Entries/<str>/",
+        "/redfish/v1/UpdateService/FirmwareInventory/<str>/",
+        "/redfish/v1/SessionService/Sessions/<str>/",
+        "/redfish/v1/AccountService/Accounts/<str>/",
+        "/xyz/openbmc_project/<path>",
+    };
+    crow::Trie trie;
+    unsigned index = 1;
+    for (const std::string& route : routes)
+    {
+        trie.add(route, index++);
+    }
+    trie.validate();
+    return trie;
+}
+
+static void trieFind(benchmark::State& state)
+{
+    crow::Trie trie = makeTrie();
+    const std::vector<std::string_view> urls = {
+        "/redfish/v1/",
+        "/redfish/v1/Chassis/chassis/Sensors/temperature_12/",
+        "/redfish/v1/Systems/system/LogServices/EventLog/Entries/1612345678/",
+        "/xyz/openbmc_project/sensors/temperature/cpu0",
+        "/redfish/v1/NotARoute/",
+    };
+    for (auto _ : state)
+    {
+        for (std::string_view url : urls)
+        {
+            benchmark::DoNotOptimize(trie.find(url));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(urls.size()));
+}
+BENCHMARK(trieFind);
+
+static void privilegeCheck(benchmark::State& state)
+{
+    const std::vector<redfish::Privileges> required(
+        redfish::privileges::privilegeSetConfigureManagerOrConfigureComponents
+            .begin(),
+        redfish::privileges::privilegeSetConfigureManagerOrConfigureComponents
+            .end());
+    const redfish::Privileges& operatorPrivileges =
+        redfish::getUserPrivileges("priv-operator");
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(redfish::isOperationAllowedWithPrivileges(
+            required, operatorPrivileges));
+    }
+}
+BENCHMARK(privilegeCheck);
+
+static void getUserPrivileges(benchmark::State& state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(&redfish::getUserPrivileges("priv-user"));
+    }
+}
+BENCHMARK(getUserPrivileges);
+
+static const std::string logLine =
+    "2021-03-04T10:20:30.123456+00:00 OpenBMC.0.1.SystemPowerOnFailed,"
+    "arg0,arg1";
+
+static void getUniqueEntryID(benchmark::State& state)
+{
+    std::string entryID;
+    bool firstEntry = true;
+    for (auto _ : state)
+    {
+        // Identical timestamps exercise the "_<index>" suffix path too
+        benchmark::DoNotOptimize(redfish::event_log::getUniqueEntryID(
+            logLine, entryID, firstEntry));
+        firstEntry = false;
+    }
+}
+BENCHMARK(getUniqueEntryID);
+
+static void getEventLogParams(benchmark::State& state)
+{
+    std::string timestamp;
+    std::string messageID;
+    std::vector<std::string> messageArgs;
+    for (auto _ : state)
+    {
+        messageArgs.clear();
+        benchmark::DoNotOptimize(redfish::event_log::getEventLogParams(
+            logLine, timestamp, messageID, messageArgs));
+    }
+}
+BENCHMARK(getEventLogParams);
+
+static void formatMessage(benchmark::State& state)
+{
+    // The last entry of the OpenBMC registry is the worst case lookup
+    const std::vector<std::string> messageIds = {
+        "Base.1.10.PropertyValueNotInList",
+        "OpenBMC.0.1.SystemPowerOnFailed",
+        "TaskEvent.1.0.TaskCompletedOK",
+    };
+    for (auto _ : state)
+    {
+        for (const std::string& messageId : messageIds)
+        {
+            benchmark::DoNotOptimize(
+                redfish::message_registries::formatMessage(messageId));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(messageIds.size()));
+}
+BENCHMARK(formatMessage);
+
+static void getDateTime(benchmark::State& state)
+{
+    const std::time_t time = 1614853230;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(crow::utility::getDateTime(time));
+    }
+}
+BENCHMARK(getDateTime);
+
+} // namespace kernels
+} // namespace bench
+
+int main(int argc, char** argv)
+{
+    // Privilege checks log every comparison; keep that out of the timings
+    crow::Logger::setLogLevel(crow::LogLevel::Critical);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "bmcweb_config.h"
+
 #include "async_resp.hpp"
 #include "http_request.hpp"
 #include "http_server.hpp"
@@ -7,14 +9,22 @@
 #include "privileges.hpp"
 #include "routing.hpp"
 #include "utility.hpp"
+#include "utils/etag.hpp"
+#include "utils/query_param.hpp"
+
+#include <grp.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include <chrono>
 #include <cstdint>
+#include <filesystem>
 #include <functional>
 #include <future>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #define BMCWEB_ROUTE(app, url)                                                 \
     app.template route<crow::black_magic::getParameterTag(url)>(url)
@@ -34,6 +44,10 @@ class App
     using socket_t = boost::asio::ip::tcp::socket;
     using server_t = Server<App, socket_t>;
 #endif
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    using unix_socket_t = boost::asio::local::stream_protocol::socket;
+    using unix_server_t = Server<App, unix_socket_t>;
+#endif
 
     explicit App(std::shared_ptr<boost::asio::io_context> ioIn =
                      std::make_shared<boost::asio::io_context>()) :
@@ -53,6 +67,16 @@ class App
     void handle(Request& req,
                 const std::shared_ptr<bmcweb::AsyncResp>& asyncResp)
     {
+        redfish::query_param::Handler handler =
+            [this](Request& subrequest,
+                   const std::shared_ptr<bmcweb::AsyncResp>& subResp) {
+                router.handle(subrequest, subResp);
+            };
+        if (redfish::query_param::handleQuery(req, asyncResp, handler) ||
+            redfish::etag::handleIfMatch(req, asyncResp, handler))
+        {
+            return;
+        }
         router.handle(req, asyncResp);
     }
 
@@ -85,6 +109,20 @@ class App
         return *this;
     }
 
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    App& unixSocket(int existingSocket)
+    {
+        unixSocketFd = existingSocket;
+        return *this;
+    }
+
+    App& unixSocketPath(std::string path)
+    {
+        unixSocketPathStr = std::move(path);
+        return *this;
+    }
+#endif
+
     void validate()
     {
         router.validate();
@@ -120,6 +158,33 @@ class App
         }
         server->run();
 
+#endif
+
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+        if (-1 != unixSocketFd)
+        {
+            unixServer = std::make_unique<unix_server_t>(this, unixSocketFd,
+                                                         nullptr, io);
+        }
+        else if (!unixSocketPathStr.empty())
+        {
+            // Remove any socket left behind by a previous instance, otherwise
+            // bind fails with EADDRINUSE
+            std::error_code ec;
+            std::filesystem::path socketPath(unixSocketPathStr);
+            std::filesystem::create_directories(socketPath.parent_path(), ec);
+            std::filesystem::remove(socketPath, ec);
+            unixServer = std::make_unique<unix_server_t>(
+                this,
+                boost::asio::local::stream_protocol::endpoint(
+                    unixSocketPathStr),
+                nullptr, io);
+            setUnixSocketOwner(unixSocketPathStr);
+        }
+        if (unixServer)
+        {
+            unixServer->run();
+        }
 #endif
     }
 
@@ -128,6 +193,37 @@ class App
         io->stop();
     }
 
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    // Gives a socket bound by bmcweb itself the owner, group and mode that
+    // bmcweb.socket sets on the one systemd binds
+    static void setUnixSocketOwner(const std::string& path)
+    {
+        gid_t gid = 0;
+        long bufSize = sysconf(_SC_GETGR_R_SIZE_MAX);
+        std::vector<char> grBuf(bufSize > 0 ? static_cast<size_t>(bufSize)
+                                            : 16384);
+        group gr{};
+        group* grResult = nullptr;
+        if (getgrnam_r(bmcwebUnixSocketGroup, &gr, grBuf.data(), grBuf.size(),
+                       &grResult) == 0 &&
+            grResult != nullptr)
+        {
+            gid = grResult->gr_gid;
+        }
+        else
+        {
+            BMCWEB_LOG_ERROR << "Group " << bmcwebUnixSocketGroup
+                             << " not found, leaving the local socket to root";
+        }
+        if (chown(path.c_str(), 0, gid) != 0 ||
+            chmod(path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) != 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to set the owner and mode of " << path
+                             << ", errno " << errno;
+        }
+    }
+#endif
+
     void debugPrint()
     {
         BMCWEB_LOG_DEBUG << "Routing:";
@@ -219,6 +315,10 @@ class App
 #endif
     std::string bindaddrStr = "0.0.0.0";
     int socketFd = -1;
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    int unixSocketFd = -1;
+    std::string unixSocketPathStr;
+#endif
     Router router;
 
 #ifdef BMCWEB_ENABLE_SSL
@@ -226,6 +326,9 @@ class App
 #else
     std::unique_ptr<server_t> server;
 #endif
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    std::unique_ptr<unix_server_t> unixServer;
+#endif
 };
 } // namespace crow
 using App = crow::App;
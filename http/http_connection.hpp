@@ -5,13 +5,19 @@
 #include "http_response.hpp"
 #include "http_utility.hpp"
 #include "logging.hpp"
+#include "metrics.hpp"
 #include "timer_queue.hpp"
 #include "utility.hpp"
 
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/ssl/stream.hpp>
 #include <boost/beast/core/flat_static_buffer.hpp>
 #include <boost/beast/ssl/ssl_stream.hpp>
@@ -21,7 +27,9 @@
 #include <ssl_key_handler.hpp>
 
 #include <atomic>
+#include <cerrno>
 #include <chrono>
+#include <memory>
 #include <vector>
 
 namespace crow
@@ -71,7 +79,12 @@ class Connection :
         parser->header_limit(httpHeaderLimit);
 
 #ifdef BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
-        prepareMutualTls();
+        if constexpr (std::is_same_v<Adaptor,
+                                     boost::beast::ssl_stream<
+                                         boost::asio::ip::tcp::socket>>)
+        {
+            prepareMutualTls();
+        }
 #endif // BMCWEB_ENABLE_MUTUAL_TLS_AUTHENTICATION
 
 #ifdef BMCWEB_ENABLE_DEBUG
@@ -303,6 +316,23 @@ class Connection :
                                         doReadHeaders();
                                     });
         }
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+        else if constexpr (std::is_same_v<
+                               Adaptor,
+                               boost::asio::local::stream_protocol::socket>)
+        {
+            // Local peers are authenticated once, by their credentials, for
+            // the lifetime of the connection
+            userSession = crow::authorization::performPeerCredAuth(
+                adaptor.native_handle());
+            if (userSession == nullptr)
+            {
+                close();
+                return;
+            }
+            doReadHeaders();
+        }
+#endif
         else
         {
             doReadHeaders();
@@ -312,6 +342,7 @@ class Connection :
     void handle()
     {
         cancelDeadlineTimer();
+        handleStart = std::chrono::steady_clock::now();
 
         // Fetch the client IP address
         readClientIp();
@@ -340,6 +371,7 @@ class Connection :
             // causes life time issue
             req->urlView = boost::urls::url_view(req->target());
             req->url = req->urlView.encoded_path();
+            req->urlParams = req->urlView.params();
         }
         catch (std::exception& p)
         {
@@ -373,6 +405,9 @@ class Connection :
             res.setCompleteRequestHandler(nullptr);
             return;
         }
+        res.cancellation = std::make_shared<CancellationToken>();
+        watchForPeerClose(res.cancellation);
+
         auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
         handler->handle(*req, asyncResp);
     }
@@ -414,6 +449,70 @@ class Connection :
         }
     }
 
+    auto& lowestLayer()
+    {
+        if constexpr (std::is_same_v<Adaptor,
+                                     boost::beast::ssl_stream<
+                                         boost::asio::ip::tcp::socket>>)
+        {
+            return adaptor.next_layer();
+        }
+        else
+        {
+            return adaptor;
+        }
+    }
+
+    // Nothing reads from the socket while a request is being handled, so a
+    // client that gives up and closes it would go unnoticed until the
+    // response is written.  Wait for the socket to become readable and, if
+    // that is because the peer closed it, cancel the request.
+    void watchForPeerClose(const std::shared_ptr<CancellationToken>& token)
+    {
+        lowestLayer().async_wait(
+            boost::asio::socket_base::wait_read,
+            [this, self(shared_from_this()),
+             token](const boost::system::error_code& ec) {
+                if (ec || token != res.cancellation || !peerClosed())
+                {
+                    return;
+                }
+                BMCWEB_LOG_DEBUG << this
+                                 << " client went away, cancelling request";
+                token->cancel();
+                crow::metrics::cancellation().requests++;
+            });
+    }
+
+    bool peerClosed()
+    {
+        int fd = lowestLayer().native_handle();
+        char byte = 0;
+        ssize_t n = recv(fd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (n == 0)
+        {
+            return true;
+        }
+        if (n < 0)
+        {
+            return errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR;
+        }
+        // Data is waiting.  It may be a pipelined request, or a TLS
+        // close_notify sent ahead of the FIN, so ask TCP whether the peer has
+        // closed its side.
+        if constexpr (!std::is_same_v<
+                          Adaptor, boost::asio::local::stream_protocol::socket>)
+        {
+            tcp_info info{};
+            socklen_t len = sizeof(info);
+            if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0)
+            {
+                return info.tcpi_state == TCP_CLOSE_WAIT;
+            }
+        }
+        return false;
+    }
+
     void completeRequest()
     {
         BMCWEB_LOG_INFO << "Response: " << this << ' ' << req->url << ' '
@@ -435,6 +534,10 @@ class Connection :
             res.setCompleteRequestHandler(nullptr);
             return;
         }
+        // Stop watching for the client going away
+        boost::system::error_code ec;
+        lowestLayer().cancel(ec);
+
         if (res.body().empty() && !res.jsonValue.empty())
         {
             if (http_helpers::requestPrefersHtml(req->getHeaderValue("Accept")))
@@ -443,9 +546,8 @@ class Connection :
             }
             else
             {
-                res.jsonMode();
-                res.body() = res.jsonValue.dump(
-                    2, ' ', true, nlohmann::json::error_handler_t::replace);
+                res.writeJsonBody();
+                checkEtag();
             }
         }
 
@@ -468,6 +570,10 @@ class Connection :
 
         res.keepAlive(req->keepAlive());
 
+        crow::metrics::recordResponse(
+            res.resultInt(), res.body().size(),
+            std::chrono::steady_clock::now() - handleStart);
+
         doWrite();
 
         // delete lambda with self shared_ptr
@@ -475,6 +581,27 @@ class Connection :
         res.setCompleteRequestHandler(nullptr);
     }
 
+    // Tags a successful GET of a JSON resource with its ETag, and turns it
+    // into a 304 Not Modified if the client already has that version
+    void checkEtag()
+    {
+        if (req->method() != boost::beast::http::verb::get ||
+            res.result() != boost::beast::http::status::ok)
+        {
+            return;
+        }
+        std::string etag = res.computeEtag();
+        res.addHeader(boost::beast::http::field::etag, etag);
+        std::string_view ifNoneMatch =
+            req->getHeaderValue(boost::beast::http::field::if_none_match);
+        if (!ifNoneMatch.empty() &&
+            http_helpers::etagMatches(ifNoneMatch, etag, true))
+        {
+            res.result(boost::beast::http::status::not_modified);
+            res.body().clear();
+        }
+    }
+
     void readClientIp()
     {
         boost::asio::ip::address ip;
@@ -489,20 +616,30 @@ class Connection :
     boost::system::error_code getClientIp(boost::asio::ip::address& ip)
     {
         boost::system::error_code ec;
-        BMCWEB_LOG_DEBUG << "Fetch the client IP address";
-        boost::asio::ip::tcp::endpoint endpoint =
-            boost::beast::get_lowest_layer(adaptor).remote_endpoint(ec);
-
-        if (ec)
+        if constexpr (std::is_same_v<
+                          Adaptor, boost::asio::local::stream_protocol::socket>)
         {
-            // If remote endpoint fails keep going. "ClientOriginIPAddress"
-            // will be empty.
-            BMCWEB_LOG_ERROR << "Failed to get the client's IP Address. ec : "
-                             << ec;
+            // Local peers have no IP address; they're identified by their
+            // credentials instead
+            return ec;
+        }
+        else
+        {
+            BMCWEB_LOG_DEBUG << "Fetch the client IP address";
+            boost::asio::ip::tcp::endpoint endpoint =
+                boost::beast::get_lowest_layer(adaptor).remote_endpoint(ec);
+
+            if (ec)
+            {
+                // If remote endpoint fails keep going. "ClientOriginIPAddress"
+                // will be empty.
+                BMCWEB_LOG_ERROR
+                    << "Failed to get the client's IP Address. ec : " << ec;
+                return ec;
+            }
+            ip = endpoint.address();
             return ec;
         }
-        ip = endpoint.address();
-        return ec;
     }
 
   private:
@@ -563,9 +700,14 @@ class Connection :
                 {
                     BMCWEB_LOG_DEBUG << "Unable to get client IP";
                 }
-                userSession = crow::authorization::authenticate(
-                    req->url, ip, res, method, parser->get().base(),
-                    userSession);
+                if constexpr (!std::is_same_v<
+                                  Adaptor,
+                                  boost::asio::local::stream_protocol::socket>)
+                {
+                    userSession = crow::authorization::authenticate(
+                        req->url, ip, res, method, parser->get().base(),
+                        userSession);
+                }
                 bool loggedIn = userSession != nullptr;
                 if (loggedIn)
                 {
@@ -694,7 +836,12 @@ class Connection :
                 parser.emplace(std::piecewise_construct, std::make_tuple());
                 parser->body_limit(httpReqBodyLimit); // reset body limit for
                                                       // newly created parser
-                buffer.consume(buffer.size());
+                // async_read_header() and async_read() consume the bytes of
+                // the message they parse from buffer, so whatever is left in
+                // it is already the start of the next, pipelined, request.
+                // It has to be kept for the next read: discarding it left a
+                // pipelining client waiting for responses to requests that
+                // were never parsed.
 
                 req.emplace(parser->release());
                 doReadHeaders();
@@ -785,6 +932,8 @@ class Connection :
 
     std::optional<size_t> timerCancelKey;
 
+    std::chrono::steady_clock::time_point handleStart;
+
     std::function<std::string()>& getCachedDateStr;
     detail::TimerQueue& timerQueue;
 
@@ -10,9 +10,18 @@
 #include <boost/beast/websocket.hpp>
 #include <boost/url/url_view.hpp>
 
+#include <memory>
 #include <string>
 #include <string_view>
 
+namespace redfish
+{
+namespace query_param
+{
+struct Query;
+} // namespace query_param
+} // namespace redfish
+
 namespace crow
 {
 
@@ -33,6 +42,11 @@ struct Request
     std::shared_ptr<persistent_data::UserSession> session;
 
     std::string userRole{};
+
+    // Query parameters such as $select, parsed once before routing.  Null
+    // when the request has none.
+    std::shared_ptr<const redfish::query_param::Query> query;
+
     Request(
         boost::beast::http::request<boost::beast::http::string_body> reqIn) :
         req(std::move(reqIn)),
@@ -5,6 +5,8 @@
 #include <boost/beast/http/message.hpp>
 #include <boost/beast/http/string_body.hpp>
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -12,6 +14,28 @@
 namespace crow
 {
 
+/**
+ * @brief Cancellation state of a single request.  The connection that
+ * received the request cancels it when the client goes away before the
+ * response has been written.
+ */
+class CancellationToken
+{
+  public:
+    bool isCancelled() const noexcept
+    {
+        return cancelled;
+    }
+
+    void cancel() noexcept
+    {
+        cancelled = true;
+    }
+
+  private:
+    bool cancelled = false;
+};
+
 template <typename Adaptor, typename Handler>
 class Connection;
 
@@ -48,6 +72,8 @@ struct Response
         r.stringResponse.emplace(response_type{});
         jsonValue = std::move(r.jsonValue);
         completed = r.completed;
+        cancellation = std::move(r.cancellation);
+        routeTemplate = r.routeTemplate;
         return *this;
     }
 
@@ -102,6 +128,8 @@ struct Response
         stringResponse.emplace(response_type{});
         jsonValue.clear();
         completed = false;
+        cancellation = nullptr;
+        routeTemplate = {};
     }
 
     void write(std::string_view bodyPart)
@@ -136,15 +164,71 @@ struct Response
         return isAliveHelper && isAliveHelper();
     }
 
+    // True once the client that sent the request has gone away, after which
+    // there is no point doing more work to build the response
+    bool isCancelled() const noexcept
+    {
+        return cancellation != nullptr && cancellation->isCancelled();
+    }
+
+    // Makes this response, built for a subrequest of parent, cancelled
+    // whenever parent is
+    void inheritCancellation(const Response& parent) noexcept
+    {
+        cancellation = parent.cancellation;
+    }
+
+    // Route template of the rule handling the request, such as
+    // "/redfish/v1/Systems/<str>/", or empty before routing
+    std::string_view route() const noexcept
+    {
+        return routeTemplate;
+    }
+
+    void setRoute(std::string_view newRoute) noexcept
+    {
+        routeTemplate = newRoute;
+    }
+
     void setCompleteRequestHandler(std::function<void()> newHandler)
     {
         completeRequestHandler = std::move(newHandler);
     }
 
+    // Serializes jsonValue into the body, as it is sent to clients
+    void writeJsonBody()
+    {
+        jsonMode();
+        stringResponse->body() = jsonValue.dump(
+            2, ' ', true, nlohmann::json::error_handler_t::replace);
+    }
+
+    // Strong entity tag of the body: a 64 bit FNV-1a hash of it, which is
+    // cheap to compute and stays the same across restarts
+    std::string computeEtag() const
+    {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (char c : stringResponse->body())
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 0x100000001b3ULL;
+        }
+        static constexpr std::string_view hex = "0123456789abcdef";
+        std::string etag(18, '"');
+        for (size_t i = 16; i > 0; i--)
+        {
+            etag[i] = hex[hash & 0xf];
+            hash >>= 4;
+        }
+        return etag;
+    }
+
   private:
     bool completed{};
     std::function<void()> completeRequestHandler;
     std::function<bool()> isAliveHelper;
+    std::shared_ptr<CancellationToken> cancellation;
+    std::string_view routeTemplate;
 
     // In case of a JSON object, set the Content-Type header
     void jsonMode()
@@ -6,6 +6,7 @@
 
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/asio/ssl/context.hpp>
 #include <boost/asio/steady_timer.hpp>
@@ -29,15 +30,23 @@ template <typename Handler, typename Adaptor = boost::asio::ip::tcp::socket>
 class Server
 {
   public:
-    Server(Handler* handlerIn,
-           std::unique_ptr<boost::asio::ip::tcp::acceptor>&& acceptorIn,
+    using protocol_type =
+        typename boost::beast::lowest_layer_type<Adaptor>::protocol_type;
+    using acceptor_type = boost::asio::basic_socket_acceptor<protocol_type>;
+
+    // adaptorCtx is the TLS context of the listener.  Without one, the server
+    // loads the BMC certificate into a context of its own on run(), and
+    // reloads it on SIGHUP.  A context handed in is used as is: the BMC
+    // certificate is then never loaded, and the caller owns the certificate.
+    Server(Handler* handlerIn, std::unique_ptr<acceptor_type>&& acceptorIn,
            std::shared_ptr<boost::asio::ssl::context> adaptorCtx,
            std::shared_ptr<boost::asio::io_context> io =
                std::make_shared<boost::asio::io_context>()) :
         ioService(std::move(io)),
         acceptor(std::move(acceptorIn)),
         signals(*ioService, SIGINT, SIGTERM, SIGHUP), timer(*ioService),
-        handler(handlerIn), adaptorCtx(std::move(adaptorCtx))
+        handler(handlerIn), adaptorCtx(std::move(adaptorCtx)),
+        ownsCertificate(this->adaptorCtx == nullptr)
     {}
 
     Server(Handler* handlerIn, const std::string& bindaddr, uint16_t port,
@@ -51,16 +60,36 @@ class Server
                adaptorCtx, io)
     {}
 
+    Server(Handler* handlerIn, const typename protocol_type::endpoint& endpoint,
+           const std::shared_ptr<boost::asio::ssl::context>& adaptorCtx,
+           const std::shared_ptr<boost::asio::io_context>& io =
+               std::make_shared<boost::asio::io_context>()) :
+        Server(handlerIn, std::make_unique<acceptor_type>(*io, endpoint),
+               adaptorCtx, io)
+    {}
+
     Server(Handler* handlerIn, int existingSocket,
            const std::shared_ptr<boost::asio::ssl::context>& adaptorCtx,
            const std::shared_ptr<boost::asio::io_context>& io =
                std::make_shared<boost::asio::io_context>()) :
         Server(handlerIn,
-               std::make_unique<boost::asio::ip::tcp::acceptor>(
-                   *io, boost::asio::ip::tcp::v6(), existingSocket),
+               std::make_unique<acceptor_type>(*io, listenProtocol(),
+                                               existingSocket),
                adaptorCtx, io)
     {}
 
+    static protocol_type listenProtocol()
+    {
+        if constexpr (std::is_same_v<protocol_type, boost::asio::ip::tcp>)
+        {
+            return boost::asio::ip::tcp::v6();
+        }
+        else
+        {
+            return protocol_type();
+        }
+    }
+
     void updateDateStr()
     {
         time_t lastTimeT = time(nullptr);
@@ -113,6 +142,19 @@ class Server
     void loadCertificate()
     {
 #ifdef BMCWEB_ENABLE_SSL
+        if (!ownsCertificate)
+        {
+            BMCWEB_LOG_INFO << "Using the TLS context handed in, not loading "
+                               "the BMC certificate";
+            return;
+        }
+        if constexpr (!std::is_same_v<Adaptor,
+                                      boost::beast::ssl_stream<
+                                          boost::asio::ip::tcp::socket>>)
+        {
+            // Only the TLS listener owns the certificate
+            return;
+        }
         namespace fs = std::filesystem;
         // Cleanup older certificate file existing in the system
         fs::path oldCert = "/home/root/server.pem";
@@ -222,7 +264,7 @@ class Server
     std::shared_ptr<boost::asio::io_context> ioService;
     detail::TimerQueue timerQueue;
     std::function<std::string()> getCachedDateStr;
-    std::unique_ptr<boost::asio::ip::tcp::acceptor> acceptor;
+    std::unique_ptr<acceptor_type> acceptor;
     boost::asio::signal_set signals;
     boost::asio::steady_timer timer;
 
@@ -236,5 +278,7 @@ class Server
     bool useSsl{false};
 #endif
     std::shared_ptr<boost::asio::ssl::context> adaptorCtx;
+    // Whether adaptorCtx holds the BMC certificate, loaded by the server
+    bool ownsCertificate;
 }; // namespace crow
 } // namespace crow
@@ -11,9 +11,11 @@
 #include "websocket.hpp"
 
 #include <async_resp.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/container/small_vector.hpp>
 #include <boost/lexical_cast.hpp>
+#include <dbus_accounting.hpp>
 
 #include <cerrno>
 #include <cstdint>
@@ -63,6 +65,14 @@ class BaseRule
         res.end();
     }
 #endif
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    virtual void handleUpgrade(const Request&, Response& res,
+                               boost::asio::local::stream_protocol::socket&&)
+    {
+        res.result(boost::beast::http::status::not_found);
+        res.end();
+    }
+#endif
 
     size_t getMethods()
     {
@@ -358,6 +368,20 @@ class WebSocketRule : public BaseRule
         myConnection->start();
     }
 #endif
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    void handleUpgrade(
+        const Request& req, Response&,
+        boost::asio::local::stream_protocol::socket&& adaptor) override
+    {
+        std::shared_ptr<crow::websocket::ConnectionImpl<
+            boost::asio::local::stream_protocol::socket>>
+            myConnection = std::make_shared<crow::websocket::ConnectionImpl<
+                boost::asio::local::stream_protocol::socket>>(
+                req, std::move(adaptor), openHandler, messageHandler,
+                closeHandler, errorHandler);
+        myConnection->start();
+    }
+#endif
 
     template <typename Func>
     self_t& onopen(Func f)
@@ -1301,6 +1325,10 @@ class Router
                          << static_cast<uint32_t>(req.method()) << " / "
                          << rules[ruleIndex]->getMethods();
 
+        asyncResp->res.setRoute(rules[ruleIndex]->rule);
+        // The calls the handler sends are accounted to the route
+        crow::dbus_accounting::RouteScope scope(asyncResp->res.route());
+
         if (req.session == nullptr)
         {
             rules[ruleIndex]->handle(req, asyncResp, found.second);
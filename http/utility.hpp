@@ -7,6 +7,7 @@
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <ctime>
 #include <functional>
 #include <regex>
 #include <stdexcept>
@@ -583,8 +584,10 @@ inline std::string getDateTime(const std::time_t& time)
     std::array<char, 128> dateTime;
     std::string redfishDateTime("0000-00-00T00:00:00Z00:00");
 
-    if (std::strftime(dateTime.begin(), dateTime.size(), "%FT%T%z",
-                      std::localtime(&time)))
+    // localtime_r(), as journal entries are also dated on the worker thread
+    std::tm tm{};
+    if (localtime_r(&time, &tm) != nullptr &&
+        std::strftime(dateTime.begin(), dateTime.size(), "%FT%T%z", &tm))
     {
         // insert the colon required by the ISO 8601 standard
         redfishDateTime = std::string(dateTime.data());
@@ -12,8 +12,16 @@
 #include <http_utility.hpp>
 #include <pam_authenticate.hpp>
 
+#include <grp.h>
+#include <pwd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
 #include <random>
 #include <utility>
+#include <vector>
 
 namespace crow
 {
@@ -213,6 +221,97 @@ static std::shared_ptr<persistent_data::UserSession>
 }
 #endif
 
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+// The groups a local socket peer has to be in, one per Redfish role.  Other
+// local users, service accounts included, don't get a session.
+constexpr std::array<const char*, 3> peerCredGroups = {
+    "priv-admin", "priv-operator", "priv-user"};
+
+inline bool isInPeerCredGroup(const passwd& pwd)
+{
+    int count = 0;
+    getgrouplist(pwd.pw_name, pwd.pw_gid, nullptr, &count);
+    std::vector<gid_t> groups(static_cast<size_t>(std::max(count, 1)));
+    count = static_cast<int>(groups.size());
+    if (getgrouplist(pwd.pw_name, pwd.pw_gid, groups.data(), &count) < 0)
+    {
+        BMCWEB_LOG_ERROR << "Failed to read the groups of " << pwd.pw_name;
+        return false;
+    }
+    groups.resize(static_cast<size_t>(count));
+
+    long bufSize = sysconf(_SC_GETGR_R_SIZE_MAX);
+    std::vector<char> grBuf(bufSize > 0 ? static_cast<size_t>(bufSize)
+                                        : 16384);
+    for (const char* name : peerCredGroups)
+    {
+        group gr{};
+        group* grResult = nullptr;
+        int ret =
+            getgrnam_r(name, &gr, grBuf.data(), grBuf.size(), &grResult);
+        if (ret != 0 || grResult == nullptr)
+        {
+            continue;
+        }
+        if (std::find(groups.begin(), groups.end(), grResult->gr_gid) !=
+            groups.end())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Local socket peers are identified by the kernel-supplied credentials of the
+// connecting process.  The session belongs to the connection, and is never
+// added to the SessionStore, so it can't be listed or reused through the
+// Redfish SessionService.
+static std::shared_ptr<persistent_data::UserSession>
+    performPeerCredAuth(int socketFd)
+{
+    BMCWEB_LOG_DEBUG << "[AuthMiddleware] Peer credential authentication";
+
+    ucred cred{};
+    socklen_t credLen = sizeof(cred);
+    if (getsockopt(socketFd, SOL_SOCKET, SO_PEERCRED, &cred, &credLen) != 0)
+    {
+        BMCWEB_LOG_ERROR << "Failed to read peer credentials, errno "
+                         << errno;
+        return nullptr;
+    }
+
+    passwd pwd{};
+    passwd* pwdResult = nullptr;
+    std::array<char, 1024> pwdBuf{};
+    if (getpwuid_r(cred.uid, &pwd, pwdBuf.data(), pwdBuf.size(),
+                   &pwdResult) != 0 ||
+        pwdResult == nullptr)
+    {
+        BMCWEB_LOG_WARNING << "[AuthMiddleware] No user found for peer uid "
+                           << cred.uid;
+        return nullptr;
+    }
+    if (!isInPeerCredGroup(*pwdResult))
+    {
+        BMCWEB_LOG_WARNING << "[AuthMiddleware] Peer user "
+                           << pwdResult->pw_name
+                           << " is not in a privilege group";
+        return nullptr;
+    }
+
+    BMCWEB_LOG_DEBUG << "[AuthMiddleware] Local peer pid " << cred.pid
+                     << " authenticated as " << pwdResult->pw_name;
+
+    std::shared_ptr<persistent_data::UserSession> session =
+        std::make_shared<persistent_data::UserSession>();
+    session->uniqueId = "unix-" + std::to_string(cred.pid);
+    session->username = pwdResult->pw_name;
+    session->lastUpdated = std::chrono::steady_clock::now();
+    session->persistence = persistent_data::PersistenceType::TIMEOUT;
+    return session;
+}
+#endif
+
 // checks if request can be forwarded without authentication
 static bool isOnWhitelist(std::string_view url, boost::beast::http::verb method)
 {
@@ -0,0 +1,160 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <async_resp.hpp>
+#include <boost/asio/coroutine.hpp>
+#include <boost/asio/error.hpp>
+#include <boost/system/error_code.hpp>
+#include <dbus_utility.hpp>
+#include <http_request.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace crow
+{
+namespace coroutine
+{
+
+/**
+ * @brief Base for request handlers written as stackless coroutines.
+ *
+ * bmcweb is built as C++17, so rather than C++20 co_await these build on
+ * boost::asio::coroutine.  Derived implements operator()() with its body in
+ * BOOST_ASIO_CORO_REENTER(this), and suspends with BOOST_ASIO_CORO_YIELD
+ * after starting D-Bus calls with call() or getProperty().  The coroutine is
+ * resumed once every call started by the yield statement has been answered,
+ * so the calls started by a single yield run in parallel.  A yield that
+ * starts no calls resumes straight away.  Locals don't survive a yield;
+ * state that has to lives in members of Derived.
+ *
+ * The handler, its state and the replies it waits for are one allocation,
+ * shared by the calls in flight.  Calls go through
+ * dbus::utility::asyncMethodCall, so if the client goes away while calls
+ * are in flight the coroutine is not resumed again and is freed along with
+ * its last call.  Calls started after that fail at once with
+ * operation_aborted.
+ */
+template <typename Derived>
+class Handler :
+    public boost::asio::coroutine,
+    public std::enable_shared_from_this<Derived>
+{
+  public:
+    explicit Handler(const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn) :
+        asyncResp(asyncRespIn)
+    {}
+
+    // Runs the coroutine until it waits for calls, or returns
+    void resume()
+    {
+        running = true;
+        do
+        {
+            (*static_cast<Derived*>(this))();
+        } while (outstanding == 0 && !this->is_complete());
+        running = false;
+    }
+
+  protected:
+    /**
+     * @brief Starts a method call.  When it is answered, its error code is
+     * stored in ec and its reply in reply, both of which have to be members.
+     */
+    template <typename Reply, typename... Args>
+    void call(boost::system::error_code& ec, Reply& reply,
+              const std::string& service, const std::string& path,
+              const std::string& interface, const std::string& method,
+              const Args&... args)
+    {
+        if (dbus::utility::isCancelled(asyncResp))
+        {
+            ec = boost::asio::error::operation_aborted;
+            return;
+        }
+        outstanding++;
+        dbus::utility::asyncMethodCall(
+            asyncResp,
+            [self{this->shared_from_this()}, &ec,
+             &reply](const boost::system::error_code replyEc, Reply& value) {
+                ec = replyEc;
+                reply = std::move(value);
+                self->answered();
+            },
+            service, path, interface, method, args...);
+    }
+
+    // org.freedesktop.DBus.Properties.Get into a variant
+    template <typename Reply>
+    void getProperty(boost::system::error_code& ec, Reply& reply,
+                     const std::string& service, const std::string& path,
+                     const std::string& interface, const std::string& property)
+    {
+        call(ec, reply, service, path, "org.freedesktop.DBus.Properties",
+             "Get", interface, property);
+    }
+
+    std::shared_ptr<bmcweb::AsyncResp> asyncResp;
+
+  private:
+    void answered()
+    {
+        outstanding--;
+        // A call answered before the yield returned is picked up by resume()
+        if (outstanding == 0 && !running)
+        {
+            resume();
+        }
+    }
+
+    size_t outstanding = 0;
+    bool running = false;
+};
+
+/**
+ * @brief Creates a coroutine handler and runs it until it first waits for
+ * calls, or returns.
+ */
+template <typename Coroutine, typename... Args>
+void spawn(Args&&... args)
+{
+    std::make_shared<Coroutine>(std::forward<Args>(args)...)->resume();
+}
+
+/**
+ * @brief A route handler that runs Coroutine for each request, for use with
+ * BMCWEB_ROUTE.  Coroutine is constructed from the request, the response and
+ * the route parameters, whose types are given as Params.
+ *
+ * BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/")
+ *     .methods(boost::beast::http::verb::get)(
+ *         crow::coroutine::route<ChassisGet, std::string>());
+ */
+template <typename Coroutine, typename... Params>
+auto route()
+{
+    return [](const crow::Request& req,
+              const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+              const Params&... params) {
+        spawn<Coroutine>(req, asyncResp, params...);
+    };
+}
+
+} // namespace coroutine
+} // namespace crow
@@ -0,0 +1,437 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <boost/callable_traits.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/system/error_code.hpp>
+#include <metrics.hpp>
+#include <nlohmann/json.hpp>
+#include <sdbusplus/message/types.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace crow
+{
+namespace dbus_accounting
+{
+
+namespace details
+{
+
+// Approximate wire size of a decoded reply: fixed size types count their
+// size, strings and object paths their length plus the length prefix and
+// terminator, containers the sum of their elements plus the length prefix.
+// Types without a D-Bus encoding, such as the error code and raw messages,
+// count nothing.
+template <typename T, typename Enable = void>
+struct PayloadSize
+{
+    static size_t get(const T& /*value*/)
+    {
+        return 0;
+    }
+};
+
+template <typename T>
+struct PayloadSize<T, std::enable_if_t<std::is_arithmetic_v<T>>>
+{
+    static size_t get(const T& /*value*/)
+    {
+        return sizeof(T);
+    }
+};
+
+template <>
+struct PayloadSize<std::string>
+{
+    static size_t get(const std::string& value)
+    {
+        return value.size() + 5;
+    }
+};
+
+template <>
+struct PayloadSize<sdbusplus::message::object_path>
+{
+    static size_t get(const sdbusplus::message::object_path& value)
+    {
+        return value.str.size() + 5;
+    }
+};
+
+template <typename T>
+size_t payloadSize(const T& value)
+{
+    return PayloadSize<T>::get(value);
+}
+
+template <typename First, typename Second>
+struct PayloadSize<std::pair<First, Second>>
+{
+    static size_t get(const std::pair<First, Second>& value)
+    {
+        return payloadSize(value.first) + payloadSize(value.second);
+    }
+};
+
+template <typename... Types>
+struct PayloadSize<std::tuple<Types...>>
+{
+    static size_t get(const std::tuple<Types...>& value)
+    {
+        return std::apply(
+            [](const Types&... member) {
+                return (size_t{0} + ... + payloadSize(member));
+            },
+            value);
+    }
+};
+
+template <typename... Types>
+struct PayloadSize<std::variant<Types...>>
+{
+    static size_t get(const std::variant<Types...>& value)
+    {
+        // Plus the signature of the contained type
+        return 3 + std::visit(
+                       [](const auto& contained) {
+                           return payloadSize(contained);
+                       },
+                       value);
+    }
+};
+
+template <typename Container>
+size_t containerSize(const Container& container)
+{
+    size_t size = 4;
+    for (const typename Container::value_type& element : container)
+    {
+        size += payloadSize(element);
+    }
+    return size;
+}
+
+template <typename T, typename Allocator>
+struct PayloadSize<std::vector<T, Allocator>>
+{
+    static size_t get(const std::vector<T, Allocator>& value)
+    {
+        return containerSize(value);
+    }
+};
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+struct PayloadSize<std::map<Key, Value, Compare, Allocator>>
+{
+    static size_t get(const std::map<Key, Value, Compare, Allocator>& value)
+    {
+        return containerSize(value);
+    }
+};
+
+template <typename Key, typename Value, typename Compare, typename Allocator>
+struct PayloadSize<
+    boost::container::flat_map<Key, Value, Compare, Allocator>>
+{
+    static size_t
+        get(const boost::container::flat_map<Key, Value, Compare, Allocator>&
+                value)
+    {
+        return containerSize(value);
+    }
+};
+
+} // namespace details
+
+// Upper bounds, in milliseconds, of the latency histogram buckets.  Calls
+// slower than the last bound are counted in one more bucket.
+constexpr std::array<uint64_t, 10> latencyBoundsMs = {
+    1, 5, 10, 25, 50, 100, 250, 500, 1000, 5000};
+
+struct CallStats
+{
+    uint64_t calls = 0;
+    uint64_t errors = 0;
+    uint64_t replyBytes = 0;
+    std::chrono::microseconds time{0};
+    std::chrono::microseconds maxTime{0};
+    std::array<uint64_t, latencyBoundsMs.size() + 1> latency{};
+};
+
+/**
+ * @brief Counts, reply sizes and latencies of the D-Bus method calls sent
+ * with async_method_call on crow::connections::systemBus, kept per
+ * originating route, destination service and interface.method.
+ *
+ * A call is attributed to the route template of the request being handled
+ * when it is sent, as marked by RouteScope: the router marks the handler of
+ * the route, and each reply handler runs as part of the route its call was
+ * made for.  Calls made outside any request, and those made through
+ * scheduledMethodCall, which are not made for a single request, are
+ * attributed to "(internal)".  Calls that sdbusplus makes for its own
+ * property helpers are not seen.  Reply sizes are estimated from the
+ * decoded reply, so calls whose handler takes the raw message count no
+ * bytes.
+ */
+class Accounting
+{
+  public:
+    static Accounting& getInstance()
+    {
+        static Accounting accounting;
+        return accounting;
+    }
+
+    Accounting(const Accounting&) = delete;
+    Accounting& operator=(const Accounting&) = delete;
+    Accounting(Accounting&&) = delete;
+    Accounting& operator=(Accounting&&) = delete;
+
+    void record(std::string_view route, const std::string& service,
+                const std::string& member, bool failed, size_t replyBytes,
+                std::chrono::steady_clock::duration elapsed)
+    {
+        if (route.empty())
+        {
+            route = "(internal)";
+        }
+        CallStats& stats = calls[Key(std::string(route), service, member)];
+        std::chrono::microseconds us =
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+        stats.calls++;
+        if (failed)
+        {
+            stats.errors++;
+        }
+        stats.replyBytes += replyBytes;
+        stats.time += us;
+        if (us > stats.maxTime)
+        {
+            stats.maxTime = us;
+        }
+        uint64_t ms = static_cast<uint64_t>(us.count()) / 1000;
+        size_t bucket = 0;
+        while (bucket < latencyBoundsMs.size() &&
+               ms >= latencyBoundsMs[bucket])
+        {
+            bucket++;
+        }
+        stats.latency[bucket]++;
+    }
+
+    // Per route, service and member, plus the totals per service so that
+    // slow daemons stand out regardless of which route calls them
+    nlohmann::json statistics() const
+    {
+        nlohmann::json json;
+        nlohmann::json& byRoute = json["routes"];
+        byRoute = nlohmann::json::object();
+        nlohmann::json& byService = json["services"];
+        byService = nlohmann::json::object();
+        boost::container::flat_map<std::string, CallStats> serviceTotals;
+        for (const auto& [key, stats] : calls)
+        {
+            const auto& [route, service, member] = key;
+            byRoute[route][service][member] = toJson(stats);
+
+            CallStats& total = serviceTotals[service];
+            total.calls += stats.calls;
+            total.errors += stats.errors;
+            total.replyBytes += stats.replyBytes;
+            total.time += stats.time;
+            if (stats.maxTime > total.maxTime)
+            {
+                total.maxTime = stats.maxTime;
+            }
+            for (size_t i = 0; i < stats.latency.size(); i++)
+            {
+                total.latency[i] += stats.latency[i];
+            }
+        }
+        for (const auto& [service, total] : serviceTotals)
+        {
+            byService[service] = toJson(total);
+        }
+        return json;
+    }
+
+  private:
+    using Key = std::tuple<std::string, std::string, std::string>;
+
+    Accounting()
+    {
+        metrics::registerProvider(
+            "dbus_calls",
+            [this](nlohmann::json& json) { json = statistics(); });
+    }
+
+    static nlohmann::json toJson(const CallStats& stats)
+    {
+        nlohmann::json json;
+        json["calls"] = stats.calls;
+        json["errors"] = stats.errors;
+        json["reply_bytes"] = stats.replyBytes;
+        json["time_us"] = stats.time.count();
+        json["max_time_us"] = stats.maxTime.count();
+        nlohmann::json& latency = json["latency_ms"];
+        latency = nlohmann::json::object();
+        for (size_t i = 0; i < latencyBoundsMs.size(); i++)
+        {
+            latency["<" + std::to_string(latencyBoundsMs[i])] =
+                stats.latency[i];
+        }
+        latency[">=" + std::to_string(latencyBoundsMs.back())] =
+            stats.latency.back();
+        return json;
+    }
+
+    std::map<Key, CallStats> calls;
+};
+
+/**
+ * @brief Marks the route whose request is being handled, for the calls sent
+ * meanwhile to be attributed to.  Scopes nest, the innermost one counting.
+ */
+class RouteScope
+{
+  public:
+    // route has to outlive the calls sent in the scope, as route templates
+    // do
+    explicit RouteScope(std::string_view route) : previous(active())
+    {
+        active() = route;
+    }
+
+    ~RouteScope()
+    {
+        active() = previous;
+    }
+
+    RouteScope(const RouteScope&) = delete;
+    RouteScope& operator=(const RouteScope&) = delete;
+    RouteScope(RouteScope&&) = delete;
+    RouteScope& operator=(RouteScope&&) = delete;
+
+    static std::string_view current()
+    {
+        return active();
+    }
+
+  private:
+    static std::string_view& active()
+    {
+        static std::string_view route;
+        return route;
+    }
+
+    std::string_view previous;
+};
+
+/**
+ * @brief Reply guard that records one call when its reply arrives.  Timing
+ * starts when the guard is constructed, which should be right before the
+ * call is sent.
+ */
+class Call
+{
+  public:
+    Call(std::string_view callRoute, const std::string& callService,
+         const std::string& interf, const std::string& method) :
+        route(callRoute),
+        service(callService), member(interf + "." + method),
+        start(std::chrono::steady_clock::now())
+    {}
+
+    template <typename... Reply>
+    bool operator()(const boost::system::error_code& ec,
+                    const Reply&... reply) const
+    {
+        Accounting::getInstance().record(
+            route, service, member, static_cast<bool>(ec),
+            (size_t{0} + ... + details::payloadSize(reply)),
+            std::chrono::steady_clock::now() - start);
+        return true;
+    }
+
+    std::string_view callRoute() const
+    {
+        return route;
+    }
+
+  private:
+    // Route templates belong to the router's rules, which live as long as
+    // the application does
+    std::string_view route;
+    std::string service;
+    std::string member;
+    std::chrono::steady_clock::time_point start;
+};
+
+namespace details
+{
+
+template <typename Handler, typename Args>
+struct Accounted;
+
+// Wraps handler in a callable with exactly the same parameters, so that
+// sdbusplus can still deduce the reply type from it, which records the call
+// and runs handler as part of the route the call was made for
+template <typename Handler, typename... Args>
+struct Accounted<Handler, std::tuple<Args...>>
+{
+    static auto wrap(Handler&& handler, Call&& call)
+    {
+        return [handler{std::move(handler)},
+                call{std::move(call)}](Args... args) mutable {
+            call(std::as_const(args)...);
+            RouteScope scope(call.callRoute());
+            handler(std::forward<Args>(args)...);
+        };
+    }
+};
+
+} // namespace details
+
+/**
+ * @brief Wraps the reply handler of a call about to be sent, to account for
+ * it against the current route.
+ */
+template <typename Handler>
+inline auto accounted(Handler&& handler, const std::string& service,
+                      const std::string& interf, const std::string& method)
+{
+    using HandlerType = std::decay_t<Handler>;
+    using Args = boost::callable_traits::args_t<HandlerType>;
+    return details::Accounted<HandlerType, Args>::wrap(
+        HandlerType(std::forward<Handler>(handler)),
+        Call(RouteScope::current(), service, interf, method));
+}
+
+} // namespace dbus_accounting
+} // namespace crow
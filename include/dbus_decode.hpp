@@ -0,0 +1,834 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <nlohmann/json.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Visitor-style decoding of D-Bus replies.  Rather than unpacking a reply
+// into nested maps of variants, the reply is walked in place and each
+// selected value is handed to the caller, who reads it straight into the
+// type or JSON it needs.  Interfaces and values that aren't asked for are
+// skipped without being decoded.  All functions return 0 or a negative errno,
+// as sd-bus does.
+namespace dbus
+{
+namespace decode
+{
+
+namespace details
+{
+
+template <typename T>
+struct BasicType
+{
+    static constexpr char code = '\0';
+};
+template <>
+struct BasicType<uint8_t>
+{
+    static constexpr char code = SD_BUS_TYPE_BYTE;
+};
+template <>
+struct BasicType<int16_t>
+{
+    static constexpr char code = SD_BUS_TYPE_INT16;
+};
+template <>
+struct BasicType<uint16_t>
+{
+    static constexpr char code = SD_BUS_TYPE_UINT16;
+};
+template <>
+struct BasicType<int32_t>
+{
+    static constexpr char code = SD_BUS_TYPE_INT32;
+};
+template <>
+struct BasicType<uint32_t>
+{
+    static constexpr char code = SD_BUS_TYPE_UINT32;
+};
+template <>
+struct BasicType<int64_t>
+{
+    static constexpr char code = SD_BUS_TYPE_INT64;
+};
+template <>
+struct BasicType<uint64_t>
+{
+    static constexpr char code = SD_BUS_TYPE_UINT64;
+};
+template <>
+struct BasicType<double>
+{
+    static constexpr char code = SD_BUS_TYPE_DOUBLE;
+};
+
+inline bool isStringType(std::string_view type)
+{
+    return type.size() == 1 && (type[0] == SD_BUS_TYPE_STRING ||
+                                type[0] == SD_BUS_TYPE_OBJECT_PATH ||
+                                type[0] == SD_BUS_TYPE_SIGNATURE);
+}
+
+// Reads a basic value of the given type code, which the caller has checked
+template <typename T>
+inline int readBasic(sd_bus_message* m, char code, T& value)
+{
+    if constexpr (std::is_same_v<T, bool>)
+    {
+        int b = 0;
+        int r = sd_bus_message_read_basic(m, code, &b);
+        value = b != 0;
+        return r;
+    }
+    else if constexpr (std::is_same_v<T, std::string_view> ||
+                       std::is_same_v<T, std::string>)
+    {
+        const char* str = nullptr;
+        int r = sd_bus_message_read_basic(m, code, &str);
+        if (r >= 0)
+        {
+            value = str;
+        }
+        return r;
+    }
+    else
+    {
+        return sd_bus_message_read_basic(m, code, &value);
+    }
+}
+
+// Reads an array of a basic type, given its type code as contents
+template <typename T>
+inline int readArray(sd_bus_message* m, const char* contents,
+                     std::vector<T>& values)
+{
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, contents);
+    if (r < 0)
+    {
+        return r;
+    }
+    values.clear();
+    while ((r = sd_bus_message_at_end(m, false)) == 0)
+    {
+        r = readBasic(m, *contents, values.emplace_back());
+        if (r < 0)
+        {
+            return r;
+        }
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_exit_container(m);
+}
+
+inline int readArray(sd_bus_message* m, const char* /*contents*/,
+                     std::vector<std::tuple<std::string, std::string,
+                                            std::string>>& values)
+{
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "(sss)");
+    if (r < 0)
+    {
+        return r;
+    }
+    values.clear();
+    const char* first = nullptr;
+    const char* second = nullptr;
+    const char* third = nullptr;
+    while ((r = sd_bus_message_read(m, "(sss)", &first, &second, &third)) > 0)
+    {
+        values.emplace_back(first, second, third);
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    return sd_bus_message_exit_container(m);
+}
+
+// Reads any single complete type into JSON, the way the D-Bus REST API
+// renders it: structs become arrays and dictionaries with string keys
+// become objects.
+inline int readJson(sd_bus_message* m, nlohmann::json& value)
+{
+    char type = 0;
+    const char* contents = nullptr;
+    int r = sd_bus_message_peek_type(m, &type, &contents);
+    if (r <= 0)
+    {
+        return r < 0 ? r : -EBADMSG;
+    }
+
+    switch (type)
+    {
+        case SD_BUS_TYPE_BOOLEAN:
+        {
+            bool b = false;
+            r = readBasic(m, type, b);
+            value = b;
+            return r;
+        }
+        case SD_BUS_TYPE_BYTE:
+        {
+            uint8_t y = 0;
+            r = readBasic(m, type, y);
+            value = y;
+            return r;
+        }
+        case SD_BUS_TYPE_INT16:
+        {
+            int16_t n = 0;
+            r = readBasic(m, type, n);
+            value = n;
+            return r;
+        }
+        case SD_BUS_TYPE_UINT16:
+        {
+            uint16_t q = 0;
+            r = readBasic(m, type, q);
+            value = q;
+            return r;
+        }
+        case SD_BUS_TYPE_INT32:
+        {
+            int32_t i = 0;
+            r = readBasic(m, type, i);
+            value = i;
+            return r;
+        }
+        case SD_BUS_TYPE_UINT32:
+        {
+            uint32_t u = 0;
+            r = readBasic(m, type, u);
+            value = u;
+            return r;
+        }
+        case SD_BUS_TYPE_INT64:
+        {
+            int64_t x = 0;
+            r = readBasic(m, type, x);
+            value = x;
+            return r;
+        }
+        case SD_BUS_TYPE_UINT64:
+        {
+            uint64_t t = 0;
+            r = readBasic(m, type, t);
+            value = t;
+            return r;
+        }
+        case SD_BUS_TYPE_DOUBLE:
+        {
+            double d = 0.0;
+            r = readBasic(m, type, d);
+            value = d;
+            return r;
+        }
+        case SD_BUS_TYPE_STRING:
+        case SD_BUS_TYPE_OBJECT_PATH:
+        case SD_BUS_TYPE_SIGNATURE:
+        {
+            std::string str;
+            r = readBasic(m, type, str);
+            value = std::move(str);
+            return r;
+        }
+        case SD_BUS_TYPE_VARIANT:
+        {
+            r = sd_bus_message_enter_container(m, type, contents);
+            if (r < 0)
+            {
+                return r;
+            }
+            r = readJson(m, value);
+            if (r < 0)
+            {
+                return r;
+            }
+            return sd_bus_message_exit_container(m);
+        }
+        case SD_BUS_TYPE_STRUCT:
+        case SD_BUS_TYPE_ARRAY:
+        {
+            std::string_view inner(contents);
+            bool stringDict =
+                type == SD_BUS_TYPE_ARRAY && inner.substr(0, 2) == "{s";
+            // Signature of the dict entry, without the braces
+            std::string entryType;
+            if (stringDict)
+            {
+                entryType = inner.substr(1, inner.size() - 2);
+            }
+            r = sd_bus_message_enter_container(m, type, contents);
+            if (r < 0)
+            {
+                return r;
+            }
+            value = stringDict ? nlohmann::json::object()
+                               : nlohmann::json::array();
+            while ((r = sd_bus_message_at_end(m, false)) == 0)
+            {
+                if (stringDict)
+                {
+                    std::string_view key;
+                    r = sd_bus_message_enter_container(
+                        m, SD_BUS_TYPE_DICT_ENTRY, entryType.c_str());
+                    if (r >= 0)
+                    {
+                        r = readBasic(m, SD_BUS_TYPE_STRING, key);
+                    }
+                    if (r >= 0)
+                    {
+                        r = readJson(m, value[std::string(key)]);
+                    }
+                    if (r >= 0)
+                    {
+                        r = sd_bus_message_exit_container(m);
+                    }
+                }
+                else
+                {
+                    value.push_back(nullptr);
+                    r = readJson(m, value.back());
+                }
+                if (r < 0)
+                {
+                    return r;
+                }
+            }
+            if (r < 0)
+            {
+                return r;
+            }
+            return sd_bus_message_exit_container(m);
+        }
+        case SD_BUS_TYPE_DICT_ENTRY:
+        {
+            // Only reachable for dictionaries with non-string keys, which
+            // JSON can't represent as objects; render as [key, value]
+            r = sd_bus_message_enter_container(m, type, contents);
+            if (r < 0)
+            {
+                return r;
+            }
+            value = nlohmann::json::array();
+            value.push_back(nullptr);
+            value.push_back(nullptr);
+            r = readJson(m, value[0]);
+            if (r >= 0)
+            {
+                r = readJson(m, value[1]);
+            }
+            if (r < 0)
+            {
+                return r;
+            }
+            return sd_bus_message_exit_container(m);
+        }
+        default:
+            BMCWEB_LOG_ERROR << "Unsupported D-Bus type " << type;
+            return -EINVAL;
+    }
+}
+
+} // namespace details
+
+/**
+ * @brief One property of a reply, positioned at its value.  The value can
+ * be read once, in whichever form suits the caller; if it isn't read it is
+ * skipped.  A read that sd-bus fails may leave the message partway through
+ * the value, so after one the property only returns that error, and the
+ * walk of the reply stops.
+ */
+class Property
+{
+  public:
+    Property(sd_bus_message* message, std::string_view name,
+             std::string_view type) :
+        m(message),
+        propertyName(name), valueType(type)
+    {}
+
+    Property(const Property&) = delete;
+    Property& operator=(const Property&) = delete;
+    Property(Property&&) = delete;
+    Property& operator=(Property&&) = delete;
+    ~Property() = default;
+
+    std::string_view name() const
+    {
+        return propertyName;
+    }
+
+    // D-Bus signature of the value
+    std::string_view type() const
+    {
+        return valueType;
+    }
+
+    /**
+     * @brief Reads the value if its D-Bus type matches T exactly.
+     *
+     * T may be bool, any of the fixed width integers, double, std::string,
+     * std::string_view (which points into the message, so it is only valid
+     * until the reply is released), std::vector<std::string> or
+     * std::vector<double>.
+     *
+     * @return 0 on success, -ENXIO if the value has another type, or a
+     * negative errno from sd-bus
+     */
+    template <typename T>
+    int read(T& value)
+    {
+        if (consumed)
+        {
+            return error < 0 ? error : -EALREADY;
+        }
+        int r = -ENXIO;
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            if (valueType == "b")
+            {
+                r = details::readBasic(m, SD_BUS_TYPE_BOOLEAN, value);
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::string> ||
+                           std::is_same_v<T, std::string_view>)
+        {
+            if (details::isStringType(valueType))
+            {
+                r = details::readBasic(m, valueType[0], value);
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::vector<std::string>>)
+        {
+            if (valueType == "as")
+            {
+                r = details::readArray(m, "s", value);
+            }
+        }
+        else if constexpr (std::is_same_v<T, std::vector<double>>)
+        {
+            if (valueType == "ad")
+            {
+                r = details::readArray(m, "d", value);
+            }
+        }
+        else
+        {
+            static_assert(details::BasicType<T>::code != '\0',
+                          "Unsupported property type");
+            if (valueType.size() == 1 &&
+                valueType[0] == details::BasicType<T>::code)
+            {
+                r = details::readBasic(m, valueType[0], value);
+            }
+        }
+        return settle(r);
+    }
+
+    /**
+     * @brief Reads any numeric value, converted to double.
+     *
+     * @return 0 on success, -ENXIO if the value isn't a number, or a
+     * negative errno from sd-bus
+     */
+    int readNumber(double& value)
+    {
+        if (valueType.size() != 1)
+        {
+            return -ENXIO;
+        }
+        switch (valueType[0])
+        {
+            case SD_BUS_TYPE_BYTE:
+                return readAs<uint8_t>(value);
+            case SD_BUS_TYPE_INT16:
+                return readAs<int16_t>(value);
+            case SD_BUS_TYPE_UINT16:
+                return readAs<uint16_t>(value);
+            case SD_BUS_TYPE_INT32:
+                return readAs<int32_t>(value);
+            case SD_BUS_TYPE_UINT32:
+                return readAs<uint32_t>(value);
+            case SD_BUS_TYPE_INT64:
+                return readAs<int64_t>(value);
+            case SD_BUS_TYPE_UINT64:
+                return readAs<uint64_t>(value);
+            case SD_BUS_TYPE_DOUBLE:
+                return read(value);
+            default:
+                return -ENXIO;
+        }
+    }
+
+    // Reads the value of any type straight into JSON
+    int readJson(nlohmann::json& value)
+    {
+        if (consumed)
+        {
+            return error < 0 ? error : -EALREADY;
+        }
+        return settle(details::readJson(m, value));
+    }
+
+    /**
+     * @brief Reads the value into the general purpose variant, for callers
+     * that need to hold on to it.
+     *
+     * @return 0 on success, -ENXIO if the variant can't hold the value, or a
+     * negative errno from sd-bus
+     */
+    int readVariant(dbus::utility::DbusVariantType& value)
+    {
+        if (details::isStringType(valueType))
+        {
+            return read(value.emplace<std::string>());
+        }
+        if (valueType == "as")
+        {
+            return read(value.emplace<std::vector<std::string>>());
+        }
+        if (valueType == "ad")
+        {
+            return read(value.emplace<std::vector<double>>());
+        }
+        if (valueType == "a(sss)")
+        {
+            if (consumed)
+            {
+                return error < 0 ? error : -EALREADY;
+            }
+            return settle(details::readArray(
+                m, "(sss)",
+                value.emplace<std::vector<
+                    std::tuple<std::string, std::string, std::string>>>()));
+        }
+        if (valueType.size() != 1)
+        {
+            return -ENXIO;
+        }
+        switch (valueType[0])
+        {
+            case SD_BUS_TYPE_BOOLEAN:
+                return read(value.emplace<bool>());
+            case SD_BUS_TYPE_BYTE:
+                return read(value.emplace<uint8_t>());
+            case SD_BUS_TYPE_INT16:
+                return read(value.emplace<int16_t>());
+            case SD_BUS_TYPE_UINT16:
+                return read(value.emplace<uint16_t>());
+            case SD_BUS_TYPE_INT32:
+                return read(value.emplace<int32_t>());
+            case SD_BUS_TYPE_UINT32:
+                return read(value.emplace<uint32_t>());
+            case SD_BUS_TYPE_INT64:
+                return read(value.emplace<int64_t>());
+            case SD_BUS_TYPE_UINT64:
+                return read(value.emplace<uint64_t>());
+            case SD_BUS_TYPE_DOUBLE:
+                return read(value.emplace<double>());
+            default:
+                return -ENXIO;
+        }
+    }
+
+    // Skips the value if the visitor didn't read it
+    int finish()
+    {
+        if (consumed)
+        {
+            return error;
+        }
+        return settle(sd_bus_message_skip(m, std::string(valueType).c_str()));
+    }
+
+  private:
+    // Records the outcome of reading the value.  -ENXIO comes from the type
+    // check, before the message is touched, so the value can still be read
+    // another way.
+    int settle(int r)
+    {
+        if (r >= 0)
+        {
+            consumed = true;
+            return 0;
+        }
+        if (r != -ENXIO)
+        {
+            consumed = true;
+            error = r;
+        }
+        return r;
+    }
+
+    template <typename T>
+    int readAs(double& value)
+    {
+        T raw{};
+        int r = read(raw);
+        if (r >= 0)
+        {
+            value = static_cast<double>(raw);
+        }
+        return r;
+    }
+
+    sd_bus_message* m;
+    std::string_view propertyName;
+    std::string_view valueType;
+    bool consumed = false;
+    // Set once sd-bus has failed a read
+    int error = 0;
+};
+
+/**
+ * @brief Walks a dictionary of properties, a{sv}, calling visitor with each
+ * Property.  The visitor returns false to stop early.
+ *
+ * @return 0 once every property has been visited, -ECANCELED if the visitor
+ * stopped, or a negative errno if the dictionary couldn't be decoded
+ */
+template <typename Visitor>
+inline int readPropertyDict(sd_bus_message* m, Visitor&& visitor)
+{
+    int r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}");
+    if (r < 0)
+    {
+        return r;
+    }
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "sv")) > 0)
+    {
+        std::string_view name;
+        r = details::readBasic(m, SD_BUS_TYPE_STRING, name);
+        if (r < 0)
+        {
+            return r;
+        }
+        const char* contents = nullptr;
+        r = sd_bus_message_peek_type(m, nullptr, &contents);
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_enter_container(m, SD_BUS_TYPE_VARIANT, contents);
+        if (r < 0)
+        {
+            return r;
+        }
+        Property property(m, name, contents);
+        if (!visitor(property))
+        {
+            return -ECANCELED;
+        }
+        r = property.finish();
+        if (r < 0)
+        {
+            return r;
+        }
+        // Leave the variant, then the dict entry
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            return r;
+        }
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    r = sd_bus_message_exit_container(m);
+    return r < 0 ? r : 0;
+}
+
+/**
+ * @brief The properties of one interface of a GetManagedObjects reply, to be
+ * visited one at a time.  Properties that aren't are skipped.
+ */
+class Properties
+{
+  public:
+    explicit Properties(sd_bus_message* message) : m(message)
+    {}
+
+    Properties(const Properties&) = delete;
+    Properties& operator=(const Properties&) = delete;
+    Properties(Properties&&) = delete;
+    Properties& operator=(Properties&&) = delete;
+    ~Properties() = default;
+
+    // See readPropertyDict
+    template <typename Visitor>
+    int forEach(Visitor&& visitor)
+    {
+        if (consumed)
+        {
+            return -EALREADY;
+        }
+        consumed = true;
+        // Unless the whole dictionary was walked, the message is left
+        // somewhere inside it
+        result = readPropertyDict(m, std::forward<Visitor>(visitor));
+        return result;
+    }
+
+    int finish()
+    {
+        if (consumed)
+        {
+            return result;
+        }
+        consumed = true;
+        result = sd_bus_message_skip(m, "a{sv}");
+        return result < 0 ? result : 0;
+    }
+
+  private:
+    sd_bus_message* m;
+    bool consumed = false;
+    int result = 0;
+};
+
+/**
+ * @brief Walks a GetManagedObjects reply, a{oa{sa{sv}}}, calling
+ * visitor(path, interface, properties) for each instance of the requested
+ * interfaces.  Other interfaces are skipped without being decoded.  The
+ * visitor returns false to stop early.
+ *
+ * @param[in] msg         Reply to GetManagedObjects
+ * @param[in] interfaces  Interfaces to visit; all of them if empty
+ * @param[in] visitor     Callable taking (std::string_view path,
+ *                        std::string_view interface, Properties&)
+ *
+ * @return 0 once the whole reply has been visited, -ECANCELED if the visitor
+ * stopped, or a negative errno if the reply couldn't be decoded
+ */
+template <typename Interfaces, typename Visitor>
+inline int readManagedObjects(sdbusplus::message::message& msg,
+                              const Interfaces& interfaces, Visitor&& visitor)
+{
+    sd_bus_message* m = msg.get();
+    int r =
+        sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{oa{sa{sv}}}");
+    if (r < 0)
+    {
+        return r;
+    }
+    while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                               "oa{sa{sv}}")) > 0)
+    {
+        std::string_view path;
+        r = details::readBasic(m, SD_BUS_TYPE_OBJECT_PATH, path);
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}");
+        if (r < 0)
+        {
+            return r;
+        }
+        while ((r = sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                   "sa{sv}")) > 0)
+        {
+            std::string_view interface;
+            r = details::readBasic(m, SD_BUS_TYPE_STRING, interface);
+            if (r < 0)
+            {
+                return r;
+            }
+            Properties properties(m);
+            if (std::empty(interfaces) ||
+                std::find_if(std::begin(interfaces), std::end(interfaces),
+                             [interface](const auto& wanted) {
+                                 return interface == wanted;
+                             }) != std::end(interfaces))
+            {
+                if (!visitor(path, interface, properties))
+                {
+                    return -ECANCELED;
+                }
+            }
+            r = properties.finish();
+            if (r < 0)
+            {
+                return r;
+            }
+            r = sd_bus_message_exit_container(m);
+            if (r < 0)
+            {
+                return r;
+            }
+        }
+        if (r < 0)
+        {
+            return r;
+        }
+        // Leave the interface array, then the object's dict entry
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            return r;
+        }
+        r = sd_bus_message_exit_container(m);
+        if (r < 0)
+        {
+            return r;
+        }
+    }
+    if (r < 0)
+    {
+        return r;
+    }
+    r = sd_bus_message_exit_container(m);
+    return r < 0 ? r : 0;
+}
+
+/**
+ * @brief Walks a Properties.GetAll reply, calling visitor with each
+ * Property.  See readPropertyDict.
+ */
+template <typename Visitor>
+inline int readProperties(sdbusplus::message::message& msg, Visitor&& visitor)
+{
+    return readPropertyDict(msg.get(), std::forward<Visitor>(visitor));
+}
+
+} // namespace decode
+} // namespace dbus
@@ -200,7 +200,7 @@ inline void requestRoutes(App& app)
 
                     thisSession.matches.emplace_back(
                         std::make_unique<sdbusplus::bus::match::match>(
-                            *crow::connections::systemBus,
+                            *crow::connections::signalBus,
                             propertiesMatchString, onPropertyUpdate, &conn));
                 }
                 else
@@ -224,7 +224,7 @@ inline void requestRoutes(App& app)
                                          << ifaceMatchString;
                         thisSession.matches.emplace_back(
                             std::make_unique<sdbusplus::bus::match::match>(
-                                *crow::connections::systemBus, ifaceMatchString,
+                                *crow::connections::signalBus, ifaceMatchString,
                                 onPropertyUpdate, &conn));
                     }
                 }
@@ -239,7 +239,7 @@ inline void requestRoutes(App& app)
                                  << objectManagerMatchString;
                 thisSession.matches.emplace_back(
                     std::make_unique<sdbusplus::bus::match::match>(
-                        *crow::connections::systemBus, objectManagerMatchString,
+                        *crow::connections::signalBus, objectManagerMatchString,
                         onPropertyUpdate, &conn));
             }
         });
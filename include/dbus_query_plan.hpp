@@ -0,0 +1,277 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <async_resp.hpp>
+#include <boost/system/error_code.hpp>
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <mapper_mirror.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dbus
+{
+namespace utility
+{
+
+/**
+ * @brief The D-Bus reads needed to build one resource, declared up front and
+ * run together.
+ *
+ * A handler declares each read it needs along with a callback for its reply,
+ * then calls execute().  Every read declared before execute() is issued at
+ * once, so reads that don't depend on each other run in parallel instead of
+ * one after another.  A read that depends on the reply to another is
+ * declared from that read's callback, through the plan the callback is given,
+ * and is issued right away.  Identical reads are made only once, and the
+ * reply is handed to each of their callbacks.  The join callback given to
+ * execute() runs once every read, including those declared by callbacks, has
+ * completed and had its callbacks run.
+ *
+ * Reads are made through asyncMethodCall on behalf of the request, so a plan
+ * whose client goes away stops without running its join callback.  A plan
+ * must be owned by a std::shared_ptr, and is kept alive by the reads it has
+ * issued; reads declared on a plan that is never executed don't hold it.
+ */
+class QueryPlan : public std::enable_shared_from_this<QueryPlan>
+{
+  public:
+    template <typename Reply>
+    using Callback = std::function<void(const boost::system::error_code&,
+                                        const Reply&, QueryPlan&)>;
+
+    // Hands the reply to a read over to the plan
+    template <typename Reply>
+    using Done = std::function<void(const boost::system::error_code&, Reply&&)>;
+
+    explicit QueryPlan(const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn) :
+        asyncResp(asyncRespIn)
+    {}
+
+    QueryPlan(const QueryPlan&) = delete;
+    QueryPlan& operator=(const QueryPlan&) = delete;
+    QueryPlan(QueryPlan&&) = delete;
+    QueryPlan& operator=(QueryPlan&&) = delete;
+    ~QueryPlan() = default;
+
+    // org.freedesktop.DBus.Properties.GetAll
+    void getAllProperties(const std::string& service, const std::string& path,
+                          const std::string& interface,
+                          Callback<DBusPropertiesMap>&& callback)
+    {
+        add<DBusPropertiesMap>(
+            "GetAll " + service + " " + path + " " + interface,
+            std::move(callback),
+            [this, service, path, interface](Done<DBusPropertiesMap> done) {
+                asyncMethodCall(
+                    asyncResp,
+                    [done{std::move(done)}](const boost::system::error_code ec,
+                                            DBusPropertiesMap& properties) {
+                        done(ec, std::move(properties));
+                    },
+                    service, path, "org.freedesktop.DBus.Properties",
+                    "GetAll", interface);
+            });
+    }
+
+    // org.freedesktop.DBus.Properties.Get
+    void getProperty(const std::string& service, const std::string& path,
+                     const std::string& interface, const std::string& property,
+                     Callback<DbusVariantType>&& callback)
+    {
+        add<DbusVariantType>(
+            "Get " + service + " " + path + " " + interface + " " + property,
+            std::move(callback),
+            [this, service, path, interface,
+             property](Done<DbusVariantType> done) {
+                asyncMethodCall(
+                    asyncResp,
+                    [done{std::move(done)}](const boost::system::error_code ec,
+                                            DbusVariantType& value) {
+                        done(ec, std::move(value));
+                    },
+                    service, path, "org.freedesktop.DBus.Properties", "Get",
+                    interface, property);
+            });
+    }
+
+    // ObjectMapper GetSubTree, answered by the mapper mirror when it is
+    // enabled
+    void getSubTree(const std::string& path, int32_t depth,
+                    const std::vector<std::string>& interfaces,
+                    Callback<crow::mapper_mirror::GetSubTreeType>&& callback)
+    {
+        std::string key =
+            "GetSubTree " + path + " " + std::to_string(depth) + " ";
+        for (const std::string& interface : interfaces)
+        {
+            key += interface + ",";
+        }
+        add<crow::mapper_mirror::GetSubTreeType>(
+            key, std::move(callback),
+            [this, path, depth, interfaces](
+                Done<crow::mapper_mirror::GetSubTreeType> done) {
+                if (isCancelled(asyncResp))
+                {
+                    return;
+                }
+                dbus::utility::getSubTree(
+                    path, depth, interfaces,
+                    [done{std::move(done)}](
+                        const boost::system::error_code ec,
+                        crow::mapper_mirror::GetSubTreeType& subtree) {
+                        done(ec, std::move(subtree));
+                    });
+            });
+    }
+
+    /**
+     * @brief Declares a read that the helpers above don't cover.
+     *
+     * @param[in] key       Identifies the read; reads with the same key are
+     *                      made once
+     * @param[in] callback  Called with the reply
+     * @param[in] issue     Makes the read when called with a Done<Reply>,
+     *                      which it must call exactly once with the reply
+     */
+    template <typename Reply, typename Issue>
+    void add(const std::string& key, Callback<Reply>&& callback, Issue&& issue)
+    {
+        auto it = reads.find(key);
+        if (it != reads.end())
+        {
+            BMCWEB_LOG_DEBUG << "Query plan reusing " << key;
+            std::shared_ptr<Read<Reply>> read =
+                std::static_pointer_cast<Read<Reply>>(it->second);
+            if (read->done)
+            {
+                callback(read->ec, read->reply, *this);
+                return;
+            }
+            read->callbacks.emplace_back(std::move(callback));
+            return;
+        }
+
+        auto read = std::make_shared<Read<Reply>>();
+        read->callbacks.emplace_back(std::move(callback));
+        reads.emplace(key, read);
+        pending++;
+
+        // Only the issued read holds the plan, so that reads waiting in
+        // deferred don't keep it alive
+        std::function<void()> start =
+            [this, read, issue{std::forward<Issue>(issue)}]() mutable {
+                issue([self{shared_from_this()},
+                       read](const boost::system::error_code& ec,
+                             Reply&& reply) {
+                    self->complete(*read, ec, std::move(reply));
+                });
+            };
+        if (executing)
+        {
+            start();
+            return;
+        }
+        deferred.emplace_back(std::move(start));
+    }
+
+    /**
+     * @brief Issues every read declared so far, and arranges for join, if
+     * given, to run once all reads are complete.  Call once, after declaring
+     * the reads that don't depend on others.
+     */
+    void execute(std::function<void()>&& joinIn = nullptr)
+    {
+        join = std::move(joinIn);
+        executing = true;
+        std::vector<std::function<void()>> toIssue;
+        toIssue.swap(deferred);
+        // Held while issuing, so that a read answered synchronously can't
+        // run join before the rest have been issued
+        pending++;
+        for (std::function<void()>& issue : toIssue)
+        {
+            issue();
+        }
+        finishOne();
+    }
+
+  private:
+    struct ReadBase
+    {
+        ReadBase() = default;
+        ReadBase(const ReadBase&) = delete;
+        ReadBase& operator=(const ReadBase&) = delete;
+        ReadBase(ReadBase&&) = delete;
+        ReadBase& operator=(ReadBase&&) = delete;
+        virtual ~ReadBase() = default;
+    };
+
+    template <typename Reply>
+    struct Read : ReadBase
+    {
+        bool done = false;
+        boost::system::error_code ec;
+        Reply reply;
+        std::vector<Callback<Reply>> callbacks;
+    };
+
+    template <typename Reply>
+    void complete(Read<Reply>& read, const boost::system::error_code& ec,
+                  Reply&& reply)
+    {
+        read.done = true;
+        read.ec = ec;
+        read.reply = std::move(reply);
+        std::vector<Callback<Reply>> callbacks;
+        callbacks.swap(read.callbacks);
+        for (Callback<Reply>& callback : callbacks)
+        {
+            callback(read.ec, read.reply, *this);
+        }
+        finishOne();
+    }
+
+    void finishOne()
+    {
+        pending--;
+        if (pending != 0 || !executing || !join)
+        {
+            return;
+        }
+        std::function<void()> onComplete = std::move(join);
+        join = nullptr;
+        onComplete();
+    }
+
+    std::shared_ptr<bmcweb::AsyncResp> asyncResp;
+    std::map<std::string, std::shared_ptr<ReadBase>> reads;
+    // Reads declared before execute(), waiting to be issued
+    std::vector<std::function<void()>> deferred;
+    size_t pending = 0;
+    bool executing = false;
+    std::function<void()> join;
+};
+
+} // namespace utility
+} // namespace dbus
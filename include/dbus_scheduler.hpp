@@ -0,0 +1,282 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include "bmcweb_config.h"
+
+#include <boost/container/flat_map.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <string>
+#include <utility>
+
+namespace crow
+{
+namespace dbus_scheduler
+{
+
+/**
+ * @brief Admission control for D-Bus method calls.
+ *
+ * Every call is submitted together with the destination service and an owner,
+ * normally the request it is made for.  A call starts immediately if neither
+ * the service nor the whole process is at its limit of calls in flight;
+ * otherwise it is queued.  Each service keeps one queue per owner, and
+ * queued calls are started round-robin across owners, so a single request
+ * that fans out to hundreds of objects cannot hold back everyone else that
+ * talks to the same daemon.  When the global limit is what held a call back,
+ * services with queued calls are served in turn as slots free up.
+ *
+ * A started call holds its slot until release() is called for its service,
+ * which has to happen exactly once per started call, normally from the reply
+ * handler.  A job that throws, as async_method_call does when the call can't
+ * be sent, never started a call, so its slot is given back straight away.
+ * The exception reaches the caller of submit() if the job started there;
+ * a queued job has nobody to hand it to, so its failure callback runs
+ * instead, for the caller to answer whoever the call was made for.
+ */
+class Scheduler
+{
+  public:
+    using Job = std::function<void()>;
+
+    static Scheduler& getInstance()
+    {
+        static Scheduler scheduler;
+        return scheduler;
+    }
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+    Scheduler(Scheduler&&) = delete;
+    Scheduler& operator=(Scheduler&&) = delete;
+
+    // failed must not throw
+    void submit(const std::string& service, const void* owner, Job&& job,
+                Job&& failed = nullptr)
+    {
+        Service& dest = services[service];
+        dest.submitted++;
+        if (queued == 0 && inFlight < globalLimit &&
+            dest.inFlight < dest.limit)
+        {
+            // Exceptions reach the caller, as they would without the
+            // scheduler
+            start(service, dest, std::move(job));
+            return;
+        }
+
+        auto it = std::find_if(
+            dest.owners.begin(), dest.owners.end(),
+            [owner](const OwnerQueue& queue) { return queue.owner == owner; });
+        if (it == dest.owners.end())
+        {
+            dest.owners.push_back(OwnerQueue{owner, {}});
+            it = dest.owners.end() - 1;
+        }
+        it->calls.push_back(Call{std::move(job), std::move(failed)});
+        dest.queued++;
+        queued++;
+        peakQueued = std::max(peakQueued, queued);
+        BMCWEB_LOG_DEBUG << "Queued call to " << service << ", " << dest.queued
+                         << " waiting for that service";
+        dispatch();
+    }
+
+    void release(const std::string& service)
+    {
+        auto it = services.find(service);
+        if (it == services.end() || it->second.inFlight == 0)
+        {
+            BMCWEB_LOG_ERROR << "Released a call to " << service
+                             << " that was never started";
+            return;
+        }
+        it->second.inFlight--;
+        inFlight--;
+        dispatch();
+    }
+
+    // Overrides the per-service limit for a daemon known to cope with more,
+    // or fewer, concurrent calls than the default
+    void setLimit(const std::string& service, size_t limit)
+    {
+        services[service].limit = std::max<size_t>(limit, 1);
+        dispatch();
+    }
+
+    nlohmann::json statistics() const
+    {
+        nlohmann::json stats;
+        stats["in_flight"] = inFlight;
+        stats["queued"] = queued;
+        stats["peak_in_flight"] = peakInFlight;
+        stats["peak_queued"] = peakQueued;
+        stats["global_limit"] = globalLimit;
+        nlohmann::json& perService = stats["services"];
+        perService = nlohmann::json::object();
+        for (const auto& [name, dest] : services)
+        {
+            perService[name] = {{"in_flight", dest.inFlight},
+                                {"queued", dest.queued},
+                                {"submitted", dest.submitted},
+                                {"delayed", dest.delayed},
+                                {"failed", dest.failed},
+                                {"limit", dest.limit}};
+        }
+        return stats;
+    }
+
+  private:
+    struct Call
+    {
+        Job start;
+        Job failed;
+    };
+
+    struct OwnerQueue
+    {
+        const void* owner;
+        std::deque<Call> calls;
+    };
+
+    struct Service
+    {
+        size_t limit = bmcwebDbusServiceConcurrency;
+        size_t inFlight = 0;
+        size_t queued = 0;
+        uint64_t submitted = 0;
+        uint64_t delayed = 0;
+        uint64_t failed = 0;
+        // Owners with queued calls, in the order they will next be served
+        std::deque<OwnerQueue> owners;
+    };
+
+    Scheduler()
+    {
+        metrics::registerProvider(
+            "dbus_scheduler",
+            [this](nlohmann::json& json) { json = statistics(); });
+    }
+
+    // dest must not be used once job has run
+    void start(const std::string& service, Service& dest, Job&& job)
+    {
+        dest.inFlight++;
+        inFlight++;
+        peakInFlight = std::max(peakInFlight, inFlight);
+        try
+        {
+            job();
+        }
+        catch (...)
+        {
+            // The job may have added services, moving dest
+            Service& failed = services[service];
+            failed.inFlight--;
+            failed.failed++;
+            inFlight--;
+            throw;
+        }
+    }
+
+    // Starts queued calls until every service with work is at its limit or
+    // the global limit is reached.  Each pass starts at most one call per
+    // service, so services share the global slots evenly.
+    void dispatch()
+    {
+        // Jobs can submit further calls; the outer loop picks those up
+        if (dispatching)
+        {
+            return;
+        }
+        dispatching = true;
+        bool progress = true;
+        while (progress && queued > 0 && inFlight < globalLimit)
+        {
+            progress = false;
+            // Indexed, as a started job may add services to the map
+            for (size_t i = 0; i < services.size(); i++)
+            {
+                if (inFlight >= globalLimit)
+                {
+                    break;
+                }
+                auto destIt = services.nth(i);
+                Service& dest = destIt->second;
+                if (dest.owners.empty() || dest.inFlight >= dest.limit)
+                {
+                    continue;
+                }
+                OwnerQueue queue = std::move(dest.owners.front());
+                dest.owners.pop_front();
+                Call call = std::move(queue.calls.front());
+                queue.calls.pop_front();
+                if (!queue.calls.empty())
+                {
+                    dest.owners.push_back(std::move(queue));
+                }
+                dest.queued--;
+                dest.delayed++;
+                queued--;
+                // Whoever freed the slot has nothing to do with this job, so
+                // there is nobody to hand the exception to
+                std::string service = destIt->first;
+                bool started = false;
+                try
+                {
+                    start(service, dest, std::move(call.start));
+                    started = true;
+                }
+                catch (const std::exception& e)
+                {
+                    BMCWEB_LOG_ERROR << "Queued call to " << service
+                                     << " failed to start: " << e.what();
+                }
+                catch (...)
+                {
+                    BMCWEB_LOG_ERROR << "Queued call to " << service
+                                     << " failed to start";
+                }
+                if (!started && call.failed)
+                {
+                    call.failed();
+                }
+                progress = true;
+            }
+        }
+        dispatching = false;
+    }
+
+    boost::container::flat_map<std::string, Service> services;
+    const size_t globalLimit = bmcwebDbusGlobalConcurrency;
+    size_t inFlight = 0;
+    size_t queued = 0;
+    size_t peakInFlight = 0;
+    size_t peakQueued = 0;
+    bool dispatching = false;
+};
+
+} // namespace dbus_scheduler
+} // namespace crow
@@ -1,11 +1,56 @@
 #pragma once
+#include <dbus_accounting.hpp>
 #include <sdbusplus/asio/connection.hpp>
 
+#include <memory>
+#include <string>
+#include <utility>
+
 namespace crow
 {
 namespace connections
 {
-static std::shared_ptr<sdbusplus::asio::connection> systemBus;
+
+/**
+ * @brief A bus connection that accounts for every method call sent with
+ * async_method_call when metrics are enabled, whichever handler sends it.
+ */
+class Bus : public sdbusplus::asio::connection
+{
+  public:
+    using sdbusplus::asio::connection::connection;
+
+    template <typename MessageHandler, typename... InputArgs>
+    void async_method_call(MessageHandler&& handler,
+                           const std::string& service,
+                           const std::string& objpath,
+                           const std::string& interf,
+                           const std::string& method,
+                           const InputArgs&... args)
+    {
+#ifdef BMCWEB_ENABLE_METRICS
+        sdbusplus::asio::connection::async_method_call(
+            dbus_accounting::accounted(std::forward<MessageHandler>(handler),
+                                       service, interf, method),
+            service, objpath, interf, method, args...);
+#else
+        sdbusplus::asio::connection::async_method_call(
+            std::forward<MessageHandler>(handler), service, objpath, interf,
+            method, args...);
+#endif
+    }
+};
+
+static std::shared_ptr<Bus> systemBus;
+
+// A second system bus connection, which carries the signal matches that can
+// see bursts of traffic, such as event, task and firmware update matches.
+// Each connection has its own socket and dispatches one message per turn of
+// the io_context, so a signal storm queues up here rather than ahead of the
+// method replies that requests are waiting for on systemBus.  The caches
+// kept current from signals match here too; those whose seed has to be
+// ordered against the signals make the seed calls on this connection.
+static std::shared_ptr<Bus> signalBus;
 
 } // namespace connections
 } // namespace crow
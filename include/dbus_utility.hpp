@@ -15,10 +15,26 @@
  */
 #pragma once
 
+#include <async_resp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/callable_traits.hpp>
+#include <dbus_accounting.hpp>
+#include <dbus_scheduler.hpp>
+#include <dbus_singleton.hpp>
+#include <logging.hpp>
+#include <mapper_mirror.hpp>
+#include <metrics.hpp>
 #include <sdbusplus/message.hpp>
 
 #include <filesystem>
+#include <iterator>
+#include <memory>
+#include <optional>
 #include <regex>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 namespace dbus
 {
@@ -82,6 +98,113 @@ inline bool getNthStringFromPath(const std::string& path, int index,
     return true;
 }
 
+namespace details
+{
+
+template <typename Handler, typename Args>
+struct Guarded;
+
+// Wraps handler in a callable with exactly the same parameters, so that
+// sdbusplus can still deduce the reply type from it.  guard runs first, with
+// the reply if it accepts it, and the handler only runs if it returns true.
+template <typename Handler, typename... Args>
+struct Guarded<Handler, std::tuple<Args...>>
+{
+    template <typename Guard>
+    static auto wrap(Handler&& handler, Guard&& guard)
+    {
+        return [handler{std::move(handler)},
+                guard{std::forward<Guard>(guard)}](Args... args) mutable {
+            if constexpr (std::is_invocable_v<std::decay_t<Guard>&,
+                                              const Args&...>)
+            {
+                if (!guard(std::as_const(args)...))
+                {
+                    return;
+                }
+            }
+            else
+            {
+                if (!guard())
+                {
+                    return;
+                }
+            }
+            handler(std::forward<Args>(args)...);
+        };
+    }
+};
+
+template <typename Handler, typename Guard>
+inline auto guarded(Handler&& handler, Guard&& guard)
+{
+    using HandlerType = std::decay_t<Handler>;
+    using Args = boost::callable_traits::args_t<HandlerType>;
+    return Guarded<HandlerType, Args>::wrap(
+        HandlerType(std::forward<Handler>(handler)),
+        std::forward<Guard>(guard));
+}
+
+template <typename Args>
+struct Failed;
+
+// Answers a handler with an error, and empty values for the rest of its
+// parameters, as for a call that failed
+template <typename Ec, typename... Rest>
+struct Failed<std::tuple<Ec, Rest...>>
+{
+    template <typename Handler>
+    static void answer(Handler& handler)
+    {
+        std::tuple<std::decay_t<Rest>...> values;
+        std::apply(
+            [&handler](auto&... value) {
+                handler(boost::system::errc::make_error_code(
+                            boost::system::errc::io_error),
+                        static_cast<Rest&&>(value)...);
+            },
+            values);
+    }
+};
+
+// Answers handler with an error for a call that couldn't be sent.  The
+// completion is kept asynchronous, as handlers expect.
+template <typename Handler>
+inline void answerFailed(const std::shared_ptr<Handler>& handler)
+{
+    boost::asio::post(crow::connections::systemBus->get_io_context(),
+                      [handler]() {
+                          using Args = boost::callable_traits::args_t<Handler>;
+                          Failed<Args>::answer(*handler);
+                      });
+}
+
+// A copy of handler that first gives back the scheduler slot of the call to
+// service, so that calls the handler makes can take it
+template <typename Handler>
+inline auto releasing(const Handler& handler, const std::string& service)
+{
+    return guarded(Handler(handler), [service]() {
+        crow::dbus_scheduler::Scheduler::getInstance().release(service);
+        return true;
+    });
+}
+
+// Sends the call, accounting for it against route when metrics are enabled
+template <typename Handler, typename... InputArgs>
+inline void send(std::string_view route, Handler&& handler,
+                 const std::string& service, const std::string& objpath,
+                 const std::string& interf, const std::string& method,
+                 const InputArgs&... args)
+{
+    crow::dbus_accounting::RouteScope scope(route);
+    crow::connections::systemBus->async_method_call(
+        std::forward<Handler>(handler), service, objpath, interf, method,
+        args...);
+}
+
+} // namespace details
+
 template <typename Callback>
 inline void checkDbusPathExists(const std::string& path, Callback&& callback)
 {
@@ -99,5 +222,259 @@ inline void checkDbusPathExists(const std::string& path, Callback&& callback)
         std::array<std::string, 0>());
 }
 
+/**
+ * @brief Calls ObjectMapper GetSubTree, answering from the in-process mirror
+ * of the mapper when it is enabled and up to date.
+ *
+ * @param[in] path        D-Bus path at which to start the search
+ * @param[in] depth       Maximum depth below path, 0 for unlimited
+ * @param[in] interfaces  Objects must implement one of these, if not empty
+ * @param[in] callback    Called with the error code and the subtree
+ */
+template <typename Interfaces, typename Callback>
+inline void getSubTree(const std::string& path, int32_t depth,
+                       const Interfaces& interfaces, Callback&& callback)
+{
+    std::vector<std::string> wanted(std::begin(interfaces),
+                                    std::end(interfaces));
+#ifdef BMCWEB_ENABLE_MAPPER_MIRROR
+    const crow::mapper_mirror::Mirror& mirror =
+        crow::mapper_mirror::Mirror::getInstance();
+    if (mirror.ready())
+    {
+        std::optional<crow::mapper_mirror::GetSubTreeType> subtree =
+            mirror.getIndex().getSubTree(path, depth, wanted);
+        boost::system::error_code ec;
+        if (!subtree)
+        {
+            ec = crow::mapper_mirror::resourceNotFound();
+            subtree.emplace();
+        }
+        // Keep the completion asynchronous, as handlers expect
+        boost::asio::post(crow::connections::systemBus->get_io_context(),
+                          [callback{std::forward<Callback>(callback)}, ec,
+                           subtree{std::move(*subtree)}]() mutable {
+                              callback(ec, subtree);
+                          });
+        return;
+    }
+#endif
+    crow::connections::systemBus->async_method_call(
+        [callback{std::forward<Callback>(callback)}](
+            const boost::system::error_code ec,
+            crow::mapper_mirror::GetSubTreeType& subtree) mutable {
+            callback(ec, subtree);
+        },
+        crow::mapper_mirror::mapperService, crow::mapper_mirror::mapperPath,
+        crow::mapper_mirror::mapperInterface, "GetSubTree", path, depth,
+        wanted);
+}
+
+/**
+ * @brief Calls ObjectMapper GetSubTreePaths, answering from the in-process
+ * mirror of the mapper when it is enabled and up to date.
+ *
+ * @param[in] path        D-Bus path at which to start the search
+ * @param[in] depth       Maximum depth below path, 0 for unlimited
+ * @param[in] interfaces  Objects must implement one of these, if not empty
+ * @param[in] callback    Called with the error code and the object paths
+ */
+template <typename Interfaces, typename Callback>
+inline void getSubTreePaths(const std::string& path, int32_t depth,
+                            const Interfaces& interfaces, Callback&& callback)
+{
+    std::vector<std::string> wanted(std::begin(interfaces),
+                                    std::end(interfaces));
+#ifdef BMCWEB_ENABLE_MAPPER_MIRROR
+    const crow::mapper_mirror::Mirror& mirror =
+        crow::mapper_mirror::Mirror::getInstance();
+    if (mirror.ready())
+    {
+        std::optional<crow::mapper_mirror::GetSubTreePathsType> paths =
+            mirror.getIndex().getSubTreePaths(path, depth, wanted);
+        boost::system::error_code ec;
+        if (!paths)
+        {
+            ec = crow::mapper_mirror::resourceNotFound();
+            paths.emplace();
+        }
+        boost::asio::post(crow::connections::systemBus->get_io_context(),
+                          [callback{std::forward<Callback>(callback)}, ec,
+                           paths{std::move(*paths)}]() mutable {
+                              callback(ec, paths);
+                          });
+        return;
+    }
+#endif
+    crow::connections::systemBus->async_method_call(
+        [callback{std::forward<Callback>(callback)}](
+            const boost::system::error_code ec,
+            crow::mapper_mirror::GetSubTreePathsType& paths) mutable {
+            callback(ec, paths);
+        },
+        crow::mapper_mirror::mapperService, crow::mapper_mirror::mapperPath,
+        crow::mapper_mirror::mapperInterface, "GetSubTreePaths", path, depth,
+        wanted);
+}
+
+/**
+ * @brief Calls ObjectMapper GetObject, answering from the in-process mirror
+ * of the mapper when it is enabled and up to date.
+ *
+ * @param[in] path        D-Bus object path to look up
+ * @param[in] interfaces  Services must implement one of these, if not empty
+ * @param[in] callback    Called with the error code and the owning services
+ */
+template <typename Interfaces, typename Callback>
+inline void getObject(const std::string& path, const Interfaces& interfaces,
+                      Callback&& callback)
+{
+    std::vector<std::string> wanted(std::begin(interfaces),
+                                    std::end(interfaces));
+#ifdef BMCWEB_ENABLE_MAPPER_MIRROR
+    const crow::mapper_mirror::Mirror& mirror =
+        crow::mapper_mirror::Mirror::getInstance();
+    if (mirror.ready())
+    {
+        std::optional<crow::mapper_mirror::GetObjectType> object =
+            mirror.getIndex().getObject(path, wanted);
+        boost::system::error_code ec;
+        if (!object)
+        {
+            ec = crow::mapper_mirror::resourceNotFound();
+            object.emplace();
+        }
+        boost::asio::post(crow::connections::systemBus->get_io_context(),
+                          [callback{std::forward<Callback>(callback)}, ec,
+                           object{std::move(*object)}]() mutable {
+                              callback(ec, object);
+                          });
+        return;
+    }
+#endif
+    crow::connections::systemBus->async_method_call(
+        [callback{std::forward<Callback>(callback)}](
+            const boost::system::error_code ec,
+            crow::mapper_mirror::GetObjectType& object) mutable {
+            callback(ec, object);
+        },
+        crow::mapper_mirror::mapperService, crow::mapper_mirror::mapperPath,
+        crow::mapper_mirror::mapperInterface, "GetObject", path, wanted);
+}
+
+/**
+ * @brief Wraps a D-Bus reply handler so that it is dropped, rather than run,
+ * if the request that asyncResp belongs to has been cancelled by the time the
+ * reply arrives.  Handlers that would only issue more calls for a client
+ * that has gone away are skipped along with all of that work.
+ */
+template <typename Handler>
+inline auto cancellable(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                        Handler&& handler)
+{
+    return details::guarded(std::forward<Handler>(handler), [asyncResp]() {
+        if (asyncResp->res.isCancelled())
+        {
+            crow::metrics::cancellation().repliesDropped++;
+            return false;
+        }
+        return true;
+    });
+}
+
+/**
+ * @brief Returns true, and accounts for the call that won't be made, if the
+ * request that asyncResp belongs to has been cancelled.
+ */
+inline bool isCancelled(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp)
+{
+    if (!asyncResp->res.isCancelled())
+    {
+        return false;
+    }
+    crow::metrics::cancellation().callsSkipped++;
+    return true;
+}
+
+/**
+ * @brief async_method_call through the D-Bus scheduler, for calls that are
+ * not made on behalf of a single request.  owner groups the calls that are
+ * queued fairly against each other.
+ */
+template <typename Handler, typename... InputArgs>
+inline void scheduledMethodCall(const void* owner, Handler&& handler,
+                                const std::string& service,
+                                const std::string& objpath,
+                                const std::string& interf,
+                                const std::string& method,
+                                const InputArgs&... args)
+{
+#ifdef BMCWEB_ENABLE_DBUS_SCHEDULER
+    // Shared with the failure callback, in case the call can't be sent once
+    // it leaves the queue
+    auto reply = std::make_shared<std::decay_t<Handler>>(
+        std::forward<Handler>(handler));
+    crow::dbus_scheduler::Scheduler::getInstance().submit(
+        service, owner,
+        [reply, service, objpath, interf, method, args...]() {
+            details::send({}, details::releasing(*reply, service), service,
+                          objpath, interf, method, args...);
+        },
+        [reply]() { details::answerFailed(reply); });
+#else
+    std::ignore = owner;
+    details::send({}, std::forward<Handler>(handler), service, objpath,
+                  interf, method, args...);
+#endif
+}
+
+/**
+ * @brief async_method_call on behalf of a request.  The call isn't made if
+ * the request has already been cancelled, and the handler is dropped if it
+ * is cancelled while the call is in flight.  With the D-Bus scheduler
+ * enabled the call may be queued, and is skipped if the request is
+ * cancelled before it leaves the queue.
+ */
+template <typename Handler, typename... InputArgs>
+inline void
+    asyncMethodCall(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                    Handler&& handler, const std::string& service,
+                    const std::string& objpath, const std::string& interf,
+                    const std::string& method, const InputArgs&... args)
+{
+    if (isCancelled(asyncResp))
+    {
+        BMCWEB_LOG_DEBUG << "Request cancelled, not calling " << interf << "."
+                         << method << " on " << service;
+        return;
+    }
+#ifdef BMCWEB_ENABLE_DBUS_SCHEDULER
+    // Shared with the failure callback, which answers the handler with an
+    // error if the call can't be sent once it leaves the queue
+    auto cancellableHandler =
+        cancellable(asyncResp, std::forward<Handler>(handler));
+    auto reply = std::make_shared<decltype(cancellableHandler)>(
+        std::move(cancellableHandler));
+    crow::dbus_scheduler::Scheduler::getInstance().submit(
+        service, asyncResp.get(),
+        [asyncResp, reply, service, objpath, interf, method, args...]() {
+            if (isCancelled(asyncResp))
+            {
+                crow::dbus_scheduler::Scheduler::getInstance().release(
+                    service);
+                return;
+            }
+            details::send(asyncResp->res.route(),
+                          details::releasing(*reply, service), service,
+                          objpath, interf, method, args...);
+        },
+        [reply]() { details::answerFailed(reply); });
+#else
+    details::send(asyncResp->res.route(),
+                  cancellable(asyncResp, std::forward<Handler>(handler)),
+                  service, objpath, interf, method, args...);
+#endif
+}
+
 } // namespace utility
 } // namespace dbus
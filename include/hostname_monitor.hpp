@@ -133,7 +133,7 @@ inline void registerHostnameSignal()
          "member='PropertiesChanged'");
 
     hostnameSignalMonitor = std::make_unique<sdbusplus::bus::match::match>(
-        *crow::connections::systemBus, propertiesMatchString, onPropertyUpdate,
+        *crow::connections::signalBus, propertiesMatchString, onPropertyUpdate,
         nullptr);
 }
 } // namespace hostname_monitor
@@ -26,6 +26,47 @@ inline bool requestPrefersHtml(std::string_view header)
     return false;
 }
 
+/**
+ * @brief Whether an If-Match or If-None-Match header, a comma separated list
+ * of entity tags or "*", names etag, a strong entity tag.  If-None-Match
+ * compares weakly, and so also matches weak tags with the same value;
+ * If-Match compares strongly.
+ */
+inline bool etagMatches(std::string_view header, std::string_view etag,
+                        bool weak)
+{
+    while (!header.empty())
+    {
+        size_t comma = header.find(',');
+        std::string_view tag = header.substr(0, comma);
+        header.remove_prefix(comma == std::string_view::npos ? header.size()
+                                                             : comma + 1);
+        size_t start = tag.find_first_not_of(" \t");
+        if (start == std::string_view::npos)
+        {
+            continue;
+        }
+        tag = tag.substr(start, tag.find_last_not_of(" \t") + 1 - start);
+        if (tag == "*")
+        {
+            return true;
+        }
+        if (tag.substr(0, 2) == "W/")
+        {
+            if (!weak)
+            {
+                continue;
+            }
+            tag.remove_prefix(2);
+        }
+        if (tag == etag)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 inline std::string urlEncode(const std::string_view value)
 {
     std::ostringstream escaped;
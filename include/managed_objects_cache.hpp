@@ -0,0 +1,616 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <boost/asio/post.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace managed_objects_cache
+{
+
+using ManagedObjectType = dbus::utility::ManagedObjectType;
+using Callback = std::function<void(const boost::system::error_code&,
+                                    const ManagedObjectType&)>;
+
+// Most (service, path) pairs cached at once; beyond that the least recently
+// used idle snapshot is evicted to make room
+constexpr size_t maxEntries = 32;
+
+// The functions below apply ObjectManager and Properties signals to a
+// snapshot, whose objects are sorted by path
+
+inline ManagedObjectType::iterator findObject(ManagedObjectType& objects,
+                                              const std::string& path)
+{
+    auto it = std::lower_bound(
+        objects.begin(), objects.end(), path,
+        [](const ManagedObjectType::value_type& object,
+           const std::string& value) { return object.first.str < value; });
+    if (it == objects.end() || it->first.str != path)
+    {
+        return objects.end();
+    }
+    return it;
+}
+
+inline bool hasInterface(ManagedObjectType& objects, const std::string& path,
+                         const std::string& interface)
+{
+    auto it = findObject(objects, path);
+    return it != objects.end() &&
+           it->second.find(interface) != it->second.end();
+}
+
+inline void addInterfaces(ManagedObjectType& objects,
+                          sdbusplus::message::object_path&& objPath,
+                          dbus::utility::DBusInteracesMap&& interfaces)
+{
+    auto it = std::lower_bound(
+        objects.begin(), objects.end(), objPath.str,
+        [](const ManagedObjectType::value_type& object,
+           const std::string& value) { return object.first.str < value; });
+    if (it == objects.end() || it->first.str != objPath.str)
+    {
+        objects.emplace(it, std::move(objPath), std::move(interfaces));
+        return;
+    }
+    for (auto& [interface, properties] : interfaces)
+    {
+        it->second[interface] = std::move(properties);
+    }
+}
+
+inline void removeInterfaces(ManagedObjectType& objects,
+                             const std::string& path,
+                             const std::vector<std::string>& interfaces)
+{
+    auto it = findObject(objects, path);
+    if (it == objects.end())
+    {
+        return;
+    }
+    for (const std::string& interface : interfaces)
+    {
+        it->second.erase(interface);
+    }
+    if (it->second.empty())
+    {
+        objects.erase(it);
+    }
+}
+
+// Objects and interfaces not in the snapshot are left alone, as
+// GetManagedObjects would not have returned them either
+inline void changeProperties(ManagedObjectType& objects,
+                             const std::string& path,
+                             const std::string& interface,
+                             dbus::utility::DBusPropertiesMap&& changed)
+{
+    auto it = findObject(objects, path);
+    if (it == objects.end())
+    {
+        return;
+    }
+    auto interfaceIt = it->second.find(interface);
+    if (interfaceIt == it->second.end())
+    {
+        return;
+    }
+    for (auto& [name, value] : changed)
+    {
+        interfaceIt->second[name] = std::move(value);
+    }
+}
+
+/**
+ * @brief Snapshot cache of GetManagedObjects results, per service and
+ * ObjectManager path.
+ *
+ * The first request for a (service, path) pair fetches the tree and
+ * subscribes to the PropertiesChanged, InterfacesAdded and InterfacesRemoved
+ * signals below that path, which keep the snapshot current from then on.
+ * Requests that arrive while the fetch is in flight wait for it rather than
+ * issuing their own.  A snapshot is dropped, and fetched again on the next
+ * request, when the service changes owner or a change can't be applied.
+ * Entries of a service that leaves the bus are dropped altogether, and at
+ * most maxEntries are kept.
+ *
+ * Snapshots are shared with the callbacks that read them and copied on
+ * write, so an update never changes a tree a handler is looking at.
+ */
+class Cache
+{
+  public:
+    static Cache& getInstance()
+    {
+        static Cache cache;
+        return cache;
+    }
+
+    Cache(const Cache&) = delete;
+    Cache& operator=(const Cache&) = delete;
+    Cache(Cache&&) = delete;
+    Cache& operator=(Cache&&) = delete;
+
+    void get(const std::string& service, const std::string& path,
+             Callback&& callback)
+    {
+        if (nameOwnerChangedMatch == nullptr)
+        {
+            watchNameOwners();
+        }
+
+        Key key(service, path);
+        if (entries.size() >= maxEntries && entries.find(key) == entries.end())
+        {
+            evictIdle();
+        }
+        Entry& entry = entries[key];
+        entry.lastUsed = ++useClock;
+        if (entry.snapshot != nullptr)
+        {
+            entry.hits++;
+            boost::asio::post(
+                crow::connections::systemBus->get_io_context(),
+                [callback{std::move(callback)},
+                 snapshot{std::shared_ptr<const ManagedObjectType>(
+                     entry.snapshot)}]() {
+                    callback(boost::system::error_code(), *snapshot);
+                });
+            return;
+        }
+
+        entry.waiters.emplace_back(std::move(callback));
+        if (entry.fetching)
+        {
+            entry.joined++;
+            return;
+        }
+        entry.misses++;
+        if (entry.signalMatch == nullptr)
+        {
+            watch(service, path, entry);
+        }
+        fetch(service, path, entry);
+    }
+
+  private:
+    using Key = std::pair<std::string, std::string>;
+
+    struct Entry
+    {
+        // Objects sorted by path, or null when there is no current snapshot
+        std::shared_ptr<ManagedObjectType> snapshot;
+        std::vector<Callback> waiters;
+        std::unique_ptr<sdbusplus::bus::match::match> signalMatch;
+        std::unique_ptr<sdbusplus::bus::match::match> propertiesMatch;
+        bool fetching = false;
+        // Bumped whenever the snapshot is dropped, so that a fetch which
+        // started before then is not stored
+        uint64_t generation = 0;
+        // Value of useClock when the entry was last requested
+        uint64_t lastUsed = 0;
+
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t joined = 0;
+        uint64_t updates = 0;
+        uint64_t invalidations = 0;
+    };
+
+    Cache()
+    {
+        crow::metrics::registerProvider(
+            "managed_objects_cache",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Cache() = default;
+
+    static bool idle(const Entry& entry)
+    {
+        return !entry.fetching && entry.waiters.empty();
+    }
+
+    // Drops the least recently used entry that nothing is waiting on
+    void evictIdle()
+    {
+        auto victim = entries.end();
+        for (auto it = entries.begin(); it != entries.end(); ++it)
+        {
+            if (idle(it->second) &&
+                (victim == entries.end() ||
+                 it->second.lastUsed < victim->second.lastUsed))
+            {
+                victim = it;
+            }
+        }
+        if (victim == entries.end())
+        {
+            return;
+        }
+        BMCWEB_LOG_DEBUG << "Evicting GetManagedObjects snapshot for "
+                         << victim->first.first << " "
+                         << victim->first.second;
+        entries.erase(victim);
+        evictions++;
+    }
+
+    void fetch(const std::string& service, const std::string& path,
+               Entry& entry)
+    {
+        entry.fetching = true;
+        uint64_t generation = entry.generation;
+        dbus::utility::scheduledMethodCall(
+            &entry,
+            [this, key{Key(service, path)},
+             generation](const boost::system::error_code ec,
+                         ManagedObjectType& objects) {
+                Entry& entry = entries[key];
+                entry.fetching = false;
+                std::vector<Callback> waiters;
+                waiters.swap(entry.waiters);
+                if (ec)
+                {
+                    BMCWEB_LOG_ERROR << "GetManagedObjects failed for "
+                                     << key.first << " " << key.second << ": "
+                                     << ec;
+                    for (Callback& waiter : waiters)
+                    {
+                        waiter(ec, objects);
+                    }
+                    return;
+                }
+
+                std::sort(objects.begin(), objects.end(),
+                          [](const ManagedObjectType::value_type& left,
+                             const ManagedObjectType::value_type& right) {
+                              return left.first.str < right.first.str;
+                          });
+                auto snapshot =
+                    std::make_shared<ManagedObjectType>(std::move(objects));
+                if (generation == entry.generation)
+                {
+                    entry.snapshot = snapshot;
+                }
+                for (Callback& waiter : waiters)
+                {
+                    waiter(ec, *snapshot);
+                }
+            },
+            service, path, "org.freedesktop.DBus.ObjectManager",
+            "GetManagedObjects");
+    }
+
+    // Subscribes before the first fetch, so no change made after the reply
+    // was generated can be missed
+    void watch(const std::string& service, const std::string& path,
+               Entry& entry)
+    {
+        Key key(service, path);
+        entry.signalMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::systemBus,
+            "type='signal',sender='" + service +
+                "',interface='org.freedesktop.DBus.ObjectManager',path='" +
+                path + "'",
+            [this, key](sdbusplus::message::message& msg) {
+                onObjectManagerSignal(key, msg);
+            });
+        entry.propertiesMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::systemBus,
+            "type='signal',sender='" + service +
+                "',interface='org.freedesktop.DBus.Properties',"
+                "member='PropertiesChanged',path_namespace='" +
+                path + "'",
+            [this, key](sdbusplus::message::message& msg) {
+                onPropertiesChanged(key, msg);
+            });
+    }
+
+    void watchNameOwners()
+    {
+        nameOwnerChangedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::systemBus,
+            "type='signal',sender='org.freedesktop.DBus',"
+            "interface='org.freedesktop.DBus',member='NameOwnerChanged'",
+            [this](sdbusplus::message::message& msg) {
+                std::string name;
+                std::string oldOwner;
+                std::string newOwner;
+                msg.read(name, oldOwner, newOwner);
+                for (auto it = entries.begin(); it != entries.end();)
+                {
+                    if (it->first.first != name)
+                    {
+                        ++it;
+                        continue;
+                    }
+                    // A service that left the bus may never come back, so
+                    // don't keep its matches around
+                    if (newOwner.empty() && idle(it->second))
+                    {
+                        it = entries.erase(it);
+                        evictions++;
+                        continue;
+                    }
+                    invalidate(it->second);
+                    ++it;
+                }
+            });
+    }
+
+    static void invalidate(Entry& entry)
+    {
+        if (entry.snapshot != nullptr)
+        {
+            entry.invalidations++;
+        }
+        entry.snapshot = nullptr;
+        entry.generation++;
+    }
+
+    // Returns the snapshot for writing, copying it first if a reader holds it
+    static ManagedObjectType& writable(Entry& entry)
+    {
+        if (entry.snapshot.use_count() > 1)
+        {
+            entry.snapshot =
+                std::make_shared<ManagedObjectType>(*entry.snapshot);
+        }
+        entry.updates++;
+        return *entry.snapshot;
+    }
+
+    void onObjectManagerSignal(const Key& key,
+                               sdbusplus::message::message& msg)
+    {
+        auto entryIt = entries.find(key);
+        if (entryIt == entries.end() || entryIt->second.snapshot == nullptr)
+        {
+            return;
+        }
+        Entry& entry = entryIt->second;
+        std::string member = msg.get_member();
+        try
+        {
+            if (member == "InterfacesAdded")
+            {
+                sdbusplus::message::object_path objPath;
+                dbus::utility::DBusInteracesMap interfaces;
+                msg.read(objPath, interfaces);
+                addInterfaces(writable(entry), std::move(objPath),
+                              std::move(interfaces));
+            }
+            else if (member == "InterfacesRemoved")
+            {
+                sdbusplus::message::object_path objPath;
+                std::vector<std::string> interfaces;
+                msg.read(objPath, interfaces);
+                removeInterfaces(writable(entry), objPath.str, interfaces);
+            }
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Failed to apply " << member << " for "
+                             << key.first << ": " << e.what();
+            invalidate(entry);
+        }
+    }
+
+    void onPropertiesChanged(const Key& key, sdbusplus::message::message& msg)
+    {
+        auto entryIt = entries.find(key);
+        if (entryIt == entries.end() || entryIt->second.snapshot == nullptr)
+        {
+            return;
+        }
+        Entry& entry = entryIt->second;
+        std::string path = msg.get_path();
+        try
+        {
+            std::string interface;
+            dbus::utility::DBusPropertiesMap changed;
+            std::vector<std::string> invalidated;
+            msg.read(interface, changed, invalidated);
+            if (!invalidated.empty())
+            {
+                // The new values aren't in the signal
+                invalidate(entry);
+                return;
+            }
+
+            // Check first, so that readers aren't copied for nothing
+            if (!hasInterface(*entry.snapshot, path, interface))
+            {
+                return;
+            }
+            changeProperties(writable(entry), path, interface,
+                             std::move(changed));
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Failed to apply PropertiesChanged for "
+                             << key.first << " " << path << ": " << e.what();
+            invalidate(entry);
+        }
+    }
+
+    static size_t stringBytes(const std::string& str)
+    {
+        return sizeof(std::string) + str.capacity();
+    }
+
+    static size_t variantBytes(const dbus::utility::DbusVariantType& value)
+    {
+        return sizeof(value) +
+               std::visit(
+                   [](const auto& v) -> size_t {
+                       using T = std::decay_t<decltype(v)>;
+                       if constexpr (std::is_same_v<T, std::string>)
+                       {
+                           return v.capacity();
+                       }
+                       else if constexpr (std::is_same_v<
+                                              T, std::vector<std::string>>)
+                       {
+                           size_t bytes = 0;
+                           for (const std::string& str : v)
+                           {
+                               bytes += stringBytes(str);
+                           }
+                           return bytes;
+                       }
+                       else if constexpr (std::is_same_v<T,
+                                                         std::vector<double>>)
+                       {
+                           return v.capacity() * sizeof(double);
+                       }
+                       else if constexpr (std::is_same_v<
+                                              T, std::vector<std::tuple<
+                                                     std::string, std::string,
+                                                     std::string>>>)
+                       {
+                           size_t bytes = 0;
+                           for (const auto& [a, b, c] : v)
+                           {
+                               bytes += stringBytes(a) + stringBytes(b) +
+                                        stringBytes(c);
+                           }
+                           return bytes;
+                       }
+                       else
+                       {
+                           return 0;
+                       }
+                   },
+                   value);
+    }
+
+    // An estimate of the heap held by a snapshot
+    static size_t snapshotBytes(const ManagedObjectType& objects)
+    {
+        size_t bytes =
+            objects.capacity() * sizeof(ManagedObjectType::value_type);
+        for (const auto& [path, interfaces] : objects)
+        {
+            bytes += path.str.capacity();
+            for (const auto& [interface, properties] : interfaces)
+            {
+                bytes += stringBytes(interface);
+                for (const auto& [name, value] : properties)
+                {
+                    bytes += stringBytes(name) + variantBytes(value);
+                }
+            }
+        }
+        return bytes;
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t joined = 0;
+        size_t objects = 0;
+        size_t bytes = 0;
+        nlohmann::json& snapshots = json["snapshots"];
+        snapshots = nlohmann::json::array();
+        for (const auto& [key, entry] : entries)
+        {
+            size_t entryObjects = 0;
+            size_t entryBytes = 0;
+            if (entry.snapshot != nullptr)
+            {
+                entryObjects = entry.snapshot->size();
+                entryBytes = snapshotBytes(*entry.snapshot);
+            }
+            snapshots.push_back({{"service", key.first},
+                                 {"path", key.second},
+                                 {"objects", entryObjects},
+                                 {"memory_bytes", entryBytes},
+                                 {"hits", entry.hits},
+                                 {"misses", entry.misses},
+                                 {"joined", entry.joined},
+                                 {"updates", entry.updates},
+                                 {"invalidations", entry.invalidations}});
+            hits += entry.hits;
+            misses += entry.misses;
+            joined += entry.joined;
+            objects += entryObjects;
+            bytes += entryBytes;
+        }
+        json["hits"] = hits;
+        json["misses"] = misses;
+        json["joined"] = joined;
+        json["objects"] = objects;
+        json["memory_bytes"] = bytes;
+        json["evictions"] = evictions;
+    }
+
+    std::map<Key, Entry> entries;
+    uint64_t useClock = 0;
+    uint64_t evictions = 0;
+    std::unique_ptr<sdbusplus::bus::match::match> nameOwnerChangedMatch;
+};
+
+} // namespace managed_objects_cache
+
+/**
+ * @brief Calls GetManagedObjects on service at path, answering from the
+ * snapshot cache when it is enabled.
+ *
+ * Objects in a cached reply are sorted by path.
+ *
+ * @param[in] service   D-Bus service implementing the ObjectManager
+ * @param[in] path      Path of the ObjectManager
+ * @param[in] callback  Called with the error code and the managed objects
+ */
+template <typename Callback>
+inline void getManagedObjects(const std::string& service,
+                              const std::string& path, Callback&& callback)
+{
+#ifdef BMCWEB_ENABLE_MANAGED_OBJECTS_CACHE
+    managed_objects_cache::Cache::getInstance().get(
+        service, path, std::forward<Callback>(callback));
+#else
+    dbus::utility::scheduledMethodCall(
+        nullptr,
+        [callback{std::forward<Callback>(callback)}](
+            const boost::system::error_code ec,
+            const managed_objects_cache::ManagedObjectType& objects) mutable {
+            callback(ec, objects);
+        },
+        service, path, "org.freedesktop.DBus.ObjectManager",
+        "GetManagedObjects");
+#endif
+}
+
+} // namespace crow
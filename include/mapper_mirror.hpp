@@ -0,0 +1,569 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <dbus_singleton.hpp>
+#include <logging.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <signal_cache.hpp>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace mapper_mirror
+{
+
+using GetObjectType =
+    std::vector<std::pair<std::string, std::vector<std::string>>>;
+using GetSubTreeType = std::vector<std::pair<std::string, GetObjectType>>;
+using GetSubTreePathsType = std::vector<std::string>;
+
+constexpr const char* mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* mapperPath = "/xyz/openbmc_project/object_mapper";
+constexpr const char* mapperInterface = "xyz.openbmc_project.ObjectMapper";
+
+// sd-bus has no errno for the mapper's ResourceNotFound, so it reaches
+// callers of the real mapper as EIO; answers from the mirror match that
+inline boost::system::error_code resourceNotFound()
+{
+    return boost::system::errc::make_error_code(boost::system::errc::io_error);
+}
+
+/**
+ * @brief The mapper's path -> service -> interfaces index, and the lookups it
+ * answers.
+ *
+ * Lookups follow the mapper: asking about a path it does not know, or a
+ * GetObject that no service matches, yields std::nullopt where the mapper
+ * fails the call with ResourceNotFound.
+ */
+class Index
+{
+  public:
+    // service -> interfaces
+    using ServiceMap =
+        boost::container::flat_map<std::string,
+                                   boost::container::flat_set<std::string>>;
+
+    static bool isIgnoredInterface(std::string_view interface)
+    {
+        // The mapper does not index the standard interfaces, apart from
+        // ObjectManager
+        return interface == "org.freedesktop.DBus.Introspectable" ||
+               interface == "org.freedesktop.DBus.Peer" ||
+               interface == "org.freedesktop.DBus.Properties";
+    }
+
+    void clear()
+    {
+        objects.clear();
+    }
+
+    size_t size() const
+    {
+        return objects.size();
+    }
+
+    // Whether the mapper knows reqPath, either as an object or as the parent
+    // of one
+    bool hasPath(std::string_view reqPath) const
+    {
+        if (reqPath.size() > 1 && reqPath.back() == '/')
+        {
+            reqPath.remove_suffix(1);
+        }
+        if (reqPath.empty() || reqPath == "/")
+        {
+            return true;
+        }
+        if (objects.find(reqPath) != objects.end())
+        {
+            return true;
+        }
+        std::string prefix(reqPath);
+        prefix += '/';
+        auto it = objects.lower_bound(prefix);
+        return it != objects.end() &&
+               it->first.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    std::optional<GetSubTreeType>
+        getSubTree(std::string_view reqPath, int32_t depth,
+                   const std::vector<std::string>& interfaces) const
+    {
+        if (!hasPath(reqPath))
+        {
+            return std::nullopt;
+        }
+        GetSubTreeType subtree;
+        forEachInSubtree(reqPath, depth,
+                         [&subtree, &interfaces](const std::string& path,
+                                                 const ServiceMap& services) {
+                             GetObjectType object =
+                                 matchServices(services, interfaces);
+                             if (!object.empty())
+                             {
+                                 subtree.emplace_back(path, std::move(object));
+                             }
+                         });
+        return subtree;
+    }
+
+    std::optional<GetSubTreePathsType>
+        getSubTreePaths(std::string_view reqPath, int32_t depth,
+                        const std::vector<std::string>& interfaces) const
+    {
+        if (!hasPath(reqPath))
+        {
+            return std::nullopt;
+        }
+        GetSubTreePathsType paths;
+        forEachInSubtree(reqPath, depth,
+                         [&paths, &interfaces](const std::string& path,
+                                               const ServiceMap& services) {
+                             if (anyServiceMatches(services, interfaces))
+                             {
+                                 paths.emplace_back(path);
+                             }
+                         });
+        return paths;
+    }
+
+    std::optional<GetObjectType>
+        getObject(std::string_view path,
+                  const std::vector<std::string>& interfaces) const
+    {
+        auto it = objects.find(path);
+        if (it == objects.end())
+        {
+            return std::nullopt;
+        }
+        GetObjectType object = matchServices(it->second, interfaces);
+        if (object.empty())
+        {
+            return std::nullopt;
+        }
+        return object;
+    }
+
+    void addInterfaces(const std::string& path, const std::string& service,
+                       const std::vector<std::string>& interfaces)
+    {
+        objects[path][service].insert(interfaces.begin(), interfaces.end());
+
+        // Like the mapper, make every parent path visible for this service
+        std::string parent = path;
+        size_t pos = parent.rfind('/');
+        while (pos != std::string::npos && pos > 0)
+        {
+            parent.resize(pos);
+            objects[parent].try_emplace(service);
+            pos = parent.rfind('/');
+        }
+    }
+
+    void removeInterfaces(const std::string& path, const std::string& service,
+                          const std::vector<std::string>& interfaces)
+    {
+        auto pathIt = objects.find(path);
+        if (pathIt == objects.end())
+        {
+            return;
+        }
+        auto serviceIt = pathIt->second.find(service);
+        if (serviceIt == pathIt->second.end())
+        {
+            return;
+        }
+        for (const std::string& interface : interfaces)
+        {
+            serviceIt->second.erase(interface);
+        }
+        if (!serviceIt->second.empty())
+        {
+            return;
+        }
+        pathIt->second.erase(serviceIt);
+        if (pathIt->second.empty())
+        {
+            objects.erase(pathIt);
+        }
+        removeUnneededParents(path, service);
+    }
+
+    void removeService(const std::string& service)
+    {
+        for (auto it = objects.begin(); it != objects.end();)
+        {
+            it->second.erase(service);
+            if (it->second.empty())
+            {
+                it = objects.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+  private:
+    bool hasDescendant(const std::string& path,
+                       const std::string& service) const
+    {
+        std::string prefix = path + '/';
+        for (auto it = objects.lower_bound(prefix);
+             it != objects.end() &&
+             it->first.compare(0, prefix.size(), prefix) == 0;
+             ++it)
+        {
+            if (it->second.find(service) != it->second.end())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removeUnneededParents(std::string path, const std::string& service)
+    {
+        size_t pos = path.rfind('/');
+        while (pos != std::string::npos && pos > 0)
+        {
+            path.resize(pos);
+            auto pathIt = objects.find(path);
+            if (pathIt == objects.end())
+            {
+                return;
+            }
+            auto serviceIt = pathIt->second.find(service);
+            if (serviceIt == pathIt->second.end() ||
+                !serviceIt->second.empty() || hasDescendant(path, service))
+            {
+                return;
+            }
+            pathIt->second.erase(serviceIt);
+            if (pathIt->second.empty())
+            {
+                objects.erase(pathIt);
+            }
+            pos = path.rfind('/');
+        }
+    }
+
+    static bool hasAnyInterface(
+        const boost::container::flat_set<std::string>& implemented,
+        const std::vector<std::string>& interfaces)
+    {
+        if (interfaces.empty())
+        {
+            return true;
+        }
+        return std::any_of(interfaces.begin(), interfaces.end(),
+                           [&implemented](const std::string& interface) {
+                               return implemented.find(interface) !=
+                                      implemented.end();
+                           });
+    }
+
+    static bool anyServiceMatches(const ServiceMap& services,
+                                  const std::vector<std::string>& interfaces)
+    {
+        return std::any_of(
+            services.begin(), services.end(),
+            [&interfaces](const ServiceMap::value_type& service) {
+                return hasAnyInterface(service.second, interfaces);
+            });
+    }
+
+    static GetObjectType
+        matchServices(const ServiceMap& services,
+                      const std::vector<std::string>& interfaces)
+    {
+        GetObjectType object;
+        for (const auto& [service, implemented] : services)
+        {
+            if (hasAnyInterface(implemented, interfaces))
+            {
+                object.emplace_back(
+                    service, std::vector<std::string>(implemented.begin(),
+                                                      implemented.end()));
+            }
+        }
+        return object;
+    }
+
+    // Calls callback for every indexed path strictly below reqPath and at
+    // most depth levels deep, where a depth of 0 is unlimited
+    template <typename Callback>
+    void forEachInSubtree(std::string_view reqPath, int32_t depth,
+                          Callback&& callback) const
+    {
+        std::string prefix(reqPath);
+        if (prefix.empty() || prefix.back() != '/')
+        {
+            prefix += '/';
+        }
+        for (auto it = objects.lower_bound(prefix); it != objects.end(); ++it)
+        {
+            const std::string& path = it->first;
+            if (path.compare(0, prefix.size(), prefix) != 0)
+            {
+                break;
+            }
+            if (path.size() == prefix.size())
+            {
+                continue;
+            }
+            if (depth > 0)
+            {
+                auto levels = std::count(
+                                  path.begin() + static_cast<std::ptrdiff_t>(
+                                                     prefix.size()),
+                                  path.end(), '/') +
+                              1;
+                if (levels > depth)
+                {
+                    continue;
+                }
+            }
+            callback(path, it->second);
+        }
+    }
+
+    // path -> service -> interfaces, ordered so that subtrees are contiguous
+    std::map<std::string, ServiceMap, std::less<>> objects;
+};
+
+/**
+ * @brief In-process copy of the ObjectMapper's path -> service -> interfaces
+ * index.
+ *
+ * The index is seeded from a single GetSubTree("/") call and then kept up to
+ * date from InterfacesAdded, InterfacesRemoved and NameOwnerChanged signals,
+ * so that GetSubTree, GetSubTreePaths and GetObject can be answered without a
+ * bus round trip.  When a new service name appears the mapper has to
+ * introspect it first, so the mirror stops answering and re-seeds shortly
+ * after; callers fall back to the real mapper whenever ready() is false.
+ */
+class Mirror
+{
+  public:
+    static Mirror& getInstance()
+    {
+        static Mirror mirror;
+        return mirror;
+    }
+
+    Mirror(const Mirror&) = delete;
+    Mirror& operator=(const Mirror&) = delete;
+    Mirror(Mirror&&) = delete;
+    Mirror& operator=(Mirror&&) = delete;
+
+    void start()
+    {
+        BMCWEB_LOG_INFO << "Starting ObjectMapper mirror";
+
+        interfacesAddedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::signalBus,
+            "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+            "member='InterfacesAdded'",
+            [this](sdbusplus::message::message& msg) {
+                onInterfacesAdded(msg);
+            });
+        interfacesRemovedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+                "member='InterfacesRemoved'",
+                [this](sdbusplus::message::message& msg) {
+                    onInterfacesRemoved(msg);
+                });
+        nameOwnerChangedMatch = crow::signal_cache::watchNameOwners(
+            [this](const std::string& name, const std::string& oldOwner,
+                   const std::string& newOwner) {
+                onNameOwnerChanged(name, oldOwner, newOwner);
+            });
+
+        seeding.start();
+    }
+
+    bool ready() const
+    {
+        return seeding.ready();
+    }
+
+    const Index& getIndex() const
+    {
+        return index;
+    }
+
+  private:
+    Mirror() : seeding("ObjectMapper mirror", [this]() { seed(); })
+    {}
+    ~Mirror() = default;
+
+    void seed()
+    {
+        crow::connections::systemBus->async_method_call(
+            [this](const boost::system::error_code ec,
+                   const GetSubTreeType& subtree) {
+                if (ec)
+                {
+                    seeding.failed(ec);
+                    return;
+                }
+                index.clear();
+                boost::container::flat_set<std::string> services;
+                for (const auto& [path, object] : subtree)
+                {
+                    for (const auto& [service, interfaces] : object)
+                    {
+                        index.addInterfaces(path, service, interfaces);
+                        services.insert(service);
+                    }
+                }
+                // Signals carry the unique name of the sender, so learn the
+                // owner of every indexed service
+                owners.resolve(std::move(services), [this]() {
+                    if (seeding.done())
+                    {
+                        BMCWEB_LOG_INFO << "ObjectMapper mirror seeded with "
+                                        << index.size() << " paths";
+                    }
+                });
+            },
+            mapperService, mapperPath, mapperInterface, "GetSubTree", "/", 0,
+            std::array<const char*, 0>());
+    }
+
+    void onInterfacesAdded(sdbusplus::message::message& msg)
+    {
+        if (!seeding.acceptSignal())
+        {
+            return;
+        }
+        const std::string* service = owners.serviceOf(msg.get_sender());
+        if (service == nullptr)
+        {
+            // Not a service the mapper indexes
+            return;
+        }
+
+        // Only the interface names are needed, so skip over the properties
+        // rather than decoding them
+        sd_bus_message* m = msg.get();
+        const char* objPath = nullptr;
+        std::vector<std::string> interfaces;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_OBJECT_PATH, &objPath) <
+                0 ||
+            sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}") <
+                0)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+            return;
+        }
+        while (sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                              "sa{sv}") > 0)
+        {
+            const char* interface = nullptr;
+            if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &interface) <
+                    0 ||
+                sd_bus_message_skip(m, "a{sv}") < 0 ||
+                sd_bus_message_exit_container(m) < 0)
+            {
+                BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                return;
+            }
+            if (!Index::isIgnoredInterface(interface))
+            {
+                interfaces.emplace_back(interface);
+            }
+        }
+        index.addInterfaces(objPath, *service, interfaces);
+    }
+
+    void onInterfacesRemoved(sdbusplus::message::message& msg)
+    {
+        if (!seeding.acceptSignal())
+        {
+            return;
+        }
+        const std::string* service = owners.serviceOf(msg.get_sender());
+        if (service == nullptr)
+        {
+            return;
+        }
+        sdbusplus::message::object_path objPath;
+        std::vector<std::string> interfaces;
+        msg.read(objPath, interfaces);
+        index.removeInterfaces(objPath.str, *service, interfaces);
+    }
+
+    void onNameOwnerChanged(const std::string& name,
+                            const std::string& oldOwner,
+                            const std::string& newOwner)
+    {
+        owners.ownerChanged(name, oldOwner, newOwner);
+        if (crow::signal_cache::isUniqueName(name))
+        {
+            return;
+        }
+        if (!oldOwner.empty())
+        {
+            if (seeding.ready())
+            {
+                index.removeService(name);
+            }
+            else
+            {
+                seeding.changed();
+            }
+        }
+        if (!newOwner.empty())
+        {
+            // The mapper indexes every service, and introspects a new one on
+            // its own schedule; read its view again once it has had the
+            // chance
+            seeding.changed();
+        }
+    }
+
+    Index index;
+    crow::signal_cache::Owners owners;
+    crow::signal_cache::Seeding seeding;
+
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> nameOwnerChangedMatch;
+};
+
+} // namespace mapper_mirror
+} // namespace crow
@@ -0,0 +1,138 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <boost/container/flat_map.hpp>
+#include <nlohmann/json.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace crow
+{
+namespace metrics
+{
+
+/**
+ * @brief Counters for the HTTP side of the server, updated as each response
+ * is completed.
+ */
+struct HttpMetrics
+{
+    uint64_t requests = 0;
+    // Indexed by the first digit of the status code
+    std::array<uint64_t, 6> responsesByClass{};
+    uint64_t responseBytes = 0;
+    // Time from the request being dispatched to its response being complete
+    std::chrono::microseconds handlerTime{0};
+    std::chrono::microseconds maxHandlerTime{0};
+};
+
+inline HttpMetrics& http()
+{
+    static HttpMetrics metrics;
+    return metrics;
+}
+
+inline void recordResponse(unsigned status, size_t bodyBytes,
+                           std::chrono::steady_clock::duration elapsed)
+{
+    HttpMetrics& metrics = http();
+    std::chrono::microseconds us =
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    metrics.requests++;
+    size_t statusClass = status / 100;
+    if (statusClass < metrics.responsesByClass.size())
+    {
+        metrics.responsesByClass[statusClass]++;
+    }
+    metrics.responseBytes += bodyBytes;
+    metrics.handlerTime += us;
+    if (us > metrics.maxHandlerTime)
+    {
+        metrics.maxHandlerTime = us;
+    }
+}
+
+/**
+ * @brief Work saved by abandoning requests whose client went away.
+ */
+struct CancellationMetrics
+{
+    // Requests whose client disconnected before the response was written
+    uint64_t requests = 0;
+    // D-Bus calls that were never issued for a cancelled request
+    uint64_t callsSkipped = 0;
+    // D-Bus replies whose continuation was dropped instead of run
+    uint64_t repliesDropped = 0;
+};
+
+inline CancellationMetrics& cancellation()
+{
+    static CancellationMetrics metrics;
+    return metrics;
+}
+
+/**
+ * @brief A source of metrics other than HTTP, which fills in its own section
+ * of the metrics document when it is read.
+ */
+using Provider = std::function<void(nlohmann::json&)>;
+
+inline boost::container::flat_map<std::string, Provider>& providers()
+{
+    static boost::container::flat_map<std::string, Provider> providerMap;
+    return providerMap;
+}
+
+inline void registerProvider(const std::string& name, Provider provider)
+{
+    providers()[name] = std::move(provider);
+}
+
+inline nlohmann::json getMetrics()
+{
+    const HttpMetrics& metrics = http();
+    nlohmann::json json;
+    nlohmann::json& httpJson = json["http"];
+    httpJson["requests"] = metrics.requests;
+    nlohmann::json& responses = httpJson["responses"];
+    responses = nlohmann::json::object();
+    for (size_t i = 1; i < metrics.responsesByClass.size(); i++)
+    {
+        responses[std::to_string(i) + "xx"] = metrics.responsesByClass[i];
+    }
+    httpJson["response_bytes"] = metrics.responseBytes;
+    httpJson["handler_time_us"] = metrics.handlerTime.count();
+    httpJson["max_handler_time_us"] = metrics.maxHandlerTime.count();
+
+    const CancellationMetrics& cancelled = cancellation();
+    json["cancellation"] = {{"requests", cancelled.requests},
+                            {"calls_skipped", cancelled.callsSkipped},
+                            {"replies_dropped", cancelled.repliesDropped}};
+
+    for (const auto& [name, provider] : providers())
+    {
+        provider(json[name]);
+    }
+    return json;
+}
+
+} // namespace metrics
+} // namespace crow
@@ -0,0 +1,42 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <app.hpp>
+#include <async_resp.hpp>
+#include <http_request.hpp>
+#include <metrics.hpp>
+
+#include <memory>
+
+namespace crow
+{
+namespace metrics
+{
+
+inline void requestRoutes(App& app)
+{
+    BMCWEB_ROUTE(app, "/metrics/")
+        .privileges({{"ConfigureManager"}})
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request&,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                asyncResp->res.jsonValue = getMetrics();
+            });
+}
+
+} // namespace metrics
+} // namespace crow
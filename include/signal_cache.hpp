@@ -0,0 +1,339 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <dbus_singleton.hpp>
+#include <logging.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace crow
+{
+namespace signal_cache
+{
+
+// Time to wait for a service that came or went to settle, and for the mapper
+// to introspect it, before reading a cache again
+constexpr std::chrono::seconds reseedDelay(2);
+
+// Unique names come and go with every client; only the well known names
+// the mapper reports name services
+inline bool isUniqueName(std::string_view name)
+{
+    return name.empty() || name.front() == ':';
+}
+
+/**
+ * @brief The seeding of a cache that is read from D-Bus once, then kept
+ * current from signals, such as the ObjectMapper mirror.
+ *
+ * The cache reads D-Bus in the seed handler, and ends the seed with done()
+ * or failed().  A cache that may have missed a change calls changed() to be
+ * seeded again shortly; restarting the timer coalesces bursts of changes,
+ * as happen while the BMC boots.  A change while seeding may or may not be
+ * in the replies, so the seed is done again once it ends.
+ */
+class Seeding
+{
+  public:
+    Seeding(const char* nameIn, std::function<void()>&& seedHandlerIn) :
+        name(nameIn), seedHandler(std::move(seedHandlerIn))
+    {}
+
+    Seeding(const Seeding&) = delete;
+    Seeding& operator=(const Seeding&) = delete;
+    Seeding(Seeding&&) = delete;
+    Seeding& operator=(Seeding&&) = delete;
+    ~Seeding() = default;
+
+    void start()
+    {
+        reseedTimer.emplace(crow::connections::signalBus->get_io_context());
+        seed();
+    }
+
+    bool started() const
+    {
+        return reseedTimer.has_value();
+    }
+
+    bool ready() const
+    {
+        return seeded;
+    }
+
+    bool isSeeding() const
+    {
+        return seeding;
+    }
+
+    uint64_t seeds() const
+    {
+        return completed;
+    }
+
+    // Ends a seed.  Returns whether the cache is ready, which it isn't if it
+    // changed while seeding.
+    bool done()
+    {
+        seeding = false;
+        if (changedWhileSeeding)
+        {
+            changed();
+            return false;
+        }
+        seeded = true;
+        completed++;
+        return true;
+    }
+
+    void failed(const boost::system::error_code& ec)
+    {
+        BMCWEB_LOG_ERROR << name << " seed failed: " << ec;
+        seeding = false;
+        changed();
+    }
+
+    // The cache may have missed a change, so is seeded again shortly
+    void changed()
+    {
+        seeded = false;
+        if (seeding)
+        {
+            changedWhileSeeding = true;
+            return;
+        }
+        reseedTimer->expires_after(reseedDelay);
+        reseedTimer->async_wait([this](const boost::system::error_code& ec) {
+            if (ec)
+            {
+                return;
+            }
+            seed();
+        });
+    }
+
+    // The cache can't be read until the service it is read from returns,
+    // which calls changed()
+    void suspend()
+    {
+        seeded = false;
+        changedWhileSeeding = seeding;
+        reseedTimer->cancel();
+    }
+
+    // Returns false when there is no point in applying a signal, as the
+    // cache isn't seeded or will be seeded again
+    bool acceptSignal()
+    {
+        if (seeding)
+        {
+            changedWhileSeeding = true;
+            return false;
+        }
+        return seeded;
+    }
+
+  private:
+    void seed()
+    {
+        if (seeding)
+        {
+            changedWhileSeeding = true;
+            return;
+        }
+        seeding = true;
+        changedWhileSeeding = false;
+        BMCWEB_LOG_DEBUG << "Seeding " << name;
+        seedHandler();
+    }
+
+    const char* name;
+    std::function<void()> seedHandler;
+    std::optional<boost::asio::steady_timer> reseedTimer;
+    bool seeded = false;
+    bool seeding = false;
+    bool changedWhileSeeding = false;
+    uint64_t completed = 0;
+};
+
+/**
+ * @brief The services a cache holds objects of, by the unique names that
+ * their signals carry, as the mapper reports well known names.
+ */
+class Owners
+{
+  public:
+    // Tracks services, without learning their owners
+    void track(boost::container::flat_set<std::string>&& services)
+    {
+        tracked = std::move(services);
+        owners.clear();
+    }
+
+    // Tracks services and learns the owner of each, then calls done
+    void resolve(boost::container::flat_set<std::string>&& services,
+                 std::function<void()>&& done)
+    {
+        track(std::move(services));
+        pendingLookups = tracked.size();
+        onResolved = std::move(done);
+        if (pendingLookups == 0)
+        {
+            onResolved();
+            return;
+        }
+        for (const std::string& service : tracked)
+        {
+            if (isUniqueName(service))
+            {
+                owners[service] = service;
+                lookupDone();
+                continue;
+            }
+            // On the connection NameOwnerChanged arrives on, so that every
+            // change before the reply is in it
+            crow::connections::signalBus->async_method_call(
+                [this, service](const boost::system::error_code ec,
+                                const std::string& owner) {
+                    if (!ec)
+                    {
+                        owners[owner] = service;
+                    }
+                    lookupDone();
+                },
+                "org.freedesktop.DBus", "/org/freedesktop/DBus",
+                "org.freedesktop.DBus", "GetNameOwner", service);
+        }
+    }
+
+    bool tracks(const std::string& service) const
+    {
+        return tracked.contains(service);
+    }
+
+    // Returns the well known name of the service sender, or nullptr if it
+    // isn't one of the tracked services
+    const std::string* serviceOf(const char* sender) const
+    {
+        if (sender == nullptr)
+        {
+            return nullptr;
+        }
+        auto it = owners.find(std::string(sender));
+        if (it == owners.end())
+        {
+            return nullptr;
+        }
+        return &it->second;
+    }
+
+    // Follows a NameOwnerChanged.  A tracked service keeps being tracked
+    // while it is away, under its new owner once it returns.
+    void ownerChanged(const std::string& name, const std::string& oldOwner,
+                      const std::string& newOwner)
+    {
+        if (isUniqueName(name))
+        {
+            if (newOwner.empty())
+            {
+                owners.erase(name);
+            }
+            return;
+        }
+        if (!oldOwner.empty())
+        {
+            owners.erase(oldOwner);
+        }
+        if (!newOwner.empty() && tracks(name))
+        {
+            owners[newOwner] = name;
+        }
+    }
+
+    size_t size() const
+    {
+        return tracked.size();
+    }
+
+  private:
+    void lookupDone()
+    {
+        if (--pendingLookups == 0)
+        {
+            onResolved();
+        }
+    }
+
+    boost::container::flat_set<std::string> tracked;
+    // unique name -> well known name
+    boost::container::flat_map<std::string, std::string> owners;
+    size_t pendingLookups = 0;
+    std::function<void()> onResolved;
+};
+
+using NameOwnerHandler =
+    std::function<void(const std::string& name, const std::string& oldOwner,
+                       const std::string& newOwner)>;
+
+/**
+ * @brief Calls handler for every change of owner of a name, or of name only
+ * if it is given.
+ */
+inline std::unique_ptr<sdbusplus::bus::match::match>
+    watchNameOwners(NameOwnerHandler&& handler, const std::string& name = {})
+{
+    std::string rule = "type='signal',sender='org.freedesktop.DBus',"
+                       "interface='org.freedesktop.DBus',"
+                       "member='NameOwnerChanged'";
+    if (!name.empty())
+    {
+        rule += ",arg0='" + name + "'";
+    }
+    return std::make_unique<sdbusplus::bus::match::match>(
+        *crow::connections::signalBus, rule,
+        [handler{std::move(handler)}](sdbusplus::message::message& msg) {
+            std::string changedName;
+            std::string oldOwner;
+            std::string newOwner;
+            try
+            {
+                msg.read(changedName, oldOwner, newOwner);
+            }
+            catch (const sdbusplus::exception::SdBusError& e)
+            {
+                BMCWEB_LOG_ERROR << "Malformed NameOwnerChanged signal: "
+                                 << e.what();
+                return;
+            }
+            handler(changedName, oldOwner, newOwner);
+        });
+}
+
+} // namespace signal_cache
+} // namespace crow
@@ -0,0 +1,59 @@
+#include <coroutine_handler.hpp>
+
+#include <memory>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+// Yields twice without starting any calls
+class Steps : public crow::coroutine::Handler<Steps>
+{
+  public:
+    Steps(const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn,
+          int& stepsIn) :
+        Handler(asyncRespIn),
+        steps(stepsIn)
+    {}
+
+    void operator()()
+    {
+        BOOST_ASIO_CORO_REENTER(this)
+        {
+            steps++;
+            BOOST_ASIO_CORO_YIELD;
+            steps++;
+            BOOST_ASIO_CORO_YIELD;
+            steps++;
+        }
+    }
+
+    int& steps;
+};
+
+TEST(CoroutineHandler, YieldsWithoutCallsResumeAtOnce)
+{
+    crow::Response res;
+    auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
+
+    int steps = 0;
+    auto coroutine = std::make_shared<Steps>(asyncResp, steps);
+    coroutine->resume();
+
+    EXPECT_EQ(steps, 3);
+    EXPECT_TRUE(coroutine->is_complete());
+}
+
+TEST(CoroutineHandler, SpawnRunsToCompletion)
+{
+    crow::Response res;
+    auto asyncResp = std::make_shared<bmcweb::AsyncResp>(res);
+
+    int steps = 0;
+    crow::coroutine::spawn<Steps>(asyncResp, steps);
+
+    EXPECT_EQ(steps, 3);
+}
+
+} // namespace
@@ -0,0 +1,77 @@
+#include <dbus_accounting.hpp>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using crow::dbus_accounting::Accounting;
+using crow::dbus_accounting::RouteScope;
+
+namespace
+{
+
+uint64_t calls(const std::string& route, const std::string& member)
+{
+    nlohmann::json stats = Accounting::getInstance().statistics();
+    const nlohmann::json& byRoute = stats["routes"];
+    if (!byRoute.contains(route) ||
+        !byRoute[route]["test.Service"].contains(member))
+    {
+        return 0;
+    }
+    return byRoute[route]["test.Service"][member]["calls"].get<uint64_t>();
+}
+
+} // namespace
+
+TEST(DbusAccounting, RouteScopesNest)
+{
+    EXPECT_EQ(RouteScope::current(), "");
+    {
+        RouteScope outer("/redfish/v1/Chassis/<str>/");
+        EXPECT_EQ(RouteScope::current(), "/redfish/v1/Chassis/<str>/");
+        {
+            RouteScope inner("/redfish/v1/Systems/<str>/");
+            EXPECT_EQ(RouteScope::current(), "/redfish/v1/Systems/<str>/");
+        }
+        EXPECT_EQ(RouteScope::current(), "/redfish/v1/Chassis/<str>/");
+    }
+    EXPECT_EQ(RouteScope::current(), "");
+}
+
+TEST(DbusAccounting, ReplyRunsAsPartOfItsRoute)
+{
+    const std::string route = "/redfish/v1/Managers/<str>/";
+    std::vector<std::string> replies;
+    std::string_view replyRoute;
+    auto reply = [&replies,
+                  &replyRoute](const boost::system::error_code ec,
+                               const std::vector<std::string>& values) {
+        EXPECT_FALSE(ec);
+        replies = values;
+        replyRoute = RouteScope::current();
+    };
+    auto accounted = [&reply, &route]() {
+        RouteScope scope(route);
+        return crow::dbus_accounting::accounted(reply, "test.Service",
+                                                "test.Interface", "Get");
+    }();
+
+    EXPECT_EQ(calls(route, "test.Interface.Get"), 0U);
+    accounted(boost::system::error_code(),
+              std::vector<std::string>{"a", "b"});
+    EXPECT_THAT(replies, testing::ElementsAre("a", "b"));
+    EXPECT_EQ(calls(route, "test.Interface.Get"), 1U);
+    // Calls sent from the reply are accounted to the route too
+    EXPECT_EQ(replyRoute, route);
+    EXPECT_EQ(RouteScope::current(), "");
+
+    // Outside any request, calls are internal
+    auto internal = crow::dbus_accounting::accounted(
+        reply, "test.Service", "test.Interface", "List");
+    internal(boost::system::error_code(), std::vector<std::string>{});
+    EXPECT_EQ(replyRoute, "");
+    EXPECT_EQ(calls("(internal)", "test.Interface.List"), 1U);
+}
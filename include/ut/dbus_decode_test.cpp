@@ -0,0 +1,254 @@
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <dbus_decode.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace
+{
+
+// Builds messages in memory and reads them back.  sd-bus only creates
+// messages for a started bus, so the bus is started on one end of a socket
+// pair that nothing ever answers.
+class DbusDecode : public testing::Test
+{
+  protected:
+    DbusDecode()
+    {
+        std::array<int, 2> fds{-1, -1};
+        EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()), 0);
+        peer = fds[1];
+        EXPECT_GE(sd_bus_new(&bus), 0);
+        EXPECT_GE(sd_bus_set_fd(bus, fds[0], fds[0]), 0);
+        EXPECT_GE(sd_bus_start(bus), 0);
+        EXPECT_GE(sd_bus_message_new_signal(bus, &m, "/test", "test.Decode",
+                                            "Decode"),
+                  0);
+    }
+
+    ~DbusDecode() override
+    {
+        sd_bus_message_unref(m);
+        sd_bus_unref(bus);
+        close(peer);
+    }
+
+    DbusDecode(const DbusDecode&) = delete;
+    DbusDecode& operator=(const DbusDecode&) = delete;
+    DbusDecode(DbusDecode&&) = delete;
+    DbusDecode& operator=(DbusDecode&&) = delete;
+
+    // Appends {name: value} to an open a{sv}
+    template <typename T>
+    void appendProperty(const char* name, char type, const T& value)
+    {
+        const char contents[2] = {type, '\0'};
+        ASSERT_GE(
+            sd_bus_message_open_container(m, SD_BUS_TYPE_DICT_ENTRY, "sv"), 0);
+        ASSERT_GE(sd_bus_message_append_basic(m, SD_BUS_TYPE_STRING, name), 0);
+        ASSERT_GE(
+            sd_bus_message_open_container(m, SD_BUS_TYPE_VARIANT, contents),
+            0);
+        if constexpr (std::is_same_v<T, const char*>)
+        {
+            ASSERT_GE(sd_bus_message_append_basic(m, type, value), 0);
+        }
+        else
+        {
+            ASSERT_GE(sd_bus_message_append_basic(m, type, &value), 0);
+        }
+        ASSERT_GE(sd_bus_message_close_container(m), 0);
+        ASSERT_GE(sd_bus_message_close_container(m), 0);
+    }
+
+    // A dictionary of properties of every kind the decoder handles
+    void appendProperties()
+    {
+        ASSERT_GE(sd_bus_message_open_container(m, SD_BUS_TYPE_ARRAY, "{sv}"),
+                  0);
+        appendProperty("Name", SD_BUS_TYPE_STRING, "fan0");
+        appendProperty("Value", SD_BUS_TYPE_DOUBLE, 42.5);
+        appendProperty("Count", SD_BUS_TYPE_UINT32, uint32_t{7});
+        appendProperty("Enabled", SD_BUS_TYPE_BOOLEAN, 1);
+        ASSERT_GE(sd_bus_message_append(m, "{sv}", "Inputs", "as", 2, "a",
+                                        "b"),
+                  0);
+        ASSERT_GE(sd_bus_message_append(m, "{sv}", "Map", "a{sv}", 1, "k",
+                                        "i", 3),
+                  0);
+        ASSERT_GE(sd_bus_message_close_container(m), 0);
+    }
+
+    void seal()
+    {
+        ASSERT_GE(sd_bus_message_seal(m, 1, 0), 0);
+        ASSERT_GE(sd_bus_message_rewind(m, 1), 0);
+    }
+
+    sd_bus* bus = nullptr;
+    sd_bus_message* m = nullptr;
+    int peer = -1;
+};
+
+} // namespace
+
+TEST_F(DbusDecode, ReadsSelectedPropertiesAndSkipsTheRest)
+{
+    appendProperties();
+    ASSERT_GE(sd_bus_message_append(m, "s", "trailer"), 0);
+    seal();
+
+    std::string name;
+    std::vector<std::string> inputs;
+    nlohmann::json map;
+    std::vector<std::string> seen;
+    EXPECT_EQ(dbus::decode::readPropertyDict(
+                  m,
+                  [&](dbus::decode::Property& property) {
+                      seen.emplace_back(property.name());
+                      if (property.name() == "Name")
+                      {
+                          EXPECT_EQ(property.read(name), 0);
+                      }
+                      else if (property.name() == "Inputs")
+                      {
+                          EXPECT_EQ(property.read(inputs), 0);
+                      }
+                      else if (property.name() == "Map")
+                      {
+                          EXPECT_EQ(property.readJson(map), 0);
+                      }
+                      return true;
+                  }),
+              0);
+    EXPECT_THAT(seen, testing::ElementsAre("Name", "Value", "Count",
+                                           "Enabled", "Inputs", "Map"));
+    EXPECT_EQ(name, "fan0");
+    EXPECT_THAT(inputs, testing::ElementsAre("a", "b"));
+    EXPECT_EQ(map, nlohmann::json({{"k", 3}}));
+
+    // Skipped values leave the message where the dictionary ends
+    const char* trailer = nullptr;
+    ASSERT_GE(sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &trailer), 0);
+    EXPECT_STREQ(trailer, "trailer");
+}
+
+TEST_F(DbusDecode, TypeMismatchLeavesTheValueReadable)
+{
+    appendProperties();
+    seal();
+
+    EXPECT_EQ(dbus::decode::readPropertyDict(
+                  m,
+                  [](dbus::decode::Property& property) {
+                      if (property.name() == "Count")
+                      {
+                          std::string wrong;
+                          EXPECT_EQ(property.read(wrong), -ENXIO);
+                          double value = 0.0;
+                          EXPECT_EQ(property.readNumber(value), 0);
+                          EXPECT_EQ(value, 7.0);
+                          EXPECT_EQ(property.readNumber(value), -EALREADY);
+                      }
+                      else if (property.name() == "Enabled")
+                      {
+                          dbus::utility::DbusVariantType value;
+                          EXPECT_EQ(property.readVariant(value), 0);
+                          EXPECT_EQ(std::get<bool>(value), true);
+                      }
+                      else if (property.name() == "Value")
+                      {
+                          double value = 0.0;
+                          EXPECT_EQ(property.read(value), 0);
+                          EXPECT_EQ(value, 42.5);
+                      }
+                      return true;
+                  }),
+              0);
+}
+
+TEST_F(DbusDecode, VisitorCanStopEarly)
+{
+    appendProperties();
+    seal();
+
+    size_t visited = 0;
+    EXPECT_EQ(dbus::decode::readPropertyDict(
+                  m,
+                  [&visited](dbus::decode::Property& /*property*/) {
+                      visited++;
+                      return visited < 2;
+                  }),
+              -ECANCELED);
+    EXPECT_EQ(visited, 2U);
+}
+
+TEST_F(DbusDecode, ManagedObjectsVisitsRequestedInterfaces)
+{
+    ASSERT_GE(
+        sd_bus_message_open_container(m, SD_BUS_TYPE_ARRAY, "{oa{sa{sv}}}"),
+        0);
+    for (const char* path : {"/obj/a", "/obj/b"})
+    {
+        ASSERT_GE(sd_bus_message_open_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                                "oa{sa{sv}}"),
+                  0);
+        ASSERT_GE(
+            sd_bus_message_append_basic(m, SD_BUS_TYPE_OBJECT_PATH, path), 0);
+        ASSERT_GE(
+            sd_bus_message_open_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}"),
+            0);
+        for (const char* interface : {"test.Other", "test.Wanted"})
+        {
+            ASSERT_GE(sd_bus_message_open_container(
+                          m, SD_BUS_TYPE_DICT_ENTRY, "sa{sv}"),
+                      0);
+            ASSERT_GE(sd_bus_message_append_basic(m, SD_BUS_TYPE_STRING,
+                                                  interface),
+                      0);
+            appendProperties();
+            ASSERT_GE(sd_bus_message_close_container(m), 0);
+        }
+        ASSERT_GE(sd_bus_message_close_container(m), 0);
+        ASSERT_GE(sd_bus_message_close_container(m), 0);
+    }
+    ASSERT_GE(sd_bus_message_close_container(m), 0);
+    seal();
+
+    sdbusplus::message::message msg(m);
+    std::vector<std::string> names;
+    const std::array<const char*, 1> wanted = {"test.Wanted"};
+    EXPECT_EQ(dbus::decode::readManagedObjects(
+                  msg, wanted,
+                  [&names](std::string_view path, std::string_view interface,
+                           dbus::decode::Properties& properties) {
+                      EXPECT_EQ(interface, "test.Wanted");
+                      names.emplace_back(path);
+                      // Leave some properties to the reader to skip
+                      return properties.forEach(
+                                 [](dbus::decode::Property& property) {
+                                     return property.name() != "Count";
+                                 }) == -ECANCELED;
+                  }),
+              -ECANCELED);
+    // The walk can't go on from inside a dictionary the visitor abandoned
+    EXPECT_THAT(names, testing::ElementsAre("/obj/a"));
+
+    ASSERT_GE(sd_bus_message_rewind(m, 1), 0);
+    names.clear();
+    EXPECT_EQ(dbus::decode::readManagedObjects(
+                  msg, wanted,
+                  [&names](std::string_view path,
+                           std::string_view /*interface*/,
+                           dbus::decode::Properties& /*properties*/) {
+                      names.emplace_back(path);
+                      return true;
+                  }),
+              0);
+    EXPECT_THAT(names, testing::ElementsAre("/obj/a", "/obj/b"));
+}
@@ -0,0 +1,158 @@
+#include <dbus_query_plan.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using dbus::utility::QueryPlan;
+
+namespace
+{
+
+// Counts the copies made of it, to check that replies are moved
+struct Reply
+{
+    Reply() = default;
+    explicit Reply(int valueIn) : value(valueIn)
+    {}
+    Reply(const Reply& other) : value(other.value)
+    {
+        copies++;
+    }
+    Reply& operator=(const Reply& other)
+    {
+        value = other.value;
+        copies++;
+        return *this;
+    }
+    Reply(Reply&&) = default;
+    Reply& operator=(Reply&&) = default;
+    ~Reply() = default;
+
+    int value = 0;
+    static inline size_t copies = 0;
+};
+
+// Reads whose replies the test hands over when it chooses
+class PendingReads
+{
+  public:
+    void add(QueryPlan& plan, const std::string& key,
+             QueryPlan::Callback<Reply>&& callback)
+    {
+        plan.add<Reply>(key, std::move(callback),
+                        [this](QueryPlan::Done<Reply> done) {
+                            issued.emplace_back(std::move(done));
+                        });
+    }
+
+    void answer(size_t index, int value)
+    {
+        issued[index](boost::system::error_code(), Reply(value));
+    }
+
+    std::vector<QueryPlan::Done<Reply>> issued;
+};
+
+} // namespace
+
+TEST(QueryPlan, IdenticalReadsAreMadeOnce)
+{
+    crow::Response res;
+    auto plan =
+        std::make_shared<QueryPlan>(std::make_shared<bmcweb::AsyncResp>(res));
+    PendingReads reads;
+    std::vector<int> replies;
+    auto record = [&replies](const boost::system::error_code&,
+                             const Reply& reply,
+                             QueryPlan&) { replies.push_back(reply.value); };
+    reads.add(*plan, "a", record);
+    reads.add(*plan, "a", record);
+    reads.add(*plan, "b", record);
+    EXPECT_TRUE(reads.issued.empty());
+
+    bool joined = false;
+    plan->execute([&joined]() { joined = true; });
+    ASSERT_EQ(reads.issued.size(), 2U);
+
+    Reply::copies = 0;
+    reads.answer(0, 1);
+    EXPECT_THAT(replies, testing::ElementsAre(1, 1));
+    EXPECT_EQ(Reply::copies, 0U);
+    EXPECT_FALSE(joined);
+
+    // Declared after the reply arrived, so answered straight away
+    reads.add(*plan, "a", record);
+    EXPECT_THAT(replies, testing::ElementsAre(1, 1, 1));
+    EXPECT_EQ(reads.issued.size(), 2U);
+
+    reads.answer(1, 2);
+    EXPECT_TRUE(joined);
+}
+
+TEST(QueryPlan, JoinWaitsForDependentReads)
+{
+    crow::Response res;
+    auto plan =
+        std::make_shared<QueryPlan>(std::make_shared<bmcweb::AsyncResp>(res));
+    PendingReads reads;
+    std::vector<int> replies;
+    reads.add(*plan, "first",
+              [&](const boost::system::error_code&, const Reply& reply,
+                  QueryPlan& self) {
+                  replies.push_back(reply.value);
+                  reads.add(self, "second",
+                            [&replies](const boost::system::error_code&,
+                                       const Reply& second, QueryPlan&) {
+                                replies.push_back(second.value);
+                            });
+              });
+    bool joined = false;
+    plan->execute([&joined]() { joined = true; });
+
+    reads.answer(0, 1);
+    // Issued as soon as it was declared
+    ASSERT_EQ(reads.issued.size(), 2U);
+    EXPECT_FALSE(joined);
+    reads.answer(1, 2);
+    EXPECT_TRUE(joined);
+    EXPECT_THAT(replies, testing::ElementsAre(1, 2));
+}
+
+TEST(QueryPlan, IssuedReadsKeepThePlanAlive)
+{
+    crow::Response res;
+    auto plan =
+        std::make_shared<QueryPlan>(std::make_shared<bmcweb::AsyncResp>(res));
+    std::weak_ptr<QueryPlan> weak = plan;
+    PendingReads reads;
+    bool called = false;
+    reads.add(*plan, "a",
+              [&called](const boost::system::error_code&, const Reply&,
+                        QueryPlan&) { called = true; });
+    plan->execute();
+    plan.reset();
+    EXPECT_FALSE(weak.expired());
+
+    reads.answer(0, 1);
+    EXPECT_TRUE(called);
+    reads.issued.clear();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST(QueryPlan, PlanNeverExecutedIsFreed)
+{
+    crow::Response res;
+    auto plan =
+        std::make_shared<QueryPlan>(std::make_shared<bmcweb::AsyncResp>(res));
+    std::weak_ptr<QueryPlan> weak = plan;
+    PendingReads reads;
+    reads.add(*plan, "a",
+              [](const boost::system::error_code&, const Reply&, QueryPlan&) {
+              });
+    plan.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_TRUE(reads.issued.empty());
+}
@@ -0,0 +1,125 @@
+#include <dbus_scheduler.hpp>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+using crow::dbus_scheduler::Scheduler;
+
+namespace
+{
+
+size_t inFlight(const std::string& service)
+{
+    return Scheduler::getInstance()
+        .statistics()["services"][service]["in_flight"]
+        .get<size_t>();
+}
+
+} // namespace
+
+// The scheduler is a singleton, so every test uses services of its own and
+// leaves nothing in flight
+
+TEST(DbusScheduler, QueuesBeyondTheServiceLimit)
+{
+    Scheduler& scheduler = Scheduler::getInstance();
+    const std::string service = "test.Queue";
+    scheduler.setLimit(service, 1);
+    std::vector<int> started;
+    int owner = 0;
+    scheduler.submit(service, &owner, [&started]() { started.push_back(1); });
+    scheduler.submit(service, &owner, [&started]() { started.push_back(2); });
+    EXPECT_THAT(started, testing::ElementsAre(1));
+    EXPECT_EQ(inFlight(service), 1U);
+
+    scheduler.release(service);
+    EXPECT_THAT(started, testing::ElementsAre(1, 2));
+    scheduler.release(service);
+    EXPECT_EQ(inFlight(service), 0U);
+}
+
+TEST(DbusScheduler, ServesOwnersRoundRobin)
+{
+    Scheduler& scheduler = Scheduler::getInstance();
+    const std::string service = "test.RoundRobin";
+    scheduler.setLimit(service, 1);
+    std::vector<std::string> started;
+    int busy = 0;
+    int quiet = 0;
+    for (const char* name : {"busy1", "busy2", "busy3"})
+    {
+        scheduler.submit(service, &busy,
+                         [&started, name]() { started.emplace_back(name); });
+    }
+    scheduler.submit(service, &quiet,
+                     [&started]() { started.emplace_back("quiet1"); });
+
+    for (size_t i = 0; i < 4; i++)
+    {
+        scheduler.release(service);
+    }
+    EXPECT_THAT(started,
+                testing::ElementsAre("busy1", "busy2", "quiet1", "busy3"));
+    EXPECT_EQ(inFlight(service), 0U);
+}
+
+TEST(DbusScheduler, ThrowingJobGivesBackItsSlot)
+{
+    Scheduler& scheduler = Scheduler::getInstance();
+    const std::string service = "test.Throw";
+    scheduler.setLimit(service, 1);
+    int owner = 0;
+    EXPECT_THROW(scheduler.submit(service, &owner,
+                                  []() { throw std::runtime_error("send"); }),
+                 std::runtime_error);
+    EXPECT_EQ(inFlight(service), 0U);
+
+    bool started = false;
+    scheduler.submit(service, &owner, [&started]() { started = true; });
+    EXPECT_TRUE(started);
+    scheduler.release(service);
+    EXPECT_EQ(inFlight(service), 0U);
+}
+
+TEST(DbusScheduler, ThrowingQueuedJobDoesNotStallTheQueue)
+{
+    Scheduler& scheduler = Scheduler::getInstance();
+    const std::string service = "test.ThrowQueued";
+    scheduler.setLimit(service, 1);
+    int owner = 0;
+    bool started = false;
+    bool failed = false;
+    scheduler.submit(service, &owner, []() {});
+    scheduler.submit(
+        service, &owner, []() { throw std::runtime_error("send"); },
+        [&failed]() { failed = true; });
+    scheduler.submit(service, &owner, [&started]() { started = true; });
+    EXPECT_FALSE(started);
+
+    scheduler.release(service);
+    EXPECT_TRUE(failed);
+    EXPECT_TRUE(started);
+    EXPECT_EQ(inFlight(service), 1U);
+    EXPECT_EQ(scheduler.statistics()["services"][service]["failed"], 1);
+    scheduler.release(service);
+    EXPECT_EQ(inFlight(service), 0U);
+}
+
+TEST(DbusScheduler, QueuedJobThrowingAnythingFails)
+{
+    Scheduler& scheduler = Scheduler::getInstance();
+    const std::string service = "test.ThrowAnything";
+    scheduler.setLimit(service, 1);
+    int owner = 0;
+    bool failed = false;
+    scheduler.submit(service, &owner, []() {});
+    scheduler.submit(
+        service, &owner, []() { throw 42; }, [&failed]() { failed = true; });
+
+    EXPECT_NO_THROW(scheduler.release(service));
+    EXPECT_TRUE(failed);
+    EXPECT_EQ(inFlight(service), 0U);
+}
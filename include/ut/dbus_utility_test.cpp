@@ -34,3 +34,18 @@ TEST(DbusUtility, getNthStringFromPathBadTest)
     EXPECT_EQ(result, "3rd?");
     EXPECT_FALSE(dbus::utility::getNthStringFromPath(path, -1, result));
 }
+
+TEST(DbusUtility, FailedCallAnswersWithAnError)
+{
+    boost::system::error_code replyEc;
+    std::vector<std::string> reply{"stale"};
+    auto handler = [&replyEc, &reply](const boost::system::error_code ec,
+                                      std::vector<std::string>& values) {
+        replyEc = ec;
+        reply = values;
+    };
+    using Args = boost::callable_traits::args_t<decltype(handler)>;
+    dbus::utility::details::Failed<Args>::answer(handler);
+    EXPECT_TRUE(replyEc);
+    EXPECT_TRUE(reply.empty());
+}
@@ -0,0 +1,20 @@
+#include "http_utility.hpp"
+
+#include "gmock/gmock.h"
+
+TEST(HttpUtility, EtagMatches)
+{
+    const std::string etag = "\"0123456789abcdef\"";
+    EXPECT_TRUE(http_helpers::etagMatches(etag, etag, false));
+    EXPECT_TRUE(http_helpers::etagMatches("*", etag, false));
+    EXPECT_TRUE(http_helpers::etagMatches(
+        "\"other\", \"0123456789abcdef\"", etag, false));
+    EXPECT_FALSE(http_helpers::etagMatches("\"other\"", etag, true));
+    EXPECT_FALSE(http_helpers::etagMatches("", etag, true));
+
+    // Weak tags only ever match when comparing weakly, as If-None-Match does
+    EXPECT_TRUE(
+        http_helpers::etagMatches("W/\"0123456789abcdef\"", etag, true));
+    EXPECT_FALSE(
+        http_helpers::etagMatches("W/\"0123456789abcdef\"", etag, false));
+}
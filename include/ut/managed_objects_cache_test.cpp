@@ -0,0 +1,88 @@
+#include <managed_objects_cache.hpp>
+
+#include "gmock/gmock.h"
+
+using crow::managed_objects_cache::ManagedObjectType;
+using dbus::utility::DBusInteracesMap;
+using dbus::utility::DBusPropertiesMap;
+
+namespace
+{
+
+constexpr const char* valueIface = "xyz.openbmc_project.Sensor.Value";
+constexpr const char* assetIface = "xyz.openbmc_project.Inventory.Asset";
+
+sdbusplus::message::object_path objectPath(const std::string& path)
+{
+    sdbusplus::message::object_path objPath;
+    objPath.str = path;
+    return objPath;
+}
+
+ManagedObjectType makeObjects()
+{
+    ManagedObjectType objects;
+    crow::managed_objects_cache::addInterfaces(
+        objects, objectPath("/sensors/b"),
+        DBusInteracesMap{{valueIface, {{"Value", 2.0}}}});
+    crow::managed_objects_cache::addInterfaces(
+        objects, objectPath("/sensors/a"),
+        DBusInteracesMap{{valueIface, {{"Value", 1.0}}}});
+    return objects;
+}
+
+} // namespace
+
+TEST(ManagedObjectsCache, AddInterfacesKeepsPathOrder)
+{
+    ManagedObjectType objects = makeObjects();
+    ASSERT_EQ(objects.size(), 2U);
+    EXPECT_EQ(objects[0].first.str, "/sensors/a");
+    EXPECT_EQ(objects[1].first.str, "/sensors/b");
+
+    // Adding to an existing object merges, replacing whole interfaces
+    crow::managed_objects_cache::addInterfaces(
+        objects, objectPath("/sensors/a"),
+        DBusInteracesMap{{assetIface, {{"Model", std::string("x")}}},
+                         {valueIface, {{"MaxValue", 9.0}}}});
+    ASSERT_EQ(objects.size(), 2U);
+    EXPECT_EQ(objects[0].second.size(), 2U);
+    EXPECT_EQ(objects[0].second[valueIface].size(), 1U);
+    EXPECT_EQ(objects[0].second[valueIface].count("MaxValue"), 1U);
+}
+
+TEST(ManagedObjectsCache, RemoveInterfacesDropsEmptyObjects)
+{
+    ManagedObjectType objects = makeObjects();
+    crow::managed_objects_cache::removeInterfaces(objects, "/sensors/a",
+                                                  {assetIface});
+    EXPECT_EQ(objects.size(), 2U);
+    crow::managed_objects_cache::removeInterfaces(objects, "/sensors/a",
+                                                  {valueIface});
+    ASSERT_EQ(objects.size(), 1U);
+    EXPECT_EQ(objects[0].first.str, "/sensors/b");
+    crow::managed_objects_cache::removeInterfaces(objects, "/sensors/c",
+                                                  {valueIface});
+    EXPECT_EQ(objects.size(), 1U);
+}
+
+TEST(ManagedObjectsCache, ChangePropertiesOnlyTouchesKnownInterfaces)
+{
+    ManagedObjectType objects = makeObjects();
+    EXPECT_TRUE(crow::managed_objects_cache::hasInterface(
+        objects, "/sensors/b", valueIface));
+    EXPECT_FALSE(crow::managed_objects_cache::hasInterface(
+        objects, "/sensors/b", assetIface));
+
+    crow::managed_objects_cache::changeProperties(
+        objects, "/sensors/b", valueIface, DBusPropertiesMap{{"Value", 5.0}});
+    EXPECT_EQ(std::get<double>(objects[1].second[valueIface]["Value"]), 5.0);
+
+    crow::managed_objects_cache::changeProperties(
+        objects, "/sensors/b", assetIface,
+        DBusPropertiesMap{{"Model", std::string("y")}});
+    crow::managed_objects_cache::changeProperties(
+        objects, "/sensors/c", valueIface, DBusPropertiesMap{{"Value", 5.0}});
+    EXPECT_EQ(objects.size(), 2U);
+    EXPECT_EQ(objects[1].second.size(), 1U);
+}
@@ -0,0 +1,108 @@
+#include <mapper_mirror.hpp>
+
+#include "gmock/gmock.h"
+
+using crow::mapper_mirror::GetObjectType;
+using crow::mapper_mirror::GetSubTreePathsType;
+using crow::mapper_mirror::GetSubTreeType;
+using crow::mapper_mirror::Index;
+
+namespace
+{
+
+constexpr const char* chassisIface = "xyz.openbmc_project.Inventory.Chassis";
+constexpr const char* sensorIface = "xyz.openbmc_project.Sensor.Value";
+
+Index makeIndex()
+{
+    Index index;
+    index.addInterfaces("/xyz/openbmc_project/inventory/chassis",
+                        "xyz.openbmc_project.Inventory", {chassisIface});
+    index.addInterfaces("/xyz/openbmc_project/sensors/temperature/cpu",
+                        "xyz.openbmc_project.HwmonTempSensor", {sensorIface});
+    return index;
+}
+
+} // namespace
+
+TEST(MapperMirrorIndex, AddInterfacesAddsParents)
+{
+    Index index = makeIndex();
+    EXPECT_TRUE(index.hasPath("/xyz"));
+    EXPECT_TRUE(index.hasPath("/xyz/openbmc_project/sensors/"));
+    EXPECT_TRUE(index.hasPath("/"));
+    EXPECT_FALSE(index.hasPath("/xyz/openbmc_project/sensors/power"));
+    EXPECT_FALSE(index.hasPath("/xy"));
+
+    std::optional<GetObjectType> parent =
+        index.getObject("/xyz/openbmc_project/sensors", {});
+    ASSERT_TRUE(parent);
+    ASSERT_EQ(parent->size(), 1U);
+    EXPECT_EQ((*parent)[0].first, "xyz.openbmc_project.HwmonTempSensor");
+    EXPECT_TRUE((*parent)[0].second.empty());
+}
+
+TEST(MapperMirrorIndex, GetSubTreeOfUnknownPathFails)
+{
+    Index index = makeIndex();
+    EXPECT_FALSE(index.getSubTree("/xyz/openbmc_project/nothing", 0, {}));
+    EXPECT_FALSE(index.getSubTreePaths("/xyz/openbmc_project/nothing", 0, {}));
+
+    // A known path with no matches is an empty answer, not an error
+    std::optional<GetSubTreePathsType> paths = index.getSubTreePaths(
+        "/xyz/openbmc_project/inventory", 0, {sensorIface});
+    ASSERT_TRUE(paths);
+    EXPECT_TRUE(paths->empty());
+}
+
+TEST(MapperMirrorIndex, GetSubTreeFiltersByInterfaceAndDepth)
+{
+    Index index = makeIndex();
+    std::optional<GetSubTreeType> subtree =
+        index.getSubTree("/xyz/openbmc_project", 0, {sensorIface});
+    ASSERT_TRUE(subtree);
+    ASSERT_EQ(subtree->size(), 1U);
+    EXPECT_EQ((*subtree)[0].first,
+              "/xyz/openbmc_project/sensors/temperature/cpu");
+
+    std::optional<GetSubTreePathsType> paths =
+        index.getSubTreePaths("/xyz/openbmc_project", 1, {});
+    ASSERT_TRUE(paths);
+    EXPECT_THAT(*paths, testing::ElementsAre("/xyz/openbmc_project/inventory",
+                                             "/xyz/openbmc_project/sensors"));
+
+    // The requested path itself is never part of the answer
+    paths = index.getSubTreePaths("/xyz/openbmc_project/inventory/chassis", 0,
+                                  {});
+    ASSERT_TRUE(paths);
+    EXPECT_TRUE(paths->empty());
+}
+
+TEST(MapperMirrorIndex, GetObjectWithoutMatchFails)
+{
+    Index index = makeIndex();
+    EXPECT_FALSE(index.getObject("/xyz/openbmc_project/missing", {}));
+    EXPECT_FALSE(index.getObject("/xyz/openbmc_project/inventory/chassis",
+                                 {sensorIface}));
+    EXPECT_TRUE(index.getObject("/xyz/openbmc_project/inventory/chassis",
+                                {chassisIface}));
+}
+
+TEST(MapperMirrorIndex, RemoveInterfacesDropsUnneededParents)
+{
+    Index index = makeIndex();
+    index.removeInterfaces("/xyz/openbmc_project/sensors/temperature/cpu",
+                           "xyz.openbmc_project.HwmonTempSensor",
+                           {sensorIface});
+    EXPECT_FALSE(index.hasPath("/xyz/openbmc_project/sensors"));
+    // Still needed by the inventory service
+    EXPECT_TRUE(index.hasPath("/xyz/openbmc_project"));
+}
+
+TEST(MapperMirrorIndex, RemoveServiceDropsItsPaths)
+{
+    Index index = makeIndex();
+    index.removeService("xyz.openbmc_project.Inventory");
+    EXPECT_FALSE(index.hasPath("/xyz/openbmc_project/inventory"));
+    EXPECT_TRUE(index.hasPath("/xyz/openbmc_project/sensors/temperature"));
+}
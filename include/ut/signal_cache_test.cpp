@@ -0,0 +1,53 @@
+#include <signal_cache.hpp>
+
+#include "gmock/gmock.h"
+
+using crow::signal_cache::isUniqueName;
+using crow::signal_cache::Owners;
+
+TEST(SignalCache, IsUniqueName)
+{
+    EXPECT_TRUE(isUniqueName(":1.42"));
+    EXPECT_TRUE(isUniqueName(""));
+    EXPECT_FALSE(isUniqueName("xyz.openbmc_project.Hwmon"));
+}
+
+TEST(SignalCacheOwners, FollowsTrackedServices)
+{
+    Owners owners;
+    owners.track({"xyz.openbmc_project.Hwmon"});
+    EXPECT_TRUE(owners.tracks("xyz.openbmc_project.Hwmon"));
+    EXPECT_FALSE(owners.tracks("xyz.openbmc_project.Other"));
+    EXPECT_EQ(owners.serviceOf(":1.10"), nullptr);
+    EXPECT_EQ(owners.serviceOf(nullptr), nullptr);
+
+    owners.ownerChanged("xyz.openbmc_project.Hwmon", "", ":1.10");
+    const std::string* service = owners.serviceOf(":1.10");
+    ASSERT_NE(service, nullptr);
+    EXPECT_EQ(*service, "xyz.openbmc_project.Hwmon");
+
+    // Untracked services aren't learnt
+    owners.ownerChanged("xyz.openbmc_project.Other", "", ":1.11");
+    EXPECT_EQ(owners.serviceOf(":1.11"), nullptr);
+}
+
+TEST(SignalCacheOwners, TracksServicesWhileAway)
+{
+    Owners owners;
+    owners.track({"xyz.openbmc_project.Hwmon"});
+    owners.ownerChanged("xyz.openbmc_project.Hwmon", "", ":1.10");
+
+    owners.ownerChanged("xyz.openbmc_project.Hwmon", ":1.10", "");
+    EXPECT_EQ(owners.serviceOf(":1.10"), nullptr);
+    EXPECT_TRUE(owners.tracks("xyz.openbmc_project.Hwmon"));
+
+    owners.ownerChanged("xyz.openbmc_project.Hwmon", "", ":1.20");
+    const std::string* service = owners.serviceOf(":1.20");
+    ASSERT_NE(service, nullptr);
+    EXPECT_EQ(*service, "xyz.openbmc_project.Hwmon");
+
+    // Tracking again starts over
+    owners.track({"xyz.openbmc_project.Other"});
+    EXPECT_EQ(owners.serviceOf(":1.20"), nullptr);
+    EXPECT_FALSE(owners.tracks("xyz.openbmc_project.Hwmon"));
+}
@@ -0,0 +1,266 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <dbus_singleton.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace crow
+{
+namespace worker_thread
+{
+
+/**
+ * @brief A single thread for work that would block the io thread for long,
+ * such as reading through the systemd journal.
+ *
+ * Each job is split in two: work, run on the worker thread, and done, run on
+ * the io thread once work has returned.  work must only touch data of its
+ * own; whatever it produces is picked up by done, which is where responses
+ * are filled and sent.  Asio is built without thread support, so the worker
+ * never touches the io_context: it queues the IDs of the finished jobs and
+ * wakes the io thread through an eventfd.  main() calls stop() before it
+ * tears down the io_context the eventfd is read on.
+ */
+class Worker
+{
+  public:
+    static Worker& getInstance()
+    {
+        static Worker worker;
+        return worker;
+    }
+
+    Worker(const Worker&) = delete;
+    Worker& operator=(const Worker&) = delete;
+    Worker(Worker&&) = delete;
+    Worker& operator=(Worker&&) = delete;
+
+    ~Worker()
+    {
+        stop();
+    }
+
+    // Runs work on the worker thread, then done on the io thread.  Jobs run
+    // one at a time, in the order they were posted.
+    void post(std::function<void()>&& work, std::function<void()>&& done)
+    {
+        if (!thread.joinable() && !start())
+        {
+            // Without a worker, block the io thread rather than fail
+            BMCWEB_LOG_WARNING
+                << "No worker thread, running the job on the io thread";
+            work();
+            done();
+            return;
+        }
+        uint64_t id = nextId++;
+        pending.emplace(id, std::move(done));
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.emplace_back(id, std::move(work));
+        }
+        wake.notify_one();
+    }
+
+    /**
+     * @brief Joins the worker thread, once the job it is running returns,
+     * and releases the eventfd and its descriptor.  The done handlers of the
+     * jobs left are dropped.  Jobs posted afterwards run on the io thread.
+     */
+    void stop()
+    {
+        if (thread.joinable())
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            thread.join();
+        }
+        pending.clear();
+        if (notifier)
+        {
+            // The eventfd is closed below
+            notifier->release();
+            notifier.reset();
+        }
+        if (eventFd >= 0)
+        {
+            close(eventFd);
+            eventFd = -1;
+        }
+    }
+
+  private:
+    Worker()
+    {
+        crow::metrics::registerProvider(
+            "worker_thread",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+
+    bool start()
+    {
+        if (stopping)
+        {
+            return false;
+        }
+        int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < 0)
+        {
+            BMCWEB_LOG_ERROR << "Failed to create worker eventfd: "
+                             << strerror(errno);
+            return false;
+        }
+        notifier.emplace(crow::connections::systemBus->get_io_context(), fd);
+        eventFd = fd;
+        BMCWEB_LOG_INFO << "Starting worker thread";
+        thread = std::thread([this]() { run(); });
+        readNotifier();
+        return true;
+    }
+
+    // Worker thread
+    void run()
+    {
+        while (true)
+        {
+            std::pair<uint64_t, std::function<void()>> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock,
+                          [this]() { return stopping || !jobs.empty(); });
+                if (stopping)
+                {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            try
+            {
+                job.second();
+            }
+            catch (const std::exception& e)
+            {
+                BMCWEB_LOG_ERROR << "Worker job failed: " << e.what();
+            }
+            job.second = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                finished.push_back(job.first);
+                completed++;
+            }
+            uint64_t one = 1;
+            if (write(eventFd, &one, sizeof(one)) != sizeof(one))
+            {
+                BMCWEB_LOG_ERROR << "Failed to wake the io thread: "
+                                 << strerror(errno);
+            }
+        }
+    }
+
+    // io thread
+    void readNotifier()
+    {
+        notifier->async_read_some(
+            boost::asio::buffer(&counter, sizeof(counter)),
+            [this](const boost::system::error_code& ec, size_t) {
+                if (ec)
+                {
+                    if (ec != boost::asio::error::operation_aborted)
+                    {
+                        BMCWEB_LOG_ERROR << "Worker eventfd read failed: "
+                                         << ec;
+                    }
+                    return;
+                }
+                runFinished();
+                readNotifier();
+            });
+    }
+
+    void runFinished()
+    {
+        std::vector<uint64_t> ids;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ids.swap(finished);
+        }
+        for (uint64_t id : ids)
+        {
+            auto it = pending.find(id);
+            if (it == pending.end())
+            {
+                continue;
+            }
+            std::function<void()> done = std::move(it->second);
+            pending.erase(it);
+            done();
+        }
+    }
+
+    void fillMetrics(nlohmann::json& json)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        json["started"] = thread.joinable();
+        json["queued"] = jobs.size();
+        json["in_flight"] = pending.size();
+        json["completed"] = completed;
+    }
+
+    std::thread thread;
+    int eventFd = -1;
+    std::optional<boost::asio::posix::stream_descriptor> notifier;
+    uint64_t counter = 0;
+
+    // io thread only
+    uint64_t nextId = 0;
+    std::unordered_map<uint64_t, std::function<void()>> pending;
+
+    // Shared with the worker thread, under mutex
+    std::mutex mutex;
+    std::condition_variable wake;
+    // Only set on the io thread
+    bool stopping = false;
+    std::deque<std::pair<uint64_t, std::function<void()>>> jobs;
+    std::vector<uint64_t> finished;
+    uint64_t completed = 0;
+};
+
+} // namespace worker_thread
+} // namespace crow
@@ -0,0 +1,492 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <signal_cache.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace association_graph
+{
+
+constexpr const char* mapperService = "xyz.openbmc_project.ObjectMapper";
+constexpr const char* associationInterface = "xyz.openbmc_project.Association";
+
+using SetHandler = std::function<void(
+    const std::string& associationPath, const std::vector<std::string>&)>;
+using ClearHandler = std::function<void()>;
+
+// The association called name of the object at path, one of whose endpoints
+// is the object it is found by in Graph::referrers()
+struct Edge
+{
+    std::string path;
+    std::string name;
+
+    bool operator==(const Edge& other) const
+    {
+        return path == other.path && name == other.name;
+    }
+};
+
+/**
+ * @brief The associations between D-Bus objects that the mapper keeps, with
+ * forward and reverse indexes, for looking relations up in O(degree) rather
+ * than reading all associations per request.
+ *
+ * The mapper makes the association called name of the object at path an
+ * object of its own, at path/name, with the Association interface and the
+ * associated objects as its endpoints property.  The graph is seeded from
+ * one GetManagedObjects of the mapper and then kept current from the
+ * InterfacesAdded, InterfacesRemoved and PropertiesChanged signals of
+ * those objects.  The seed is read on the connection the signals arrive
+ * on, and the mapper sends the signals and the reply in order, so every
+ * change it sends before the reply is in the reply and the signals that
+ * arrive while seeding can be dropped.  When the
+ * mapper restarts the graph stops answering until it has been seeded
+ * again; callers fall back to reading the associations from the mapper
+ * whenever ready() is false.
+ */
+class Graph
+{
+  public:
+    static Graph& getInstance()
+    {
+        static Graph graph;
+        return graph;
+    }
+
+    Graph(const Graph&) = delete;
+    Graph& operator=(const Graph&) = delete;
+    Graph(Graph&&) = delete;
+    Graph& operator=(Graph&&) = delete;
+
+    // Starts the graph on first use
+    bool ready()
+    {
+        if (!seeding.started())
+        {
+            start();
+        }
+        if (!seeding.ready())
+        {
+            fallbacks++;
+        }
+        return seeding.ready();
+    }
+
+    // Returns the endpoints of the association called name of path, as
+    // reading path/name from the mapper would
+    const std::vector<std::string>& endpoints(const std::string& path,
+                                              std::string_view name)
+    {
+        lookups++;
+        std::string associationPath = path;
+        associationPath += '/';
+        associationPath += name;
+        auto it = forward.find(associationPath);
+        if (it == forward.end())
+        {
+            return none;
+        }
+        return it->second;
+    }
+
+    // Returns the associations that have path as an endpoint
+    const std::vector<Edge>& referrers(const std::string& path)
+    {
+        lookups++;
+        auto it = reverse.find(path);
+        if (it == reverse.end())
+        {
+            return noEdges;
+        }
+        return it->second;
+    }
+
+    /**
+     * @brief Keeps an index of the caller in step with the graph.  onSet is
+     * called with the endpoints of each association as it is seeded, added or
+     * changed, and with none once it is removed; onClear when the graph is
+     * dropped to be seeded again.
+     */
+    void subscribe(SetHandler&& onSet, ClearHandler&& onClear)
+    {
+        setHandlers.emplace_back(std::move(onSet));
+        clearHandlers.emplace_back(std::move(onClear));
+    }
+
+  private:
+    Graph() : seeding("Association graph", [this]() { seed(); })
+    {
+        crow::metrics::registerProvider(
+            "association_graph",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Graph() = default;
+
+    void start()
+    {
+        std::string objectManagerRule =
+            std::string("type='signal',sender='") + mapperService +
+            "',interface='org.freedesktop.DBus.ObjectManager',member=";
+        interfacesAddedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::signalBus,
+            objectManagerRule + "'InterfacesAdded'",
+            [this](sdbusplus::message::message& msg) {
+                onInterfacesAdded(msg);
+            });
+        interfacesRemovedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                objectManagerRule + "'InterfacesRemoved'",
+                [this](sdbusplus::message::message& msg) {
+                    onInterfacesRemoved(msg);
+                });
+        propertiesChangedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                std::string("type='signal',sender='") + mapperService +
+                    "',interface='org.freedesktop.DBus.Properties',"
+                    "member='PropertiesChanged',arg0='" +
+                    associationInterface + "'",
+                [this](sdbusplus::message::message& msg) {
+                    onPropertiesChanged(msg);
+                });
+        nameOwnerChangedMatch = crow::signal_cache::watchNameOwners(
+            [this](const std::string&, const std::string& oldOwner,
+                   const std::string& newOwner) {
+                onNameOwnerChanged(oldOwner, newOwner);
+            },
+            mapperService);
+        seeding.start();
+    }
+
+    static std::pair<std::string_view, std::string_view>
+        split(std::string_view associationPath)
+    {
+        size_t slash = associationPath.rfind('/');
+        if (slash == std::string_view::npos || slash == 0)
+        {
+            return {};
+        }
+        return {associationPath.substr(0, slash),
+                associationPath.substr(slash + 1)};
+    }
+
+    // Sets the endpoints of the association at associationPath, updating
+    // the reverse index for the endpoints that came and went
+    void set(const std::string& associationPath,
+             std::vector<std::string> newEndpoints)
+    {
+        auto [path, name] = split(associationPath);
+        if (name.empty())
+        {
+            BMCWEB_LOG_ERROR << "Invalid association path: "
+                             << associationPath;
+            return;
+        }
+        Edge edge{std::string(path), std::string(name)};
+        auto it = forward.find(associationPath);
+        if (it != forward.end())
+        {
+            for (const std::string& endpoint : it->second)
+            {
+                unlink(endpoint, edge);
+            }
+            edges -= it->second.size();
+        }
+        if (newEndpoints.empty())
+        {
+            if (it != forward.end())
+            {
+                forward.erase(it);
+            }
+            notify(associationPath, none);
+            return;
+        }
+        for (const std::string& endpoint : newEndpoints)
+        {
+            reverse[endpoint].push_back(edge);
+        }
+        edges += newEndpoints.size();
+        auto [entry, inserted] =
+            forward.insert_or_assign(associationPath, std::move(newEndpoints));
+        notify(associationPath, entry->second);
+    }
+
+    void notify(const std::string& associationPath,
+                const std::vector<std::string>& endpoints)
+    {
+        for (const SetHandler& handler : setHandlers)
+        {
+            handler(associationPath, endpoints);
+        }
+    }
+
+    void unlink(const std::string& endpoint, const Edge& edge)
+    {
+        auto it = reverse.find(endpoint);
+        if (it == reverse.end())
+        {
+            return;
+        }
+        std::vector<Edge>& referring = it->second;
+        auto found = std::find(referring.begin(), referring.end(), edge);
+        if (found != referring.end())
+        {
+            referring.erase(found);
+        }
+        if (referring.empty())
+        {
+            reverse.erase(it);
+        }
+    }
+
+    void clear()
+    {
+        forward.clear();
+        reverse.clear();
+        edges = 0;
+        for (const ClearHandler& handler : clearHandlers)
+        {
+            handler();
+        }
+    }
+
+    static std::optional<std::vector<std::string>>
+        endpointsOf(const dbus::utility::DBusPropertiesMap& properties)
+    {
+        auto it = properties.find("endpoints");
+        if (it == properties.end())
+        {
+            return std::nullopt;
+        }
+        const std::vector<std::string>* endpoints =
+            std::get_if<std::vector<std::string>>(&it->second);
+        if (endpoints == nullptr)
+        {
+            return std::nullopt;
+        }
+        return *endpoints;
+    }
+
+    void seed()
+    {
+        // On the connection the signals arrive on, so that the reply is in
+        // order with them
+        crow::connections::signalBus->async_method_call(
+            [this](const boost::system::error_code ec,
+                   const dbus::utility::ManagedObjectType& objects) {
+                if (ec)
+                {
+                    seeding.failed(ec);
+                    return;
+                }
+                if (!seeding.done())
+                {
+                    // The mapper restarted while answering
+                    return;
+                }
+                clear();
+                for (const auto& [path, interfaces] : objects)
+                {
+                    auto assoc = interfaces.find(associationInterface);
+                    if (assoc == interfaces.end())
+                    {
+                        continue;
+                    }
+                    std::optional<std::vector<std::string>> endpoints =
+                        endpointsOf(assoc->second);
+                    if (endpoints)
+                    {
+                        set(path.str, std::move(*endpoints));
+                    }
+                }
+                BMCWEB_LOG_INFO << "Association graph seeded with "
+                                << forward.size() << " associations";
+            },
+            mapperService, "/", "org.freedesktop.DBus.ObjectManager",
+            "GetManagedObjects");
+    }
+
+    // The graph may have missed a change, so is dropped and seeded again
+    void reseed()
+    {
+        clear();
+        seeding.changed();
+    }
+
+    void onInterfacesAdded(sdbusplus::message::message& msg)
+    {
+        if (!seeding.ready())
+        {
+            return;
+        }
+        sdbusplus::message::object_path objPath;
+        dbus::utility::DBusInteracesMap interfaces;
+        try
+        {
+            msg.read(objPath, interfaces);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal: "
+                             << e.what();
+            reseed();
+            return;
+        }
+        auto assoc = interfaces.find(associationInterface);
+        if (assoc == interfaces.end())
+        {
+            return;
+        }
+        std::optional<std::vector<std::string>> endpoints =
+            endpointsOf(assoc->second);
+        if (endpoints)
+        {
+            set(objPath.str, std::move(*endpoints));
+            updates++;
+        }
+    }
+
+    void onInterfacesRemoved(sdbusplus::message::message& msg)
+    {
+        if (!seeding.ready())
+        {
+            return;
+        }
+        sdbusplus::message::object_path objPath;
+        std::vector<std::string> interfaces;
+        try
+        {
+            msg.read(objPath, interfaces);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesRemoved signal: "
+                             << e.what();
+            reseed();
+            return;
+        }
+        if (std::find(interfaces.begin(), interfaces.end(),
+                      associationInterface) != interfaces.end())
+        {
+            set(objPath.str, {});
+            updates++;
+        }
+    }
+
+    void onPropertiesChanged(sdbusplus::message::message& msg)
+    {
+        if (!seeding.ready())
+        {
+            return;
+        }
+        std::string interface;
+        dbus::utility::DBusPropertiesMap changed;
+        std::vector<std::string> invalidated;
+        try
+        {
+            msg.read(interface, changed, invalidated);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed PropertiesChanged signal: "
+                             << e.what();
+            reseed();
+            return;
+        }
+        std::optional<std::vector<std::string>> endpoints =
+            endpointsOf(changed);
+        if (endpoints)
+        {
+            set(msg.get_path(), std::move(*endpoints));
+            updates++;
+        }
+        else if (!invalidated.empty())
+        {
+            reseed();
+        }
+    }
+
+    void onNameOwnerChanged(const std::string& oldOwner,
+                            const std::string& newOwner)
+    {
+        BMCWEB_LOG_INFO << "Mapper owner changed from '" << oldOwner
+                        << "' to '" << newOwner << "'";
+        clear();
+        if (newOwner.empty())
+        {
+            // Seeded again once the mapper returns
+            seeding.suspend();
+            return;
+        }
+        seeding.changed();
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        json["ready"] = seeding.ready();
+        json["associations"] = forward.size();
+        json["endpoints"] = reverse.size();
+        json["edges"] = edges;
+        json["lookups"] = lookups;
+        json["fallbacks"] = fallbacks;
+        json["updates"] = updates;
+        json["seeds"] = seeding.seeds();
+    }
+
+    // path/name of an association -> its endpoints
+    std::unordered_map<std::string, std::vector<std::string>> forward;
+    // Endpoint -> the associations that point to it
+    std::unordered_map<std::string, std::vector<Edge>> reverse;
+    const std::vector<std::string> none;
+    const std::vector<Edge> noEdges;
+    std::vector<SetHandler> setHandlers;
+    std::vector<ClearHandler> clearHandlers;
+
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> propertiesChangedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> nameOwnerChangedMatch;
+    crow::signal_cache::Seeding seeding;
+
+    size_t edges = 0;
+
+    uint64_t lookups = 0;
+    uint64_t fallbacks = 0;
+    uint64_t updates = 0;
+};
+
+} // namespace association_graph
+} // namespace redfish
@@ -0,0 +1,436 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <sys/stat.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+
+// Numbers the log entries that share a timestamp, for each to get a unique ID.
+// A fresh state numbers the entries from the start of a log; a page of a log
+// collection that resumes mid-log carries on with that of the page before.
+struct EntryIDState
+{
+    // Timestamp of the entry last given an ID
+    uint64_t prevTs = 0;
+    // How many entries before that one had the same timestamp
+    uint64_t index = 0;
+};
+
+inline bool getUniqueEntryID(const std::string& logEntry, std::string& entryID,
+                             EntryIDState& state)
+{
+    // Get the entry timestamp
+    std::time_t curTs = 0;
+    std::tm timeStruct = {};
+    std::istringstream entryStream(logEntry);
+    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
+    {
+        curTs = std::mktime(&timeStruct);
+    }
+    // If the timestamp isn't unique, increment the index
+    if (static_cast<uint64_t>(curTs) == state.prevTs)
+    {
+        state.index++;
+    }
+    else
+    {
+        // Otherwise, reset it
+        state.index = 0;
+    }
+    // Save the timestamp
+    state.prevTs = static_cast<uint64_t>(curTs);
+
+    entryID = std::to_string(curTs);
+    if (state.index > 0)
+    {
+        entryID += "_" + std::to_string(state.index);
+    }
+    return true;
+}
+
+inline bool
+    getRedfishLogFiles(std::vector<std::filesystem::path>& redfishLogFiles)
+{
+    static const std::filesystem::path redfishLogDir = "/var/log";
+    static const std::string redfishLogFilename = "redfish";
+
+    // Loop through the directory looking for redfish log files
+    for (const std::filesystem::directory_entry& dirEnt :
+         std::filesystem::directory_iterator(redfishLogDir))
+    {
+        // If we find a redfish log file, save the path
+        std::string filename = dirEnt.path().filename();
+        if (boost::starts_with(filename, redfishLogFilename))
+        {
+            redfishLogFiles.emplace_back(redfishLogDir / filename);
+        }
+    }
+    // As the log files rotate, they are appended with a ".#" that is higher for
+    // the older logs. Since we don't expect more than 10 log files, we
+    // can just sort the list to get them in order from newest to oldest
+    std::sort(redfishLogFiles.begin(), redfishLogFiles.end());
+
+    return !redfishLogFiles.empty();
+}
+
+/**
+ * @brief Index of the entries of the file-backed event log, by position and
+ * by ID, so that a page or an entry is found without reading the log up to
+ * it.
+ *
+ * Each log file is known by its inode, which it keeps as it is rotated, and
+ * is read only past the point the index last reached.  refresh() brings the
+ * index up to date with the files on disk, at the cost of a stat of each
+ * file when nothing was logged.  A file that shrank, as after a copytruncate,
+ * is read again from the start.  Only complete lines are indexed, so a line
+ * being written is left for the next refresh.
+ */
+class EventLogIndex
+{
+  public:
+    struct Entry
+    {
+        // Offset of the line in its file
+        uint64_t offset = 0;
+        // The numbering state getUniqueEntryID() left for the entry, from
+        // which its ID is made
+        EntryIDState id;
+    };
+
+    struct File
+    {
+        std::filesystem::path path;
+        uint64_t inode = 0;
+        // How far the file has been read, always to the end of a line
+        uint64_t indexed = 0;
+        // Numbering state after the last entry read
+        EntryIDState ids;
+        std::vector<Entry> entries;
+    };
+
+    static EventLogIndex& getInstance()
+    {
+        static EventLogIndex index;
+        return index;
+    }
+
+    // Tests index files of their own
+    EventLogIndex() = default;
+    ~EventLogIndex() = default;
+
+    EventLogIndex(const EventLogIndex&) = delete;
+    EventLogIndex& operator=(const EventLogIndex&) = delete;
+    EventLogIndex(EventLogIndex&&) = delete;
+    EventLogIndex& operator=(EventLogIndex&&) = delete;
+
+    static std::string idString(const EntryIDState& id)
+    {
+        std::string entryID =
+            std::to_string(static_cast<std::time_t>(id.prevTs));
+        if (id.index > 0)
+        {
+            entryID += "_" + std::to_string(id.index);
+        }
+        return entryID;
+    }
+
+    void refresh()
+    {
+        std::vector<std::filesystem::path> paths;
+        getRedfishLogFiles(paths);
+        refresh(paths);
+    }
+
+    // Brings the index up to date with the log files at paths, newest
+    // first, as getRedfishLogFiles() lists them
+    void refresh(const std::vector<std::filesystem::path>& paths)
+    {
+
+        // Oldest first, as the entries are numbered
+        std::vector<File> updated;
+        updated.reserve(paths.size());
+        size_t kept = 0;
+        bool rebuildIds = false;
+        for (auto path = paths.rbegin(); path < paths.rend(); path++)
+        {
+            struct stat st = {};
+            if (stat(path->c_str(), &st) != 0)
+            {
+                continue;
+            }
+            File& file = updated.emplace_back();
+            auto old = std::find_if(files.begin(), files.end(),
+                                    [&st](const File& f) {
+                                        return f.inode == st.st_ino;
+                                    });
+            if (old != files.end() &&
+                static_cast<uint64_t>(st.st_size) >= old->indexed)
+            {
+                file = std::move(*old);
+                kept++;
+            }
+            file.path = *path;
+            file.inode = st.st_ino;
+            if (static_cast<uint64_t>(st.st_size) > file.indexed)
+            {
+                size_t before = file.entries.size();
+                readFrom(file);
+                // An entry in an older file would come before the newer
+                // entries of the same ID
+                if (file.entries.size() > before &&
+                    std::next(path) != paths.rend())
+                {
+                    rebuildIds = true;
+                }
+            }
+        }
+        // Files removed or truncated take their entries with them
+        if (kept != files.size())
+        {
+            rebuildIds = true;
+        }
+        if (rebuildIds)
+        {
+            byId.clear();
+            for (const File& file : updated)
+            {
+                addIds(file, 0);
+            }
+        }
+        else if (!updated.empty())
+        {
+            const File& newest = updated.back();
+            auto old = std::find_if(files.begin(), files.end(),
+                                    [&newest](const File& f) {
+                                        return f.inode == newest.inode;
+                                    });
+            addIds(newest, old == files.end() ? 0 : newestIndexed);
+        }
+        files = std::move(updated);
+        newestIndexed = files.empty() ? 0 : files.back().entries.size();
+    }
+
+    uint64_t size() const
+    {
+        uint64_t count = 0;
+        for (const File& file : files)
+        {
+            count += file.entries.size();
+        }
+        return count;
+    }
+
+    // Returns the number of the entry with the given ID
+    std::optional<uint64_t> find(std::string_view entryID) const
+    {
+        std::string_view tsStr = entryID.substr(0, entryID.find('_'));
+        std::time_t ts = 0;
+        auto [tsEnd, tsEc] =
+            std::from_chars(tsStr.data(), tsStr.data() + tsStr.size(), ts);
+        if (tsStr.empty() || tsEc != std::errc() ||
+            tsEnd != tsStr.data() + tsStr.size())
+        {
+            return std::nullopt;
+        }
+        EntryIDState id{static_cast<uint64_t>(ts), 0};
+        if (tsStr.size() < entryID.size())
+        {
+            std::string_view indexStr = entryID.substr(tsStr.size() + 1);
+            auto [indexEnd, indexEc] = std::from_chars(
+                indexStr.data(), indexStr.data() + indexStr.size(), id.index);
+            // getUniqueEntryID() never writes an index of 0
+            if (indexStr.empty() || indexEc != std::errc() ||
+                indexEnd != indexStr.data() + indexStr.size() || id.index == 0)
+            {
+                return std::nullopt;
+            }
+        }
+        auto it = byId.find(id);
+        if (it == byId.end())
+        {
+            return std::nullopt;
+        }
+        return ordinalOf(it->second.first, it->second.second);
+    }
+
+    // Returns the number of the entry that starts at offset in the file with
+    // the given inode, or of the entry after it if offset is its end
+    std::optional<uint64_t> find(uint64_t inode, uint64_t offset) const
+    {
+        uint64_t first = 0;
+        for (const File& file : files)
+        {
+            if (file.inode == inode)
+            {
+                if (offset == file.indexed)
+                {
+                    return first + file.entries.size();
+                }
+                auto entry = std::lower_bound(
+                    file.entries.begin(), file.entries.end(), offset,
+                    [](const Entry& e, uint64_t o) { return e.offset < o; });
+                if (entry == file.entries.end() || entry->offset != offset)
+                {
+                    return std::nullopt;
+                }
+                return first +
+                       static_cast<uint64_t>(entry - file.entries.begin());
+            }
+            first += file.entries.size();
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Reads count entries from the one numbered first, calling
+     * callback(file, entry, line, next) for each, where next is the offset
+     * in file just past the line.  Returns false if a file can't be read.
+     */
+    template <typename Callback>
+    bool forEach(uint64_t first, uint64_t count, Callback&& callback) const
+    {
+        std::string line;
+        for (const File& file : files)
+        {
+            if (count == 0)
+            {
+                break;
+            }
+            if (first >= file.entries.size())
+            {
+                first -= file.entries.size();
+                continue;
+            }
+            std::ifstream logStream(file.path);
+            if (!logStream.is_open())
+            {
+                return false;
+            }
+            logStream.seekg(
+                static_cast<std::streamoff>(file.entries[first].offset));
+            for (size_t i = static_cast<size_t>(first);
+                 count > 0 && i < file.entries.size(); i++, count--)
+            {
+                if (!std::getline(logStream, line))
+                {
+                    return false;
+                }
+                uint64_t next = i + 1 < file.entries.size()
+                                    ? file.entries[i + 1].offset
+                                    : file.indexed;
+                callback(file, file.entries[i], line, next);
+            }
+            first = 0;
+        }
+        return true;
+    }
+
+  private:
+    struct IdHash
+    {
+        size_t operator()(const EntryIDState& id) const
+        {
+            return std::hash<uint64_t>()(id.prevTs) ^
+                   (std::hash<uint64_t>()(id.index) << 1);
+        }
+    };
+
+    struct IdEqual
+    {
+        bool operator()(const EntryIDState& a, const EntryIDState& b) const
+        {
+            return a.prevTs == b.prevTs && a.index == b.index;
+        }
+    };
+
+    static void readFrom(File& file)
+    {
+        std::ifstream logStream(file.path);
+        if (!logStream.is_open())
+        {
+            return;
+        }
+        logStream.seekg(static_cast<std::streamoff>(file.indexed));
+        std::string line;
+        std::string entryID;
+        while (std::getline(logStream, line))
+        {
+            if (logStream.eof())
+            {
+                // No newline yet
+                break;
+            }
+            getUniqueEntryID(line, entryID, file.ids);
+            file.entries.emplace_back(Entry{file.indexed, file.ids});
+            file.indexed += line.size() + 1;
+        }
+    }
+
+    // As the routes that read the files, the oldest entry of an ID wins
+    void addIds(const File& file, size_t from)
+    {
+        for (size_t i = from; i < file.entries.size(); i++)
+        {
+            byId.emplace(file.entries[i].id, std::make_pair(file.inode, i));
+        }
+    }
+
+    std::optional<uint64_t> ordinalOf(uint64_t inode, size_t entry) const
+    {
+        uint64_t first = 0;
+        for (const File& file : files)
+        {
+            if (file.inode == inode)
+            {
+                return first + entry;
+            }
+            first += file.entries.size();
+        }
+        return std::nullopt;
+    }
+
+    // Oldest first
+    std::vector<File> files;
+    // Entries of the newest file that are in byId
+    size_t newestIndexed = 0;
+    // Entry ID -> inode of its file and its number in that file
+    std::unordered_map<EntryIDState, std::pair<uint64_t, size_t>, IdHash,
+                       IdEqual>
+        byId;
+};
+
+} // namespace redfish
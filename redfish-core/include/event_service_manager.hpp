@@ -1410,7 +1410,7 @@ class EventServiceManager
             "interface='xyz.openbmc_project.MonitoringService.Report'");
 
         matchTelemetryMonitor = std::make_shared<sdbusplus::bus::match::match>(
-            *crow::connections::systemBus, matchStr,
+            *crow::connections::signalBus, matchStr,
             [this](sdbusplus::message::message& msg) {
                 if (msg.is_method_error())
                 {
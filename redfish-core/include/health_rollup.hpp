@@ -0,0 +1,776 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <association_graph.hpp>
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace health_rollup
+{
+
+constexpr const char* inventoryPath = "/xyz/openbmc_project/inventory";
+constexpr const char* operationalStatusInterface =
+    "xyz.openbmc_project.State.Decorator.OperationalStatus";
+constexpr const char* globalInterface =
+    "xyz.openbmc_project.Inventory.Item.Global";
+
+// Time to wait for a service that came or went to settle before reading the
+// operational status of the inventory again
+constexpr std::chrono::seconds reseedDelay(2);
+
+enum class Level
+{
+    ok,
+    warning,
+    critical,
+};
+
+inline const char* toString(Level level)
+{
+    switch (level)
+    {
+        case Level::critical:
+            return "Critical";
+        case Level::warning:
+            return "Warning";
+        case Level::ok:
+            break;
+    }
+    return "OK";
+}
+
+/**
+ * @brief The sources of bad health of the inventory, counted so that the
+ * health of a resource is a lookup.
+ *
+ * The sources are the critical and warning associations the mapper keeps,
+ * and the inventory items whose OperationalStatus is not Functional, which
+ * count as critical.  Each source is counted at the path it belongs to and
+ * at every ancestor of it, and at every endpoint of its association, so
+ * whether an item has a source at or below it, or pointing at it, is a
+ * lookup.  evaluate() answers as HealthPopulate would from the full
+ * association dump and the OperationalStatus of the inventory, with
+ * containment following path components.
+ */
+class Index
+{
+  public:
+    /**
+     * @brief Returns the Health and HealthRollup of a resource.
+     * @param selfPath  The inventory item the resource is, if it is one
+     * @param inventory  The inventory items the resource is made of
+     * @param all  Whether the resource is made of all the inventory, as the
+     * BMC manager is
+     */
+    std::pair<Level, Level>
+        evaluate(const std::optional<std::string>& selfPath,
+                 const std::vector<std::string>& inventory, bool all) const
+    {
+        std::optional<Level> health;
+        std::optional<Level> rollup;
+        for (Level level : {Level::critical, Level::warning})
+        {
+            const Counts& levelCounts = countsOf(level);
+            bool self = selfPath && has(levelCounts.below, *selfPath);
+            bool inRollup = self;
+            bool inHealth = self;
+            if (all)
+            {
+                inRollup |= levelCounts.sources > 0;
+                inHealth |= global && has(levelCounts.below, *global);
+            }
+            else
+            {
+                for (const std::string& item : inventory)
+                {
+                    inRollup |= has(levelCounts.below, item) ||
+                                has(levelCounts.referring, item);
+                    inHealth |= global &&
+                                (belowBoth(levelCounts, item, *global) ||
+                                 has(levelCounts.referringGlobal, item));
+                }
+            }
+            if (!health && inHealth)
+            {
+                health = level;
+            }
+            if (!rollup && inRollup)
+            {
+                rollup = level;
+            }
+        }
+        return {health.value_or(Level::ok), rollup.value_or(Level::ok)};
+    }
+
+    // Sets the endpoints of an association of the graph, of which only the
+    // critical and warning associations are counted
+    void setAssociation(const std::string& associationPath,
+                        const std::vector<std::string>& endpoints)
+    {
+        size_t slash = associationPath.rfind('/');
+        if (slash == std::string::npos || slash == 0)
+        {
+            return;
+        }
+        std::string_view name(associationPath);
+        name.remove_prefix(slash + 1);
+        Level level = Level::ok;
+        if (boost::ends_with(name, "critical"))
+        {
+            level = Level::critical;
+        }
+        else if (boost::ends_with(name, "warning"))
+        {
+            level = Level::warning;
+        }
+        else
+        {
+            return;
+        }
+
+        auto it = statusAssociations.find(associationPath);
+        if (it != statusAssociations.end())
+        {
+            addAssociation(it->second, false);
+            if (endpoints.empty())
+            {
+                statusAssociations.erase(it);
+                return;
+            }
+            it->second.endpoints = endpoints;
+            addAssociation(it->second, true);
+            return;
+        }
+        if (endpoints.empty())
+        {
+            return;
+        }
+        auto [entry, inserted] = statusAssociations.emplace(
+            associationPath,
+            StatusAssociation{level, associationPath.substr(0, slash),
+                              endpoints});
+        addAssociation(entry->second, true);
+    }
+
+    void clearAssociations()
+    {
+        for (const auto& [path, association] : statusAssociations)
+        {
+            addAssociation(association, false);
+        }
+        statusAssociations.clear();
+    }
+
+    void setFunctional(const std::string& path, bool functional)
+    {
+        if (functional)
+        {
+            if (nonfunctional.erase(path) > 0)
+            {
+                addSource(Level::critical, path, false);
+            }
+        }
+        else if (nonfunctional.insert(path).second)
+        {
+            addSource(Level::critical, path, true);
+        }
+    }
+
+    void clearFunctional()
+    {
+        for (const std::string& path : nonfunctional)
+        {
+            addSource(Level::critical, path, false);
+        }
+        nonfunctional.clear();
+    }
+
+    // The endpoints counted as referred to by global associations depend on
+    // the global item, so are counted again when it changes
+    void setGlobal(std::optional<std::string> path)
+    {
+        if (path == global)
+        {
+            return;
+        }
+        for (const auto& [assocPath, association] : statusAssociations)
+        {
+            addAssociation(association, false);
+        }
+        global = std::move(path);
+        for (const auto& [assocPath, association] : statusAssociations)
+        {
+            addAssociation(association, true);
+        }
+    }
+
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        json["status_associations"] = statusAssociations.size();
+        json["nonfunctional"] = nonfunctional.size();
+        json["global"] = global.value_or("");
+    }
+
+  private:
+    // Where the sources of one level of bad health are counted
+    struct Counts
+    {
+        // Path -> sources at or below it
+        std::unordered_map<std::string, size_t> below;
+        // Path -> associations with it as an endpoint
+        std::unordered_map<std::string, size_t> referring;
+        // Path -> associations with it as an endpoint, that belong to the
+        // global inventory item or below it
+        std::unordered_map<std::string, size_t> referringGlobal;
+        size_t sources = 0;
+    };
+
+    struct StatusAssociation
+    {
+        Level level;
+        std::string owner;
+        std::vector<std::string> endpoints;
+    };
+
+    Counts& countsOf(Level level)
+    {
+        return counts[level == Level::critical ? 1 : 0];
+    }
+
+    const Counts& countsOf(Level level) const
+    {
+        return counts[level == Level::critical ? 1 : 0];
+    }
+
+    static bool has(const std::unordered_map<std::string, size_t>& map,
+                    const std::string& path)
+    {
+        return map.find(path) != map.end();
+    }
+
+    // Whether path is ancestor or below it
+    static bool within(std::string_view path, std::string_view ancestor)
+    {
+        return path.substr(0, ancestor.size()) == ancestor &&
+               (path.size() == ancestor.size() || path[ancestor.size()] == '/');
+    }
+
+    // Whether there is a source below both a and b
+    static bool belowBoth(const Counts& counts, const std::string& a,
+                          const std::string& b)
+    {
+        if (within(a, b))
+        {
+            return has(counts.below, a);
+        }
+        if (within(b, a))
+        {
+            return has(counts.below, b);
+        }
+        return false;
+    }
+
+    static void add(std::unordered_map<std::string, size_t>& map,
+                    const std::string& path, bool increment)
+    {
+        if (increment)
+        {
+            map[path]++;
+            return;
+        }
+        auto it = map.find(path);
+        if (it != map.end() && --it->second == 0)
+        {
+            map.erase(it);
+        }
+    }
+
+    // Counts a source at path and all its ancestors
+    void addSource(Level level, const std::string& path, bool increment)
+    {
+        Counts& levelCounts = countsOf(level);
+        size_t slash = path.find('/', 1);
+        while (slash != std::string::npos)
+        {
+            add(levelCounts.below, path.substr(0, slash), increment);
+            slash = path.find('/', slash + 1);
+        }
+        add(levelCounts.below, path, increment);
+        if (increment)
+        {
+            levelCounts.sources++;
+        }
+        else
+        {
+            levelCounts.sources--;
+        }
+    }
+
+    void addAssociation(const StatusAssociation& association, bool increment)
+    {
+        addSource(association.level, association.owner, increment);
+        Counts& levelCounts = countsOf(association.level);
+        bool isGlobal = global && within(association.owner, *global);
+        for (const std::string& endpoint : association.endpoints)
+        {
+            add(levelCounts.referring, endpoint, increment);
+            if (isGlobal)
+            {
+                add(levelCounts.referringGlobal, endpoint, increment);
+            }
+        }
+    }
+
+    // Indexed by warning, critical
+    std::array<Counts, 2> counts;
+    // Association path -> critical or warning association
+    std::unordered_map<std::string, StatusAssociation> statusAssociations;
+    // Inventory items that are not Functional
+    std::unordered_set<std::string> nonfunctional;
+    std::optional<std::string> global;
+};
+
+/**
+ * @brief Resident health of the inventory, for Status.Health and
+ * Status.HealthRollup without reading every association per resource.
+ *
+ * The critical and warning associations are taken from the association
+ * graph as it changes.  The OperationalStatus of the inventory is read with
+ * one GetSubTree and a Get per item, made on the connection the signals
+ * arrive on, and then kept current from PropertiesChanged, InterfacesAdded
+ * and InterfacesRemoved.  The objects of a service that leaves go without
+ * signals, so a service the inventory was read from coming or going reads
+ * it again.
+ */
+class Rollup
+{
+  public:
+    static Rollup& getInstance()
+    {
+        static Rollup rollup;
+        return rollup;
+    }
+
+    Rollup(const Rollup&) = delete;
+    Rollup& operator=(const Rollup&) = delete;
+    Rollup(Rollup&&) = delete;
+    Rollup& operator=(Rollup&&) = delete;
+
+    // Starts the rollup on first use
+    bool ready()
+    {
+        if (!seeding.started())
+        {
+            start();
+        }
+        bool isReady = association_graph::Graph::getInstance().ready() &&
+                       seeding.ready();
+        if (!isReady)
+        {
+            fallbacks++;
+        }
+        return isReady;
+    }
+
+    // Returns the Health and HealthRollup of a resource, as Index::evaluate
+    std::pair<Level, Level> evaluate(const std::optional<std::string>& selfPath,
+                                     const std::vector<std::string>& inventory,
+                                     bool all)
+    {
+        evaluations++;
+        return index.evaluate(selfPath, inventory, all);
+    }
+
+  private:
+    Rollup() : seeding("Health rollup", [this]() { seed(); })
+    {
+        crow::metrics::registerProvider(
+            "health_rollup",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Rollup() = default;
+
+    void start()
+    {
+        association_graph::Graph::getInstance().subscribe(
+            [this](const std::string& associationPath,
+                   const std::vector<std::string>& endpoints) {
+                index.setAssociation(associationPath, endpoints);
+            },
+            [this]() { index.clearAssociations(); });
+
+        propertiesChangedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                std::string("type='signal',"
+                            "interface='org.freedesktop.DBus.Properties',"
+                            "member='PropertiesChanged',arg0='") +
+                    operationalStatusInterface + "',path_namespace='" +
+                    inventoryPath + "'",
+                [this](sdbusplus::message::message& msg) {
+                    onPropertiesChanged(msg);
+                });
+        std::string inventoryRule =
+            std::string("type='signal',"
+                        "interface='org.freedesktop.DBus.ObjectManager',"
+                        "arg0path='") +
+            inventoryPath + "/',member=";
+        interfacesAddedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::signalBus, inventoryRule + "'InterfacesAdded'",
+            [this](sdbusplus::message::message& msg) {
+                onInterfacesAdded(msg);
+            });
+        interfacesRemovedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                inventoryRule + "'InterfacesRemoved'",
+                [this](sdbusplus::message::message& msg) {
+                    onInterfacesRemoved(msg);
+                });
+        nameOwnerChangedMatch = crow::signal_cache::watchNameOwners(
+            [this](const std::string& name, const std::string& oldOwner,
+                   const std::string& newOwner) {
+                owners.ownerChanged(name, oldOwner, newOwner);
+                // The objects of a service that leaves go without signals
+                if (owners.tracks(name))
+                {
+                    seeding.changed();
+                }
+            });
+        seeding.start();
+    }
+
+    using GetObjectType =
+        std::vector<std::pair<std::string, std::vector<std::string>>>;
+    using GetSubTreeType = std::vector<std::pair<std::string, GetObjectType>>;
+
+    // Reads the operational status of the inventory and the global item.
+    // Signals are applied while this runs; each Get is made on the
+    // connection the signals arrive on, and is answered by the service that
+    // sends the signals for its object, so is never older than them.
+    void seed()
+    {
+        pendingReplies = 2;
+        seedError.clear();
+        index.clearFunctional();
+
+        dbus::utility::scheduledMethodCall(
+            this,
+            [this](const boost::system::error_code ec,
+                   const std::vector<std::string>& paths) {
+                if (ec)
+                {
+                    seedFailed(ec);
+                    return;
+                }
+                // As HealthPopulate, there is no global item unless there is
+                // exactly one
+                if (paths.size() == 1)
+                {
+                    index.setGlobal(paths.front());
+                }
+                else
+                {
+                    index.setGlobal(std::nullopt);
+                }
+                replyDone();
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
+            std::string("/"), 0, std::array<const char*, 1>{globalInterface});
+
+        dbus::utility::scheduledMethodCall(
+            this,
+            [this](const boost::system::error_code ec,
+                   const GetSubTreeType& subtree) {
+                if (ec)
+                {
+                    seedFailed(ec);
+                    return;
+                }
+                boost::container::flat_set<std::string> services;
+                for (const auto& [path, object] : subtree)
+                {
+                    for (const auto& [service, interfaces] : object)
+                    {
+                        services.insert(service);
+                        pendingReplies++;
+                        getFunctional(service, path);
+                    }
+                }
+                owners.track(std::move(services));
+                replyDone();
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree",
+            std::string(inventoryPath), 0,
+            std::array<const char*, 1>{operationalStatusInterface});
+    }
+
+    void getFunctional(const std::string& service, const std::string& path)
+    {
+        crow::connections::signalBus->async_method_call(
+            [this, path](const boost::system::error_code ec,
+                         const dbus::utility::DbusVariantType& value) {
+                // The item may have gone since the mapper listed it
+                if (!ec)
+                {
+                    const bool* functional = std::get_if<bool>(&value);
+                    if (functional != nullptr)
+                    {
+                        index.setFunctional(path, *functional);
+                    }
+                }
+                replyDone();
+            },
+            service, path, "org.freedesktop.DBus.Properties", "Get",
+            operationalStatusInterface, "Functional");
+    }
+
+    void seedFailed(const boost::system::error_code& ec)
+    {
+        seedError = ec;
+        replyDone();
+    }
+
+    void replyDone()
+    {
+        if (--pendingReplies > 0)
+        {
+            return;
+        }
+        if (seedError)
+        {
+            seeding.failed(seedError);
+            return;
+        }
+        if (seeding.done())
+        {
+            BMCWEB_LOG_INFO << "Health rollup seeded from " << owners.size()
+                            << " services";
+        }
+    }
+
+    void onPropertiesChanged(sdbusplus::message::message& msg)
+    {
+        std::string interface;
+        dbus::utility::DBusPropertiesMap changed;
+        std::vector<std::string> invalidated;
+        try
+        {
+            msg.read(interface, changed, invalidated);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed PropertiesChanged signal: "
+                             << e.what();
+            seeding.changed();
+            return;
+        }
+        auto it = changed.find("Functional");
+        if (it == changed.end())
+        {
+            return;
+        }
+        const bool* functional = std::get_if<bool>(&it->second);
+        if (functional != nullptr)
+        {
+            index.setFunctional(msg.get_path(), *functional);
+        }
+    }
+
+    // Reads Functional from the OperationalStatus properties at the current
+    // position of m, skipping the rest
+    static std::optional<bool> readFunctional(sd_bus_message* m)
+    {
+        std::optional<bool> functional;
+        if (sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sv}") < 0)
+        {
+            return std::nullopt;
+        }
+        while (sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                              "sv") > 0)
+        {
+            const char* name = nullptr;
+            if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &name) < 0)
+            {
+                return std::nullopt;
+            }
+            int value = 0;
+            if (std::string_view(name) == "Functional" &&
+                sd_bus_message_enter_container(m, SD_BUS_TYPE_VARIANT, "b") >
+                    0)
+            {
+                if (sd_bus_message_read_basic(m, SD_BUS_TYPE_BOOLEAN,
+                                              &value) < 0 ||
+                    sd_bus_message_exit_container(m) < 0)
+                {
+                    return std::nullopt;
+                }
+                functional = value != 0;
+            }
+            else if (sd_bus_message_skip(m, "v") < 0)
+            {
+                return std::nullopt;
+            }
+            if (sd_bus_message_exit_container(m) < 0)
+            {
+                return std::nullopt;
+            }
+        }
+        if (sd_bus_message_exit_container(m) < 0)
+        {
+            return std::nullopt;
+        }
+        return functional;
+    }
+
+    void onInterfacesAdded(sdbusplus::message::message& msg)
+    {
+        // Inventory items carry properties of many types, so only the two
+        // interfaces of interest are decoded
+        sd_bus_message* m = msg.get();
+        const char* objPath = nullptr;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_OBJECT_PATH, &objPath) <
+                0 ||
+            sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}") <
+                0)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+            return;
+        }
+        while (sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                              "sa{sv}") > 0)
+        {
+            const char* interface = nullptr;
+            if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &interface) <
+                0)
+            {
+                BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                return;
+            }
+            if (std::string_view(interface) == operationalStatusInterface)
+            {
+                std::optional<bool> functional = readFunctional(m);
+                if (!functional)
+                {
+                    BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                    return;
+                }
+                index.setFunctional(objPath, *functional);
+            }
+            else
+            {
+                if (std::string_view(interface) == globalInterface)
+                {
+                    // Whether it is the only global item is only known to
+                    // the mapper
+                    seeding.changed();
+                }
+                if (sd_bus_message_skip(m, "a{sv}") < 0)
+                {
+                    BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                    return;
+                }
+            }
+            if (sd_bus_message_exit_container(m) < 0)
+            {
+                BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                return;
+            }
+        }
+    }
+
+    void onInterfacesRemoved(sdbusplus::message::message& msg)
+    {
+        sdbusplus::message::object_path objPath;
+        std::vector<std::string> interfaces;
+        try
+        {
+            msg.read(objPath, interfaces);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesRemoved signal: "
+                             << e.what();
+            return;
+        }
+        for (const std::string& interface : interfaces)
+        {
+            if (interface == operationalStatusInterface)
+            {
+                index.setFunctional(objPath.str, true);
+            }
+            else if (interface == globalInterface)
+            {
+                seeding.changed();
+            }
+        }
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        json["ready"] = seeding.ready();
+        index.fillMetrics(json);
+        json["evaluations"] = evaluations;
+        json["fallbacks"] = fallbacks;
+        json["seeds"] = seeding.seeds();
+    }
+
+    Index index;
+    // The services the operational status was read from
+    crow::signal_cache::Owners owners;
+    crow::signal_cache::Seeding seeding;
+
+    std::unique_ptr<sdbusplus::bus::match::match> propertiesChangedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> nameOwnerChangedMatch;
+
+    size_t pendingReplies = 0;
+    boost::system::error_code seedError;
+
+    uint64_t evaluations = 0;
+    uint64_t fallbacks = 0;
+};
+
+} // namespace health_rollup
+} // namespace redfish
@@ -34,6 +34,7 @@
 #include "../lib/processor.hpp"
 #include "../lib/redfish_sessions.hpp"
 #include "../lib/roles.hpp"
+#include "../lib/sensor_snapshot.hpp"
 #include "../lib/sensors.hpp"
 #include "../lib/service_root.hpp"
 #include "../lib/storage.hpp"
@@ -182,6 +183,9 @@ class RedfishService
 
         requestRoutesSensorCollection(app);
         requestRoutesSensor(app);
+#ifdef BMCWEB_ENABLE_REDFISH_OEM_SENSOR_SNAPSHOT
+        requestRoutesSensorSnapshot(app);
+#endif
 
         requestRoutesTaskMonitor(app);
         requestRoutesTaskService(app);
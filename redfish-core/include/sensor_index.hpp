@@ -0,0 +1,450 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <systemd/sd-bus.h>
+
+#include <boost/container/flat_map.hpp>
+#include <boost/container/flat_set.hpp>
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <signal_cache.hpp>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace sensor_index
+{
+
+constexpr const char* sensorsPath = "/xyz/openbmc_project/sensors";
+constexpr const char* valueInterface = "xyz.openbmc_project.Sensor.Value";
+
+using ObjectManagerPaths = boost::container::flat_map<std::string, std::string>;
+
+struct Sensor
+{
+    // /xyz/openbmc_project/sensors/<type>/<name>
+    std::string path;
+    // Well known name of the service providing Sensor.Value
+    std::string service;
+};
+
+/**
+ * @brief Index of the sensors on D-Bus by name, for the lookup of a single
+ * sensor without a GetSubTree of all of them.
+ *
+ * The index is seeded from one GetSubTree of the sensors namespace, along
+ * with the ObjectManager path of every service, and then kept up to date
+ * from the InterfacesAdded and InterfacesRemoved signals of the sensors and
+ * from NameOwnerChanged.  When a sensor service restarts, or a sensor
+ * comes from a service the index doesn't know, the mapper has to introspect
+ * the service first, so the index stops answering and is seeded again
+ * shortly after; callers fall back to the mapper whenever ready() is false.
+ */
+class Index
+{
+  public:
+    static Index& getInstance()
+    {
+        static Index index;
+        return index;
+    }
+
+    Index(const Index&) = delete;
+    Index& operator=(const Index&) = delete;
+    Index(Index&&) = delete;
+    Index& operator=(Index&&) = delete;
+
+    // Starts the index on first use
+    bool ready()
+    {
+        if (!seeding.started())
+        {
+            start();
+        }
+        if (!seeding.ready())
+        {
+            fallbacks++;
+        }
+        return seeding.ready();
+    }
+
+    // Returns a sensor called name, of any type, or nullptr if there is none
+    const Sensor* find(const std::string& name)
+    {
+        lookups++;
+        auto it = sensors.find(name);
+        if (it == sensors.end() || it->second.empty())
+        {
+            return nullptr;
+        }
+        return &it->second.front();
+    }
+
+    // Service -> path of its ObjectManager.  A new map replaces it when the
+    // index is seeded again, so it is never changed once returned.
+    std::shared_ptr<ObjectManagerPaths> objectManagerPaths() const
+    {
+        return objectManagers;
+    }
+
+  private:
+    Index() : seeding("sensor index", [this]() { seed(); })
+    {
+        crow::metrics::registerProvider(
+            "sensor_index",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Index() = default;
+
+    using GetObjectType =
+        std::vector<std::pair<std::string, std::vector<std::string>>>;
+    using GetSubTreeType = std::vector<std::pair<std::string, GetObjectType>>;
+
+    void start()
+    {
+        std::string sensorsRule =
+            std::string("type='signal',"
+                        "interface='org.freedesktop.DBus.ObjectManager',"
+                        "arg0path='") +
+            sensorsPath + "/',member=";
+        interfacesAddedMatch = std::make_unique<sdbusplus::bus::match::match>(
+            *crow::connections::signalBus, sensorsRule + "'InterfacesAdded'",
+            [this](sdbusplus::message::message& msg) {
+                onInterfacesAdded(msg);
+            });
+        interfacesRemovedMatch =
+            std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                sensorsRule + "'InterfacesRemoved'",
+                [this](sdbusplus::message::message& msg) {
+                    onInterfacesRemoved(msg);
+                });
+        nameOwnerChangedMatch = crow::signal_cache::watchNameOwners(
+            [this](const std::string& name, const std::string& oldOwner,
+                   const std::string& newOwner) {
+                onNameOwnerChanged(name, oldOwner, newOwner);
+            });
+        seeding.start();
+    }
+
+    static std::string_view nameOf(std::string_view path)
+    {
+        size_t slash = path.rfind('/');
+        if (slash == std::string_view::npos)
+        {
+            return {};
+        }
+        return path.substr(slash + 1);
+    }
+
+    void add(const std::string& path, const std::string& service)
+    {
+        std::string_view name = nameOf(path);
+        if (name.empty())
+        {
+            BMCWEB_LOG_ERROR << "Invalid sensor path: " << path;
+            return;
+        }
+        std::vector<Sensor>& named = sensors[std::string(name)];
+        for (const Sensor& sensor : named)
+        {
+            if (sensor.path == path && sensor.service == service)
+            {
+                return;
+            }
+        }
+        named.emplace_back(Sensor{path, service});
+        count++;
+    }
+
+    void remove(const std::string& path, const std::string& service)
+    {
+        auto it = sensors.find(std::string(nameOf(path)));
+        if (it == sensors.end())
+        {
+            return;
+        }
+        std::vector<Sensor>& named = it->second;
+        for (auto sensor = named.begin(); sensor != named.end(); ++sensor)
+        {
+            if (sensor->path == path && sensor->service == service)
+            {
+                named.erase(sensor);
+                count--;
+                break;
+            }
+        }
+        if (named.empty())
+        {
+            sensors.erase(it);
+        }
+    }
+
+    void removeService(const std::string& service)
+    {
+        for (auto it = sensors.begin(); it != sensors.end();)
+        {
+            std::vector<Sensor>& named = it->second;
+            for (auto sensor = named.begin(); sensor != named.end();)
+            {
+                if (sensor->service == service)
+                {
+                    sensor = named.erase(sensor);
+                    count--;
+                }
+                else
+                {
+                    ++sensor;
+                }
+            }
+            if (named.empty())
+            {
+                it = sensors.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    void seed()
+    {
+        dbus::utility::scheduledMethodCall(
+            this,
+            [this](const boost::system::error_code ec,
+                   const GetSubTreeType& subtree) {
+                if (ec)
+                {
+                    seeding.failed(ec);
+                    return;
+                }
+                sensors.clear();
+                count = 0;
+                boost::container::flat_set<std::string> services;
+                for (const auto& [path, object] : subtree)
+                {
+                    for (const auto& [service, interfaces] : object)
+                    {
+                        add(path, service);
+                        services.insert(service);
+                    }
+                }
+                seedObjectManagers(std::move(services));
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree",
+            std::string(sensorsPath), 2,
+            std::array<const char*, 1>{valueInterface});
+    }
+
+    void seedObjectManagers(boost::container::flat_set<std::string>&& services)
+    {
+        dbus::utility::scheduledMethodCall(
+            this,
+            [this, services{std::move(services)}](
+                const boost::system::error_code ec,
+                const GetSubTreeType& subtree) mutable {
+                if (ec)
+                {
+                    seeding.failed(ec);
+                    return;
+                }
+                auto paths = std::make_shared<ObjectManagerPaths>();
+                for (const auto& [path, object] : subtree)
+                {
+                    for (const auto& [service, interfaces] : object)
+                    {
+                        (*paths)[service] = path;
+                    }
+                }
+                objectManagers = std::move(paths);
+                // Signals carry the unique name of the sender, so learn the
+                // owner of every sensor service
+                owners.resolve(std::move(services), [this]() {
+                    if (seeding.done())
+                    {
+                        BMCWEB_LOG_INFO << "Sensor index seeded with "
+                                        << count << " sensors";
+                    }
+                });
+            },
+            "xyz.openbmc_project.ObjectMapper",
+            "/xyz/openbmc_project/object_mapper",
+            "xyz.openbmc_project.ObjectMapper", "GetSubTree", std::string("/"),
+            0,
+            std::array<const char*, 1>{"org.freedesktop.DBus.ObjectManager"});
+    }
+
+    // Returns the well known name of the service sending msg, or nullptr,
+    // having arranged for the index to be seeded again, if it isn't known
+    const std::string* senderService(sdbusplus::message::message& msg)
+    {
+        if (!seeding.acceptSignal())
+        {
+            return nullptr;
+        }
+        const std::string* service = owners.serviceOf(msg.get_sender());
+        if (service == nullptr)
+        {
+            // A sensor service that wasn't around when the index was seeded
+            seeding.changed();
+        }
+        return service;
+    }
+
+    void onInterfacesAdded(sdbusplus::message::message& msg)
+    {
+        // Only the interface names are needed, so skip over the properties
+        // rather than decoding them
+        sd_bus_message* m = msg.get();
+        const char* objPath = nullptr;
+        bool hasValue = false;
+        if (sd_bus_message_read_basic(m, SD_BUS_TYPE_OBJECT_PATH, &objPath) <
+                0 ||
+            sd_bus_message_enter_container(m, SD_BUS_TYPE_ARRAY, "{sa{sv}}") <
+                0)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+            return;
+        }
+        while (sd_bus_message_enter_container(m, SD_BUS_TYPE_DICT_ENTRY,
+                                              "sa{sv}") > 0)
+        {
+            const char* interface = nullptr;
+            if (sd_bus_message_read_basic(m, SD_BUS_TYPE_STRING, &interface) <
+                    0 ||
+                sd_bus_message_skip(m, "a{sv}") < 0 ||
+                sd_bus_message_exit_container(m) < 0)
+            {
+                BMCWEB_LOG_ERROR << "Malformed InterfacesAdded signal";
+                return;
+            }
+            if (std::string_view(interface) == valueInterface)
+            {
+                hasValue = true;
+            }
+        }
+        if (!hasValue)
+        {
+            return;
+        }
+        const std::string* service = senderService(msg);
+        if (service != nullptr)
+        {
+            add(objPath, *service);
+        }
+    }
+
+    void onInterfacesRemoved(sdbusplus::message::message& msg)
+    {
+        sdbusplus::message::object_path objPath;
+        std::vector<std::string> interfaces;
+        try
+        {
+            msg.read(objPath, interfaces);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Malformed InterfacesRemoved signal: "
+                             << e.what();
+            return;
+        }
+        if (std::find(interfaces.begin(), interfaces.end(), valueInterface) ==
+            interfaces.end())
+        {
+            return;
+        }
+        const std::string* service = senderService(msg);
+        if (service != nullptr)
+        {
+            remove(objPath.str, *service);
+        }
+    }
+
+    void onNameOwnerChanged(const std::string& name,
+                            const std::string& oldOwner,
+                            const std::string& newOwner)
+    {
+        owners.ownerChanged(name, oldOwner, newOwner);
+        // Other services only matter once they send a sensor, which
+        // senderService() doesn't know
+        if (crow::signal_cache::isUniqueName(name) || !owners.tracks(name))
+        {
+            return;
+        }
+        if (!oldOwner.empty())
+        {
+            if (seeding.ready())
+            {
+                removeService(name);
+            }
+            else
+            {
+                seeding.changed();
+            }
+        }
+        if (!newOwner.empty())
+        {
+            // The restarted service may have other sensors, which the
+            // mapper only knows of once it has introspected it
+            seeding.changed();
+        }
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        json["ready"] = seeding.ready();
+        json["sensors"] = count;
+        json["services"] = owners.size();
+        json["lookups"] = lookups;
+        json["fallbacks"] = fallbacks;
+        json["seeds"] = seeding.seeds();
+    }
+
+    // Sensor name -> the sensors of that name, of any type
+    std::unordered_map<std::string, std::vector<Sensor>> sensors;
+    std::shared_ptr<ObjectManagerPaths> objectManagers;
+    // The sensor services
+    crow::signal_cache::Owners owners;
+    crow::signal_cache::Seeding seeding;
+
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesAddedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> interfacesRemovedMatch;
+    std::unique_ptr<sdbusplus::bus::match::match> nameOwnerChangedMatch;
+
+    size_t count = 0;
+
+    uint64_t lookups = 0;
+    uint64_t fallbacks = 0;
+};
+
+} // namespace sensor_index
+} // namespace redfish
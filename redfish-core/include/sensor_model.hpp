@@ -0,0 +1,731 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <http_response.hpp>
+#include <logging.hpp>
+#include <metrics.hpp>
+#include <nlohmann/json.hpp>
+#include <sdbusplus/bus/match.hpp>
+#include <sdbusplus/message.hpp>
+#include <signal_cache.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace sensor_model
+{
+
+// Member of a sensor's JSON object that records where its readings were
+// written, until the response it is part of has been stored as a view.  It
+// is always removed before the response is sent.
+constexpr const char* readingsKey = "@Bmcweb.SensorModel.Readings";
+
+/**
+ * @brief Records on sensorJson that the Value of the sensor at dbusPath was
+ * written to pointer within it, scaled by 10^scale.
+ */
+inline void markReading(nlohmann::json& sensorJson, const std::string& dbusPath,
+                        const nlohmann::json::json_pointer& pointer,
+                        int64_t scale, bool forceToInt)
+{
+    sensorJson[readingsKey].push_back(
+        {dbusPath, pointer.to_string(), scale, forceToInt});
+}
+
+/**
+ * @brief The D-Bus objects and services a view is built from.  Only changes
+ * to these drop the view.
+ */
+struct Sources
+{
+    // A change to any of these objects, or to an object below one of them
+    // such as its associations, changes the view
+    std::set<std::string, std::less<>> paths;
+    // Services the objects were read from.  A service that leaves takes its
+    // objects with it, without signals for them.
+    std::set<std::string, std::less<>> services;
+
+    // Whether a change to the object at path changes the view
+    bool covers(std::string_view path) const
+    {
+        while (paths.find(path) == paths.end())
+        {
+            size_t slash = path.rfind('/');
+            if (slash == std::string_view::npos || slash == 0)
+            {
+                return false;
+            }
+            path.remove_suffix(path.size() - slash);
+        }
+        return true;
+    }
+
+    // Whether the view was read from objects of service
+    bool readFrom(const std::string& service) const
+    {
+        return services.find(service) != services.end();
+    }
+};
+
+// Erases the entries of map that match predicate, returning how many
+template <typename Map, typename Predicate>
+size_t eraseIf(Map& map, Predicate predicate)
+{
+    size_t erased = 0;
+    for (auto it = map.begin(); it != map.end();)
+    {
+        if (predicate(*it))
+        {
+            it = map.erase(it);
+            erased++;
+        }
+        else
+        {
+            it++;
+        }
+    }
+    return erased;
+}
+
+/**
+ * @brief What was dropped while views were being built, so that a view
+ * built from it is not stored.
+ */
+class Dropped
+{
+  public:
+    void addPath(const std::string& path)
+    {
+        paths.insert(path);
+    }
+
+    void addService(const std::string& service)
+    {
+        services.insert(service);
+    }
+
+    void clear()
+    {
+        paths.clear();
+        services.clear();
+    }
+
+    // Whether a view built from sources was dropped
+    bool affects(const Sources& sources) const
+    {
+        for (const std::string& path : paths)
+        {
+            if (sources.covers(path))
+            {
+                return true;
+            }
+        }
+        for (const std::string& service : services)
+        {
+            if (sources.readFrom(service))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+  private:
+    std::set<std::string> paths;
+    std::set<std::string> services;
+};
+
+/**
+ * @brief The views of the sensor model, and how changes are applied to them.
+ *
+ * A view is the complete response to a GET of one resource, with the places
+ * its sensors' readings were written to.  Value changes patch the readings
+ * in place.  Any other change drops the views built from the object or
+ * service it came from.  Changes that arrive while a view is being built
+ * are applied to it once it is stored, so none is lost to a D-Bus reply
+ * that was generated before them.
+ */
+class Views
+{
+  public:
+    // Returns the view of node of chassisId, or nullptr if there isn't one
+    const nlohmann::json* find(const std::string& chassisId,
+                               std::string_view node) const
+    {
+        auto it = views.find(Key(chassisId, node));
+        if (it == views.end())
+        {
+            return nullptr;
+        }
+        return &it->second.json;
+    }
+
+    // Whether there are views, or views being built, to apply changes to
+    bool active() const
+    {
+        return !views.empty() || building > 0;
+    }
+
+    /**
+     * @brief Starts building a view.  Returns the generation to pass to
+     * store() or abandon() once the response is complete.
+     */
+    uint64_t build()
+    {
+        building++;
+        return generation;
+    }
+
+    /**
+     * @brief Keeps json, the complete response to a GET of node of
+     * chassisId, as its view, unless what it was built from has changed
+     * since build() returned startGeneration.  Removes the readings recorded
+     * with markReading() from json whether or not it is kept.
+     */
+    void store(const std::string& chassisId, std::string_view node,
+               nlohmann::json& json, Sources sources, uint64_t startGeneration)
+    {
+        View view;
+        takeReadings(json, view);
+        for (const auto& [path, locations] : view.readings)
+        {
+            sources.paths.insert(path);
+        }
+        if (startGeneration == generation && !dropped.affects(sources))
+        {
+            view.json = json;
+            view.sources = std::move(sources);
+            for (const auto& [path, value] : pending)
+            {
+                applyValue(view, path, value);
+            }
+            builds++;
+            views.insert_or_assign(Key(chassisId, node), std::move(view));
+        }
+        finishBuild();
+    }
+
+    // Ends a build that failed, or that didn't complete, without a view
+    void abandon(nlohmann::json& json)
+    {
+        View view;
+        takeReadings(json, view);
+        finishBuild();
+    }
+
+    // Sets the readings of the sensor at path, as objectInterfacesToJson()
+    // would have
+    void setValue(const std::string& path, double value)
+    {
+        for (auto& [key, view] : views)
+        {
+            applyValue(view, path, value);
+        }
+        if (building > 0)
+        {
+            pending.insert_or_assign(path, value);
+        }
+    }
+
+    // Drops the views built from the object at path
+    void dropPath(const std::string& path)
+    {
+        invalidations += eraseIf(views, [&path](const auto& entry) {
+            return entry.second.sources.covers(path);
+        });
+        if (building > 0)
+        {
+            dropped.addPath(path);
+        }
+    }
+
+    // Drops the views built from objects of service
+    void dropService(const std::string& service)
+    {
+        invalidations += eraseIf(views, [&service](const auto& entry) {
+            return entry.second.sources.readFrom(service);
+        });
+        if (building > 0)
+        {
+            dropped.addService(service);
+        }
+    }
+
+    // Drops all views, for changes that can't be placed
+    void dropAll()
+    {
+        invalidations += views.size();
+        views.clear();
+        pending.clear();
+        dropped.clear();
+        generation++;
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        size_t readings = 0;
+        for (const auto& [key, view] : views)
+        {
+            for (const auto& [path, locations] : view.readings)
+            {
+                readings += locations.size();
+            }
+        }
+        json["views"] = views.size();
+        json["readings"] = readings;
+        json["builds"] = builds;
+        json["updates"] = updates;
+        json["invalidations"] = invalidations;
+    }
+
+  private:
+    using Key = std::pair<std::string, std::string>;
+
+    struct Location
+    {
+        nlohmann::json::json_pointer pointer;
+        int64_t scale = 0;
+        bool forceToInt = false;
+    };
+
+    struct View
+    {
+        nlohmann::json json;
+        // Sensor D-Bus path -> where its Value is shown in json
+        std::map<std::string, std::vector<Location>> readings;
+        Sources sources;
+    };
+
+    // Moves the marks left by markReading() on the members of the arrays
+    // at the top level of json into view
+    static void takeReadings(nlohmann::json& json, View& view)
+    {
+        if (!json.is_object())
+        {
+            return;
+        }
+        for (auto& item : json.items())
+        {
+            nlohmann::json& members = item.value();
+            if (!members.is_array())
+            {
+                continue;
+            }
+            for (size_t index = 0; index < members.size(); index++)
+            {
+                nlohmann::json& member = members[index];
+                if (!member.is_object())
+                {
+                    continue;
+                }
+                auto marks = member.find(readingsKey);
+                if (marks == member.end())
+                {
+                    continue;
+                }
+                nlohmann::json::json_pointer base;
+                base.push_back(item.key());
+                base.push_back(std::to_string(index));
+                for (const nlohmann::json& mark : *marks)
+                {
+                    view.readings[mark[0].get<std::string>()].push_back(
+                        Location{base / nlohmann::json::json_pointer(
+                                            mark[1].get<std::string>()),
+                                 mark[2].get<int64_t>(),
+                                 mark[3].get<bool>()});
+                }
+                member.erase(marks);
+            }
+        }
+    }
+
+    void applyValue(View& view, const std::string& path, double value)
+    {
+        auto it = view.readings.find(path);
+        if (it == view.readings.end())
+        {
+            return;
+        }
+        for (const Location& location : it->second)
+        {
+            double scaled =
+                value * std::pow(10, static_cast<double>(location.scale));
+            if (location.forceToInt)
+            {
+                view.json[location.pointer] = static_cast<int64_t>(scaled);
+            }
+            else
+            {
+                view.json[location.pointer] = scaled;
+            }
+        }
+        updates++;
+    }
+
+    void finishBuild()
+    {
+        building--;
+        if (building == 0)
+        {
+            pending.clear();
+            dropped.clear();
+        }
+    }
+
+    std::map<Key, View> views;
+    // Seen while building: sensor D-Bus path -> latest Value, and what was
+    // dropped
+    std::map<std::string, double> pending;
+    Dropped dropped;
+    size_t building = 0;
+    // Bumped whenever all views are dropped, so that a view which started
+    // building before then is not stored
+    uint64_t generation = 0;
+
+    uint64_t builds = 0;
+    uint64_t updates = 0;
+    uint64_t invalidations = 0;
+};
+
+/**
+ * @brief The signals of the sensors, and of the inventory, LEDs and controls
+ * they are shown with, matched once for all the resident views of the
+ * sensors: the sensor model and the sensor snapshot.
+ *
+ * Listeners subscribe before they build their first view, so no change
+ * made after the D-Bus replies it is built from were generated can be
+ * missed.  The matches are on the signal connection, so their signals may
+ * be handled before or after those replies: either way they reach the
+ * view, in the order they were sent.
+ */
+class Feed
+{
+  public:
+    struct Listener
+    {
+        // A PropertiesChanged of the object at path
+        std::function<void(const std::string& path,
+                           const std::string& interface,
+                           const dbus::utility::DBusPropertiesMap& changed,
+                           const std::vector<std::string>& invalidated)>
+            propertiesChanged;
+        // Interfaces were added to, or removed from, the object at path
+        std::function<void(const std::string& path)> objectChanged;
+        // A service came or went
+        std::function<void(const std::string& service)> serviceChanged;
+        // Something changed that can't be placed
+        std::function<void()> lost;
+    };
+
+    static Feed& getInstance()
+    {
+        static Feed feed;
+        return feed;
+    }
+
+    Feed(const Feed&) = delete;
+    Feed& operator=(const Feed&) = delete;
+    Feed(Feed&&) = delete;
+    Feed& operator=(Feed&&) = delete;
+
+    void subscribe(Listener&& listener)
+    {
+        if (matches.empty())
+        {
+            watch();
+        }
+        listeners.emplace_back(std::move(listener));
+    }
+
+  private:
+    // Namespaces which changes are rendered into the views from
+    static constexpr std::array<std::string_view, 4> watchedNamespaces{
+        "/xyz/openbmc_project/sensors", "/xyz/openbmc_project/inventory",
+        "/xyz/openbmc_project/led", "/xyz/openbmc_project/control"};
+
+    Feed() = default;
+    ~Feed() = default;
+
+    void watch()
+    {
+        for (std::string_view path : watchedNamespaces)
+        {
+            matches.emplace_back(std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                "type='signal',interface='org.freedesktop.DBus.Properties',"
+                "member='PropertiesChanged',path_namespace='" +
+                    std::string(path) + "'",
+                [this](sdbusplus::message::message& msg) {
+                    onPropertiesChanged(msg);
+                }));
+            matches.emplace_back(std::make_unique<sdbusplus::bus::match::match>(
+                *crow::connections::signalBus,
+                "type='signal',interface='org.freedesktop.DBus.ObjectManager',"
+                "arg0path='" +
+                    std::string(path) + "/'",
+                [this](sdbusplus::message::message& msg) {
+                    onObjectChanged(msg);
+                }));
+        }
+        matches.emplace_back(crow::signal_cache::watchNameOwners(
+            [this](const std::string& name, const std::string&,
+                   const std::string&) { onNameOwnerChanged(name); }));
+    }
+
+    void onPropertiesChanged(sdbusplus::message::message& msg)
+    {
+        std::string path = msg.get_path();
+        std::string interface;
+        dbus::utility::DBusPropertiesMap changed;
+        std::vector<std::string> invalidated;
+        try
+        {
+            msg.read(interface, changed, invalidated);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Failed to read PropertiesChanged for "
+                             << path << ": " << e.what();
+            lost();
+            return;
+        }
+        for (const Listener& listener : listeners)
+        {
+            listener.propertiesChanged(path, interface, changed, invalidated);
+        }
+    }
+
+    void onObjectChanged(sdbusplus::message::message& msg)
+    {
+        sdbusplus::message::object_path objPath;
+        try
+        {
+            msg.read(objPath);
+        }
+        catch (const sdbusplus::exception::SdBusError& e)
+        {
+            BMCWEB_LOG_ERROR << "Failed to read " << msg.get_member() << ": "
+                             << e.what();
+            lost();
+            return;
+        }
+        for (const Listener& listener : listeners)
+        {
+            listener.objectChanged(objPath.str);
+        }
+    }
+
+    void onNameOwnerChanged(const std::string& name)
+    {
+        if (crow::signal_cache::isUniqueName(name))
+        {
+            return;
+        }
+        // Which sensors a chassis has, and which services they are on, is
+        // read from the mapper for every view
+        if (name == "xyz.openbmc_project.ObjectMapper")
+        {
+            lost();
+            return;
+        }
+        for (const Listener& listener : listeners)
+        {
+            listener.serviceChanged(name);
+        }
+    }
+
+    void lost()
+    {
+        for (const Listener& listener : listeners)
+        {
+            listener.lost();
+        }
+    }
+
+    std::vector<Listener> listeners;
+    std::vector<std::unique_ptr<sdbusplus::bus::match::match>> matches;
+};
+
+/**
+ * @brief Resident model of the sensor resources of each chassis, that is the
+ * Thermal and Power resources and the Sensors collection.
+ *
+ * The first GET of a resource runs the full D-Bus pipeline as before, and
+ * the response it builds is kept as the view of that resource, along with
+ * the objects and services it was read from.  Later GETs are answered from
+ * the view without any D-Bus calls.  Views are kept current from the Feed:
+ * a PropertiesChanged of the Value of a sensor patches its readings in
+ * place, and any other change to the sensors, the inventory, the LEDs or
+ * the controls drops the views built from the object changed, or from the
+ * service that came or went, to be built again on their next GET.
+ */
+class Model
+{
+  public:
+    static Model& getInstance()
+    {
+        static Model model;
+        return model;
+    }
+
+    Model(const Model&) = delete;
+    Model& operator=(const Model&) = delete;
+    Model(Model&&) = delete;
+    Model& operator=(Model&&) = delete;
+
+    /**
+     * @brief Fills res from the view of node of chassisId, if there is one.
+     * Returns false, and nothing is changed, if there isn't.
+     */
+    bool serve(const std::string& chassisId, std::string_view node,
+               crow::Response& res)
+    {
+        const nlohmann::json* view = views.find(chassisId, node);
+        if (view == nullptr)
+        {
+            misses++;
+            return false;
+        }
+        hits++;
+        res.jsonValue = *view;
+        return true;
+    }
+
+    // See Views::build()
+    uint64_t build()
+    {
+        if (!subscribed)
+        {
+            subscribe();
+        }
+        return views.build();
+    }
+
+    // See Views::store()
+    void store(const std::string& chassisId, std::string_view node,
+               nlohmann::json& json, Sources sources, uint64_t startGeneration)
+    {
+        views.store(chassisId, node, json, std::move(sources),
+                    startGeneration);
+    }
+
+    void abandon(nlohmann::json& json)
+    {
+        views.abandon(json);
+    }
+
+  private:
+    Model()
+    {
+        crow::metrics::registerProvider(
+            "sensor_model",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Model() = default;
+
+    static std::optional<double>
+        toDouble(const dbus::utility::DbusVariantType& value)
+    {
+        if (const double* doubleValue = std::get_if<double>(&value))
+        {
+            return *doubleValue;
+        }
+        if (const int64_t* int64Value = std::get_if<int64_t>(&value))
+        {
+            return static_cast<double>(*int64Value);
+        }
+        if (const uint32_t* uValue = std::get_if<uint32_t>(&value))
+        {
+            return *uValue;
+        }
+        return std::nullopt;
+    }
+
+    void subscribe()
+    {
+        subscribed = true;
+        Feed::getInstance().subscribe(
+            {[this](const std::string& path, const std::string& interface,
+                    const dbus::utility::DBusPropertiesMap& changed,
+                    const std::vector<std::string>& invalidated) {
+                 onPropertiesChanged(path, interface, changed, invalidated);
+             },
+             [this](const std::string& path) { views.dropPath(path); },
+             [this](const std::string& service) {
+                 views.dropService(service);
+             },
+             [this]() { views.dropAll(); }});
+    }
+
+    void onPropertiesChanged(const std::string& path,
+                             const std::string& interface,
+                             const dbus::utility::DBusPropertiesMap& changed,
+                             const std::vector<std::string>& invalidated)
+    {
+        if (!views.active())
+        {
+            return;
+        }
+        if (interface != "xyz.openbmc_project.Sensor.Value" ||
+            !invalidated.empty())
+        {
+            views.dropPath(path);
+            return;
+        }
+        for (const auto& [name, value] : changed)
+        {
+            std::optional<double> reading = toDouble(value);
+            if (name != "Value" || !reading)
+            {
+                // The range or scale of the sensor changed
+                views.dropPath(path);
+                return;
+            }
+            views.setValue(path, *reading);
+        }
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        views.fillMetrics(json);
+        json["hits"] = hits;
+        json["misses"] = misses;
+    }
+
+    Views views;
+    bool subscribed = false;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+
+} // namespace sensor_model
+} // namespace redfish
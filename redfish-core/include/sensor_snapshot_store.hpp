@@ -0,0 +1,533 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <dbus_utility.hpp>
+#include <http_response.hpp>
+#include <metrics.hpp>
+#include <nlohmann/json.hpp>
+#include <sensor_model.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace sensor_snapshot
+{
+
+constexpr std::string_view sensorsPrefix = "/xyz/openbmc_project/sensors/";
+
+// Bits of the Status column.  A sensor that is fine has none of them set.
+enum StatusBit : uint8_t
+{
+    unavailable = 1 << 0,
+    nonfunctional = 1 << 1,
+    warning = 1 << 2,
+    critical = 1 << 3,
+};
+
+struct Row
+{
+    // /xyz/openbmc_project/sensors/<type>/<name>
+    std::string path;
+    // Value as on D-Bus, before Scale is applied
+    double value = std::numeric_limits<double>::quiet_NaN();
+    int64_t scale = 0;
+    bool available = true;
+    bool functional = true;
+    bool warningHigh = false;
+    bool warningLow = false;
+    bool criticalHigh = false;
+    bool criticalLow = false;
+    // Sequence number of the last change to the reading or status
+    uint64_t sequence = 0;
+
+    double reading() const
+    {
+        return value * std::pow(10, static_cast<double>(scale));
+    }
+
+    uint8_t status() const
+    {
+        uint8_t bits = 0;
+        bits |= available ? 0 : unavailable;
+        bits |= functional ? 0 : nonfunctional;
+        bits |= (warningHigh || warningLow) ? warning : 0;
+        bits |= (criticalHigh || criticalLow) ? critical : 0;
+        return bits;
+    }
+
+    /**
+     * @brief Applies the properties of interface, from GetManagedObjects or
+     * a PropertiesChanged signal.  Returns true if the reading or the status
+     * changed.
+     */
+    bool apply(const std::string& interface,
+               const dbus::utility::DBusPropertiesMap& properties)
+    {
+        bool changed = false;
+        for (const auto& [name, variant] : properties)
+        {
+            if (interface == "xyz.openbmc_project.Sensor.Value")
+            {
+                if (name == "Value")
+                {
+                    changed |= setValue(variant);
+                }
+                else if (name == "Scale")
+                {
+                    changed |= set(scale, variant);
+                }
+            }
+            else if (interface ==
+                     "xyz.openbmc_project.State.Decorator.Availability")
+            {
+                changed |= name == "Available" && set(available, variant);
+            }
+            else if (interface ==
+                     "xyz.openbmc_project.State.Decorator.OperationalStatus")
+            {
+                changed |= name == "Functional" && set(functional, variant);
+            }
+            else if (interface ==
+                     "xyz.openbmc_project.Sensor.Threshold.Warning")
+            {
+                if (name == "WarningAlarmHigh")
+                {
+                    changed |= set(warningHigh, variant);
+                }
+                else if (name == "WarningAlarmLow")
+                {
+                    changed |= set(warningLow, variant);
+                }
+            }
+            else if (interface ==
+                     "xyz.openbmc_project.Sensor.Threshold.Critical")
+            {
+                if (name == "CriticalAlarmHigh")
+                {
+                    changed |= set(criticalHigh, variant);
+                }
+                else if (name == "CriticalAlarmLow")
+                {
+                    changed |= set(criticalLow, variant);
+                }
+            }
+        }
+        return changed;
+    }
+
+  private:
+    template <typename T>
+    static bool set(T& field, const dbus::utility::DbusVariantType& variant)
+    {
+        const T* newValue = std::get_if<T>(&variant);
+        if (newValue == nullptr || *newValue == field)
+        {
+            return false;
+        }
+        field = *newValue;
+        return true;
+    }
+
+    bool setValue(const dbus::utility::DbusVariantType& variant)
+    {
+        double newValue = 0.0;
+        if (const double* d = std::get_if<double>(&variant))
+        {
+            newValue = *d;
+        }
+        else if (const int64_t* i = std::get_if<int64_t>(&variant))
+        {
+            newValue = static_cast<double>(*i);
+        }
+        else if (const uint32_t* u = std::get_if<uint32_t>(&variant))
+        {
+            newValue = *u;
+        }
+        else
+        {
+            return false;
+        }
+        // NaN, as sensors report while they can't be read, never equals
+        // itself
+        if (newValue == value || (std::isnan(newValue) && std::isnan(value)))
+        {
+            return false;
+        }
+        value = newValue;
+        return true;
+    }
+};
+
+struct Table
+{
+    // Sorted by path
+    std::vector<Row> rows;
+    // Sequence number the table was built at.  Polls since an earlier one
+    // get the whole table, as the rows may have changed places.
+    uint64_t base = 0;
+    // What the table was read from, besides the rows
+    sensor_model::Sources sources;
+
+    Row* find(const std::string& path)
+    {
+        auto it = std::lower_bound(
+            rows.begin(), rows.end(), path,
+            [](const Row& row, const std::string& p) { return row.path < p; });
+        if (it == rows.end() || it->path != path)
+        {
+            return nullptr;
+        }
+        return &*it;
+    }
+};
+
+/**
+ * @brief The readings and status of the sensors of each chassis, kept
+ * current from signals.
+ *
+ * A chassis' table is built by the first GET of its snapshot from the same
+ * D-Bus reads as the Sensors collection, and from then on is updated from
+ * the PropertiesChanged signals of its sensors, which come from the Feed
+ * the sensor model is kept from too.  Every change to a reading or status
+ * takes the next number of a sequence, so a client that passes the
+ * Sequence of its last poll gets only what changed since.  A sensor of the
+ * table coming or going, a change of the chassis' associations or a service
+ * it was read from coming or going drops the table, to be built again on
+ * the next GET.
+ */
+class Store
+{
+  public:
+    static Store& getInstance()
+    {
+        static Store store;
+        return store;
+    }
+
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+    Store(Store&&) = delete;
+    Store& operator=(Store&&) = delete;
+
+    // Returns the table of chassisId, or nullptr if it has to be built
+    std::shared_ptr<const Table> find(const std::string& chassisId)
+    {
+        auto it = tables.find(chassisId);
+        if (it == tables.end())
+        {
+            return nullptr;
+        }
+        hits++;
+        return it->second;
+    }
+
+    /**
+     * @brief Starts building a table.  Returns the generation to pass to
+     * store() or abandon() once it is complete.
+     */
+    uint64_t build()
+    {
+        if (!subscribed)
+        {
+            subscribe();
+        }
+        building++;
+        return generation;
+    }
+
+    /**
+     * @brief Numbers the rows of table, and keeps it as the table of
+     * chassisId unless what it was read from has changed since build()
+     * returned startGeneration.
+     */
+    void store(const std::string& chassisId,
+               const std::shared_ptr<Table>& table, uint64_t startGeneration)
+    {
+        table->base = ++sequence;
+        for (Row& row : table->rows)
+        {
+            row.sequence = table->base;
+            table->sources.paths.insert(row.path);
+        }
+        if (startGeneration == generation && !dropped.affects(table->sources))
+        {
+            for (const Change& change : pending)
+            {
+                apply(*table, change.path, change.interface,
+                      change.properties);
+            }
+            builds++;
+            tables.insert_or_assign(chassisId, table);
+        }
+        finishBuild();
+    }
+
+    void abandon()
+    {
+        finishBuild();
+    }
+
+  private:
+    struct Change
+    {
+        std::string path;
+        std::string interface;
+        dbus::utility::DBusPropertiesMap properties;
+    };
+
+    Store()
+    {
+        crow::metrics::registerProvider(
+            "sensor_snapshot",
+            [this](nlohmann::json& json) { fillMetrics(json); });
+    }
+    ~Store() = default;
+
+    void subscribe()
+    {
+        subscribed = true;
+        sensor_model::Feed::getInstance().subscribe(
+            {[this](const std::string& path, const std::string& interface,
+                    const dbus::utility::DBusPropertiesMap& changed,
+                    const std::vector<std::string>& invalidated) {
+                 onPropertiesChanged(path, interface, changed, invalidated);
+             },
+             [this](const std::string& path) { dropPath(path); },
+             [this](const std::string& service) { dropService(service); },
+             [this]() { dropAll(); }});
+    }
+
+    void finishBuild()
+    {
+        building--;
+        if (building == 0)
+        {
+            pending.clear();
+            dropped.clear();
+        }
+    }
+
+    // Drops the tables read from the object at path
+    void dropPath(const std::string& path)
+    {
+        invalidations +=
+            sensor_model::eraseIf(tables, [&path](const auto& entry) {
+                return entry.second->sources.covers(path);
+            });
+        if (building > 0)
+        {
+            dropped.addPath(path);
+        }
+    }
+
+    // Drops the tables read from objects of service
+    void dropService(const std::string& service)
+    {
+        invalidations +=
+            sensor_model::eraseIf(tables, [&service](const auto& entry) {
+                return entry.second->sources.readFrom(service);
+            });
+        if (building > 0)
+        {
+            dropped.addService(service);
+        }
+    }
+
+    void dropAll()
+    {
+        invalidations += tables.size();
+        tables.clear();
+        pending.clear();
+        dropped.clear();
+        generation++;
+    }
+
+    void apply(Table& table, const std::string& path,
+               const std::string& interface,
+               const dbus::utility::DBusPropertiesMap& properties)
+    {
+        Row* row = table.find(path);
+        if (row != nullptr && row->apply(interface, properties))
+        {
+            row->sequence = ++sequence;
+            updates++;
+        }
+    }
+
+    void onPropertiesChanged(const std::string& path,
+                             const std::string& interface,
+                             const dbus::utility::DBusPropertiesMap& changed,
+                             const std::vector<std::string>& invalidated)
+    {
+        if (tables.empty() && building == 0)
+        {
+            return;
+        }
+        if (!boost::starts_with(path, sensorsPrefix))
+        {
+            // The associations of a chassis to its sensors, which the
+            // mapper keeps below the chassis
+            if (interface == "xyz.openbmc_project.Association")
+            {
+                dropPath(path);
+            }
+            return;
+        }
+        if (!invalidated.empty())
+        {
+            // The new values aren't in the signal
+            dropPath(path);
+            return;
+        }
+        for (auto& [chassisId, table] : tables)
+        {
+            apply(*table, path, interface, changed);
+        }
+        if (building > 0)
+        {
+            pending.emplace_back(Change{path, interface, changed});
+        }
+    }
+
+    void fillMetrics(nlohmann::json& json) const
+    {
+        size_t rows = 0;
+        for (const auto& [chassisId, table] : tables)
+        {
+            rows += table->rows.size();
+        }
+        json["tables"] = tables.size();
+        json["rows"] = rows;
+        json["sequence"] = sequence;
+        json["hits"] = hits;
+        json["builds"] = builds;
+        json["updates"] = updates;
+        json["invalidations"] = invalidations;
+    }
+
+    // Chassis id -> table.  Tables are updated in place; responses are
+    // filled from them before anything else can run.
+    std::map<std::string, std::shared_ptr<Table>> tables;
+    // Seen while building: the changes, in order, and what was dropped
+    std::vector<Change> pending;
+    sensor_model::Dropped dropped;
+    size_t building = 0;
+    uint64_t sequence = 0;
+    // Bumped whenever all tables are dropped, so that a table which started
+    // building before then is not stored
+    uint64_t generation = 0;
+    bool subscribed = false;
+
+    uint64_t hits = 0;
+    uint64_t builds = 0;
+    uint64_t updates = 0;
+    uint64_t invalidations = 0;
+};
+
+/**
+ * @brief Parses the since parameter of a poll, the Sequence of an earlier
+ * one.  Returns nullopt if it isn't a number.
+ */
+inline std::optional<uint64_t> parseSince(std::string_view value)
+{
+    uint64_t since = 0;
+    const char* end = value.data() + value.size();
+    auto [ptr, ec] = std::from_chars(value.data(), end, since);
+    if (ec != std::errc() || ptr != end)
+    {
+        return std::nullopt;
+    }
+    return since;
+}
+
+/**
+ * @brief Fills res with the rows of table that changed after since, or with
+ * all of them if since is not given or is not from this table.
+ */
+inline void fillSnapshot(crow::Response& res, const std::string& chassisId,
+                         const Table& table, std::optional<uint64_t> since)
+{
+    nlohmann::json& json = res.jsonValue;
+    json["@odata.type"] = "#OemSensorSnapshot.v1_0_0.SensorSnapshot";
+    json["@odata.id"] =
+        "/redfish/v1/Chassis/" + chassisId + "/Oem/OpenBmc/SensorSnapshot";
+    json["Id"] = "SensorSnapshot";
+    json["Name"] = "Sensor Snapshot";
+
+    uint64_t sequence = table.base;
+    for (const Row& row : table.rows)
+    {
+        sequence = std::max(sequence, row.sequence);
+    }
+    json["Sequence"] = sequence;
+
+    nlohmann::json readings = nlohmann::json::array();
+    nlohmann::json status = nlohmann::json::array();
+    // A since ahead of the sequence was handed out before bmcweb restarted
+    bool full = !since || *since < table.base || *since > sequence;
+    json["Full"] = full;
+    if (full)
+    {
+        nlohmann::json names = nlohmann::json::array();
+        for (const Row& row : table.rows)
+        {
+            names.push_back(row.path.substr(sensorsPrefix.size()));
+            readings.push_back(row.reading());
+            status.push_back(row.status());
+        }
+        json["Names"] = std::move(names);
+        json["StatusBits"] = {{"Unavailable", unavailable},
+                              {"Nonfunctional", nonfunctional},
+                              {"Warning", warning},
+                              {"Critical", critical}};
+    }
+    else
+    {
+        nlohmann::json indexes = nlohmann::json::array();
+        for (size_t index = 0; index < table.rows.size(); index++)
+        {
+            const Row& row = table.rows[index];
+            if (row.sequence > *since)
+            {
+                indexes.push_back(index);
+                readings.push_back(row.reading());
+                status.push_back(row.status());
+            }
+        }
+        json["Since"] = *since;
+        json["Indexes"] = std::move(indexes);
+    }
+    json["Readings"] = std::move(readings);
+    json["Status"] = std::move(status);
+}
+
+} // namespace sensor_snapshot
+} // namespace redfish
@@ -1,8 +1,19 @@
 #pragma once
 
 #include <boost/container/flat_map.hpp>
+#include <dbus_utility.hpp>
+#include <error_messages.hpp>
+#include <http_request.hpp>
+#include <http_utility.hpp>
+#include <utility.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace redfish
@@ -10,6 +21,126 @@ namespace redfish
 namespace collection_util
 {
 
+/**
+ * @brief The page of a collection a request asks for with $skip, $top and
+ * $skiptoken.
+ *
+ * $skiptoken is the opaque continuation token a collection puts in the
+ * Members@odata.nextLink of a page that leaves members out.  It encodes a
+ * position in the source of the collection, such as the last member name,
+ * file offset or journal cursor it returned, so that the next page resumes
+ * there instead of counting its way through the members before it.  Each
+ * collection decides what its positions look like.
+ */
+struct Page
+{
+    // Where the previous page ended, as encoded by the collection; empty on
+    // the first page
+    std::string position;
+    // Members to leave out after position
+    uint64_t skip = 0;
+    uint64_t top = std::numeric_limits<uint64_t>::max();
+    // The other query parameters, for the next page to carry on with
+    std::string query;
+};
+
+/**
+ * @brief Reads the page req asks for.  Without $top, a page holds up to
+ * defaultTop members.  On a malformed parameter, fills res with the error and
+ * returns std::nullopt.
+ */
+inline std::optional<Page>
+    getPage(const crow::Request& req, crow::Response& res,
+            uint64_t defaultTop = std::numeric_limits<uint64_t>::max(),
+            uint64_t maxTop = std::numeric_limits<uint64_t>::max())
+{
+    Page page;
+    page.top = defaultTop;
+    boost::urls::url_view::params_type::iterator it =
+        req.urlParams.find("$skip");
+    if (it != req.urlParams.end())
+    {
+        std::string skipParam = it->value();
+        char* ptr = nullptr;
+        page.skip = std::strtoull(skipParam.c_str(), &ptr, 10);
+        if (skipParam.empty() || *ptr != '\0')
+        {
+            messages::queryParameterValueTypeError(res, skipParam, "$skip");
+            return std::nullopt;
+        }
+    }
+    it = req.urlParams.find("$top");
+    if (it != req.urlParams.end())
+    {
+        std::string topParam = it->value();
+        char* ptr = nullptr;
+        page.top = std::strtoull(topParam.c_str(), &ptr, 10);
+        if (topParam.empty() || *ptr != '\0')
+        {
+            messages::queryParameterValueTypeError(res, topParam, "$top");
+            return std::nullopt;
+        }
+        if (page.top < 1U || page.top > maxTop)
+        {
+            messages::queryParameterOutOfRange(res, std::to_string(page.top),
+                                               "$top",
+                                               "1-" + std::to_string(maxTop));
+            return std::nullopt;
+        }
+    }
+    it = req.urlParams.find("$skiptoken");
+    if (it != req.urlParams.end())
+    {
+        std::string token = it->value();
+        if (!crow::utility::base64Decode(token, page.position) ||
+            page.position.empty())
+        {
+            messages::queryParameterValueFormatError(res, token,
+                                                     "$skiptoken");
+            return std::nullopt;
+        }
+    }
+    for (std::string_view name : {"$filter", "$select", "$expand"})
+    {
+        it = req.urlParams.find(name);
+        if (it != req.urlParams.end())
+        {
+            page.query += '&';
+            page.query += name;
+            page.query += '=';
+            page.query += http_helpers::urlEncode(it->value());
+        }
+    }
+    return page;
+}
+
+// Reports a $skiptoken the collection can't make sense of, such as one made
+// by another collection
+inline void badPosition(crow::Response& res, const Page& page)
+{
+    messages::queryParameterValueFormatError(
+        res, crow::utility::base64encode(page.position), "$skiptoken");
+}
+
+/**
+ * @brief Links the page of a collection ending at position to the page after
+ * it.
+ */
+inline void setNextLink(crow::Response& res, std::string_view collectionPath,
+                        const Page& page, std::string_view position)
+{
+    std::string nextLink(collectionPath);
+    nextLink += "?$skiptoken=";
+    nextLink += http_helpers::urlEncode(crow::utility::base64encode(position));
+    if (page.top != std::numeric_limits<uint64_t>::max())
+    {
+        nextLink += "&$top=";
+        nextLink += std::to_string(page.top);
+    }
+    nextLink += page.query;
+    res.jsonValue["Members@odata.nextLink"] = std::move(nextLink);
+}
+
 /**
  * @brief Populate the collection "Members" from a GetSubTreePaths search of
  *        inventory
@@ -19,6 +150,8 @@ namespace collection_util
  *             Members Redfish Path
  * @param[i]   interfaces  List of interfaces to constrain the GetSubTree search
  * @param[in]  subtree     D-Bus base path to constrain search to.
+ * @param[in]  page        Page of the members to return.  Members are in order
+ *             of name, which is also the position a page ends at.
  *
  * @return void
  */
@@ -26,11 +159,13 @@ inline void
     getCollectionMembers(std::shared_ptr<bmcweb::AsyncResp> aResp,
                          const std::string& collectionPath,
                          const std::vector<const char*>& interfaces,
-                         const char* subtree = "/xyz/openbmc_project/inventory")
+                         const char* subtree = "/xyz/openbmc_project/inventory",
+                         const Page& page = Page())
 {
     BMCWEB_LOG_DEBUG << "Get collection members for: " << collectionPath;
-    crow::connections::systemBus->async_method_call(
-        [collectionPath,
+    dbus::utility::getSubTreePaths(
+        subtree, 0, interfaces,
+        [collectionPath, page,
          aResp{std::move(aResp)}](const boost::system::error_code ec,
                                   const std::vector<std::string>& objects) {
             if (ec)
@@ -42,6 +177,8 @@ inline void
             nlohmann::json& members = aResp->res.jsonValue["Members"];
             members = nlohmann::json::array();
 
+            std::vector<std::string> leaves;
+            leaves.reserve(objects.size());
             for (const auto& object : objects)
             {
                 sdbusplus::message::object_path path(object);
@@ -50,17 +187,34 @@ inline void
                 {
                     continue;
                 }
+                leaves.emplace_back(std::move(leaf));
+            }
+            std::sort(leaves.begin(), leaves.end());
+
+            // Members added or removed since the previous page don't move
+            // where this one starts
+            std::vector<std::string>::iterator leaf = leaves.begin();
+            if (!page.position.empty())
+            {
+                leaf = std::upper_bound(leaves.begin(), leaves.end(),
+                                        page.position);
+            }
+            leaf += static_cast<std::ptrdiff_t>(std::min<uint64_t>(
+                page.skip,
+                static_cast<uint64_t>(std::distance(leaf, leaves.end()))));
+            for (; leaf != leaves.end() && members.size() < page.top; leaf++)
+            {
                 std::string newPath = collectionPath;
                 newPath += '/';
-                newPath += leaf;
+                newPath += *leaf;
                 members.push_back({{"@odata.id", std::move(newPath)}});
             }
-            aResp->res.jsonValue["Members@odata.count"] = members.size();
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", subtree, 0,
-        interfaces);
+            aResp->res.jsonValue["Members@odata.count"] = leaves.size();
+            if (leaf != leaves.end())
+            {
+                setNextLink(aResp->res, collectionPath, page, *(leaf - 1));
+            }
+        });
 }
 
 } // namespace collection_util
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "async_resp.hpp"
+#include "error_messages.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "http_utility.hpp"
+#include "logging.hpp"
+#include "utils/query_param.hpp"
+
+#include <memory>
+#include <string>
+
+namespace redfish
+{
+namespace etag
+{
+
+/**
+ * @brief Enforces the If-Match header of a PATCH to a Redfish resource.  The
+ * resource is read first with a GET subrequest, and the PATCH only runs
+ * through handler if that version of the resource has a matching ETag, the
+ * same one a GET by the client would have returned.  Otherwise the PATCH
+ * fails with PreconditionFailed.  Returns false if req has nothing to enforce
+ * and should just be routed as usual.
+ */
+inline bool handleIfMatch(crow::Request& req,
+                          const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                          const query_param::Handler& handler)
+{
+    if (req.method() != boost::beast::http::verb::patch ||
+        req.url.substr(0, std::string_view("/redfish/").size()) !=
+            "/redfish/")
+    {
+        return false;
+    }
+    std::string ifMatch(
+        req.getHeaderValue(boost::beast::http::field::if_match));
+    if (ifMatch.empty())
+    {
+        return false;
+    }
+
+    // The connection keeps req until asyncResp completes, which the PATCH
+    // has to do
+    auto budget = std::make_shared<query_param::Budget>();
+    auto current = std::make_shared<query_param::Expansion>(
+        handler, query_param::ExpandType::None, 0, budget,
+        [&req, asyncResp, handler,
+         ifMatch{std::move(ifMatch)}](crow::Response& res) {
+            if (res.result() != boost::beast::http::status::ok)
+            {
+                BMCWEB_LOG_DEBUG << "Can't read " << req.url
+                                 << " to check If-Match: " << res.resultInt();
+                messages::preconditionFailed(asyncResp->res);
+                return;
+            }
+            res.writeJsonBody();
+            if (!http_helpers::etagMatches(ifMatch, res.computeEtag(), false))
+            {
+                messages::preconditionFailed(asyncResp->res);
+                return;
+            }
+            handler(req, asyncResp);
+        });
+    budget->start([&req, asyncResp, current]() {
+        current->runSubrequest(req, asyncResp->res, std::string(req.target()),
+                               nullptr);
+    });
+    return true;
+}
+
+} // namespace etag
+} // namespace redfish
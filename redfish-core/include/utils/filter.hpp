@@ -0,0 +1,521 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace filter
+{
+
+// Outcome of a filter, or of part of one, on a member.  Unknown when the
+// filter compares properties the caller couldn't provide.
+enum class Result : uint8_t
+{
+    False,
+    True,
+    Unknown,
+};
+
+/**
+ * @brief A compiled $filter expression.
+ *
+ * Supports comparisons of a property with a literal using eq, ne, gt, ge, lt
+ * and le, combined with and, or, not and parentheses, as in
+ * "Severity eq 'Critical' and not (Created lt '2021-06-01T00:00:00+00:00')".
+ * Properties below the top level of a member are written as paths, such as
+ * Status/Health.  Literals are strings in single quotes, numbers, true,
+ * false and null.  Numbers compare numerically and strings lexically, which
+ * orders Redfish date-times with the same offset correctly.  A property a
+ * member doesn't have compares as null.
+ *
+ * A collection can evaluate a filter against what it knows of a member
+ * before building it, such as a log entry's severity, and skip the member
+ * when the result is False.
+ */
+class Filter
+{
+  public:
+    // Returns std::nullopt if expression is malformed
+    static std::optional<Filter> parse(std::string_view expression)
+    {
+        Parser parser(expression);
+        if (!parser.tokenize())
+        {
+            return std::nullopt;
+        }
+        Filter filter;
+        if (!parser.parseOr(filter.root, 0) || !parser.atEnd())
+        {
+            return std::nullopt;
+        }
+        return filter;
+    }
+
+    bool matches(const nlohmann::json& member) const
+    {
+        return evaluate(root, member, nullptr) == Result::True;
+    }
+
+    /**
+     * @brief Evaluates against a partially built member, of which only the
+     * top level properties named in known have been filled in.  Comparisons
+     * of any other property are Unknown.
+     */
+    Result evaluate(const nlohmann::json& member,
+                    const std::vector<std::string_view>& known) const
+    {
+        return evaluate(root, member, &known);
+    }
+
+    // The "/" separated paths of the properties the filter compares
+    std::vector<std::string> properties() const
+    {
+        std::vector<std::string> paths;
+        addProperties(root, paths);
+        return paths;
+    }
+
+  private:
+    enum class Op : uint8_t
+    {
+        And,
+        Or,
+        Not,
+        Eq,
+        Ne,
+        Gt,
+        Ge,
+        Lt,
+        Le,
+    };
+
+    struct Node
+    {
+        Op op = Op::And;
+        // Of And, Or and Not
+        std::vector<Node> operands;
+        // Of comparisons
+        std::vector<std::string> path;
+        nlohmann::json literal;
+    };
+
+    struct Token
+    {
+        enum class Kind : uint8_t
+        {
+            Open,
+            Close,
+            String,
+            Word,
+        };
+        Kind kind;
+        std::string text;
+    };
+
+    class Parser
+    {
+      public:
+        explicit Parser(std::string_view expressionIn) :
+            expression(expressionIn)
+        {}
+
+        bool tokenize()
+        {
+            size_t i = 0;
+            while (i < expression.size())
+            {
+                char c = expression[i];
+                if (c == ' ')
+                {
+                    i++;
+                }
+                else if (c == '(' || c == ')')
+                {
+                    tokens.push_back(Token{c == '(' ? Token::Kind::Open
+                                                    : Token::Kind::Close,
+                                           std::string(1, c)});
+                    i++;
+                }
+                else if (c == '\'')
+                {
+                    // A quote inside a string is written twice
+                    std::string text;
+                    i++;
+                    while (true)
+                    {
+                        if (i >= expression.size())
+                        {
+                            return false;
+                        }
+                        if (expression[i] == '\'')
+                        {
+                            if (i + 1 < expression.size() &&
+                                expression[i + 1] == '\'')
+                            {
+                                text += '\'';
+                                i += 2;
+                                continue;
+                            }
+                            i++;
+                            break;
+                        }
+                        text += expression[i];
+                        i++;
+                    }
+                    tokens.push_back(
+                        Token{Token::Kind::String, std::move(text)});
+                }
+                else
+                {
+                    size_t end = expression.find_first_of(" ()'", i);
+                    if (end == std::string_view::npos)
+                    {
+                        end = expression.size();
+                    }
+                    tokens.push_back(
+                        Token{Token::Kind::Word,
+                              std::string(expression.substr(i, end - i))});
+                    i = end;
+                }
+            }
+            return true;
+        }
+
+        bool atEnd() const
+        {
+            return next == tokens.size();
+        }
+
+        bool parseOr(Node& node, size_t depth)
+        {
+            return parseBinary(node, depth, Op::Or, "or");
+        }
+
+      private:
+        // Deepest nesting of parentheses and not accepted
+        static constexpr size_t maxDepth = 32;
+
+        bool parseBinary(Node& node, size_t depth, Op op,
+                         std::string_view keyword)
+        {
+            Node operand;
+            if (!(op == Op::Or ? parseBinary(operand, depth, Op::And, "and")
+                               : parseUnary(operand, depth)))
+            {
+                return false;
+            }
+            if (!peekWord(keyword))
+            {
+                node = std::move(operand);
+                return true;
+            }
+            node.op = op;
+            node.operands.emplace_back(std::move(operand));
+            while (peekWord(keyword))
+            {
+                next++;
+                Node right;
+                if (!(op == Op::Or ? parseBinary(right, depth, Op::And, "and")
+                                   : parseUnary(right, depth)))
+                {
+                    return false;
+                }
+                node.operands.emplace_back(std::move(right));
+            }
+            return true;
+        }
+
+        bool parseUnary(Node& node, size_t depth)
+        {
+            if (depth > maxDepth || atEnd())
+            {
+                return false;
+            }
+            if (peekWord("not"))
+            {
+                next++;
+                node.op = Op::Not;
+                node.operands.emplace_back();
+                return parseUnary(node.operands.back(), depth + 1);
+            }
+            if (tokens[next].kind == Token::Kind::Open)
+            {
+                next++;
+                if (!parseOr(node, depth + 1) || atEnd() ||
+                    tokens[next].kind != Token::Kind::Close)
+                {
+                    return false;
+                }
+                next++;
+                return true;
+            }
+            return parseComparison(node);
+        }
+
+        bool parseComparison(Node& node)
+        {
+            if (tokens.size() - next < 3 ||
+                tokens[next].kind != Token::Kind::Word ||
+                tokens[next + 1].kind != Token::Kind::Word)
+            {
+                return false;
+            }
+            if (!parsePath(tokens[next].text, node.path) ||
+                !parseOp(tokens[next + 1].text, node.op))
+            {
+                return false;
+            }
+            const Token& literal = tokens[next + 2];
+            if (literal.kind == Token::Kind::String)
+            {
+                node.literal = literal.text;
+            }
+            else if (literal.kind != Token::Kind::Word ||
+                     !parseLiteral(literal.text, node.literal))
+            {
+                return false;
+            }
+            next += 3;
+            return true;
+        }
+
+        static bool parsePath(std::string_view text,
+                              std::vector<std::string>& path)
+        {
+            while (true)
+            {
+                size_t slash = text.find('/');
+                std::string_view name = text.substr(0, slash);
+                if (name.empty())
+                {
+                    return false;
+                }
+                for (char c : name)
+                {
+                    if (!std::isalnum(static_cast<unsigned char>(c)) &&
+                        c != '_' && c != '@' && c != '.' && c != '#')
+                    {
+                        return false;
+                    }
+                }
+                path.emplace_back(name);
+                if (slash == std::string_view::npos)
+                {
+                    return true;
+                }
+                text.remove_prefix(slash + 1);
+            }
+        }
+
+        static bool parseOp(std::string_view text, Op& op)
+        {
+            static constexpr std::pair<std::string_view, Op> ops[] = {
+                {"eq", Op::Eq}, {"ne", Op::Ne}, {"gt", Op::Gt},
+                {"ge", Op::Ge}, {"lt", Op::Lt}, {"le", Op::Le}};
+            for (const auto& [name, value] : ops)
+            {
+                if (text == name)
+                {
+                    op = value;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static bool parseLiteral(const std::string& text,
+                                 nlohmann::json& literal)
+        {
+            if (text == "true" || text == "false")
+            {
+                literal = text == "true";
+                return true;
+            }
+            if (text == "null")
+            {
+                literal = nullptr;
+                return true;
+            }
+            char* end = nullptr;
+            if (text.find_first_of(".eE") == std::string::npos)
+            {
+                long long integer = std::strtoll(text.c_str(), &end, 10);
+                literal = static_cast<int64_t>(integer);
+            }
+            else
+            {
+                literal = std::strtod(text.c_str(), &end);
+            }
+            return !text.empty() && end != nullptr && *end == '\0';
+        }
+
+        bool peekWord(std::string_view word) const
+        {
+            return next < tokens.size() &&
+                   tokens[next].kind == Token::Kind::Word &&
+                   tokens[next].text == word;
+        }
+
+        std::string_view expression;
+        std::vector<Token> tokens;
+        size_t next = 0;
+    };
+
+    static Result evaluate(const Node& node, const nlohmann::json& member,
+                           const std::vector<std::string_view>* known)
+    {
+        switch (node.op)
+        {
+            case Op::And:
+            case Op::Or:
+            {
+                // The result that decides the outcome on its own
+                Result decisive =
+                    node.op == Op::And ? Result::False : Result::True;
+                Result result =
+                    node.op == Op::And ? Result::True : Result::False;
+                for (const Node& operand : node.operands)
+                {
+                    Result value = evaluate(operand, member, known);
+                    if (value == decisive)
+                    {
+                        return decisive;
+                    }
+                    if (value == Result::Unknown)
+                    {
+                        result = Result::Unknown;
+                    }
+                }
+                return result;
+            }
+            case Op::Not:
+            {
+                Result value = evaluate(node.operands.front(), member, known);
+                if (value == Result::Unknown)
+                {
+                    return value;
+                }
+                return value == Result::True ? Result::False : Result::True;
+            }
+            default:
+                break;
+        }
+
+        if (known != nullptr)
+        {
+            bool isKnown = false;
+            for (std::string_view name : *known)
+            {
+                if (name == node.path.front())
+                {
+                    isKnown = true;
+                    break;
+                }
+            }
+            if (!isKnown)
+            {
+                return Result::Unknown;
+            }
+        }
+        static const nlohmann::json null;
+        const nlohmann::json* value = &member;
+        for (const std::string& name : node.path)
+        {
+            nlohmann::json::const_iterator it = value->find(name);
+            if (!value->is_object() || it == value->end())
+            {
+                value = &null;
+                break;
+            }
+            value = &*it;
+        }
+        return compare(node.op, *value, node.literal) ? Result::True
+                                                      : Result::False;
+    }
+
+    static bool compare(Op op, const nlohmann::json& value,
+                        const nlohmann::json& literal)
+    {
+        int order = 0;
+        if (value.is_number() && literal.is_number())
+        {
+            double left = value.get<double>();
+            double right = literal.get<double>();
+            order = left < right ? -1 : (left > right ? 1 : 0);
+        }
+        else if (value.is_string() && literal.is_string())
+        {
+            order = value.get_ref<const std::string&>().compare(
+                literal.get_ref<const std::string&>());
+        }
+        else
+        {
+            // Values of different types, booleans and null are only ever
+            // equal or not
+            bool equal = value == literal;
+            if (op == Op::Eq)
+            {
+                return equal;
+            }
+            if (op == Op::Ne)
+            {
+                return !equal;
+            }
+            return false;
+        }
+
+        switch (op)
+        {
+            case Op::Eq:
+                return order == 0;
+            case Op::Ne:
+                return order != 0;
+            case Op::Gt:
+                return order > 0;
+            case Op::Ge:
+                return order >= 0;
+            case Op::Lt:
+                return order < 0;
+            case Op::Le:
+                return order <= 0;
+            default:
+                return false;
+        }
+    }
+
+    static void addProperties(const Node& node, std::vector<std::string>& paths)
+    {
+        for (const Node& operand : node.operands)
+        {
+            addProperties(operand, paths);
+        }
+        if (node.path.empty())
+        {
+            return;
+        }
+        std::string path;
+        for (const std::string& name : node.path)
+        {
+            if (!path.empty())
+            {
+                path += '/';
+            }
+            path += name;
+        }
+        paths.emplace_back(std::move(path));
+    }
+
+    Node root;
+};
+
+} // namespace filter
+} // namespace redfish
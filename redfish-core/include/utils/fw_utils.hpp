@@ -1,5 +1,6 @@
 #pragma once
 #include <async_resp.hpp>
+#include <dbus_utility.hpp>
 
 #include <algorithm>
 #include <string>
@@ -38,7 +39,8 @@ inline void
                                 const bool populateLinkToImages)
 {
     // Used later to determine running (known on Redfish as active) FW images
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp, fwVersionPurpose, activeVersionPropName, populateLinkToImages](
             const boost::system::error_code ec,
             const std::variant<std::vector<std::string>>& resp) {
@@ -78,7 +80,8 @@ inline void
                 functionalFwIds.push_back(leaf);
             }
 
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                aResp,
                 [aResp, fwVersionPurpose, activeVersionPropName,
                  populateLinkToImages, functionalFwIds](
                     const boost::system::error_code ec2,
@@ -126,7 +129,8 @@ inline void
                         }
 
                         // Now grab its version info
-                        crow::connections::systemBus->async_method_call(
+                        dbus::utility::asyncMethodCall(
+                            aResp,
                             [aResp, swId, runningImage, fwVersionPurpose,
                              activeVersionPropName, populateLinkToImages](
                                 const boost::system::error_code ec3,
@@ -330,7 +334,8 @@ inline void getFwStatus(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
 {
     BMCWEB_LOG_DEBUG << "getFwStatus: swId " << *swId << " svc " << dbusSvc;
 
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        asyncResp,
         [asyncResp,
          swId](const boost::system::error_code errorCode,
                const boost::container::flat_map<
@@ -386,7 +391,8 @@ inline void
     getFwUpdateableStatus(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                           const std::shared_ptr<std::string>& fwId)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        asyncResp,
         [asyncResp, fwId](const boost::system::error_code ec,
                           const std::variant<std::vector<std::string>>& resp) {
             if (ec)
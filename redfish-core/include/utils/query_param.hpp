@@ -0,0 +1,987 @@
+#pragma once
+
+#include "async_resp.hpp"
+#include "error_messages.hpp"
+#include "http_request.hpp"
+#include "http_response.hpp"
+#include "logging.hpp"
+#include "utils/filter.hpp"
+
+#include <boost/asio/post.hpp>
+#include <boost/beast/http/message.hpp>
+#include <boost/beast/http/string_body.hpp>
+#include <boost/url/url_view.hpp>
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace query_param
+{
+
+enum class ExpandType : uint8_t
+{
+    None,
+    // "~": only hyperlinks in Links
+    Links,
+    // ".": only hyperlinks outside of Links, i.e. subordinate resources
+    NotLinks,
+    // "*": every hyperlink
+    Both,
+};
+
+// Deepest $levels accepted, advertised as ExpandQuery.MaxLevels
+constexpr uint8_t maxExpandLevels = 6;
+
+// Most subrequests a single request can make
+constexpr size_t maxSubrequests = 500;
+// Most subrequests of a single request running at the same time
+constexpr size_t maxConcurrentSubrequests = 8;
+// Most bytes of JSON the subrequests of a single request can add to it
+constexpr size_t maxSubrequestBytes = 4 * 1024 * 1024;
+
+/**
+ * @brief The properties named by $select, as a tree of path segments.  A
+ * node that is selected in full, with everything below it, has all set.
+ */
+struct SelectTrie
+{
+    bool all = false;
+    // A vector rather than a map, as a container of an incomplete type
+    std::vector<std::pair<std::string, SelectTrie>> children;
+
+    const SelectTrie* find(std::string_view name) const
+    {
+        for (const std::pair<std::string, SelectTrie>& child : children)
+        {
+            if (child.first == name)
+            {
+                return &child.second;
+            }
+        }
+        return nullptr;
+    }
+
+    SelectTrie& insert(std::string_view name)
+    {
+        for (std::pair<std::string, SelectTrie>& child : children)
+        {
+            if (child.first == name)
+            {
+                return child.second;
+            }
+        }
+        return children.emplace_back(std::string(name), SelectTrie()).second;
+    }
+
+    // Selects the property at path, a "/" separated list of property names,
+    // in full
+    void insertPath(std::string_view path)
+    {
+        SelectTrie* node = this;
+        while (true)
+        {
+            size_t slash = path.find('/');
+            node = &node->insert(path.substr(0, slash));
+            if (slash == std::string_view::npos)
+            {
+                break;
+            }
+            path.remove_prefix(slash + 1);
+        }
+        node->all = true;
+    }
+};
+
+struct Query
+{
+    ExpandType expandType = ExpandType::None;
+    uint8_t expandLevel = 1;
+    // Unset when every property is wanted
+    std::optional<SelectTrie> select;
+    // Unset when every member of a collection is wanted
+    std::optional<filter::Filter> filter;
+
+    /**
+     * @brief Whether the response has to contain the property at path, a
+     * "/" separated list of property names such as "Status/Health", or any
+     * property below it.  Handlers use this to skip work, such as D-Bus
+     * calls, that only feeds properties nobody asked for.
+     */
+    bool isSelected(std::string_view path) const
+    {
+        if (!select)
+        {
+            return true;
+        }
+        const SelectTrie* node = &*select;
+        while (!path.empty())
+        {
+            if (node->all)
+            {
+                return true;
+            }
+            size_t slash = path.find('/');
+            node = node->find(path.substr(0, slash));
+            if (node == nullptr)
+            {
+                return false;
+            }
+            path.remove_prefix(slash == std::string_view::npos ? path.size()
+                                                               : slash + 1);
+        }
+        return true;
+    }
+};
+
+// Whether the query of a request, which is null for a request without one,
+// selects path
+inline bool isSelected(const std::shared_ptr<const Query>& query,
+                       std::string_view path)
+{
+    return query == nullptr || query->isSelected(path);
+}
+
+/**
+ * @brief Parses an $expand value: one of "*", "." and "~", optionally
+ * followed by "($levels=<n>)".  Returns false if the value is malformed.
+ */
+inline bool getExpandType(std::string_view value, Query& query)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+    switch (value.front())
+    {
+        case '*':
+            query.expandType = ExpandType::Both;
+            break;
+        case '.':
+            query.expandType = ExpandType::NotLinks;
+            break;
+        case '~':
+            query.expandType = ExpandType::Links;
+            break;
+        default:
+            return false;
+    }
+    value.remove_prefix(1);
+    if (value.empty())
+    {
+        query.expandLevel = 1;
+        return true;
+    }
+
+    constexpr std::string_view levelsPrefix = "($levels=";
+    if (value.substr(0, levelsPrefix.size()) != levelsPrefix ||
+        value.back() != ')')
+    {
+        return false;
+    }
+    value.remove_prefix(levelsPrefix.size());
+    value.remove_suffix(1);
+    if (value.empty() || value.size() > 3)
+    {
+        return false;
+    }
+    unsigned levels = 0;
+    for (char c : value)
+    {
+        if (c < '0' || c > '9')
+        {
+            return false;
+        }
+        levels = levels * 10 + static_cast<unsigned>(c - '0');
+    }
+    if (levels < 1 || levels > maxExpandLevels)
+    {
+        return false;
+    }
+    query.expandLevel = static_cast<uint8_t>(levels);
+    return true;
+}
+
+/**
+ * @brief Parses a $select value: a comma separated list of properties, each
+ * a "/" separated path such as "Status/Health".  Returns false if the value
+ * is malformed.
+ */
+inline bool getSelect(std::string_view value, Query& query)
+{
+    SelectTrie& root = query.select.emplace();
+    while (true)
+    {
+        size_t comma = value.find(',');
+        std::string_view property = value.substr(0, comma);
+        SelectTrie* node = &root;
+        while (true)
+        {
+            size_t slash = property.find('/');
+            std::string_view name = property.substr(0, slash);
+            if (name.empty())
+            {
+                return false;
+            }
+            for (char c : name)
+            {
+                if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_' &&
+                    c != '@' && c != '.' && c != '#')
+                {
+                    return false;
+                }
+            }
+            node = &node->insert(name);
+            if (slash == std::string_view::npos)
+            {
+                break;
+            }
+            property.remove_prefix(slash + 1);
+        }
+        node->all = true;
+        if (comma == std::string_view::npos)
+        {
+            return true;
+        }
+        value.remove_prefix(comma + 1);
+    }
+}
+
+/**
+ * @brief Reads the query parameters handled generically for every Redfish
+ * resource.  On a malformed value, fills res with the error and returns
+ * std::nullopt.
+ */
+inline std::optional<Query>
+    parseParameters(const boost::urls::url_view::params_type& params,
+                    crow::Response& res)
+{
+    Query query;
+#ifdef BMCWEB_ENABLE_REDFISH_EXPAND
+    boost::urls::url_view::params_type::iterator expand =
+        params.find("$expand");
+    if (expand != params.end())
+    {
+        std::string value = expand->value();
+        if (!getExpandType(value, query))
+        {
+            messages::queryParameterValueFormatError(res, value, "$expand");
+            return std::nullopt;
+        }
+    }
+#endif
+    boost::urls::url_view::params_type::iterator select =
+        params.find("$select");
+    if (select != params.end())
+    {
+        std::string value = select->value();
+        if (!getSelect(value, query))
+        {
+            messages::queryParameterValueFormatError(res, value, "$select");
+            return std::nullopt;
+        }
+    }
+    boost::urls::url_view::params_type::iterator filter =
+        params.find("$filter");
+    if (filter != params.end())
+    {
+        std::string value = filter->value();
+        query.filter = filter::Filter::parse(value);
+        if (!query.filter)
+        {
+            messages::queryParameterValueFormatError(res, value, "$filter");
+            return std::nullopt;
+        }
+    }
+    return query;
+}
+
+// Removes from json the properties select doesn't name.  Annotations of
+// the resource itself, such as @odata.id, always stay, as do those of a kept
+// property, such as Members@odata.count.
+inline void pruneProperties(nlohmann::json& json, const SelectTrie& select)
+{
+    if (select.all)
+    {
+        return;
+    }
+    if (json.is_array())
+    {
+        for (nlohmann::json& element : json)
+        {
+            pruneProperties(element, select);
+        }
+        return;
+    }
+    if (!json.is_object())
+    {
+        return;
+    }
+    std::vector<std::string> unselected;
+    for (auto& item : json.items())
+    {
+        const std::string& key = item.key();
+        std::string_view name = key;
+        size_t at = name.find('@');
+        if (at == 0)
+        {
+            continue;
+        }
+        name = name.substr(0, at);
+        const SelectTrie* child = select.find(name);
+        if (child == nullptr)
+        {
+            unselected.emplace_back(key);
+            continue;
+        }
+        if (at == std::string_view::npos)
+        {
+            pruneProperties(item.value(), *child);
+        }
+    }
+    for (const std::string& key : unselected)
+    {
+        json.erase(key);
+    }
+}
+
+/**
+ * @brief Applies $select to a response.  In a collection, the selection
+ * applies to the members, which are kept whether or not they are named.
+ */
+inline void applySelect(nlohmann::json& json, const SelectTrie& select)
+{
+    nlohmann::json::iterator members = json.find("Members");
+    if (members == json.end() || !members->is_array() ||
+        select.find("Members") != nullptr)
+    {
+        pruneProperties(json, select);
+        return;
+    }
+    pruneProperties(*members, select);
+    SelectTrie collection = select;
+    collection.insert("Members").all = true;
+    pruneProperties(json, collection);
+}
+
+/**
+ * @brief The properties to fetch of a resource queried with query: those of
+ * its $select, plus those its $filter compares.  Returns std::nullopt if
+ * every property is wanted.
+ */
+inline std::optional<SelectTrie> fetchedProperties(const Query& query)
+{
+    if (!query.select)
+    {
+        return std::nullopt;
+    }
+    SelectTrie select = *query.select;
+    if (query.filter)
+    {
+        for (const std::string& path : query.filter->properties())
+        {
+            select.insertPath(path);
+        }
+    }
+    return select;
+}
+
+// Adds the members of a collection that are only hyperlinks.  Fetching them
+// is bounded by the Budget of the request.
+inline void findMemberLinks(nlohmann::json& json,
+                            std::vector<nlohmann::json*>& references)
+{
+    nlohmann::json::iterator members = json.find("Members");
+    if (members == json.end() || !members->is_array())
+    {
+        return;
+    }
+    for (nlohmann::json& member : *members)
+    {
+        if (member.is_object() && member.size() == 1 &&
+            member.contains("@odata.id"))
+        {
+            references.push_back(&member);
+        }
+    }
+}
+
+/**
+ * @brief The subrequests of a single request, shared by all of its
+ * expansions.  Keeps the resources already expanded, so that each is only
+ * expanded once and cycles of hyperlinks end, and bounds the subrequests in
+ * total, at once, and by the size of what they return.  Once a bound is
+ * exceeded no more subrequests are started, and the request fails.
+ */
+class Budget
+{
+  public:
+    // Marks the resource at uri expanded.  Returns false if it already was.
+    bool visit(std::string_view uri)
+    {
+        if (uri.size() > 1 && uri.back() == '/')
+        {
+            uri.remove_suffix(1);
+        }
+        return visited.emplace(uri).second;
+    }
+
+    // Runs start, now or once fewer subrequests are running, unless the
+    // request has run out of subrequests.  start has to call finished() once
+    // its subrequest has been answered.
+    bool start(std::function<void()>&& start)
+    {
+        if (exceeded)
+        {
+            return false;
+        }
+        if (started == maxSubrequests)
+        {
+            BMCWEB_LOG_WARNING << "Request exceeded " << maxSubrequests
+                               << " subrequests";
+            exceeded = true;
+            return false;
+        }
+        started++;
+        waiting.emplace_back(std::move(start));
+        runWaiting();
+        return true;
+    }
+
+    void finished()
+    {
+        running--;
+        runWaiting();
+    }
+
+    // Accounts for bytes of JSON added to the response.  Returns false once
+    // the response has grown too large.
+    bool addBytes(size_t count)
+    {
+        bytes += count;
+        if (bytes > maxSubrequestBytes && !exceeded)
+        {
+            BMCWEB_LOG_WARNING << "Request exceeded " << maxSubrequestBytes
+                               << " bytes of subrequests";
+            exceeded = true;
+        }
+        return !exceeded;
+    }
+
+    bool isExceeded() const
+    {
+        return exceeded;
+    }
+
+    size_t runningCount() const
+    {
+        return running;
+    }
+
+  private:
+    void runWaiting()
+    {
+        // A subrequest answered while starting another one is picked up by
+        // the loop below rather than by recursing
+        if (draining)
+        {
+            return;
+        }
+        draining = true;
+        while (!waiting.empty() && running < maxConcurrentSubrequests)
+        {
+            std::function<void()> next = std::move(waiting.front());
+            waiting.pop_front();
+            running++;
+            next();
+        }
+        draining = false;
+    }
+
+    std::unordered_set<std::string> visited;
+    std::deque<std::function<void()>> waiting;
+    size_t started = 0;
+    size_t running = 0;
+    size_t bytes = 0;
+    bool exceeded = false;
+    bool draining = false;
+};
+
+// Runs a request through the router
+using Handler = std::function<void(
+    crow::Request&, const std::shared_ptr<bmcweb::AsyncResp>&)>;
+
+/**
+ * @brief Adds the hyperlinks in json that $expand of type replaces with the
+ * resources they point to.  A hyperlink is an object whose only property is
+ * "@odata.id".  References to parts of a resource, which carry a fragment,
+ * are left alone.
+ */
+inline void findReferences(nlohmann::json& json, ExpandType type, bool inLinks,
+                           std::vector<nlohmann::json*>& references)
+{
+    if (json.is_array())
+    {
+        for (nlohmann::json& element : json)
+        {
+            findReferences(element, type, inLinks, references);
+        }
+        return;
+    }
+    if (!json.is_object())
+    {
+        return;
+    }
+    if (json.size() == 1)
+    {
+        nlohmann::json::iterator id = json.find("@odata.id");
+        if (id != json.end())
+        {
+            const std::string* uri = id->get_ptr<const std::string*>();
+            if (uri == nullptr ||
+                uri->compare(0, std::string_view("/redfish/v1/").size(),
+                             "/redfish/v1/") != 0 ||
+                uri->find('#') != std::string::npos)
+            {
+                return;
+            }
+            if (type == ExpandType::Both ||
+                (type == ExpandType::Links) == inLinks)
+            {
+                references.push_back(&json);
+            }
+            return;
+        }
+    }
+    for (auto& item : json.items())
+    {
+        findReferences(item.value(), type, inLinks || item.key() == "Links",
+                       references);
+    }
+}
+
+/**
+ * @brief One resource of an $expand: a request run through the router into a
+ * response of its own, whose hyperlinks are then replaced by the resources
+ * they point to.  Those are fetched as subrequests and are themselves
+ * expanded while levels remain.  Once every subrequest has been spliced in,
+ * the response is handed to the done callback.
+ *
+ * Subrequests are dispatched in-process, carry the session of the original
+ * request, and so are authorized like separate requests from the same user
+ * would be.  A hyperlink whose subrequest fails is left as it was, as is one
+ * to a resource that has already been expanded elsewhere in the response.
+ * How many subrequests run is bounded by the Budget of the request.
+ *
+ * $select is applied to the response before its hyperlinks are looked for,
+ * so that unselected ones aren't fetched.  The members of a collection are
+ * fetched with the same $select, letting their handlers skip work too.
+ *
+ * $filter applies to the members of the collection requested.  Members that
+ * aren't otherwise expanded are fetched with only the properties the filter
+ * compares, and go back to being hyperlinks once it has been evaluated.
+ * Those fetches count against the same Budget.  On a page of a paged
+ * collection, Members@odata.count stays the number of members before the
+ * filter, as the members of the other pages aren't known.
+ */
+class Expansion : public std::enable_shared_from_this<Expansion>
+{
+  public:
+    using Done = std::function<void(crow::Response&)>;
+
+    Expansion(const Handler& handlerIn, ExpandType typeIn, uint8_t levelsIn,
+              const std::shared_ptr<Budget>& budgetIn, Done&& doneIn) :
+        handler(handlerIn),
+        type(typeIn), levels(levelsIn), budget(budgetIn),
+        done(std::move(doneIn))
+    {}
+
+    Expansion(const Expansion&) = delete;
+    Expansion& operator=(const Expansion&) = delete;
+    Expansion(Expansion&&) = delete;
+    Expansion& operator=(Expansion&&) = delete;
+    ~Expansion() = default;
+
+    // Runs request, which has to outlive the expansion, into a response that
+    // is cancelled along with parent
+    void run(crow::Request& request, const crow::Response& parent)
+    {
+        req = &request;
+        res.inheritCancellation(parent);
+        res.setCompleteRequestHandler([self{shared_from_this()}]() mutable {
+            // Moved out, so that the response no longer keeps the expansion
+            // alive once it is complete
+            std::shared_ptr<Expansion> expansion = std::move(self);
+            if (expansion->subrequest)
+            {
+                expansion->budget->finished();
+            }
+            if (expansion->req->ioService == nullptr)
+            {
+                expansion->expandReferences();
+                return;
+            }
+            boost::asio::post(*expansion->req->ioService,
+                              [expansion] { expansion->expandReferences(); });
+        });
+        handler(request, std::make_shared<bmcweb::AsyncResp>(res));
+    }
+
+    // Runs a GET of target, with query, on behalf of the same client as
+    // parent.  Has to be started through the budget.
+    void runSubrequest(const crow::Request& parent,
+                       const crow::Response& parentRes,
+                       const std::string& target,
+                       const std::shared_ptr<const Query>& query)
+    {
+        boost::beast::http::request<boost::beast::http::string_body> get(
+            boost::beast::http::verb::get, target, 11);
+        // Headers describing the body or conditions on the outer request
+        // don't apply to a subrequest
+        for (const auto& field : parent.fields)
+        {
+            if (field.name() != boost::beast::http::field::content_length &&
+                field.name() != boost::beast::http::field::content_type &&
+                field.name() != boost::beast::http::field::if_match &&
+                field.name() != boost::beast::http::field::if_none_match)
+            {
+                get.set(field.name_string(), field.value());
+            }
+        }
+        subrequest.emplace(std::move(get));
+        try
+        {
+            subrequest->urlView = boost::urls::url_view(subrequest->target());
+            subrequest->url = subrequest->urlView.encoded_path();
+        }
+        catch (const std::exception& e)
+        {
+            BMCWEB_LOG_ERROR << "Can't expand " << target << ": " << e.what();
+            res.result(boost::beast::http::status::not_found);
+            budget->finished();
+            finish();
+            return;
+        }
+        subrequest->isSecure = parent.isSecure;
+        subrequest->ioService = parent.ioService;
+        subrequest->ipAddress = parent.ipAddress;
+        subrequest->session = parent.session;
+        subrequest->userRole = parent.userRole;
+        subrequest->query = query;
+        run(*subrequest, parentRes);
+    }
+
+  private:
+    void expandReferences()
+    {
+        if (res.result() != boost::beast::http::status::ok ||
+            budget->isExceeded())
+        {
+            finish();
+            return;
+        }
+        const Query* query = req->query.get();
+        std::shared_ptr<const Query> memberQuery;
+        if (query != nullptr)
+        {
+            std::optional<SelectTrie> select = fetchedProperties(*query);
+            if (select)
+            {
+                applySelect(res.jsonValue, *select);
+                if (res.jsonValue.contains("Members") &&
+                    select->find("Members") == nullptr)
+                {
+                    auto membersQuery = std::make_shared<Query>();
+                    membersQuery->select = std::move(select);
+                    memberQuery = std::move(membersQuery);
+                }
+            }
+        }
+        if (res.isCancelled())
+        {
+            finish();
+            return;
+        }
+        // Measured before this resource's own hyperlinks are spliced in, so
+        // that each subrequest is only counted once
+        if (subrequest &&
+            !budget->addBytes(
+                res.jsonValue
+                    .dump(-1, ' ', false,
+                          nlohmann::json::error_handler_t::replace)
+                    .size()))
+        {
+            finish();
+            return;
+        }
+        std::vector<nlohmann::json*> references;
+        if (levels != 0)
+        {
+            findReferences(res.jsonValue, type, false, references);
+            references.erase(
+                std::remove_if(
+                    references.begin(), references.end(),
+                    [this](const nlohmann::json* reference) {
+                        return !budget->visit(
+                            (*reference)["@odata.id"]
+                                .get_ref<const std::string&>());
+                    }),
+                references.end());
+        }
+        // Any further references are members fetched only for the filter
+        size_t expanded = references.size();
+        std::shared_ptr<const Query> filterQuery;
+        if (query != nullptr && query->filter &&
+            (levels == 0 || type == ExpandType::Links))
+        {
+            findMemberLinks(res.jsonValue, references);
+            fetchedMembers = references.size() != expanded;
+        }
+        if (fetchedMembers)
+        {
+            auto membersQuery = std::make_shared<Query>();
+            SelectTrie& select = membersQuery->select.emplace();
+            for (const std::string& path : query->filter->properties())
+            {
+                select.insertPath(path);
+            }
+            filterQuery = std::move(membersQuery);
+        }
+        if (references.empty())
+        {
+            finish();
+            return;
+        }
+        BMCWEB_LOG_DEBUG << "Expanding " << references.size()
+                         << " references in " << req->url;
+
+        // Held while starting subrequests, so that one completing
+        // synchronously can't finish the expansion before the rest start
+        pending = references.size() + 1;
+        for (size_t i = 0; i < references.size(); i++)
+        {
+            nlohmann::json* reference = references[i];
+            bool isMember = i >= expanded;
+            std::string target =
+                (*reference)["@odata.id"].get<std::string>();
+            auto child = std::make_shared<Expansion>(
+                handler, type, static_cast<uint8_t>(isMember ? 0 : levels - 1),
+                budget,
+                [self{shared_from_this()},
+                 reference](crow::Response& childRes) {
+                    self->splice(*reference, childRes);
+                });
+            bool started = budget->start(
+                [self{shared_from_this()}, child, target{std::move(target)},
+                 childQuery{isMember ? filterQuery : memberQuery}]() {
+                    if (self->budget->isExceeded())
+                    {
+                        // Answered at once, leaving the hyperlink as it is
+                        self->budget->finished();
+                        self->finishOne();
+                        return;
+                    }
+                    child->runSubrequest(*self->req, self->res, target,
+                                         childQuery);
+                });
+            if (!started)
+            {
+                pending -= references.size() - i;
+                break;
+            }
+        }
+        finishOne();
+    }
+
+    // Splicing only ever replaces a hyperlink object, so the pointers to the
+    // other hyperlinks stay valid
+    void splice(nlohmann::json& reference, crow::Response& childRes)
+    {
+        if (childRes.result() == boost::beast::http::status::ok)
+        {
+            reference = std::move(childRes.jsonValue);
+        }
+        else
+        {
+            BMCWEB_LOG_DEBUG << "Not expanding " << reference["@odata.id"]
+                             << ": " << childRes.resultInt();
+        }
+        finishOne();
+    }
+
+    void finishOne()
+    {
+        pending--;
+        if (pending == 0)
+        {
+            finish();
+        }
+    }
+
+    // Drops the members the filter of the request doesn't match, then
+    // applies $select to what is left
+    void applyFilter()
+    {
+        const Query& query = *req->query;
+        nlohmann::json::iterator members = res.jsonValue.find("Members");
+        if (members == res.jsonValue.end() || !members->is_array())
+        {
+            res.jsonValue.clear();
+            messages::queryNotSupportedOnResource(res);
+            return;
+        }
+        size_t total = members->size();
+        nlohmann::json::array_t matched;
+        for (nlohmann::json& member : *members)
+        {
+            if (!query.filter->matches(member))
+            {
+                continue;
+            }
+            nlohmann::json::iterator id = member.find("@odata.id");
+            if (fetchedMembers && id != member.end())
+            {
+                nlohmann::json::object_t link;
+                link["@odata.id"] = std::move(*id);
+                member = std::move(link);
+            }
+            matched.emplace_back(std::move(member));
+        }
+        *members = std::move(matched);
+        // Only a response holding the whole collection can count what it
+        // matches.  A page of a collection paged by $top and $skiptoken
+        // keeps the collection's own count, which is that of the members
+        // before filtering.  Collections that filter their own members as
+        // they build them count them themselves, and nothing is dropped here.
+        bool isPage =
+            req->urlParams.find("$skiptoken") != req->urlParams.end() ||
+            res.jsonValue.contains("Members@odata.nextLink");
+        if (res.jsonValue["Members"].size() != total && !isPage)
+        {
+            res.jsonValue["Members@odata.count"] =
+                res.jsonValue["Members"].size();
+        }
+        if (query.select)
+        {
+            applySelect(res.jsonValue, *query.select);
+        }
+    }
+
+    void finish()
+    {
+        if (req != nullptr && req->query != nullptr && req->query->filter &&
+            res.result() == boost::beast::http::status::ok)
+        {
+            applyFilter();
+        }
+        Done onDone = std::move(done);
+        done = nullptr;
+        if (onDone)
+        {
+            onDone(res);
+        }
+    }
+
+    Handler handler;
+    ExpandType type;
+    uint8_t levels;
+    std::shared_ptr<Budget> budget;
+    Done done;
+
+    // The request being expanded; points at subrequest unless this is the
+    // outermost expansion
+    crow::Request* req = nullptr;
+    std::optional<crow::Request> subrequest;
+    crow::Response res;
+    size_t pending = 0;
+    // Whether members were fetched only to evaluate the filter
+    bool fetchedMembers = false;
+};
+
+/**
+ * @brief Parses the query parameters of req for its handler to find in
+ * req.query, and serves req with $expand, $select and $filter applied if it
+ * asks for them, by running it and its subrequests through handler.  Returns
+ * false, having at most parsed the parameters, if req should just be routed
+ * as usual.
+ */
+inline bool handleQuery(crow::Request& req,
+                        const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                        const Handler& handler)
+{
+    if (req.method() != boost::beast::http::verb::get ||
+        req.url.substr(0, std::string_view("/redfish/").size()) !=
+            "/redfish/" ||
+        (req.urlParams.find("$expand") == req.urlParams.end() &&
+         req.urlParams.find("$select") == req.urlParams.end() &&
+         req.urlParams.find("$filter") == req.urlParams.end()))
+    {
+        return false;
+    }
+    std::optional<Query> query = parseParameters(req.urlParams, asyncResp->res);
+    if (!query)
+    {
+        return true;
+    }
+    if (query->expandType == ExpandType::None && !query->select &&
+        !query->filter)
+    {
+        return false;
+    }
+
+    uint8_t levels =
+        query->expandType == ExpandType::None ? 0 : query->expandLevel;
+    ExpandType type = query->expandType;
+    req.query = std::make_shared<const Query>(std::move(*query));
+    auto budget = std::make_shared<Budget>();
+    budget->visit(req.url);
+    auto expansion = std::make_shared<Expansion>(
+        handler, type, levels, budget,
+        [asyncResp, budget, &req, type](crow::Response& expanded) {
+            crow::Response& res = asyncResp->res;
+            if (budget->isExceeded())
+            {
+                // Blame the parameter that made the subrequests
+                const char* parameter =
+                    type == ExpandType::None ? "$filter" : "$expand";
+                auto value = req.urlParams.find(parameter);
+                if (value == req.urlParams.end())
+                {
+                    messages::internalError(res);
+                    return;
+                }
+                messages::queryParameterOutOfRange(
+                    res, value->value(), parameter,
+                    "of " + std::to_string(maxSubrequests) +
+                        " subrequests and " +
+                        std::to_string(maxSubrequestBytes) + " bytes");
+                return;
+            }
+            res.result(expanded.result());
+            for (const auto& field : expanded.stringResponse->base())
+            {
+                res.addHeader(field.name_string(), field.value());
+            }
+            res.jsonValue = std::move(expanded.jsonValue);
+            res.body() = std::move(expanded.body());
+            res.setRoute(expanded.route());
+        });
+    expansion->run(req, asyncResp->res);
+    return true;
+}
+
+} // namespace query_param
+} // namespace redfish
@@ -438,7 +438,7 @@ inline void requestRoutesCertificateActionGenerateCSR(App& app)
                     "',"
                     "member='InterfacesAdded'");
                 csrMatcher = std::make_unique<sdbusplus::bus::match::match>(
-                    *crow::connections::systemBus, match,
+                    *crow::connections::signalBus, match,
                     [asyncResp, service, objectPath,
                      certURI](sdbusplus::message::message& m) {
                         timeout.cancel();
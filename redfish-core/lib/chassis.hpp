@@ -165,8 +165,14 @@ inline void requestRoutesChassisCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/")
         .privileges(redfish::privileges::getChassisCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res);
+                if (!page)
+                {
+                    return;
+                }
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#ChassisCollection.ChassisCollection";
                 asyncResp->res.jsonValue["@odata.id"] = "/redfish/v1/Chassis";
@@ -175,7 +181,8 @@ inline void requestRoutesChassisCollection(App& app)
                 collection_util::getCollectionMembers(
                     asyncResp, "/redfish/v1/Chassis",
                     {"xyz.openbmc_project.Inventory.Item.Board",
-                     "xyz.openbmc_project.Inventory.Item.Chassis"});
+                     "xyz.openbmc_project.Inventory.Item.Chassis"},
+                    "/xyz/openbmc_project/inventory", *page);
             });
 }
 
@@ -19,7 +19,9 @@
 #include <boost/container/flat_map.hpp>
 #include <boost/container/flat_set.hpp>
 #include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
 #include <error_messages.hpp>
+#include <managed_objects_cache.hpp>
 #include <registries/privilege_registry.hpp>
 #include <utils/json_utils.hpp>
 
@@ -38,15 +40,7 @@ using PropertiesMapType = boost::container::flat_map<
     std::string, std::variant<std::string, bool, uint8_t, int16_t, uint16_t,
                               int32_t, uint32_t, int64_t, uint64_t, double>>;
 
-using GetManagedObjects = std::vector<std::pair<
-    sdbusplus::message::object_path,
-    std::vector<std::pair<
-        std::string,
-        boost::container::flat_map<
-            std::string,
-            std::variant<std::string, bool, uint8_t, int16_t, uint16_t, int32_t,
-                         uint32_t, int64_t, uint64_t, double,
-                         std::vector<std::string>>>>>>>;
+using GetManagedObjects = dbus::utility::ManagedObjectType;
 
 enum class LinkType
 {
@@ -202,13 +196,13 @@ inline std::string
 }
 
 inline bool extractEthernetInterfaceData(const std::string& ethifaceId,
-                                         GetManagedObjects& dbusData,
+                                         const GetManagedObjects& dbusData,
                                          EthernetInterfaceData& ethData)
 {
     bool idFound = false;
-    for (auto& objpath : dbusData)
+    for (const auto& objpath : dbusData)
     {
-        for (auto& ifacePair : objpath.second)
+        for (const auto& ifacePair : objpath.second)
         {
             if (objpath.first == "/xyz/openbmc_project/network/" + ethifaceId)
             {
@@ -930,10 +924,11 @@ template <typename CallbackFunc>
 void getEthernetIfaceData(const std::string& ethifaceId,
                           CallbackFunc&& callback)
 {
-    crow::connections::systemBus->async_method_call(
+    crow::getManagedObjects(
+        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
         [ethifaceId{std::string{ethifaceId}}, callback{std::move(callback)}](
             const boost::system::error_code errorCode,
-            GetManagedObjects& resp) {
+            const GetManagedObjects& resp) {
             EthernetInterfaceData ethData{};
             boost::container::flat_set<IPv4AddressData> ipv4Data;
             boost::container::flat_set<IPv6AddressData> ipv6Data;
@@ -967,9 +962,7 @@ void getEthernetIfaceData(const std::string& ethifaceId,
             extractIPV6Data(ethifaceId, resp, ipv6Data);
             // Finally make a callback with useful data
             callback(true, ethData, ipv4Data, ipv6Data);
-        },
-        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        });
 }
 
 /**
@@ -981,10 +974,11 @@ void getEthernetIfaceData(const std::string& ethifaceId,
 template <typename CallbackFunc>
 void getEthernetIfaceList(CallbackFunc&& callback)
 {
-    crow::connections::systemBus->async_method_call(
+    crow::getManagedObjects(
+        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
         [callback{std::move(callback)}](
             const boost::system::error_code errorCode,
-            GetManagedObjects& resp) {
+            const GetManagedObjects& resp) {
             // Callback requires vector<string> to retrieve all available
             // ethernet interfaces
             boost::container::flat_set<std::string> ifaceList;
@@ -1019,9 +1013,7 @@ void getEthernetIfaceList(CallbackFunc&& callback)
             }
             // Finally make a callback with useful data
             callback(true, ifaceList);
-        },
-        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        });
 }
 
 inline void
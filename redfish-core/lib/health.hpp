@@ -21,6 +21,9 @@
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/container/flat_set.hpp>
 #include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <health_rollup.hpp>
+#include <managed_objects_cache.hpp>
 
 #include <variant>
 
@@ -51,6 +54,47 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
         {
             healthChild->globalInventoryPath = globalInventoryPath;
             healthChild->statuses = statuses;
+            healthChild->nonfunctional = nonfunctional;
+            healthChild->resident = resident;
+        }
+
+#ifdef BMCWEB_ENABLE_REDFISH_HEALTH_ROLLUP
+        if (resident)
+        {
+            auto [selfHealth, selfRollup] =
+                health_rollup::Rollup::getInstance().evaluate(
+                    selfPath, inventory, isManagersHealth);
+            health = health_rollup::toString(selfHealth);
+            rollup = health_rollup::toString(selfRollup);
+            return;
+        }
+#endif
+
+        // Inventory that is not Functional counts as critical, at the item
+        for (const std::string& path : nonfunctional)
+        {
+            bool isSelf =
+                selfPath && (path == *selfPath ||
+                             boost::starts_with(path, *selfPath + "/"));
+            bool isChild = isManagersHealth;
+            for (const std::string& child : inventory)
+            {
+                if (boost::starts_with(path, child))
+                {
+                    isChild = true;
+                    break;
+                }
+            }
+            if (!isSelf && !isChild)
+            {
+                continue;
+            }
+            rollup = "Critical";
+            if (isSelf || boost::starts_with(path, globalInventoryPath))
+            {
+                health = "Critical";
+                return;
+            }
         }
 
         for (const auto& [path, interfaces] : statuses)
@@ -172,14 +216,25 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
             return;
         }
         populated = true;
+#ifdef BMCWEB_ENABLE_REDFISH_HEALTH_ROLLUP
+        if (health_rollup::Rollup::getInstance().ready())
+        {
+            resident = true;
+            return;
+        }
+#endif
         getAllStatusAssociations();
         getGlobalPath();
+        getNonfunctional();
     }
 
     void getGlobalPath()
     {
         std::shared_ptr<HealthPopulate> self = shared_from_this();
-        crow::connections::systemBus->async_method_call(
+        dbus::utility::getSubTreePaths(
+            "/", 0,
+            std::array<const char*, 1>{
+                "xyz.openbmc_project.Inventory.Item.Global"},
             [self](const boost::system::error_code ec,
                    std::vector<std::string>& resp) {
                 if (ec || resp.size() != 1)
@@ -188,38 +243,67 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
                     return;
                 }
                 self->globalInventoryPath = std::move(resp[0]);
-            },
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths", "/", 0,
+            });
+    }
+
+    void getNonfunctional()
+    {
+        std::shared_ptr<HealthPopulate> self = shared_from_this();
+        dbus::utility::getSubTree(
+            health_rollup::inventoryPath, 0,
             std::array<const char*, 1>{
-                "xyz.openbmc_project.Inventory.Item.Global"});
+                health_rollup::operationalStatusInterface},
+            [self](const boost::system::error_code ec,
+                   const crow::mapper_mirror::GetSubTreeType& subtree) {
+                if (ec)
+                {
+                    return;
+                }
+                for (const auto& [path, object] : subtree)
+                {
+                    for (const auto& [service, interfaces] : object)
+                    {
+                        crow::connections::systemBus->async_method_call(
+                            [self, path{path}](
+                                const boost::system::error_code ec2,
+                                const dbus::utility::DbusVariantType& value) {
+                                const bool* functional =
+                                    std::get_if<bool>(&value);
+                                if (ec2 || functional == nullptr ||
+                                    *functional)
+                                {
+                                    return;
+                                }
+                                self->nonfunctional.emplace_back(path);
+                            },
+                            service, path, "org.freedesktop.DBus.Properties",
+                            "Get", health_rollup::operationalStatusInterface,
+                            "Functional");
+                    }
+                }
+            });
     }
 
     void getAllStatusAssociations()
     {
         std::shared_ptr<HealthPopulate> self = shared_from_this();
-        crow::connections::systemBus->async_method_call(
+        crow::getManagedObjects(
+            "xyz.openbmc_project.ObjectMapper", "/",
             [self](const boost::system::error_code ec,
-                   dbus::utility::ManagedObjectType& resp) {
+                   const dbus::utility::ManagedObjectType& resp) {
                 if (ec)
                 {
                     return;
                 }
-                for (auto it = resp.begin(); it != resp.end();)
+                for (const auto& object : resp)
                 {
-                    if (boost::ends_with(it->first.str, "critical") ||
-                        boost::ends_with(it->first.str, "warning"))
+                    if (boost::ends_with(object.first.str, "critical") ||
+                        boost::ends_with(object.first.str, "warning"))
                     {
-                        it++;
-                        continue;
+                        self->statuses.emplace_back(object);
                     }
-                    it = resp.erase(it);
                 }
-                self->statuses = std::move(resp);
-            },
-            "xyz.openbmc_project.ObjectMapper", "/",
-            "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+            });
     }
 
     std::shared_ptr<bmcweb::AsyncResp> asyncResp;
@@ -237,7 +321,12 @@ struct HealthPopulate : std::enable_shared_from_this<HealthPopulate>
     std::vector<std::string> inventory;
     bool isManagersHealth = false;
     dbus::utility::ManagedObjectType statuses;
+    // Inventory items whose OperationalStatus is not Functional
+    std::vector<std::string> nonfunctional;
     std::string globalInventoryPath = "-"; // default to illegal dbus path
     bool populated = false;
+    // Whether health is taken from the resident health rollup rather than
+    // from statuses
+    bool resident = false;
 };
 } // namespace redfish
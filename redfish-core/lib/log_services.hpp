@@ -20,6 +20,7 @@
 #include "registries/openbmc_message_registry.hpp"
 #include "task.hpp"
 
+#include <sys/stat.h>
 #include <systemd/sd-journal.h>
 #include <unistd.h>
 
@@ -30,12 +31,22 @@
 #include <boost/beast/http.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/system/linux_error.hpp>
+#include <coroutine_handler.hpp>
+#include <dbus_utility.hpp>
 #include <error_messages.hpp>
+#include <event_log_index.hpp>
+#include <managed_objects_cache.hpp>
 #include <registries/privilege_registry.hpp>
+#include <utils/collection.hpp>
+#include <utils/query_param.hpp>
+#include <worker_thread.hpp>
 
+#include <charconv>
 #include <filesystem>
+#include <fstream>
 #include <optional>
 #include <string_view>
+#include <unordered_map>
 #include <variant>
 
 namespace redfish
@@ -183,66 +194,61 @@ inline static bool getEntryTimestamp(sd_journal* journal,
     return true;
 }
 
-static bool getSkipParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
-                         const crow::Request& req, uint64_t& skip)
+static constexpr const uint64_t maxEntriesPerPage = 1000;
+
+// Reads a number, followed by separator unless it ends position, off the
+// front of position
+inline static bool readPositionNumber(std::string_view& position,
+                                      char separator, uint64_t& value)
 {
-    boost::urls::url_view::params_type::iterator it =
-        req.urlParams.find("$skip");
-    if (it != req.urlParams.end())
+    size_t end = position.find(separator);
+    std::string_view number = position.substr(0, end);
+    const char* numberEnd = number.data() + number.size();
+    auto [ptr, ec] = std::from_chars(number.data(), numberEnd, value);
+    if (number.empty() || ec != std::errc() || ptr != numberEnd)
     {
-        std::string skipParam = it->value();
-        char* ptr = nullptr;
-        skip = std::strtoul(skipParam.c_str(), &ptr, 10);
-        if (skipParam.empty() || *ptr != '\0')
-        {
-
-            messages::queryParameterValueTypeError(
-                asyncResp->res, std::string(skipParam), "$skip");
-            return false;
-        }
+        return false;
     }
+    position.remove_prefix(end == std::string_view::npos ? position.size()
+                                                         : end + 1);
     return true;
 }
 
-static constexpr const uint64_t maxEntriesPerPage = 1000;
-static bool getTopParam(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
-                        const crow::Request& req, uint64_t& top)
+/**
+ * @brief Where a page of a log collection ended, as kept in its $skiptoken:
+ * how many members came before the end, the state for numbering the entries
+ * after it, and where in the log it is.
+ */
+struct LogPosition
 {
-    boost::urls::url_view::params_type::iterator it =
-        req.urlParams.find("$top");
-    if (it != req.urlParams.end())
+    uint64_t count = 0;
+    EntryIDState ids;
+    // A file inode and offset, or a journal cursor
+    std::string where;
+
+    std::string encode() const
     {
-        std::string topParam = it->value();
-        char* ptr = nullptr;
-        top = std::strtoul(topParam.c_str(), &ptr, 10);
-        if (topParam.empty() || *ptr != '\0')
-        {
-            messages::queryParameterValueTypeError(
-                asyncResp->res, std::string(topParam), "$top");
-            return false;
-        }
-        if (top < 1U || top > maxEntriesPerPage)
-        {
+        return std::to_string(count) + ',' + std::to_string(ids.prevTs) + ',' +
+               std::to_string(ids.index) + ',' + where;
+    }
 
-            messages::queryParameterOutOfRange(
-                asyncResp->res, std::to_string(top), "$top",
-                "1-" + std::to_string(maxEntriesPerPage));
+    bool decode(std::string_view position)
+    {
+        if (!readPositionNumber(position, ',', count) ||
+            !readPositionNumber(position, ',', ids.prevTs) ||
+            !readPositionNumber(position, ',', ids.index) || position.empty())
+        {
             return false;
         }
+        where = position;
+        return true;
     }
-    return true;
-}
+};
 
 inline static bool getUniqueEntryID(sd_journal* journal, std::string& entryID,
-                                    const bool firstEntry = true)
+                                    EntryIDState& state)
 {
     int ret = 0;
-    static uint64_t prevTs = 0;
-    static int index = 0;
-    if (firstEntry)
-    {
-        prevTs = 0;
-    }
 
     // Get the entry timestamp
     uint64_t curTs = 0;
@@ -254,61 +260,22 @@ inline static bool getUniqueEntryID(sd_journal* journal, std::string& entryID,
         return false;
     }
     // If the timestamp isn't unique, increment the index
-    if (curTs == prevTs)
+    if (curTs == state.prevTs)
     {
-        index++;
+        state.index++;
     }
     else
     {
         // Otherwise, reset it
-        index = 0;
+        state.index = 0;
     }
     // Save the timestamp
-    prevTs = curTs;
+    state.prevTs = curTs;
 
     entryID = std::to_string(curTs);
-    if (index > 0)
+    if (state.index > 0)
     {
-        entryID += "_" + std::to_string(index);
-    }
-    return true;
-}
-
-static bool getUniqueEntryID(const std::string& logEntry, std::string& entryID,
-                             const bool firstEntry = true)
-{
-    static time_t prevTs = 0;
-    static int index = 0;
-    if (firstEntry)
-    {
-        prevTs = 0;
-    }
-
-    // Get the entry timestamp
-    std::time_t curTs = 0;
-    std::tm timeStruct = {};
-    std::istringstream entryStream(logEntry);
-    if (entryStream >> std::get_time(&timeStruct, "%Y-%m-%dT%H:%M:%S"))
-    {
-        curTs = std::mktime(&timeStruct);
-    }
-    // If the timestamp isn't unique, increment the index
-    if (curTs == prevTs)
-    {
-        index++;
-    }
-    else
-    {
-        // Otherwise, reset it
-        index = 0;
-    }
-    // Save the timestamp
-    prevTs = curTs;
-
-    entryID = std::to_string(curTs);
-    if (index > 0)
-    {
-        entryID += "_" + std::to_string(index);
+        entryID += "_" + std::to_string(state.index);
     }
     return true;
 }
@@ -377,31 +344,6 @@ inline static bool
     return true;
 }
 
-static bool
-    getRedfishLogFiles(std::vector<std::filesystem::path>& redfishLogFiles)
-{
-    static const std::filesystem::path redfishLogDir = "/var/log";
-    static const std::string redfishLogFilename = "redfish";
-
-    // Loop through the directory looking for redfish log files
-    for (const std::filesystem::directory_entry& dirEnt :
-         std::filesystem::directory_iterator(redfishLogDir))
-    {
-        // If we find a redfish log file, save the path
-        std::string filename = dirEnt.path().filename();
-        if (boost::starts_with(filename, redfishLogFilename))
-        {
-            redfishLogFiles.emplace_back(redfishLogDir / filename);
-        }
-    }
-    // As the log files rotate, they are appended with a ".#" that is higher for
-    // the older logs. Since we don't expect more than 10 log files, we
-    // can just sort the list to get them in order from newest to oldest
-    std::sort(redfishLogFiles.begin(), redfishLogFiles.end());
-
-    return !redfishLogFiles.empty();
-}
-
 inline void
     getDumpEntryCollection(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                            const std::string& dumpType)
@@ -1147,6 +1089,114 @@ static int fillEventLogEntryJson(const std::string& logEntryID,
     return 0;
 }
 
+/**
+ * @brief Evaluates filter on an event log entry as far as the properties that
+ * are cheap to get allow: those read straight off the start of the log line,
+ * plus the Severity of its message.  Only when that leaves the result Unknown
+ * does the whole entry need building.
+ */
+static filter::Result filterEventLogEntry(const filter::Filter& filter,
+                                          const std::string& logEntryID,
+                                          const std::string& logEntry)
+{
+    static const std::vector<std::string_view> known = {
+        "Id", "Created", "MessageId", "Severity", "EntryType"};
+    size_t space = logEntry.find_first_of(' ');
+    if (space == std::string::npos)
+    {
+        return filter::Result::Unknown;
+    }
+    std::string timestamp = logEntry.substr(0, space);
+    size_t entryStart = logEntry.find_first_not_of(' ', space);
+    if (entryStart == std::string::npos)
+    {
+        return filter::Result::Unknown;
+    }
+    size_t comma = logEntry.find(',', entryStart);
+    std::string messageID = logEntry.substr(
+        entryStart,
+        comma == std::string::npos ? std::string::npos : comma - entryStart);
+    const message_registries::Message* message =
+        message_registries::getMessage(messageID);
+    std::string severity;
+    if (message != nullptr)
+    {
+        severity = message->severity;
+    }
+    // As fillEventLogEntryJson, drop the fractional seconds
+    std::size_t dot = timestamp.find_first_of('.');
+    std::size_t plus = timestamp.find_first_of('+');
+    if (dot != std::string::npos && plus != std::string::npos)
+    {
+        timestamp.erase(dot, plus - dot);
+    }
+
+    nlohmann::json summary = {{"Id", logEntryID},
+                              {"Created", std::move(timestamp)},
+                              {"MessageId", std::move(messageID)},
+                              {"Severity", std::move(severity)},
+                              {"EntryType", "Event"}};
+    return filter.evaluate(summary, known);
+}
+
+/**
+ * @brief Fills a page of the event log entry collection from the index,
+ * reading only the lines on the page.
+ * @param start  The inode and offset the previous page ended at, if any
+ */
+inline void
+    fillEventLogPage(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                     const collection_util::Page& page,
+                     std::optional<std::pair<uint64_t, uint64_t>> start)
+{
+    EventLogIndex& index = EventLogIndex::getInstance();
+    index.refresh();
+    uint64_t total = index.size();
+    uint64_t first = 0;
+    if (start)
+    {
+        // As when reading the files, a page that ended in entries since
+        // rotated away carries on from the oldest entry left
+        first = index.find(start->first, start->second).value_or(0);
+    }
+    first = std::min(total, first + std::min(page.skip, total));
+    uint64_t count = std::min(page.top, total - first);
+
+    nlohmann::json& logEntryArray = asyncResp->res.jsonValue["Members"];
+    std::optional<LogPosition> end;
+    bool ok = index.forEach(
+        first, count,
+        [&logEntryArray, &end, last{first + count}](
+            const EventLogIndex::File& file, const EventLogIndex::Entry& entry,
+            const std::string& logEntry, uint64_t next) {
+            nlohmann::json bmcLogEntry;
+            if (fillEventLogEntryJson(EventLogIndex::idString(entry.id),
+                                      logEntry, bmcLogEntry) != 0)
+            {
+                return;
+            }
+            logEntryArray.push_back(std::move(bmcLogEntry));
+            end.emplace();
+            end->count = last;
+            end->ids = entry.id;
+            end->where =
+                std::to_string(file.inode) + ':' + std::to_string(next);
+        });
+    if (!ok || logEntryArray.size() != count)
+    {
+        messages::internalError(asyncResp->res);
+        return;
+    }
+    asyncResp->res.jsonValue["Members@odata.count"] = total;
+    if (end && end->count < total)
+    {
+        collection_util::setNextLink(
+            asyncResp->res,
+            "/redfish/v1/Systems/system/LogServices/EventLog/Entries", page,
+            end->encode());
+    }
+}
+
 inline void requestRoutesJournalEventLogEntryCollection(App& app)
 {
     BMCWEB_ROUTE(app,
@@ -1155,15 +1205,33 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
         .methods(boost::beast::http::verb::get)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
-                uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res,
+                                             maxEntriesPerPage,
+                                             maxEntriesPerPage);
+                if (!page)
                 {
                     return;
                 }
-                if (!getTopParam(asyncResp, req, top))
+                // A page ends at an offset into a log file, which keeps its
+                // inode as it is rotated
+                LogPosition start;
+                uint64_t startInode = 0;
+                uint64_t startOffset = 0;
+                if (!page->position.empty())
                 {
-                    return;
+                    std::string_view where;
+                    if (start.decode(page->position))
+                    {
+                        where = start.where;
+                    }
+                    if (!readPositionNumber(where, ':', startInode) ||
+                        !readPositionNumber(where, ':', startOffset) ||
+                        !where.empty())
+                    {
+                        collection_util::badPosition(asyncResp->res, *page);
+                        return;
+                    }
                 }
                 // Collections don't include the static data added by SubRoute
                 // because it has a duplicate entry for members
@@ -1178,15 +1246,60 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
                 nlohmann::json& logEntryArray =
                     asyncResp->res.jsonValue["Members"];
                 logEntryArray = nlohmann::json::array();
+                // Entries the filter rules out don't count towards $skip and
+                // $top
+                const filter::Filter* entryFilter = nullptr;
+                if (req.query != nullptr && req.query->filter)
+                {
+                    entryFilter = &*req.query->filter;
+                }
+#ifdef BMCWEB_ENABLE_REDFISH_EVENT_LOG_INDEX
+                // A filtered page still has to look at every entry
+                if (entryFilter == nullptr)
+                {
+                    std::optional<std::pair<uint64_t, uint64_t>> position;
+                    if (!page->position.empty())
+                    {
+                        position.emplace(startInode, startOffset);
+                    }
+                    fillEventLogPage(asyncResp, *page, position);
+                    return;
+                }
+#endif
                 // Go through the log files and create a unique ID for each
                 // entry
                 std::vector<std::filesystem::path> redfishLogFiles;
                 getRedfishLogFiles(redfishLogFiles);
-                uint64_t entryCount = 0;
                 std::string logEntry;
 
                 // Oldest logs are in the last file, so start there and loop
-                // backwards
+                // backwards.  A page resumes in the file the previous one
+                // ended in; if that has been rotated away, so have all the
+                // entries before those left, and it starts from the oldest.
+                auto resume = redfishLogFiles.rend();
+                for (auto file = redfishLogFiles.rbegin();
+                     startOffset != 0 && file < redfishLogFiles.rend(); file++)
+                {
+                    struct stat st = {};
+                    if (stat(file->c_str(), &st) == 0 &&
+                        st.st_ino == startInode &&
+                        startOffset <= static_cast<uint64_t>(st.st_size))
+                    {
+                        resume = file;
+                        break;
+                    }
+                }
+                bool started = resume == redfishLogFiles.rend();
+
+                // Members up to the end of the page, then up to the end of
+                // the log.  Without the index, the count takes reading the
+                // rest of the log, although lines past the page are only
+                // parsed when the filter needs them.  The entries before the
+                // page are read again too, rather than taking the count and
+                // the IDs in the $skiptoken on trust.
+                uint64_t entryCount = 0;
+                uint64_t skipped = 0;
+                std::optional<LogPosition> end;
                 for (auto it = redfishLogFiles.rbegin();
                      it < redfishLogFiles.rend(); it++)
                 {
@@ -1197,46 +1310,116 @@ inline void requestRoutesJournalEventLogEntryCollection(App& app)
                     }
 
                     // Reset the unique ID on the first entry
-                    bool firstEntry = true;
-                    while (std::getline(logStream, logEntry))
+                    EntryIDState ids;
+                    uint64_t offset = 0;
+                    while (true)
                     {
-                        entryCount++;
-                        // Handle paging using skip (number of entries to skip
-                        // from the start) and top (number of entries to
-                        // display)
-                        if (entryCount <= skip || entryCount > skip + top)
+                        if (!started && it == resume && offset >= startOffset)
+                        {
+                            // The page before ended at the start of a line,
+                            // after the entry its IDs carry on from
+                            if (offset != startOffset ||
+                                ids.prevTs != start.ids.prevTs ||
+                                ids.index != start.ids.index)
+                            {
+                                collection_util::badPosition(asyncResp->res,
+                                                             *page);
+                                return;
+                            }
+                            started = true;
+                        }
+                        if (!std::getline(logStream, logEntry))
+                        {
+                            break;
+                        }
+                        offset += logEntry.size() + 1;
+                        if (end && entryFilter == nullptr)
                         {
+                            entryCount++;
                             continue;
                         }
 
                         std::string idStr;
-                        if (!getUniqueEntryID(logEntry, idStr, firstEntry))
+                        getUniqueEntryID(logEntry, idStr, ids);
+                        nlohmann::json bmcLogEntry;
+                        if (entryFilter != nullptr)
+                        {
+                            filter::Result result = filterEventLogEntry(
+                                *entryFilter, idStr, logEntry);
+                            if (result == filter::Result::Unknown)
+                            {
+                                if (fillEventLogEntryJson(idStr, logEntry,
+                                                          bmcLogEntry) != 0)
+                                {
+                                    messages::internalError(asyncResp->res);
+                                    return;
+                                }
+                                result = entryFilter->matches(bmcLogEntry)
+                                             ? filter::Result::True
+                                             : filter::Result::False;
+                            }
+                            if (result == filter::Result::False)
+                            {
+                                continue;
+                            }
+                        }
+                        entryCount++;
+                        if (end || !started)
                         {
                             continue;
                         }
-
-                        if (firstEntry)
+                        if (skipped < page->skip)
                         {
-                            firstEntry = false;
+                            skipped++;
+                            continue;
                         }
 
-                        logEntryArray.push_back({});
-                        nlohmann::json& bmcLogEntry = logEntryArray.back();
-                        if (fillEventLogEntryJson(idStr, logEntry,
+                        if (bmcLogEntry.is_null() &&
+                            fillEventLogEntryJson(idStr, logEntry,
                                                   bmcLogEntry) != 0)
                         {
                             messages::internalError(asyncResp->res);
                             return;
                         }
+                        logEntryArray.push_back(std::move(bmcLogEntry));
+                        if (logEntryArray.size() < page->top)
+                        {
+                            continue;
+                        }
+
+                        struct stat st = {};
+                        if (stat(it->c_str(), &st) != 0)
+                        {
+                            messages::internalError(asyncResp->res);
+                            return;
+                        }
+                        // Past the last line if that has no newline
+                        std::streamoff next = logStream.tellg();
+                        if (next < 0)
+                        {
+                            next = st.st_size;
+                        }
+                        end.emplace();
+                        end->count = entryCount;
+                        end->ids = ids;
+                        end->where = std::to_string(st.st_ino) + ':' +
+                                     std::to_string(next);
                     }
                 }
+                if (!started)
+                {
+                    // The file was cut short since it was found
+                    collection_util::badPosition(asyncResp->res, *page);
+                    return;
+                }
                 asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
-                if (skip + top < entryCount)
+                if (end && end->count < entryCount)
                 {
-                    asyncResp->res.jsonValue["Members@odata.nextLink"] =
+                    collection_util::setNextLink(
+                        asyncResp->res,
                         "/redfish/v1/Systems/system/LogServices/EventLog/"
-                        "Entries?$skip=" +
-                        std::to_string(skip + top);
+                        "Entries",
+                        *page, end->encode());
                 }
             });
 }
@@ -1252,6 +1435,31 @@ inline void requestRoutesJournalEventLogEntry(App& app)
                const std::string& param) {
                 const std::string& targetID = param;
 
+#ifdef BMCWEB_ENABLE_REDFISH_EVENT_LOG_INDEX
+                EventLogIndex& index = EventLogIndex::getInstance();
+                index.refresh();
+                std::optional<uint64_t> ordinal = index.find(targetID);
+                if (!ordinal)
+                {
+                    messages::resourceMissingAtURI(asyncResp->res, targetID);
+                    return;
+                }
+                bool filled = false;
+                bool ok = index.forEach(
+                    *ordinal, 1,
+                    [&asyncResp, &targetID,
+                     &filled](const EventLogIndex::File&,
+                              const EventLogIndex::Entry&,
+                              const std::string& logEntry, uint64_t) {
+                        filled = fillEventLogEntryJson(
+                                     targetID, logEntry,
+                                     asyncResp->res.jsonValue) == 0;
+                    });
+                if (!ok || !filled)
+                {
+                    messages::internalError(asyncResp->res);
+                }
+#else
                 // Go through the log files and check the unique ID for each
                 // entry to find the target entry
                 std::vector<std::filesystem::path> redfishLogFiles;
@@ -1270,20 +1478,15 @@ inline void requestRoutesJournalEventLogEntry(App& app)
                     }
 
                     // Reset the unique ID on the first entry
-                    bool firstEntry = true;
+                    EntryIDState ids;
                     while (std::getline(logStream, logEntry))
                     {
                         std::string idStr;
-                        if (!getUniqueEntryID(logEntry, idStr, firstEntry))
+                        if (!getUniqueEntryID(logEntry, idStr, ids))
                         {
                             continue;
                         }
 
-                        if (firstEntry)
-                        {
-                            firstEntry = false;
-                        }
-
                         if (idStr == targetID)
                         {
                             if (fillEventLogEntryJson(
@@ -1299,6 +1502,7 @@ inline void requestRoutesJournalEventLogEntry(App& app)
                 }
                 // Requested ID was not found
                 messages::resourceMissingAtURI(asyncResp->res, targetID);
+#endif
             });
 }
 
@@ -1323,9 +1527,10 @@ inline void requestRoutesDBusEventLogEntryCollection(App& app)
 
             // DBus implementation of EventLog/Entries
             // Make call to Logging Service to find all log entry objects
-            crow::connections::systemBus->async_method_call(
+            crow::getManagedObjects(
+                "xyz.openbmc_project.Logging", "/xyz/openbmc_project/logging",
                 [asyncResp](const boost::system::error_code ec,
-                            GetManagedObjectsType& resp) {
+                            const dbus::utility::ManagedObjectType& resp) {
                     if (ec)
                     {
                         // TODO Handle for specific error code
@@ -1338,21 +1543,22 @@ inline void requestRoutesDBusEventLogEntryCollection(App& app)
                     nlohmann::json& entriesArray =
                         asyncResp->res.jsonValue["Members"];
                     entriesArray = nlohmann::json::array();
-                    for (auto& objectPath : resp)
+                    for (const auto& objectPath : resp)
                     {
-                        uint32_t* id = nullptr;
+                        const uint32_t* id = nullptr;
                         std::time_t timestamp{};
                         std::time_t updateTimestamp{};
-                        std::string* severity = nullptr;
-                        std::string* message = nullptr;
-                        std::string* filePath = nullptr;
+                        const std::string* severity = nullptr;
+                        const std::string* message = nullptr;
+                        const std::string* filePath = nullptr;
                         bool resolved = false;
-                        for (auto& interfaceMap : objectPath.second)
+                        for (const auto& interfaceMap : objectPath.second)
                         {
                             if (interfaceMap.first ==
                                 "xyz.openbmc_project.Logging.Entry")
                             {
-                                for (auto& propertyMap : interfaceMap.second)
+                                for (const auto& propertyMap :
+                                     interfaceMap.second)
                                 {
                                     if (propertyMap.first == "Id")
                                     {
@@ -1396,8 +1602,9 @@ inline void requestRoutesDBusEventLogEntryCollection(App& app)
                                     }
                                     else if (propertyMap.first == "Resolved")
                                     {
-                                        bool* resolveptr = std::get_if<bool>(
-                                            &propertyMap.second);
+                                        const bool* resolveptr =
+                                            std::get_if<bool>(
+                                                &propertyMap.second);
                                         if (resolveptr == nullptr)
                                         {
                                             messages::internalError(
@@ -1417,7 +1624,8 @@ inline void requestRoutesDBusEventLogEntryCollection(App& app)
                             else if (interfaceMap.first ==
                                      "xyz.openbmc_project.Common.FilePath")
                             {
-                                for (auto& propertyMap : interfaceMap.second)
+                                for (const auto& propertyMap :
+                                     interfaceMap.second)
                                 {
                                     if (propertyMap.first == "Path")
                                     {
@@ -1469,9 +1677,7 @@ inline void requestRoutesDBusEventLogEntryCollection(App& app)
                               });
                     asyncResp->res.jsonValue["Members@odata.count"] =
                         entriesArray.size();
-                },
-                "xyz.openbmc_project.Logging", "/xyz/openbmc_project/logging",
-                "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+                });
         });
 }
 
@@ -1929,6 +2135,270 @@ static int fillBMCJournalLogEntryJson(const std::string& bmcJournalLogEntryID,
     return 0;
 }
 
+inline static bool getJournalCursor(sd_journal* journal, std::string& cursor)
+{
+    char* cursorTmp = nullptr;
+    int ret = sd_journal_get_cursor(journal, &cursorTmp);
+    if (ret < 0)
+    {
+        BMCWEB_LOG_ERROR << "failed to read journal cursor: "
+                         << strerror(-ret);
+        return false;
+    }
+    cursor = cursorTmp;
+    free(cursorTmp);
+    return true;
+}
+
+/**
+ * @brief The number of entries in the journal, kept between requests so that
+ * each only has to count the entries appended since the one before.  It is
+ * counted over when the first entry changes, as after a vacuum, or when the
+ * last entry counted is gone.  Only used on the thread that reads the journal:
+ * the worker thread if there is one, the io thread otherwise.
+ */
+class JournalCount
+{
+  public:
+    static JournalCount& getInstance()
+    {
+        static JournalCount journalCount;
+        return journalCount;
+    }
+
+    JournalCount(const JournalCount&) = delete;
+    JournalCount& operator=(const JournalCount&) = delete;
+    JournalCount(JournalCount&&) = delete;
+    JournalCount& operator=(JournalCount&&) = delete;
+
+    // Returns std::nullopt if the journal can't be read.  Leaves journal at
+    // an arbitrary entry.
+    std::optional<uint64_t> update(sd_journal* journal)
+    {
+        if (sd_journal_seek_head(journal) < 0)
+        {
+            return std::nullopt;
+        }
+        if (sd_journal_next(journal) <= 0)
+        {
+            count = 0;
+            head.clear();
+            tail.clear();
+            return count;
+        }
+        bool resume =
+            !head.empty() && sd_journal_test_cursor(journal, head.c_str()) > 0;
+        if (!resume && !getJournalCursor(journal, head))
+        {
+            return std::nullopt;
+        }
+        if (resume)
+        {
+            // Step onto the last entry counted
+            resume = sd_journal_seek_cursor(journal, tail.c_str()) >= 0 &&
+                     sd_journal_next(journal) > 0 &&
+                     sd_journal_test_cursor(journal, tail.c_str()) > 0;
+        }
+        if (!resume)
+        {
+            BMCWEB_LOG_DEBUG << "Counting the journal from its start";
+            count = 0;
+            if (sd_journal_seek_head(journal) < 0)
+            {
+                return std::nullopt;
+            }
+        }
+        while (sd_journal_next(journal) > 0)
+        {
+            count++;
+        }
+        // A next() past the end leaves the journal on the last entry
+        if (!getJournalCursor(journal, tail))
+        {
+            head.clear();
+            return std::nullopt;
+        }
+        return count;
+    }
+
+  private:
+    JournalCount() = default;
+    ~JournalCount() = default;
+
+    uint64_t count = 0;
+    // Cursors of the first entry and of the last one counted
+    std::string head;
+    std::string tail;
+};
+
+// A page of the BMC journal, read on the worker thread
+struct BMCJournalPage
+{
+    uint64_t skip = 0;
+    uint64_t top = 0;
+    LogPosition start;
+
+    nlohmann::json members = nlohmann::json::array();
+    uint64_t count = 0;
+    // Where the page ended, if more entries follow it
+    std::optional<LogPosition> end;
+    bool badPosition = false;
+    bool failed = false;
+};
+
+/**
+ * @brief Reads the members of a page of the BMC journal, from the cursor the
+ * page before ended at, and stops at the end of the page.  The member count
+ * comes from JournalCount rather than from reading to the end.
+ */
+inline void readBMCJournalPage(BMCJournalPage& page)
+{
+    sd_journal* journalTmp = nullptr;
+    int ret = sd_journal_open(&journalTmp, SD_JOURNAL_LOCAL_ONLY);
+    if (ret < 0)
+    {
+        BMCWEB_LOG_ERROR << "failed to open journal: " << strerror(-ret);
+        page.failed = true;
+        return;
+    }
+    std::unique_ptr<sd_journal, decltype(&sd_journal_close)> journal(
+        journalTmp, sd_journal_close);
+    journalTmp = nullptr;
+
+    std::optional<uint64_t> count =
+        JournalCount::getInstance().update(journal.get());
+    if (!count)
+    {
+        page.failed = true;
+        return;
+    }
+
+    if (page.start.where.empty())
+    {
+        ret = sd_journal_seek_head(journal.get());
+    }
+    else
+    {
+        ret = sd_journal_seek_cursor(journal.get(), page.start.where.c_str());
+        if (ret < 0)
+        {
+            page.badPosition = true;
+            return;
+        }
+        // Step onto the entry the previous page ended at.  If it has been
+        // vacuumed, the journal lands on the next one instead, which still
+        // has to be returned.
+        if (sd_journal_next(journal.get()) > 0 &&
+            sd_journal_test_cursor(journal.get(),
+                                   page.start.where.c_str()) <= 0)
+        {
+            sd_journal_previous(journal.get());
+        }
+    }
+    if (ret < 0)
+    {
+        page.failed = true;
+        return;
+    }
+
+    EntryIDState ids = page.start.ids;
+    uint64_t position = page.start.count;
+    uint64_t skipped = 0;
+    while (sd_journal_next(journal.get()) > 0)
+    {
+        position++;
+        std::string idStr;
+        if (!getUniqueEntryID(journal.get(), idStr, ids))
+        {
+            continue;
+        }
+        if (skipped < page.skip)
+        {
+            skipped++;
+            continue;
+        }
+
+        page.members.push_back({});
+        if (fillBMCJournalLogEntryJson(idStr, journal.get(),
+                                       page.members.back()) != 0)
+        {
+            page.failed = true;
+            return;
+        }
+        if (page.members.size() < page.top)
+        {
+            continue;
+        }
+
+        LogPosition end;
+        end.count = position;
+        end.ids = ids;
+        if (!getJournalCursor(journal.get(), end.where))
+        {
+            page.failed = true;
+            return;
+        }
+        if (sd_journal_next(journal.get()) > 0)
+        {
+            page.end = std::move(end);
+        }
+        break;
+    }
+    // Entries appended since the count was taken may already be on the page
+    page.count = std::max(*count, page.end ? position + 1 : position);
+}
+
+// Fills asyncResp with a page of the BMC journal that has been read
+inline void
+    fillBMCJournalPageJson(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                           const collection_util::Page& page,
+                           BMCJournalPage& journalPage)
+{
+    if (journalPage.badPosition)
+    {
+        collection_util::badPosition(asyncResp->res, page);
+        return;
+    }
+    if (journalPage.failed)
+    {
+        messages::internalError(asyncResp->res);
+        return;
+    }
+    asyncResp->res.jsonValue["Members"] = std::move(journalPage.members);
+    asyncResp->res.jsonValue["Members@odata.count"] = journalPage.count;
+    if (journalPage.end)
+    {
+        collection_util::setNextLink(
+            asyncResp->res,
+            "/redfish/v1/Managers/bmc/LogServices/Journal/Entries", page,
+            journalPage.end->encode());
+    }
+}
+
+#ifdef BMCWEB_ENABLE_REDFISH_JOURNAL_WORKER
+/**
+ * @brief Fills asyncResp with a page of the BMC journal, read on the worker
+ * thread.
+ *
+ * @param start  Where the previous page ended, if anywhere
+ */
+inline void
+    fillBMCJournalPage(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                       const collection_util::Page& page,
+                       const LogPosition& start)
+{
+    auto journalPage = std::make_shared<BMCJournalPage>();
+    journalPage->skip = page.skip;
+    journalPage->top = page.top;
+    journalPage->start = start;
+    crow::worker_thread::Worker::getInstance().post(
+        [journalPage]() { readBMCJournalPage(*journalPage); },
+        [asyncResp, page, journalPage]() {
+            fillBMCJournalPageJson(asyncResp, page, *journalPage);
+        });
+}
+#endif
+
 inline void requestRoutesBMCJournalLogEntryCollection(App& app)
 {
     BMCWEB_ROUTE(app, "/redfish/v1/Managers/bmc/LogServices/Journal/Entries/")
@@ -1936,15 +2406,19 @@ inline void requestRoutesBMCJournalLogEntryCollection(App& app)
         .methods(boost::beast::http::verb::get)(
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
-                static constexpr const long maxEntriesPerPage = 1000;
-                uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res,
+                                             maxEntriesPerPage,
+                                             maxEntriesPerPage);
+                if (!page)
                 {
                     return;
                 }
-                if (!getTopParam(asyncResp, req, top))
+                // A page ends at a journal cursor
+                LogPosition start;
+                if (!page->position.empty() && !start.decode(page->position))
                 {
+                    collection_util::badPosition(asyncResp->res, *page);
                     return;
                 }
                 // Collections don't include the static data added by SubRoute
@@ -1959,62 +2433,18 @@ inline void requestRoutesBMCJournalLogEntryCollection(App& app)
                 nlohmann::json& logEntryArray =
                     asyncResp->res.jsonValue["Members"];
                 logEntryArray = nlohmann::json::array();
-
-                // Go through the journal and use the timestamp to create a
-                // unique ID for each entry
-                sd_journal* journalTmp = nullptr;
-                int ret = sd_journal_open(&journalTmp, SD_JOURNAL_LOCAL_ONLY);
-                if (ret < 0)
-                {
-                    BMCWEB_LOG_ERROR << "failed to open journal: "
-                                     << strerror(-ret);
-                    messages::internalError(asyncResp->res);
-                    return;
-                }
-                std::unique_ptr<sd_journal, decltype(&sd_journal_close)>
-                    journal(journalTmp, sd_journal_close);
-                journalTmp = nullptr;
-                uint64_t entryCount = 0;
-                // Reset the unique ID on the first entry
-                bool firstEntry = true;
-                SD_JOURNAL_FOREACH(journal.get())
-                {
-                    entryCount++;
-                    // Handle paging using skip (number of entries to skip from
-                    // the start) and top (number of entries to display)
-                    if (entryCount <= skip || entryCount > skip + top)
-                    {
-                        continue;
-                    }
-
-                    std::string idStr;
-                    if (!getUniqueEntryID(journal.get(), idStr, firstEntry))
-                    {
-                        continue;
-                    }
-
-                    if (firstEntry)
-                    {
-                        firstEntry = false;
-                    }
-
-                    logEntryArray.push_back({});
-                    nlohmann::json& bmcJournalLogEntry = logEntryArray.back();
-                    if (fillBMCJournalLogEntryJson(idStr, journal.get(),
-                                                   bmcJournalLogEntry) != 0)
-                    {
-                        messages::internalError(asyncResp->res);
-                        return;
-                    }
-                }
-                asyncResp->res.jsonValue["Members@odata.count"] = entryCount;
-                if (skip + top < entryCount)
-                {
-                    asyncResp->res.jsonValue["Members@odata.nextLink"] =
-                        "/redfish/v1/Managers/bmc/LogServices/Journal/"
-                        "Entries?$skip=" +
-                        std::to_string(skip + top);
-                }
+#ifdef BMCWEB_ENABLE_REDFISH_JOURNAL_WORKER
+                fillBMCJournalPage(asyncResp, *page, start);
+#else
+                // Reads up to the end of the page; the member count comes
+                // from JournalCount
+                BMCJournalPage journalPage;
+                journalPage.skip = page->skip;
+                journalPage.top = page->top;
+                journalPage.start = std::move(start);
+                readBMCJournalPage(journalPage);
+                fillBMCJournalPageJson(asyncResp, *page, journalPage);
+#endif
             });
 }
 
@@ -2050,7 +2480,7 @@ inline void requestRoutesBMCJournalLogEntry(App& app)
                 // Go to the timestamp in the log and move to the entry at the
                 // index tracking the unique ID
                 std::string idStr;
-                bool firstEntry = true;
+                EntryIDState ids;
                 ret = sd_journal_seek_realtime_usec(journal.get(), ts);
                 if (ret < 0)
                 {
@@ -2062,15 +2492,11 @@ inline void requestRoutesBMCJournalLogEntry(App& app)
                 for (uint64_t i = 0; i <= index; i++)
                 {
                     sd_journal_next(journal.get());
-                    if (!getUniqueEntryID(journal.get(), idStr, firstEntry))
+                    if (!getUniqueEntryID(journal.get(), idStr, ids))
                     {
                         messages::internalError(asyncResp->res);
                         return;
                     }
-                    if (firstEntry)
-                    {
-                        firstEntry = false;
-                    }
                 }
                 // Confirm that the entry ID matches what was requested
                 if (idStr != entryID)
@@ -2998,93 +3424,130 @@ static void getPostCodeForEntry(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
         bootIndex);
 }
 
-static void getPostCodeForBoot(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                               const uint16_t bootIndex,
-                               const uint16_t bootCount,
-                               const uint64_t entryCount, const uint64_t skip,
-                               const uint64_t top)
+// Boot cycles whose POST codes are read at the same time; each reply can be
+// large, and the PostCode daemon answers them one after another anyway
+constexpr size_t postCodeReadsInFlight = 4;
+
+/**
+ * @brief Lists the POST codes of every boot cycle, reading the boot cycles a
+ * few at a time and then paging through them in order.
+ */
+class PostCodeEntries : public crow::coroutine::Handler<PostCodeEntries>
 {
-    crow::connections::systemBus->async_method_call(
-        [aResp, bootIndex, bootCount, entryCount, skip,
-         top](const boost::system::error_code ec,
-              const boost::container::flat_map<
-                  uint64_t, std::tuple<uint64_t, std::vector<uint8_t>>>&
-                  postcode) {
+  public:
+    PostCodeEntries(const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn,
+                    const collection_util::Page& pageIn, uint64_t skipIn) :
+        Handler(asyncRespIn),
+        page(pageIn), skip(skipIn), top(pageIn.top)
+    {}
+
+    void operator()()
+    {
+        BOOST_ASIO_CORO_REENTER(this)
+        {
+            BOOST_ASIO_CORO_YIELD getProperty(
+                ec, bootCount, "xyz.openbmc_project.State.Boot.PostCode0",
+                "/xyz/openbmc_project/State/Boot/PostCode0",
+                "xyz.openbmc_project.State.Boot.PostCode",
+                "CurrentBootCycleCount");
             if (ec)
             {
-                BMCWEB_LOG_DEBUG << "DBUS POST CODE PostCode response error";
-                messages::internalError(aResp->res);
+                BMCWEB_LOG_DEBUG << "DBUS response error " << ec;
+                messages::internalError(asyncResp->res);
                 return;
             }
-
-            uint64_t endCount = entryCount;
-            if (!postcode.empty())
             {
-                endCount = entryCount + postcode.size();
-
-                if ((skip < endCount) && ((top + skip) > entryCount))
+                const uint16_t* count = std::get_if<uint16_t>(&bootCount);
+                if (count == nullptr)
                 {
-                    uint64_t thisBootSkip =
-                        std::max(skip, entryCount) - entryCount;
-                    uint64_t thisBootTop =
-                        std::min(top + skip, endCount) - entryCount;
-
-                    fillPostCodeEntry(aResp, postcode, bootIndex, 0,
-                                      thisBootSkip, thisBootTop);
+                    BMCWEB_LOG_DEBUG << "Post code boot index failed.";
+                    return;
                 }
-                aResp->res.jsonValue["Members@odata.count"] = endCount;
+                // The current boot cycle is read even if none is counted yet
+                boots.resize(std::max<uint16_t>(*count, 1));
             }
 
-            // continue to previous bootIndex
-            if (bootIndex < bootCount)
-            {
-                getPostCodeForBoot(aResp, static_cast<uint16_t>(bootIndex + 1),
-                                   bootCount, endCount, skip, top);
-            }
-            else
+            while (nextBoot < boots.size())
             {
-                aResp->res.jsonValue["Members@odata.nextLink"] =
-                    "/redfish/v1/Systems/system/LogServices/PostCodes/"
-                    "Entries?$skip=" +
-                    std::to_string(skip + top);
+                BOOST_ASIO_CORO_YIELD
+                {
+                    size_t end = std::min(nextBoot + postCodeReadsInFlight,
+                                          boots.size());
+                    for (; nextBoot < end; nextBoot++)
+                    {
+                        call(boots[nextBoot].ec, boots[nextBoot].postcode,
+                             "xyz.openbmc_project.State.Boot.PostCode0",
+                             "/xyz/openbmc_project/State/Boot/PostCode0",
+                             "xyz.openbmc_project.State.Boot.PostCode",
+                             "GetPostCodesWithTimeStamp",
+                             static_cast<uint16_t>(nextBoot + 1));
+                    }
+                }
             }
-        },
-        "xyz.openbmc_project.State.Boot.PostCode0",
-        "/xyz/openbmc_project/State/Boot/PostCode0",
-        "xyz.openbmc_project.State.Boot.PostCode", "GetPostCodesWithTimeStamp",
-        bootIndex);
-}
 
-static void
-    getCurrentBootNumber(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                         const uint64_t skip, const uint64_t top)
-{
-    uint64_t entryCount = 0;
-    crow::connections::systemBus->async_method_call(
-        [aResp, entryCount, skip,
-         top](const boost::system::error_code ec,
-              const std::variant<uint16_t>& bootCount) {
-            if (ec)
+            fillEntries();
+        }
+    }
+
+  private:
+    using PostCodes = boost::container::flat_map<
+        uint64_t, std::tuple<uint64_t, std::vector<uint8_t>>>;
+
+    struct BootCycle
+    {
+        boost::system::error_code ec;
+        PostCodes postcode;
+    };
+
+    void fillEntries()
+    {
+        uint64_t entryCount = 0;
+        for (size_t i = 0; i < boots.size(); i++)
+        {
+            const BootCycle& boot = boots[i];
+            if (boot.ec)
             {
-                BMCWEB_LOG_DEBUG << "DBUS response error " << ec;
-                messages::internalError(aResp->res);
+                BMCWEB_LOG_DEBUG << "DBUS POST CODE PostCode response error";
+                messages::internalError(asyncResp->res);
                 return;
             }
-            auto pVal = std::get_if<uint16_t>(&bootCount);
-            if (pVal)
+            if (boot.postcode.empty())
             {
-                getPostCodeForBoot(aResp, 1, *pVal, entryCount, skip, top);
+                continue;
             }
-            else
+
+            uint64_t endCount = entryCount + boot.postcode.size();
+            if ((skip < endCount) && ((top + skip) > entryCount))
             {
-                BMCWEB_LOG_DEBUG << "Post code boot index failed.";
+                uint64_t thisBootSkip = std::max(skip, entryCount) - entryCount;
+                uint64_t thisBootTop =
+                    std::min(top + skip, endCount) - entryCount;
+
+                fillPostCodeEntry(asyncResp, boot.postcode,
+                                  static_cast<uint16_t>(i + 1), 0,
+                                  thisBootSkip, thisBootTop);
             }
-        },
-        "xyz.openbmc_project.State.Boot.PostCode0",
-        "/xyz/openbmc_project/State/Boot/PostCode0",
-        "org.freedesktop.DBus.Properties", "Get",
-        "xyz.openbmc_project.State.Boot.PostCode", "CurrentBootCycleCount");
-}
+            asyncResp->res.jsonValue["Members@odata.count"] = endCount;
+            entryCount = endCount;
+        }
+        if (skip + top < entryCount)
+        {
+            collection_util::setNextLink(
+                asyncResp->res,
+                "/redfish/v1/Systems/system/LogServices/PostCodes/Entries",
+                page, std::to_string(skip + top));
+        }
+    }
+
+    const collection_util::Page page;
+    const uint64_t skip;
+    const uint64_t top;
+    boost::system::error_code ec;
+    dbus::utility::DbusVariantType bootCount;
+    std::vector<BootCycle> boots;
+    // First boot cycle not yet read
+    size_t nextBoot = 0;
+};
 
 inline void requestRoutesPostCodesEntryCollection(App& app)
 {
@@ -3104,17 +3567,30 @@ inline void requestRoutesPostCodesEntryCollection(App& app)
                 asyncResp->res.jsonValue["Members"] = nlohmann::json::array();
                 asyncResp->res.jsonValue["Members@odata.count"] = 0;
 
-                uint64_t skip = 0;
-                uint64_t top = maxEntriesPerPage; // Show max entries by default
-                if (!getSkipParam(asyncResp, req, skip))
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res,
+                                             maxEntriesPerPage,
+                                             maxEntriesPerPage);
+                if (!page)
                 {
                     return;
                 }
-                if (!getTopParam(asyncResp, req, top))
+                // Boots are numbered back from the current one, so all a
+                // page can end at is a count of the entries before
+                uint64_t skip = page->skip;
+                if (!page->position.empty())
                 {
-                    return;
+                    std::string_view position = page->position;
+                    uint64_t before = 0;
+                    if (!readPositionNumber(position, ',', before) ||
+                        !position.empty())
+                    {
+                        collection_util::badPosition(asyncResp->res, *page);
+                        return;
+                    }
+                    skip += before;
                 }
-                getCurrentBootNumber(asyncResp, skip, top);
+                crow::coroutine::spawn<PostCodeEntries>(asyncResp, *page, skip);
             });
 }
 
@@ -21,6 +21,8 @@
 #include <app.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/date_time.hpp>
+#include <dbus_decode.hpp>
+#include <dbus_query_plan.hpp>
 #include <dbus_utility.hpp>
 #include <registries/privilege_registry.hpp>
 #include <utils/fw_utils.hpp>
@@ -28,6 +30,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <variant>
 
@@ -254,6 +257,165 @@ static constexpr const char* stepwiseConfigurationIface =
 static constexpr const char* thermalModeIface =
     "xyz.openbmc_project.Control.ThermalMode";
 
+// A PID, stepwise or zone configuration, as decoded from the properties of
+// one entity-manager object
+struct PidConfiguration
+{
+    std::optional<std::string> name;
+    std::optional<std::string> pidClass;
+    std::optional<std::vector<std::string>> profiles;
+    // Stepwise only
+    std::optional<std::vector<double>> reading;
+    std::optional<std::vector<double>> output;
+    // The remaining properties, already in their Redfish form
+    nlohmann::json fields = nlohmann::json::object();
+};
+
+inline int readPidDouble(dbus::decode::Property& property,
+                         nlohmann::json& fields)
+{
+    double value = 0.0;
+    int r = property.read(value);
+    if (r >= 0)
+    {
+        fields[std::string(property.name())] = value;
+    }
+    return r;
+}
+
+/**
+ * @brief Decodes one property of a configuration with the given interface
+ * into pid.  Properties that don't map to Redfish are left unread.
+ *
+ * @return 0 on success, -ENXIO if the property has an illegal type or value,
+ * or a negative errno if it couldn't be decoded
+ */
+inline int readPidProperty(std::string_view interface,
+                           dbus::decode::Property& property,
+                           PidConfiguration& pid)
+{
+    std::string_view name = property.name();
+    if (name == "Type")
+    {
+        return 0;
+    }
+    if (name == "Name")
+    {
+        return property.read(pid.name.emplace());
+    }
+    if (name == "Class")
+    {
+        // Only controllers need a class, so that is checked by the caller
+        std::string pidClass;
+        int r = property.read(pidClass);
+        if (r >= 0)
+        {
+            pid.pidClass = std::move(pidClass);
+        }
+        return r == -ENXIO ? 0 : r;
+    }
+    if (name == "Profiles")
+    {
+        return property.read(pid.profiles.emplace());
+    }
+
+    // zones
+    if (interface == pidZoneConfigurationIface)
+    {
+        return readPidDouble(property, pid.fields);
+    }
+
+    if (interface == stepwiseConfigurationIface)
+    {
+        if (name == "Reading")
+        {
+            return property.read(pid.reading.emplace());
+        }
+        if (name == "Output")
+        {
+            return property.read(pid.output.emplace());
+        }
+    }
+
+    // pid and fans are off the same configuration
+    if (name == "Zones")
+    {
+        std::vector<std::string> inputs;
+        int r = property.read(inputs);
+        if (r < 0)
+        {
+            return r;
+        }
+        nlohmann::json& data = pid.fields["Zones"];
+        data = nlohmann::json::array();
+        for (std::string& itemCopy : inputs)
+        {
+            dbus::utility::escapePathForDbus(itemCopy);
+            data.push_back({{"@odata.id", "/redfish/v1/Managers/bmc#/Oem/"
+                                          "OpenBmc/Fan/FanZones/" +
+                                              itemCopy}});
+        }
+        return 0;
+    }
+    // todo(james): may never happen, but this assumes configuration data
+    // referenced in the PID config is provided by the same daemon, we could
+    // add another loop to cover all cases, but I'm okay kicking this can
+    // down the road a bit
+    if (name == "Inputs" || name == "Outputs")
+    {
+        std::vector<std::string> inputs;
+        int r = property.read(inputs);
+        if (r >= 0)
+        {
+            pid.fields[std::string(name)] = std::move(inputs);
+        }
+        return r;
+    }
+    if (name == "SetPointOffset")
+    {
+        std::string offset;
+        int r = property.read(offset);
+        if (r < 0)
+        {
+            return r;
+        }
+        // translate from dbus to redfish
+        if (offset == "WarningHigh")
+        {
+            pid.fields["SetPointOffset"] = "UpperThresholdNonCritical";
+        }
+        else if (offset == "WarningLow")
+        {
+            pid.fields["SetPointOffset"] = "LowerThresholdNonCritical";
+        }
+        else if (offset == "CriticalHigh")
+        {
+            pid.fields["SetPointOffset"] = "UpperThresholdCritical";
+        }
+        else if (offset == "CriticalLow")
+        {
+            pid.fields["SetPointOffset"] = "LowerThresholdCritical";
+        }
+        else
+        {
+            BMCWEB_LOG_ERROR << "Value Illegal " << offset;
+            return -ENXIO;
+        }
+        return 0;
+    }
+    // doubles
+    if (name == "FFGainCoefficient" || name == "FFOffCoefficient" ||
+        name == "ICoefficient" || name == "ILimitMax" || name == "ILimitMin" ||
+        name == "PositiveHysteresis" || name == "NegativeHysteresis" ||
+        name == "OutLimitMax" || name == "OutLimitMin" ||
+        name == "PCoefficient" || name == "SetPoint" || name == "SlewNeg" ||
+        name == "SlewPos")
+    {
+        return readPidDouble(property, pid.fields);
+    }
+    return 0;
+}
+
 inline void
     asyncPopulatePid(const std::string& connection, const std::string& path,
                      const std::string& currentProfile,
@@ -264,7 +426,7 @@ inline void
     crow::connections::systemBus->async_method_call(
         [asyncResp, currentProfile, supportedProfiles](
             const boost::system::error_code ec,
-            const dbus::utility::ManagedObjectType& managedObj) {
+            sdbusplus::message::message& msg) {
             if (ec)
             {
                 BMCWEB_LOG_ERROR << ec;
@@ -304,69 +466,61 @@ inline void
             }
             BMCWEB_LOG_ERROR << "profile = " << currentProfile << " !";
 
-            for (const auto& pathPair : managedObj)
-            {
-                for (const auto& intfPair : pathPair.second)
-                {
-                    if (intfPair.first != pidConfigurationIface &&
-                        intfPair.first != pidZoneConfigurationIface &&
-                        intfPair.first != stepwiseConfigurationIface)
-                    {
-                        continue;
-                    }
-                    auto findName = intfPair.second.find("Name");
-                    if (findName == intfPair.second.end())
+            // The entity-manager tree holds every configuration object, so
+            // only the controller interfaces are decoded
+            const std::array<const char*, 3> configurations = {
+                pidConfigurationIface, pidZoneConfigurationIface,
+                stepwiseConfigurationIface};
+            int r = dbus::decode::readManagedObjects(
+                msg, configurations,
+                [&](std::string_view objectPath, std::string_view interface,
+                    dbus::decode::Properties& reader) {
+                    PidConfiguration pid;
+                    int fieldResult = 0;
+                    int r = reader.forEach(
+                        [&](dbus::decode::Property& property) {
+                            fieldResult =
+                                readPidProperty(interface, property, pid);
+                            if (fieldResult == -ENXIO)
+                            {
+                                BMCWEB_LOG_ERROR << "Field Illegal "
+                                                 << property.name();
+                            }
+                            return fieldResult >= 0;
+                        });
+                    if (r < 0)
                     {
-                        BMCWEB_LOG_ERROR << "Pid Field missing Name";
+                        BMCWEB_LOG_ERROR << "Failed to decode " << interface
+                                         << " of " << objectPath << ": "
+                                         << (fieldResult < 0 ? fieldResult
+                                                             : r);
                         messages::internalError(asyncResp->res);
-                        return;
+                        return false;
                     }
-
-                    const std::string* namePtr =
-                        std::get_if<std::string>(&findName->second);
-                    if (namePtr == nullptr)
+                    if (!pid.name)
                     {
-                        BMCWEB_LOG_ERROR << "Pid Name Field illegal";
+                        BMCWEB_LOG_ERROR << "Pid Field missing Name";
                         messages::internalError(asyncResp->res);
-                        return;
+                        return false;
                     }
-                    std::string name = *namePtr;
+                    std::string name = *pid.name;
                     dbus::utility::escapePathForDbus(name);
 
-                    auto findProfiles = intfPair.second.find("Profiles");
-                    if (findProfiles != intfPair.second.end())
+                    if (pid.profiles &&
+                        std::find(pid.profiles->begin(), pid.profiles->end(),
+                                  currentProfile) == pid.profiles->end())
                     {
-                        const std::vector<std::string>* profiles =
-                            std::get_if<std::vector<std::string>>(
-                                &findProfiles->second);
-                        if (profiles == nullptr)
-                        {
-                            BMCWEB_LOG_ERROR << "Pid Profiles Field illegal";
-                            messages::internalError(asyncResp->res);
-                            return;
-                        }
-                        if (std::find(profiles->begin(), profiles->end(),
-                                      currentProfile) == profiles->end())
-                        {
-                            BMCWEB_LOG_INFO
-                                << name << " not supported in current profile";
-                            continue;
-                        }
+                        BMCWEB_LOG_INFO << name
+                                        << " not supported in current profile";
+                        return true;
                     }
                     nlohmann::json* config = nullptr;
 
-                    const std::string* classPtr = nullptr;
-                    auto findClass = intfPair.second.find("Class");
-                    if (findClass != intfPair.second.end())
-                    {
-                        classPtr = std::get_if<std::string>(&findClass->second);
-                    }
-
-                    if (intfPair.first == pidZoneConfigurationIface)
+                    if (interface == pidZoneConfigurationIface)
                     {
                         std::string chassis;
                         if (!dbus::utility::getNthStringFromPath(
-                                pathPair.first.str, 5, chassis))
+                                std::string(objectPath), 5, chassis))
                         {
                             chassis = "#IllegalValue";
                         }
@@ -380,13 +534,13 @@ inline void
                         config = &zone;
                     }
 
-                    else if (intfPair.first == stepwiseConfigurationIface)
+                    else if (interface == stepwiseConfigurationIface)
                     {
-                        if (classPtr == nullptr)
+                        if (!pid.pidClass)
                         {
                             BMCWEB_LOG_ERROR << "Pid Class Field illegal";
                             messages::internalError(asyncResp->res);
-                            return;
+                            return false;
                         }
 
                         nlohmann::json& controller = stepwise[name];
@@ -399,20 +553,20 @@ inline void
                         controller["@odata.type"] =
                             "#OemManager.StepwiseController";
 
-                        controller["Direction"] = *classPtr;
+                        controller["Direction"] = *pid.pidClass;
                     }
 
                     // pid and fans are off the same configuration
-                    else if (intfPair.first == pidConfigurationIface)
+                    else if (interface == pidConfigurationIface)
                     {
 
-                        if (classPtr == nullptr)
+                        if (!pid.pidClass)
                         {
                             BMCWEB_LOG_ERROR << "Pid Class Field illegal";
                             messages::internalError(asyncResp->res);
-                            return;
+                            return false;
                         }
-                        bool isFan = *classPtr == "fan";
+                        bool isFan = *pid.pidClass == "fan";
                         nlohmann::json& element =
                             isFan ? fans[name] : pids[name];
                         config = &element;
@@ -439,226 +593,35 @@ inline void
                     {
                         BMCWEB_LOG_ERROR << "Unexpected configuration";
                         messages::internalError(asyncResp->res);
-                        return;
+                        return false;
                     }
 
-                    // used for making maps out of 2 vectors
-                    const std::vector<double>* keys = nullptr;
-                    const std::vector<double>* values = nullptr;
-
-                    for (const auto& propertyPair : intfPair.second)
+                    if (pid.reading && pid.output)
                     {
-                        if (propertyPair.first == "Type" ||
-                            propertyPair.first == "Class" ||
-                            propertyPair.first == "Name")
+                        if (pid.reading->size() != pid.output->size())
                         {
-                            continue;
-                        }
-
-                        // zones
-                        if (intfPair.first == pidZoneConfigurationIface)
-                        {
-                            const double* ptr =
-                                std::get_if<double>(&propertyPair.second);
-                            if (ptr == nullptr)
-                            {
-                                BMCWEB_LOG_ERROR << "Field Illegal "
-                                                 << propertyPair.first;
-                                messages::internalError(asyncResp->res);
-                                return;
-                            }
-                            (*config)[propertyPair.first] = *ptr;
-                        }
-
-                        if (intfPair.first == stepwiseConfigurationIface)
-                        {
-                            if (propertyPair.first == "Reading" ||
-                                propertyPair.first == "Output")
-                            {
-                                const std::vector<double>* ptr =
-                                    std::get_if<std::vector<double>>(
-                                        &propertyPair.second);
-
-                                if (ptr == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR << "Field Illegal "
-                                                     << propertyPair.first;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-
-                                if (propertyPair.first == "Reading")
-                                {
-                                    keys = ptr;
-                                }
-                                else
-                                {
-                                    values = ptr;
-                                }
-                                if (keys && values)
-                                {
-                                    if (keys->size() != values->size())
-                                    {
-                                        BMCWEB_LOG_ERROR
-                                            << "Reading and Output size don't "
-                                               "match ";
-                                        messages::internalError(asyncResp->res);
-                                        return;
-                                    }
-                                    nlohmann::json& steps = (*config)["Steps"];
-                                    steps = nlohmann::json::array();
-                                    for (size_t ii = 0; ii < keys->size(); ii++)
-                                    {
-                                        steps.push_back(
-                                            {{"Target", (*keys)[ii]},
-                                             {"Output", (*values)[ii]}});
-                                    }
-                                }
-                            }
-                            if (propertyPair.first == "NegativeHysteresis" ||
-                                propertyPair.first == "PositiveHysteresis")
-                            {
-                                const double* ptr =
-                                    std::get_if<double>(&propertyPair.second);
-                                if (ptr == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR << "Field Illegal "
-                                                     << propertyPair.first;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                                (*config)[propertyPair.first] = *ptr;
-                            }
+                            BMCWEB_LOG_ERROR
+                                << "Reading and Output size don't match ";
+                            messages::internalError(asyncResp->res);
+                            return false;
                         }
-
-                        // pid and fans are off the same configuration
-                        if (intfPair.first == pidConfigurationIface ||
-                            intfPair.first == stepwiseConfigurationIface)
+                        nlohmann::json& steps = (*config)["Steps"];
+                        steps = nlohmann::json::array();
+                        for (size_t ii = 0; ii < pid.reading->size(); ii++)
                         {
-
-                            if (propertyPair.first == "Zones")
-                            {
-                                const std::vector<std::string>* inputs =
-                                    std::get_if<std::vector<std::string>>(
-                                        &propertyPair.second);
-
-                                if (inputs == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR
-                                        << "Zones Pid Field Illegal";
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                                auto& data = (*config)[propertyPair.first];
-                                data = nlohmann::json::array();
-                                for (std::string itemCopy : *inputs)
-                                {
-                                    dbus::utility::escapePathForDbus(itemCopy);
-                                    data.push_back(
-                                        {{"@odata.id",
-                                          "/redfish/v1/Managers/bmc#/Oem/"
-                                          "OpenBmc/Fan/FanZones/" +
-                                              itemCopy}});
-                                }
-                            }
-                            // todo(james): may never happen, but this
-                            // assumes configuration data referenced in the
-                            // PID config is provided by the same daemon, we
-                            // could add another loop to cover all cases,
-                            // but I'm okay kicking this can down the road a
-                            // bit
-
-                            else if (propertyPair.first == "Inputs" ||
-                                     propertyPair.first == "Outputs")
-                            {
-                                auto& data = (*config)[propertyPair.first];
-                                const std::vector<std::string>* inputs =
-                                    std::get_if<std::vector<std::string>>(
-                                        &propertyPair.second);
-
-                                if (inputs == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR << "Field Illegal "
-                                                     << propertyPair.first;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                                data = *inputs;
-                            }
-                            else if (propertyPair.first == "SetPointOffset")
-                            {
-                                const std::string* ptr =
-                                    std::get_if<std::string>(
-                                        &propertyPair.second);
-
-                                if (ptr == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR << "Field Illegal "
-                                                     << propertyPair.first;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                                // translate from dbus to redfish
-                                if (*ptr == "WarningHigh")
-                                {
-                                    (*config)["SetPointOffset"] =
-                                        "UpperThresholdNonCritical";
-                                }
-                                else if (*ptr == "WarningLow")
-                                {
-                                    (*config)["SetPointOffset"] =
-                                        "LowerThresholdNonCritical";
-                                }
-                                else if (*ptr == "CriticalHigh")
-                                {
-                                    (*config)["SetPointOffset"] =
-                                        "UpperThresholdCritical";
-                                }
-                                else if (*ptr == "CriticalLow")
-                                {
-                                    (*config)["SetPointOffset"] =
-                                        "LowerThresholdCritical";
-                                }
-                                else
-                                {
-                                    BMCWEB_LOG_ERROR << "Value Illegal "
-                                                     << *ptr;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                            }
-                            // doubles
-                            else if (propertyPair.first ==
-                                         "FFGainCoefficient" ||
-                                     propertyPair.first == "FFOffCoefficient" ||
-                                     propertyPair.first == "ICoefficient" ||
-                                     propertyPair.first == "ILimitMax" ||
-                                     propertyPair.first == "ILimitMin" ||
-                                     propertyPair.first ==
-                                         "PositiveHysteresis" ||
-                                     propertyPair.first ==
-                                         "NegativeHysteresis" ||
-                                     propertyPair.first == "OutLimitMax" ||
-                                     propertyPair.first == "OutLimitMin" ||
-                                     propertyPair.first == "PCoefficient" ||
-                                     propertyPair.first == "SetPoint" ||
-                                     propertyPair.first == "SlewNeg" ||
-                                     propertyPair.first == "SlewPos")
-                            {
-                                const double* ptr =
-                                    std::get_if<double>(&propertyPair.second);
-                                if (ptr == nullptr)
-                                {
-                                    BMCWEB_LOG_ERROR << "Field Illegal "
-                                                     << propertyPair.first;
-                                    messages::internalError(asyncResp->res);
-                                    return;
-                                }
-                                (*config)[propertyPair.first] = *ptr;
-                            }
+                            steps.push_back({{"Target", (*pid.reading)[ii]},
+                                             {"Output", (*pid.output)[ii]}});
                         }
                     }
-                }
+                    config->update(pid.fields);
+                    return true;
+                });
+            if (r < 0 && r != -ECANCELED)
+            {
+                BMCWEB_LOG_ERROR << "Failed to decode PID configuration: "
+                                 << r;
+                asyncResp->res.jsonValue.clear();
+                messages::internalError(asyncResp->res);
             }
         },
         connection, path, objectManagerIface, "GetManagedObjects");
@@ -1146,7 +1109,11 @@ struct GetPIDValues : std::enable_shared_from_this<GetPIDValues>
         std::shared_ptr<GetPIDValues> self = shared_from_this();
 
         // get all configurations
-        crow::connections::systemBus->async_method_call(
+        dbus::utility::getSubTree(
+            "/", 0,
+            std::array<const char*, 4>{
+                pidConfigurationIface, pidZoneConfigurationIface,
+                objectManagerIface, stepwiseConfigurationIface},
             [self](const boost::system::error_code ec,
                    const crow::openbmc_mapper::GetSubTreeType& subtreeLocal) {
                 if (ec)
@@ -1156,16 +1123,11 @@ struct GetPIDValues : std::enable_shared_from_this<GetPIDValues>
                     return;
                 }
                 self->subtree = subtreeLocal;
-            },
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", 0,
-            std::array<const char*, 4>{
-                pidConfigurationIface, pidZoneConfigurationIface,
-                objectManagerIface, stepwiseConfigurationIface});
+            });
 
         // at the same time get the selected profile
-        crow::connections::systemBus->async_method_call(
+        dbus::utility::getSubTree(
+            "/", 0, std::array<const char*, 1>{thermalModeIface},
             [self](const boost::system::error_code ec,
                    const crow::openbmc_mapper::GetSubTreeType& subtreeLocal) {
                 if (ec || subtreeLocal.empty())
@@ -1244,11 +1206,7 @@ struct GetPIDValues : std::enable_shared_from_this<GetPIDValues>
                     },
                     owner, path, "org.freedesktop.DBus.Properties", "GetAll",
                     thermalModeIface);
-            },
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", 0,
-            std::array<const char*, 1>{thermalModeIface});
+            });
     }
 
     ~GetPIDValues()
@@ -1382,7 +1340,8 @@ struct SetPIDValues : std::enable_shared_from_this<SetPIDValues>
             "GetManagedObjects");
 
         // at the same time get the profile information
-        crow::connections::systemBus->async_method_call(
+        dbus::utility::getSubTree(
+            "/", 0, std::array<const char*, 1>{thermalModeIface},
             [self](const boost::system::error_code ec,
                    const crow::openbmc_mapper::GetSubTreeType& subtree) {
                 if (ec || subtree.empty())
@@ -1463,11 +1422,7 @@ struct SetPIDValues : std::enable_shared_from_this<SetPIDValues>
                     },
                     owner, path, "org.freedesktop.DBus.Properties", "GetAll",
                     thermalModeIface);
-            },
-            "xyz.openbmc_project.ObjectMapper",
-            "/xyz/openbmc_project/object_mapper",
-            "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", 0,
-            std::array<const char*, 1>{thermalModeIface});
+            });
     }
     ~SetPIDValues()
     {
@@ -1686,20 +1641,25 @@ struct SetPIDValues : std::enable_shared_from_this<SetPIDValues>
 /**
  * @brief Retrieves BMC manager location data over DBus
  *
+ * @param[in] plan  Query plan the read is added to
  * @param[in] aResp Shared pointer for completing asynchronous calls
  * @param[in] connectionName - service name
  * @param[in] path - object path
  * @return none
  */
-inline void getLocation(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+inline void getLocation(dbus::utility::QueryPlan& plan,
+                        const std::shared_ptr<bmcweb::AsyncResp>& aResp,
                         const std::string& connectionName,
                         const std::string& path)
 {
     BMCWEB_LOG_DEBUG << "Get BMC manager Location data.";
 
-    crow::connections::systemBus->async_method_call(
+    plan.getProperty(
+        connectionName, path,
+        "xyz.openbmc_project.Inventory.Decorator.LocationCode", "LocationCode",
         [aResp](const boost::system::error_code ec,
-                const std::variant<std::string>& property) {
+                const dbus::utility::DbusVariantType& property,
+                dbus::utility::QueryPlan&) {
             if (ec)
             {
                 BMCWEB_LOG_DEBUG << "DBUS response error for "
@@ -1719,21 +1679,21 @@ inline void getLocation(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
 
             aResp->res.jsonValue["Location"]["PartLocation"]["ServiceLabel"] =
                 *value;
-        },
-        connectionName, path, "org.freedesktop.DBus.Properties", "Get",
-        "xyz.openbmc_project.Inventory.Decorator."
-        "LocationCode",
-        "LocationCode");
+        });
 }
 // avoid name collision systems.hpp
 inline void
-    managerGetLastResetTime(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
+    managerGetLastResetTime(dbus::utility::QueryPlan& plan,
+                            const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
     BMCWEB_LOG_DEBUG << "Getting Manager Last Reset Time";
 
-    crow::connections::systemBus->async_method_call(
+    plan.getProperty(
+        "xyz.openbmc_project.State.BMC", "/xyz/openbmc_project/state/bmc0",
+        "xyz.openbmc_project.State.BMC", "LastRebootTime",
         [aResp](const boost::system::error_code ec,
-                std::variant<uint64_t>& lastResetTime) {
+                const dbus::utility::DbusVariantType& lastResetTime,
+                dbus::utility::QueryPlan&) {
             if (ec)
             {
                 BMCWEB_LOG_DEBUG << "D-BUS response error " << ec;
@@ -1756,10 +1716,7 @@ inline void
             // Convert to ISO 8601 standard
             aResp->res.jsonValue["LastResetTime"] =
                 crow::utility::getDateTime(lastResetTimeStamp);
-        },
-        "xyz.openbmc_project.State.BMC", "/xyz/openbmc_project/state/bmc0",
-        "org.freedesktop.DBus.Properties", "Get",
-        "xyz.openbmc_project.State.BMC", "LastRebootTime");
+        });
 }
 
 /**
@@ -2026,7 +1983,11 @@ inline void requestRoutesManager(App& app)
             fw_util::populateFirmwareInformation(asyncResp, fw_util::bmcPurpose,
                                                  "FirmwareVersion", true);
 
-            managerGetLastResetTime(asyncResp);
+            // The D-Bus reads below are independent of each other, apart from
+            // those that need the BMC inventory object, and run in parallel
+            auto plan = std::make_shared<dbus::utility::QueryPlan>(asyncResp);
+
+            managerGetLastResetTime(*plan, asyncResp);
 
             auto pids = std::make_shared<GetPIDValues>(asyncResp);
             pids->run();
@@ -2047,9 +2008,12 @@ inline void requestRoutesManager(App& app)
 
             if (!started)
             {
-                crow::connections::systemBus->async_method_call(
+                plan->getProperty(
+                    "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
+                    "org.freedesktop.systemd1.Manager", "Progress",
                     [asyncResp](const boost::system::error_code ec,
-                                const std::variant<double>& resp) {
+                                const dbus::utility::DbusVariantType& resp,
+                                dbus::utility::QueryPlan&) {
                         if (ec)
                         {
                             BMCWEB_LOG_ERROR << "Error while getting progress";
@@ -2070,20 +2034,15 @@ inline void requestRoutesManager(App& app)
                                 "Starting";
                             started = true;
                         }
-                    },
-                    "org.freedesktop.systemd1", "/org/freedesktop/systemd1",
-                    "org.freedesktop.DBus.Properties", "Get",
-                    "org.freedesktop.systemd1.Manager", "Progress");
+                    });
             }
 
-            crow::connections::systemBus->async_method_call(
-                [asyncResp](
-                    const boost::system::error_code ec,
-                    const std::vector<
-                        std::pair<std::string,
-                                  std::vector<std::pair<
-                                      std::string, std::vector<std::string>>>>>&
-                        subtree) {
+            plan->getSubTree(
+                "/xyz/openbmc_project/inventory", 0,
+                {"xyz.openbmc_project.Inventory.Item.Bmc"},
+                [asyncResp](const boost::system::error_code ec,
+                            const crow::mapper_mirror::GetSubTreeType& subtree,
+                            dbus::utility::QueryPlan& bmcPlan) {
                     if (ec)
                     {
                         BMCWEB_LOG_DEBUG
@@ -2123,13 +2082,14 @@ inline void requestRoutesManager(App& app)
                         if (interfaceName ==
                             "xyz.openbmc_project.Inventory.Decorator.Asset")
                         {
-                            crow::connections::systemBus->async_method_call(
+                            bmcPlan.getAllProperties(
+                                connectionName, path,
+                                "xyz.openbmc_project.Inventory.Decorator.Asset",
                                 [asyncResp](
                                     const boost::system::error_code ec,
-                                    const std::vector<
-                                        std::pair<std::string,
-                                                  std::variant<std::string>>>&
-                                        propertiesList) {
+                                    const dbus::utility::DBusPropertiesMap&
+                                        propertiesList,
+                                    dbus::utility::QueryPlan&) {
                                     if (ec)
                                     {
                                         BMCWEB_LOG_DEBUG
@@ -2138,7 +2098,7 @@ inline void requestRoutesManager(App& app)
                                     }
                                     for (const std::pair<
                                              std::string,
-                                             std::variant<std::string>>&
+                                             dbus::utility::DbusVariantType>&
                                              property : propertiesList)
                                     {
                                         const std::string& propertyName =
@@ -2165,26 +2125,19 @@ inline void requestRoutesManager(App& app)
                                                 *value;
                                         }
                                     }
-                                },
-                                connectionName, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Decorator."
-                                "Asset");
+                                });
                         }
                         else if (interfaceName ==
                                  "xyz.openbmc_project.Inventory."
                                  "Decorator.LocationCode")
                         {
-                            getLocation(asyncResp, connectionName, path);
+                            getLocation(bmcPlan, asyncResp, connectionName,
+                                        path);
                         }
                     }
-                },
-                "xyz.openbmc_project.ObjectMapper",
-                "/xyz/openbmc_project/object_mapper",
-                "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-                "/xyz/openbmc_project/inventory", int32_t(0),
-                std::array<const char*, 1>{
-                    "xyz.openbmc_project.Inventory.Item.Bmc"});
+                });
+
+            plan->execute();
         });
 
     BMCWEB_ROUTE(app, "/redfish/v1/Managers/bmc/")
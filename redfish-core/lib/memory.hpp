@@ -894,8 +894,14 @@ inline void requestRoutesMemoryCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Systems/system/Memory/")
         .privileges(redfish::privileges::getMemoryCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res);
+                if (!page)
+                {
+                    return;
+                }
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#MemoryCollection.MemoryCollection";
                 asyncResp->res.jsonValue["Name"] = "Memory Module Collection";
@@ -904,7 +910,8 @@ inline void requestRoutesMemoryCollection(App& app)
 
                 collection_util::getCollectionMembers(
                     asyncResp, "/redfish/v1/Systems/system/Memory",
-                    {"xyz.openbmc_project.Inventory.Item.Dimm"});
+                    {"xyz.openbmc_project.Inventory.Item.Dimm"},
+                    "/xyz/openbmc_project/inventory", *page);
             });
 }
 
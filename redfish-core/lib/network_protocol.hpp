@@ -20,6 +20,7 @@
 #include "redfish_util.hpp"
 
 #include <app.hpp>
+#include <managed_objects_cache.hpp>
 #include <registries/privilege_registry.hpp>
 #include <utils/json_utils.hpp>
 
@@ -80,7 +81,8 @@ inline void
 template <typename CallbackFunc>
 void getEthernetIfaceData(CallbackFunc&& callback)
 {
-    crow::connections::systemBus->async_method_call(
+    crow::getManagedObjects(
+        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
         [callback{std::move(callback)}](
             const boost::system::error_code errorCode,
             const GetManagedObjects& dbusData) {
@@ -97,9 +99,7 @@ void getEthernetIfaceData(CallbackFunc&& callback)
                                                 domainNames);
 
             callback(true, ntpServers, domainNames);
-        },
-        "xyz.openbmc_project.Network", "/xyz/openbmc_project/network",
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        });
 }
 
 inline void getNetworkData(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
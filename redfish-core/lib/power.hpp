@@ -131,7 +131,7 @@ inline void requestRoutesPower(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Power/")
         .privileges(redfish::privileges::getPower)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                const std::string& chassisName) {
                 asyncResp->res.jsonValue["PowerControl"] =
@@ -140,7 +140,11 @@ inline void requestRoutesPower(App& app)
                 auto sensorAsyncResp = std::make_shared<SensorsAsyncResp>(
                     asyncResp, chassisName,
                     sensors::dbus::paths.at(sensors::node::power),
-                    sensors::node::power);
+                    sensors::node::power, req.query);
+                if (serveSensorModel(sensorAsyncResp))
+                {
+                    return;
+                }
 
                 getChassisData(sensorAsyncResp);
 
@@ -19,6 +19,7 @@
 
 #include <app.hpp>
 #include <boost/container/flat_map.hpp>
+#include <managed_objects_cache.hpp>
 #include <registries/privilege_registry.hpp>
 #include <sdbusplus/message/native_types.hpp>
 #include <sdbusplus/utility/dedup_variant.hpp>
@@ -193,7 +194,8 @@ inline void getCpuDataByService(std::shared_ptr<bmcweb::AsyncResp> aResp,
 {
     BMCWEB_LOG_DEBUG << "Get available system cpu resources by service.";
 
-    crow::connections::systemBus->async_method_call(
+    crow::getManagedObjects(
+        service, "/xyz/openbmc_project/inventory",
         [cpuId, service, objPath, aResp{std::move(aResp)}](
             const boost::system::error_code ec,
             const dbus::utility::ManagedObjectType& dbusData) {
@@ -257,9 +259,7 @@ inline void getCpuDataByService(std::shared_ptr<bmcweb::AsyncResp> aResp,
                 aResp->res.jsonValue["TotalCores"] = totalCores;
             }
             return;
-        },
-        service, "/xyz/openbmc_project/inventory",
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        });
 }
 
 inline void getCpuAssetData(std::shared_ptr<bmcweb::AsyncResp> aResp,
@@ -1072,6 +1072,12 @@ inline void requestRoutesOperatingConfigCollection(App& app)
             [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                const std::string& cpuName) {
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res);
+                if (!page)
+                {
+                    return;
+                }
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#OperatingConfigCollection.OperatingConfigCollection";
                 asyncResp->res.jsonValue["@odata.id"] = req.url;
@@ -1081,9 +1087,9 @@ inline void requestRoutesOperatingConfigCollection(App& app)
                 // First find the matching CPU object so we know how to
                 // constrain our search for related Config objects.
                 crow::connections::systemBus->async_method_call(
-                    [asyncResp,
-                     cpuName](const boost::system::error_code ec,
-                              const std::vector<std::string>& objects) {
+                    [asyncResp, cpuName, page{std::move(*page)}](
+                        const boost::system::error_code ec,
+                        const std::vector<std::string>& objects) {
                         if (ec)
                         {
                             BMCWEB_LOG_WARNING << "D-Bus error: " << ec << ", "
@@ -1111,7 +1117,7 @@ inline void requestRoutesOperatingConfigCollection(App& app)
                                     cpuName + "/OperatingConfigs",
                                 {"xyz.openbmc_project.Inventory.Item.Cpu."
                                  "OperatingConfig"},
-                                object.c_str());
+                                object.c_str(), page);
                             return;
                         }
                     },
@@ -1195,8 +1201,14 @@ inline void requestRoutesProcessorCollection(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Systems/system/Processors/")
         .privileges(redfish::privileges::getProcessorCollection)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+                std::optional<collection_util::Page> page =
+                    collection_util::getPage(req, asyncResp->res);
+                if (!page)
+                {
+                    return;
+                }
                 asyncResp->res.jsonValue["@odata.type"] =
                     "#ProcessorCollection.ProcessorCollection";
                 asyncResp->res.jsonValue["Name"] = "Processor Collection";
@@ -1207,7 +1219,8 @@ inline void requestRoutesProcessorCollection(App& app)
                 collection_util::getCollectionMembers(
                     asyncResp, "/redfish/v1/Systems/system/Processors",
                     std::vector<const char*>(processorInterfaces.begin(),
-                                             processorInterfaces.end()));
+                                             processorInterfaces.end()),
+                    "/xyz/openbmc_project/inventory", *page);
             });
 }
 
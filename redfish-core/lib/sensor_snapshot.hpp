@@ -0,0 +1,213 @@
+/*
+// Copyright (c) 2021 OpenBMC Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+*/
+#pragma once
+
+#include "sensors.hpp"
+
+#include <app.hpp>
+#include <dbus_utility.hpp>
+#include <managed_objects_cache.hpp>
+#include <registries/privilege_registry.hpp>
+#include <sensor_model.hpp>
+#include <sensor_snapshot_store.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace redfish
+{
+namespace sensor_snapshot
+{
+
+/**
+ * @brief The table being built for a GET, from the D-Bus reads in flight.
+ * Kept, and the response filled from it, once the last read is answered.
+ */
+class Build
+{
+  public:
+    Build(const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn,
+          const std::string& chassisIdIn, std::optional<uint64_t> sinceIn) :
+        asyncResp(asyncRespIn),
+        sources(std::make_shared<sensor_model::Sources>()),
+        chassisId(chassisIdIn), since(sinceIn),
+        generation(Store::getInstance().build()),
+        table(std::make_shared<Table>())
+    {}
+
+    Build(const Build&) = delete;
+    Build& operator=(const Build&) = delete;
+    Build(Build&&) = delete;
+    Build& operator=(Build&&) = delete;
+
+    ~Build()
+    {
+        Store& store = Store::getInstance();
+        if (asyncResp->res.result() != boost::beast::http::status::ok ||
+            asyncResp->res.isCancelled())
+        {
+            store.abandon();
+            return;
+        }
+        table->sources = std::move(*sources);
+        store.store(chassisId, table, generation);
+        asyncResp->res.jsonValue.clear();
+        fillSnapshot(asyncResp->res, chassisId, *table, since);
+    }
+
+    void addSensors(const boost::container::flat_set<std::string>& paths)
+    {
+        // The set is sorted, as the rows have to be
+        table->rows.reserve(paths.size());
+        for (const std::string& path : paths)
+        {
+            table->rows.emplace_back();
+            table->rows.back().path = path;
+        }
+    }
+
+    void addObjects(const dbus::utility::ManagedObjectType& objects)
+    {
+        for (const auto& [path, interfaces] : objects)
+        {
+            Row* row = table->find(path.str);
+            if (row == nullptr)
+            {
+                continue;
+            }
+            for (const auto& [interface, properties] : interfaces)
+            {
+                row->apply(interface, properties);
+            }
+        }
+    }
+
+    const std::shared_ptr<bmcweb::AsyncResp> asyncResp;
+    // What the table is read from, recorded as the reads go out
+    const std::shared_ptr<sensor_model::Sources> sources;
+
+  private:
+    const std::string chassisId;
+    const std::optional<uint64_t> since;
+    const uint64_t generation;
+    const std::shared_ptr<Table> table;
+};
+
+inline void
+    buildSnapshot(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+                  const std::string& chassisId, std::optional<uint64_t> since)
+{
+    auto build = std::make_shared<Build>(asyncResp, chassisId, since);
+    // getChassis() filters the associated sensors by these prefixes
+    auto sensorsAsyncResp = std::make_shared<SensorsAsyncResp>(
+        asyncResp, chassisId,
+        std::vector<const char*>{"/xyz/openbmc_project/sensors/"},
+        "SensorSnapshot");
+    sensorsAsyncResp->sources = build->sources;
+
+    getChassis(sensorsAsyncResp, [build, sensorsAsyncResp](
+                                     const std::shared_ptr<
+                                         boost::container::flat_set<
+                                             std::string>>& sensorNames) {
+        build->addSensors(*sensorNames);
+        getConnections(
+            sensorsAsyncResp, sensorNames,
+            [build, sensorsAsyncResp](
+                const boost::container::flat_set<std::string>& connections) {
+                for (const std::string& connection : connections)
+                {
+                    sensorsAsyncResp->addSourceService(connection);
+                }
+                getObjectManagerPaths(
+                    sensorsAsyncResp,
+                    [build, connections](
+                        const std::shared_ptr<boost::container::flat_map<
+                            std::string, std::string>>& objectMgrPaths) {
+                        for (const std::string& connection : connections)
+                        {
+                            auto iter = objectMgrPaths->find(connection);
+                            const std::string& objectMgrPath =
+                                (iter != objectMgrPaths->end()) ? iter->second
+                                                                : "/";
+                            if (dbus::utility::isCancelled(build->asyncResp))
+                            {
+                                return;
+                            }
+                            crow::getManagedObjects(
+                                connection, objectMgrPath,
+                                dbus::utility::cancellable(
+                                    build->asyncResp,
+                                    [build](const boost::system::error_code ec,
+                                            const dbus::utility::
+                                                ManagedObjectType& objects) {
+                                        if (ec)
+                                        {
+                                            BMCWEB_LOG_ERROR
+                                                << "GetManagedObjects failed: "
+                                                << ec;
+                                            messages::internalError(
+                                                build->asyncResp->res);
+                                            return;
+                                        }
+                                        build->addObjects(objects);
+                                    }));
+                        }
+                    });
+            });
+    });
+}
+
+} // namespace sensor_snapshot
+
+inline void requestRoutesSensorSnapshot(App& app)
+{
+    BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Oem/OpenBmc/SensorSnapshot/")
+        .privileges(redfish::privileges::getSensorCollection)
+        .methods(boost::beast::http::verb::get)(
+            [](const crow::Request& req,
+               const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+               const std::string& chassisId) {
+                std::optional<uint64_t> since;
+                auto it = req.urlParams.find("since");
+                if (it != req.urlParams.end())
+                {
+                    std::string sinceParam = it->value();
+                    since = sensor_snapshot::parseSince(sinceParam);
+                    if (!since)
+                    {
+                        messages::queryParameterValueFormatError(
+                            asyncResp->res, sinceParam, "since");
+                        return;
+                    }
+                }
+
+                std::shared_ptr<const sensor_snapshot::Table> table =
+                    sensor_snapshot::Store::getInstance().find(chassisId);
+                if (table != nullptr)
+                {
+                    sensor_snapshot::fillSnapshot(asyncResp->res, chassisId,
+                                                  *table, since);
+                    return;
+                }
+                sensor_snapshot::buildSnapshot(asyncResp, chassisId, since);
+            });
+}
+
+} // namespace redfish
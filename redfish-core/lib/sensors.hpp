@@ -16,15 +16,23 @@
 #pragma once
 
 #include <app.hpp>
+#include <association_graph.hpp>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/container/flat_map.hpp>
 #include <boost/range/algorithm/replace_copy_if.hpp>
+#include <coroutine_handler.hpp>
 #include <dbus_singleton.hpp>
+#include <dbus_utility.hpp>
+#include <managed_objects_cache.hpp>
 #include <registries/privilege_registry.hpp>
+#include <sensor_index.hpp>
+#include <sensor_model.hpp>
 #include <utils/json_utils.hpp>
+#include <utils/query_param.hpp>
 
 #include <cmath>
+#include <tuple>
 #include <utility>
 #include <variant>
 
@@ -35,13 +43,9 @@ using GetSubTreeType = std::vector<
     std::pair<std::string,
               std::vector<std::pair<std::string, std::vector<std::string>>>>>;
 
-using SensorVariant =
-    std::variant<int64_t, double, uint32_t, bool, std::string>;
+using SensorVariant = dbus::utility::DbusVariantType;
 
-using ManagedObjectsVectorType = std::vector<std::pair<
-    sdbusplus::message::object_path,
-    boost::container::flat_map<
-        std::string, boost::container::flat_map<std::string, SensorVariant>>>>;
+using ManagedObjectsVectorType = dbus::utility::ManagedObjectType;
 
 namespace sensors
 {
@@ -181,12 +185,14 @@ class SensorsAsyncResp
         const std::string dbusPath;
     };
 
-    SensorsAsyncResp(const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
-                     const std::string& chassisIdIn,
-                     const std::vector<const char*>& typesIn,
-                     const std::string_view& subNode) :
+    SensorsAsyncResp(
+        const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
+        const std::string& chassisIdIn, const std::vector<const char*>& typesIn,
+        const std::string_view& subNode,
+        const std::shared_ptr<const query_param::Query>& queryIn = nullptr) :
         asyncResp(asyncResp),
-        chassisId(chassisIdIn), types(typesIn), chassisSubNode(subNode)
+        chassisId(chassisIdIn), types(typesIn), chassisSubNode(subNode),
+        query(queryIn)
     {}
 
     // Store extra data about sensor mapping and return it in callback
@@ -225,6 +231,22 @@ class SensorsAsyncResp
             }
             dataComplete(asyncResp->res.result(), map);
         }
+
+        if (modelGeneration)
+        {
+            sensor_model::Model& model = sensor_model::Model::getInstance();
+            if (asyncResp->res.result() == boost::beast::http::status::ok &&
+                !asyncResp->res.isCancelled())
+            {
+                model.store(chassisId, chassisSubNode,
+                            asyncResp->res.jsonValue, std::move(*sources),
+                            *modelGeneration);
+            }
+            else
+            {
+                model.abandon(asyncResp->res.jsonValue);
+            }
+        }
     }
 
     void addMetadata(const nlohmann::json& sensorObject,
@@ -252,10 +274,78 @@ class SensorsAsyncResp
         }
     }
 
+    /**
+     * @brief Whether the inventory items associated with the sensors are
+     * needed.  They give the State and Health of sensors, and place power
+     * sensors under PowerSupplies.
+     */
+    bool needsInventory() const
+    {
+        if (chassisSubNode == sensors::node::sensors)
+        {
+            return isSelected("Status");
+        }
+        if (chassisSubNode == sensors::node::thermal)
+        {
+            return isSelected("Temperatures/Status") ||
+                   isSelected("Fans/Status") ||
+                   isSelected("Fans/IndicatorLED");
+        }
+        return isSelected("Voltages/Status") ||
+               isSelected("PowerControl/Status") || isSelected("PowerSupplies");
+    }
+
+    // Whether the state of the LEDs of the inventory items is needed
+    bool needsLeds() const
+    {
+        if (chassisSubNode == sensors::node::thermal)
+        {
+            return isSelected("Fans/IndicatorLED");
+        }
+        if (chassisSubNode == sensors::node::power)
+        {
+            return isSelected("PowerSupplies/IndicatorLED");
+        }
+        // A Sensor has no IndicatorLED
+        return false;
+    }
+
+    bool isSelected(std::string_view path) const
+    {
+        return query_param::isSelected(query, path);
+    }
+
+    // Records that the response is read from the object at path, if what
+    // it is read from is recorded
+    void addSourcePath(const std::string& path)
+    {
+        if (sources)
+        {
+            sources->paths.insert(path);
+        }
+    }
+
+    // Records that the response is read from objects of service, if what
+    // it is read from is recorded
+    void addSourceService(const std::string& service)
+    {
+        if (sources)
+        {
+            sources->services.insert(service);
+        }
+    }
+
     const std::shared_ptr<bmcweb::AsyncResp> asyncResp;
     const std::string chassisId;
     const std::vector<const char*> types;
     const std::string chassisSubNode;
+    // $select of the request, if any
+    const std::shared_ptr<const query_param::Query> query;
+    // Set when the response is to be kept as a view of the sensor model
+    std::optional<uint64_t> modelGeneration;
+    // Set when what the response is read from is to be recorded, for a
+    // view of the sensor model or a sensor snapshot
+    std::shared_ptr<sensor_model::Sources> sources;
 
   private:
     std::optional<std::vector<SensorData>> metadata;
@@ -377,8 +467,9 @@ void getObjectsWithConnection(
         BMCWEB_LOG_DEBUG << "getObjectsWithConnection resp_handler exit";
     };
     // Make call to ObjectMapper to find all sensors objects
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp, std::move(respHandler),
+        "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
         "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 2, interfaces);
     BMCWEB_LOG_DEBUG << "getObjectsWithConnection exit";
@@ -499,8 +590,8 @@ void getValidChassisPath(const std::shared_ptr<SensorsAsyncResp>& asyncResp,
         };
 
     // Get the Chassis Collection
-    crow::connections::systemBus->async_method_call(
-        respHandler, "xyz.openbmc_project.ObjectMapper",
+    dbus::utility::asyncMethodCall(
+        asyncResp->asyncResp, respHandler, "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
         "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
         "/xyz/openbmc_project/inventory", 0, interfaces);
@@ -555,7 +646,15 @@ void getChassis(const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
             return;
         }
 
+        // The chassis' sensors are associated below its path
+        sensorsAsyncResp->addSourcePath(*chassisPath);
         const std::string& chassisSubNode = sensorsAsyncResp->chassisSubNode;
+        if (chassisSubNode == sensors::node::power ||
+            chassisSubNode == sensors::node::thermal)
+        {
+            // Power limits and fan redundancy
+            sensorsAsyncResp->addSourcePath("/xyz/openbmc_project/control");
+        }
         if (chassisSubNode == sensors::node::power)
         {
             sensorsAsyncResp->asyncResp->res.jsonValue["@odata.type"] =
@@ -591,9 +690,25 @@ void getChassis(const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
             "/redfish/v1/Chassis/" + sensorsAsyncResp->chassisId + "/" +
             chassisSubNode;
         sensorsAsyncResp->asyncResp->res.jsonValue["Name"] = chassisSubNode;
+#ifdef BMCWEB_ENABLE_REDFISH_ASSOCIATION_GRAPH
+        association_graph::Graph& graph =
+            association_graph::Graph::getInstance();
+        if (graph.ready())
+        {
+            const std::shared_ptr<boost::container::flat_set<std::string>>
+                culledSensorList = std::make_shared<
+                    boost::container::flat_set<std::string>>();
+            reduceSensorList(sensorsAsyncResp,
+                             &graph.endpoints(*chassisPath, "all_sensors"),
+                             culledSensorList);
+            callback(culledSensorList);
+            return;
+        }
+#endif
         // Get the list of all sensors for this Chassis element
         std::string sensorPath = *chassisPath + "/all_sensors";
-        crow::connections::systemBus->async_method_call(
+        dbus::utility::asyncMethodCall(
+            sensorsAsyncResp->asyncResp,
             [sensorsAsyncResp, callback{std::move(callback)}](
                 const boost::system::error_code& e,
                 const std::variant<std::vector<std::string>>&
@@ -636,11 +751,14 @@ void getChassis(const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
     };
 
     // Get the Chassis Collection
-    crow::connections::systemBus->async_method_call(
-        respHandler, "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTreePaths",
-        "/xyz/openbmc_project/inventory", 0, interfaces);
+    if (dbus::utility::isCancelled(sensorsAsyncResp->asyncResp))
+    {
+        return;
+    }
+    dbus::utility::getSubTreePaths(
+        "/xyz/openbmc_project/inventory", 0, interfaces,
+        dbus::utility::cancellable(sensorsAsyncResp->asyncResp,
+                                   std::move(respHandler)));
     BMCWEB_LOG_DEBUG << "getChassis exit";
 }
 
@@ -709,10 +827,14 @@ void getObjectManagerPaths(
     };
 
     // Query mapper for all DBus object paths that implement ObjectManager
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree", "/", 0, interfaces);
+    if (dbus::utility::isCancelled(sensorsAsyncResp->asyncResp))
+    {
+        return;
+    }
+    dbus::utility::getSubTree(
+        "/", 0, interfaces,
+        dbus::utility::cancellable(sensorsAsyncResp->asyncResp,
+                                   std::move(respHandler)));
     BMCWEB_LOG_DEBUG << "getObjectManagerPaths exit";
 }
 
@@ -1144,9 +1266,14 @@ inline void objectInterfacesToJson(
         }
     }
 
-    sensorsAsyncResp->addMetadata(sensorJson, unit.to_string(),
-                                  "/xyz/openbmc_project/sensors/" + sensorType +
-                                      "/" + sensorName);
+    std::string dbusPath =
+        "/xyz/openbmc_project/sensors/" + sensorType + "/" + sensorName;
+    if (sensorsAsyncResp->modelGeneration)
+    {
+        sensor_model::markReading(sensorJson, dbusPath, unit, scaleMultiplier,
+                                  forceToInt);
+    }
+    sensorsAsyncResp->addMetadata(sensorJson, unit.to_string(), dbusPath);
 
     BMCWEB_LOG_DEBUG << "Added sensor " << sensorName;
 }
@@ -1154,7 +1281,8 @@ inline void objectInterfacesToJson(
 inline void populateFanRedundancy(
     const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp,
         [sensorsAsyncResp](const boost::system::error_code ec,
                            const GetSubTreeType& resp) {
             if (ec)
@@ -1176,7 +1304,9 @@ inline void populateFanRedundancy(
                 }
 
                 const std::string& owner = objDict.begin()->first;
-                crow::connections::systemBus->async_method_call(
+                sensorsAsyncResp->addSourceService(owner);
+                dbus::utility::asyncMethodCall(
+                    sensorsAsyncResp->asyncResp,
                     [path, owner,
                      sensorsAsyncResp](const boost::system::error_code e,
                                        std::variant<std::vector<std::string>>
@@ -1210,7 +1340,8 @@ inline void populateFanRedundancy(
                         {
                             return;
                         }
-                        crow::connections::systemBus->async_method_call(
+                        dbus::utility::asyncMethodCall(
+                            sensorsAsyncResp->asyncResp,
                             [path, sensorsAsyncResp](
                                 const boost::system::error_code& err,
                                 const boost::container::flat_map<
@@ -1667,7 +1798,7 @@ static void getInventoryItemsData(
                             objectMgrPaths, callback{std::move(callback)},
                             invConnectionsIndex](
                                const boost::system::error_code ec,
-                               ManagedObjectsVectorType& resp) {
+                               const ManagedObjectsVectorType& resp) {
             BMCWEB_LOG_DEBUG << "getInventoryItemsData respHandler enter";
             if (ec)
             {
@@ -1710,9 +1841,14 @@ static void getInventoryItemsData(
                          << objectMgrPath;
 
         // Get all object paths and their interfaces for current connection
-        crow::connections::systemBus->async_method_call(
-            std::move(respHandler), invConnection, objectMgrPath,
-            "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        if (dbus::utility::isCancelled(sensorsAsyncResp->asyncResp))
+        {
+            return;
+        }
+        crow::getManagedObjects(
+            invConnection, objectMgrPath,
+            dbus::utility::cancellable(sensorsAsyncResp->asyncResp,
+                                       std::move(respHandler)));
     }
 
     BMCWEB_LOG_DEBUG << "getInventoryItemsData exit";
@@ -1787,6 +1923,7 @@ static void getInventoryItemsConnections(
                 {
                     const std::string& invConnection = objData.first;
                     invConnections->insert(invConnection);
+                    sensorsAsyncResp->addSourceService(invConnection);
                 }
             }
         }
@@ -1796,8 +1933,9 @@ static void getInventoryItemsConnections(
     };
 
     // Make call to ObjectMapper to find all inventory items
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp, std::move(respHandler),
+        "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
         "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 0, interfaces);
     BMCWEB_LOG_DEBUG << "getInventoryItemsConnections exit";
@@ -1834,10 +1972,41 @@ static void getInventoryItemAssociations(
 {
     BMCWEB_LOG_DEBUG << "getInventoryItemAssociations enter";
 
+#ifdef BMCWEB_ENABLE_REDFISH_ASSOCIATION_GRAPH
+    association_graph::Graph& graph = association_graph::Graph::getInstance();
+    if (graph.ready())
+    {
+        std::shared_ptr<std::vector<InventoryItem>> inventoryItems =
+            std::make_shared<std::vector<InventoryItem>>();
+        for (const std::string& sensorName : *sensorNames)
+        {
+            const std::vector<std::string>& endpoints =
+                graph.endpoints(sensorName, "inventory");
+            if (!endpoints.empty())
+            {
+                addInventoryItem(inventoryItems, endpoints.front(),
+                                 sensorName);
+            }
+        }
+        for (InventoryItem& inventoryItem : *inventoryItems)
+        {
+            const std::vector<std::string>& endpoints =
+                graph.endpoints(inventoryItem.objectPath, "leds");
+            if (!endpoints.empty())
+            {
+                inventoryItem.ledObjectPath = endpoints.front();
+            }
+        }
+        callback(inventoryItems);
+        return;
+    }
+#endif
+
     // Response handler for GetManagedObjects
     auto respHandler = [callback{std::move(callback)}, sensorsAsyncResp,
                         sensorNames](const boost::system::error_code ec,
-                                     dbus::utility::ManagedObjectType& resp) {
+                                     const dbus::utility::ManagedObjectType&
+                                         resp) {
         BMCWEB_LOG_DEBUG << "getInventoryItemAssociations respHandler enter";
         if (ec)
         {
@@ -1953,9 +2122,14 @@ static void getInventoryItemAssociations(
                      << objectMgrPath;
 
     // Call GetManagedObjects on the ObjectMapper to get all associations
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), connection, objectMgrPath,
-        "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+    if (dbus::utility::isCancelled(sensorsAsyncResp->asyncResp))
+    {
+        return;
+    }
+    crow::getManagedObjects(
+        connection, objectMgrPath,
+        dbus::utility::cancellable(sensorsAsyncResp->asyncResp,
+                                   std::move(respHandler)));
 
     BMCWEB_LOG_DEBUG << "getInventoryItemAssociations exit";
 }
@@ -2071,9 +2245,9 @@ void getInventoryLedData(
             };
 
         // Get the State property for the current LED
-        crow::connections::systemBus->async_method_call(
-            std::move(respHandler), ledConnection, ledPath,
-            "org.freedesktop.DBus.Properties", "Get",
+        dbus::utility::asyncMethodCall(
+            sensorsAsyncResp->asyncResp, std::move(respHandler), ledConnection,
+            ledPath, "org.freedesktop.DBus.Properties", "Get",
             "xyz.openbmc_project.Led.Physical", "State");
     }
 
@@ -2146,6 +2320,7 @@ void getInventoryLeds(
                 // Add mapping from ledPath to connection
                 const std::string& connection = object.second.begin()->first;
                 (*ledConnections)[ledPath] = connection;
+                sensorsAsyncResp->addSourceService(connection);
                 BMCWEB_LOG_DEBUG << "Added mapping " << ledPath << " -> "
                                  << connection;
             }
@@ -2156,8 +2331,9 @@ void getInventoryLeds(
         BMCWEB_LOG_DEBUG << "getInventoryLeds respHandler exit";
     };
     // Make call to ObjectMapper to find all inventory items
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp, std::move(respHandler),
+        "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
         "xyz.openbmc_project.ObjectMapper", "GetSubTree", path, 0, interfaces);
     BMCWEB_LOG_DEBUG << "getInventoryLeds exit";
@@ -2209,6 +2385,7 @@ void getPowerSupplyAttributesData(
 
     const std::string& psAttributesPath = (*it).first;
     const std::string& psAttributesConnection = (*it).second;
+    sensorsAsyncResp->addSourceService(psAttributesConnection);
 
     // Response handler for Get DeratingFactor property
     auto respHandler = [sensorsAsyncResp, inventoryItems,
@@ -2250,8 +2427,9 @@ void getPowerSupplyAttributesData(
 
     // Get the DeratingFactor property for the PowerSupplyAttributes
     // Currently only property on the interface/only one we care about
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), psAttributesConnection, psAttributesPath,
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp, std::move(respHandler),
+        psAttributesConnection, psAttributesPath,
         "org.freedesktop.DBus.Properties", "Get",
         "xyz.openbmc_project.Control.PowerSupplyAttributes", "DeratingFactor");
 
@@ -2290,7 +2468,8 @@ void getPowerSupplyAttributes(
     BMCWEB_LOG_DEBUG << "getPowerSupplyAttributes enter";
 
     // Only need the power supply attributes when the Power Schema
-    if (sensorsAsyncResp->chassisSubNode != sensors::node::power)
+    if (sensorsAsyncResp->chassisSubNode != sensors::node::power ||
+        !sensorsAsyncResp->isSelected("PowerSupplies/EfficiencyPercent"))
     {
         BMCWEB_LOG_DEBUG << "getPowerSupplyAttributes exit since not Power";
         callback(inventoryItems);
@@ -2352,8 +2531,9 @@ void getPowerSupplyAttributes(
         BMCWEB_LOG_DEBUG << "getPowerSupplyAttributes respHandler exit";
     };
     // Make call to ObjectMapper to find the PowerSupplyAttributes service
-    crow::connections::systemBus->async_method_call(
-        std::move(respHandler), "xyz.openbmc_project.ObjectMapper",
+    dbus::utility::asyncMethodCall(
+        sensorsAsyncResp->asyncResp, std::move(respHandler),
+        "xyz.openbmc_project.ObjectMapper",
         "/xyz/openbmc_project/object_mapper",
         "xyz.openbmc_project.ObjectMapper", "GetSubTree",
         "/xyz/openbmc_project", 0, interfaces);
@@ -2419,6 +2599,11 @@ static void getInventoryItems(
                                 BMCWEB_LOG_DEBUG << "getInventoryLedsCb exit";
                             };
 
+                            if (!sensorsAsyncResp->needsLeds())
+                            {
+                                getInventoryLedsCb();
+                                return;
+                            }
                             // Find led connections and get the data
                             getInventoryLeds(sensorsAsyncResp, inventoryItems,
                                              std::move(getInventoryLedsCb));
@@ -2439,6 +2624,13 @@ static void getInventoryItems(
             BMCWEB_LOG_DEBUG << "getInventoryItemAssociationsCb exit";
         };
 
+    if (!sensorsAsyncResp->needsInventory())
+    {
+        BMCWEB_LOG_DEBUG << "getInventoryItems exit since not selected";
+        callback(std::make_shared<std::vector<InventoryItem>>());
+        return;
+    }
+
     // Get associations from sensors to inventory items
     getInventoryItemAssociations(sensorsAsyncResp, sensorNames, objectMgrPaths,
                                  std::move(getInventoryItemAssociationsCb));
@@ -2545,7 +2737,7 @@ inline void getSensorData(
         auto getManagedObjectsCb = [sensorsAsyncResp, sensorNames,
                                     inventoryItems](
                                        const boost::system::error_code ec,
-                                       ManagedObjectsVectorType& resp) {
+                                       const ManagedObjectsVectorType& resp) {
             BMCWEB_LOG_DEBUG << "getManagedObjectsCb enter";
             if (ec)
             {
@@ -2706,13 +2898,64 @@ inline void getSensorData(
         BMCWEB_LOG_DEBUG << "ObjectManager path for " << connection << " is "
                          << objectMgrPath;
 
-        crow::connections::systemBus->async_method_call(
-            getManagedObjectsCb, connection, objectMgrPath,
-            "org.freedesktop.DBus.ObjectManager", "GetManagedObjects");
+        if (dbus::utility::isCancelled(sensorsAsyncResp->asyncResp))
+        {
+            continue;
+        }
+        crow::getManagedObjects(
+            connection, objectMgrPath,
+            dbus::utility::cancellable(sensorsAsyncResp->asyncResp,
+                                       std::move(getManagedObjectsCb)));
     }
     BMCWEB_LOG_DEBUG << "getSensorData exit";
 }
 
+/**
+ * @brief Gets the inventory items of the specified sensors and then their
+ * values, once the connections providing the sensors and the ObjectManager
+ * paths are known.
+ *
+ * @param SensorsAsyncResp Pointer to object holding response data.
+ * @param sensorNames All requested sensors within the current chassis.
+ * @param connections Connections that provide sensor values.
+ * @param objectMgrPaths Mappings from connection name to DBus object path that
+ * implements ObjectManager.
+ */
+inline void getInventoryAndSensorData(
+    const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
+    const std::shared_ptr<boost::container::flat_set<std::string>>& sensorNames,
+    const boost::container::flat_set<std::string>& connections,
+    const std::shared_ptr<boost::container::flat_map<std::string, std::string>>&
+        objectMgrPaths)
+{
+    auto getInventoryItemsCb =
+        [sensorsAsyncResp, sensorNames, connections, objectMgrPaths](
+            const std::shared_ptr<std::vector<InventoryItem>>& inventoryItems) {
+            BMCWEB_LOG_DEBUG << "getInventoryItemsCb enter";
+            for (const std::string& connection : connections)
+            {
+                sensorsAsyncResp->addSourceService(connection);
+            }
+            for (const InventoryItem& inventoryItem : *inventoryItems)
+            {
+                sensorsAsyncResp->addSourcePath(inventoryItem.objectPath);
+                if (!inventoryItem.ledObjectPath.empty())
+                {
+                    sensorsAsyncResp->addSourcePath(
+                        inventoryItem.ledObjectPath);
+                }
+            }
+            // Get sensor data and store results in JSON
+            getSensorData(sensorsAsyncResp, sensorNames, connections,
+                          objectMgrPaths, inventoryItems);
+            BMCWEB_LOG_DEBUG << "getInventoryItemsCb exit";
+        };
+
+    // Get inventory items associated with sensors
+    getInventoryItems(sensorsAsyncResp, sensorNames, objectMgrPaths,
+                      std::move(getInventoryItemsCb));
+}
+
 inline void processSensorList(
     const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp,
     const std::shared_ptr<boost::container::flat_set<std::string>>& sensorNames)
@@ -2726,24 +2969,8 @@ inline void processSensorList(
                  connections](const std::shared_ptr<boost::container::flat_map<
                                   std::string, std::string>>& objectMgrPaths) {
                     BMCWEB_LOG_DEBUG << "getObjectManagerPathsCb enter";
-                    auto getInventoryItemsCb =
-                        [sensorsAsyncResp, sensorNames, connections,
-                         objectMgrPaths](
-                            const std::shared_ptr<std::vector<InventoryItem>>&
-                                inventoryItems) {
-                            BMCWEB_LOG_DEBUG << "getInventoryItemsCb enter";
-                            // Get sensor data and store results in JSON
-                            getSensorData(sensorsAsyncResp, sensorNames,
-                                          connections, objectMgrPaths,
-                                          inventoryItems);
-                            BMCWEB_LOG_DEBUG << "getInventoryItemsCb exit";
-                        };
-
-                    // Get inventory items associated with sensors
-                    getInventoryItems(sensorsAsyncResp, sensorNames,
-                                      objectMgrPaths,
-                                      std::move(getInventoryItemsCb));
-
+                    getInventoryAndSensorData(sensorsAsyncResp, sensorNames,
+                                              connections, objectMgrPaths);
                     BMCWEB_LOG_DEBUG << "getObjectManagerPathsCb exit";
                 };
 
@@ -2783,6 +3010,37 @@ inline void
     BMCWEB_LOG_DEBUG << "getChassisData exit";
 }
 
+/**
+ * @brief Answers a GET of the Thermal, Power or Sensors resource of a chassis
+ * from the resident sensor model, if it has a view of the resource and the
+ * request doesn't $select part of it.  Otherwise the response built for
+ * sensorsAsyncResp is kept as the view, once it is complete.
+ * @param SensorsAsyncResp   Pointer to object holding response data
+ * @return true if the response is complete
+ */
+inline bool
+    serveSensorModel(const std::shared_ptr<SensorsAsyncResp>& sensorsAsyncResp)
+{
+#ifdef BMCWEB_ENABLE_REDFISH_SENSOR_MODEL
+    if (sensorsAsyncResp->query != nullptr && sensorsAsyncResp->query->select)
+    {
+        return false;
+    }
+    sensor_model::Model& model = sensor_model::Model::getInstance();
+    if (model.serve(sensorsAsyncResp->chassisId,
+                    sensorsAsyncResp->chassisSubNode,
+                    sensorsAsyncResp->asyncResp->res))
+    {
+        return true;
+    }
+    sensorsAsyncResp->modelGeneration = model.build();
+    sensorsAsyncResp->sources = std::make_shared<sensor_model::Sources>();
+#else
+    std::ignore = sensorsAsyncResp;
+#endif
+    return false;
+}
+
 /**
  * @brief Find the requested sensorName in the list of all sensors supplied by
  * the chassis node
@@ -3001,6 +3259,10 @@ inline void requestRoutesSensorCollection(App& app)
                     aResp, chassisId,
                     sensors::dbus::paths.at(sensors::node::sensors),
                     sensors::node::sensors);
+            if (serveSensorModel(asyncResp))
+            {
+                return;
+            }
 
             auto getChassisCb =
                 [asyncResp](
@@ -3041,86 +3303,138 @@ inline void requestRoutesSensorCollection(App& app)
         });
 }
 
-inline void requestRoutesSensor(App& app)
+/**
+ * @brief GET of a single sensor: looks the sensor up by name among all
+ * objects implementing Sensor.Value, then reads it like the collection does.
+ */
+class SensorGet : public crow::coroutine::Handler<SensorGet>
 {
-    BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Sensors/<str>/")
-        .privileges(redfish::privileges::getSensor)
-        .methods(
-            boost::beast::http::verb::get)([](const crow::Request&,
-                                              const std::shared_ptr<
-                                                  bmcweb::AsyncResp>& aResp,
-                                              const std::string& chassisId,
-                                              const std::string& sensorName) {
-            BMCWEB_LOG_DEBUG << "Sensor doGet enter";
-            std::shared_ptr<SensorsAsyncResp> asyncResp =
-                std::make_shared<SensorsAsyncResp>(aResp, chassisId,
-                                                   std::vector<const char*>(),
-                                                   sensors::node::sensors);
+  public:
+    SensorGet(const crow::Request& req,
+              const std::shared_ptr<bmcweb::AsyncResp>& asyncRespIn,
+              const std::string& chassisId, const std::string& sensorNameIn) :
+        Handler(asyncRespIn),
+        sensorName(sensorNameIn),
+        sensorsAsyncResp(std::make_shared<SensorsAsyncResp>(
+            asyncRespIn, chassisId, std::vector<const char*>(),
+            sensors::node::sensors, req.query))
+    {}
 
-            const std::array<const char*, 1> interfaces = {
-                "xyz.openbmc_project.Sensor.Value"};
+    void operator()()
+    {
+        BOOST_ASIO_CORO_REENTER(this)
+        {
+            BMCWEB_LOG_DEBUG << "Sensor doGet enter";
+            if (findInIndex())
+            {
+                return;
+            }
 
             // Get a list of all of the sensors that implement Sensor.Value
             // and get the path and service name associated with the sensor
-            crow::connections::systemBus->async_method_call(
-                [asyncResp, sensorName](const boost::system::error_code ec,
-                                        const GetSubTreeType& subtree) {
-                    BMCWEB_LOG_DEBUG << "respHandler1 enter";
-                    if (ec)
-                    {
-                        messages::internalError(asyncResp->asyncResp->res);
-                        BMCWEB_LOG_ERROR
-                            << "Sensor getSensorPaths resp_handler: "
-                            << "Dbus error " << ec;
-                        return;
-                    }
+            BOOST_ASIO_CORO_YIELD call(
+                ec, subtree, "xyz.openbmc_project.ObjectMapper",
+                "/xyz/openbmc_project/object_mapper",
+                "xyz.openbmc_project.ObjectMapper", "GetSubTree",
+                "/xyz/openbmc_project/sensors", 2,
+                std::array<const char*, 1>{
+                    "xyz.openbmc_project.Sensor.Value"});
 
-                    GetSubTreeType::const_iterator it = std::find_if(
-                        subtree.begin(), subtree.end(),
-                        [sensorName](
-                            const std::pair<
-                                std::string,
-                                std::vector<std::pair<
-                                    std::string, std::vector<std::string>>>>&
-                                object) {
-                            sdbusplus::message::object_path path(object.first);
-                            std::string name = path.filename();
-                            if (name.empty())
-                            {
-                                BMCWEB_LOG_ERROR << "Invalid sensor path: "
-                                                 << object.first;
-                                return false;
-                            }
+            if (ec)
+            {
+                messages::internalError(asyncResp->res);
+                BMCWEB_LOG_ERROR << "Sensor getSensorPaths resp_handler: "
+                                 << "Dbus error " << ec;
+                return;
+            }
+            processSubTree();
+        }
+    }
 
-                            return name == sensorName;
-                        });
+  private:
+    // Looks the sensor up in the sensor index, if it is enabled and ready.
+    // Returns false if the mapper has to be asked instead.
+    bool findInIndex()
+    {
+#ifdef BMCWEB_ENABLE_REDFISH_SENSOR_INDEX
+        sensor_index::Index& index = sensor_index::Index::getInstance();
+        if (!index.ready())
+        {
+            return false;
+        }
+        const sensor_index::Sensor* sensor = index.find(sensorName);
+        if (sensor == nullptr)
+        {
+            BMCWEB_LOG_ERROR << "Could not find path for sensor: "
+                             << sensorName;
+            messages::resourceNotFound(asyncResp->res, "Sensor", sensorName);
+            return true;
+        }
+        BMCWEB_LOG_DEBUG << "Found sensor path for sensor '" << sensorName
+                         << "' in index: " << sensor->path;
 
-                    if (it == subtree.end())
-                    {
-                        BMCWEB_LOG_ERROR << "Could not find path for sensor: "
-                                         << sensorName;
-                        messages::resourceNotFound(asyncResp->asyncResp->res,
-                                                   "Sensor", sensorName);
-                        return;
-                    }
-                    std::string_view sensorPath = (*it).first;
-                    BMCWEB_LOG_DEBUG << "Found sensor path for sensor '"
-                                     << sensorName << "': " << sensorPath;
+        auto sensorList =
+            std::make_shared<boost::container::flat_set<std::string>>();
+        sensorList->emplace(sensor->path);
+        boost::container::flat_set<std::string> connections;
+        connections.emplace(sensor->service);
+        getInventoryAndSensorData(sensorsAsyncResp, sensorList, connections,
+                                  index.objectManagerPaths());
+        return true;
+#else
+        return false;
+#endif
+    }
 
-                    const std::shared_ptr<
-                        boost::container::flat_set<std::string>>
-                        sensorList = std::make_shared<
-                            boost::container::flat_set<std::string>>();
-
-                    sensorList->emplace(sensorPath);
-                    processSensorList(asyncResp, sensorList);
-                    BMCWEB_LOG_DEBUG << "respHandler1 exit";
-                },
-                "xyz.openbmc_project.ObjectMapper",
-                "/xyz/openbmc_project/object_mapper",
-                "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-                "/xyz/openbmc_project/sensors", 2, interfaces);
-        });
+    void processSubTree()
+    {
+        GetSubTreeType::const_iterator it = std::find_if(
+            subtree.begin(), subtree.end(),
+            [this](const GetSubTreeType::value_type& object) {
+                sdbusplus::message::object_path path(object.first);
+                std::string name = path.filename();
+                if (name.empty())
+                {
+                    BMCWEB_LOG_ERROR << "Invalid sensor path: "
+                                     << object.first;
+                    return false;
+                }
+
+                return name == sensorName;
+            });
+
+        if (it == subtree.end())
+        {
+            BMCWEB_LOG_ERROR << "Could not find path for sensor: "
+                             << sensorName;
+            messages::resourceNotFound(asyncResp->res, "Sensor", sensorName);
+            return;
+        }
+        std::string_view sensorPath = (*it).first;
+        BMCWEB_LOG_DEBUG << "Found sensor path for sensor '" << sensorName
+                         << "': " << sensorPath;
+
+        const std::shared_ptr<boost::container::flat_set<std::string>>
+            sensorList =
+                std::make_shared<boost::container::flat_set<std::string>>();
+
+        sensorList->emplace(sensorPath);
+        processSensorList(sensorsAsyncResp, sensorList);
+        BMCWEB_LOG_DEBUG << "Sensor doGet exit";
+    }
+
+    const std::string sensorName;
+    std::shared_ptr<SensorsAsyncResp> sensorsAsyncResp;
+    boost::system::error_code ec;
+    GetSubTreeType subtree;
+};
+
+inline void requestRoutesSensor(App& app)
+{
+    BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Sensors/<str>/")
+        .privileges(redfish::privileges::getSensor)
+        .methods(boost::beast::http::verb::get)(
+            crow::coroutine::route<SensorGet, std::string, std::string>());
 }
 
 } // namespace redfish
@@ -18,6 +18,7 @@
 #include <app.hpp>
 #include <persistent_data.hpp>
 #include <registries/privilege_registry.hpp>
+#include <utils/query_param.hpp>
 #include <utils/systemd_utils.hpp>
 
 namespace redfish
@@ -62,6 +63,26 @@ inline void
         {"@odata.id", "/redfish/v1/EventService"}};
     asyncResp->res.jsonValue["TelemetryService"] = {
         {"@odata.id", "/redfish/v1/TelemetryService"}};
+
+    nlohmann::json& protocolFeatures =
+        asyncResp->res.jsonValue["ProtocolFeaturesSupported"];
+    protocolFeatures["ExcerptQuery"] = false;
+    protocolFeatures["FilterQuery"] = true;
+    protocolFeatures["OnlyMemberQuery"] = false;
+    protocolFeatures["SelectQuery"] = true;
+#ifdef BMCWEB_ENABLE_REDFISH_EXPAND
+    protocolFeatures["ExpandQuery"] = {
+        {"ExpandAll", true},
+        {"Levels", true},
+        {"Links", true},
+        {"NoLinks", true},
+        {"MaxLevels", query_param::maxExpandLevels}};
+#else
+    protocolFeatures["ExpandQuery"] = {{"ExpandAll", false},
+                                       {"Levels", false},
+                                       {"Links", false},
+                                       {"NoLinks", false}};
+#endif
 }
 
 inline void requestRoutesServiceRoot(App& app)
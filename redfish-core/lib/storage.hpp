@@ -19,6 +19,7 @@
 #include "openbmc_dbus_rest.hpp"
 
 #include <app.hpp>
+#include <dbus_utility.hpp>
 #include <registries/privilege_registry.hpp>
 
 namespace redfish
@@ -59,7 +60,8 @@ inline void requestRoutesStorage(App& app)
             auto health = std::make_shared<HealthPopulate>(asyncResp);
             health->populate();
 
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                asyncResp,
                 [asyncResp,
                  health](const boost::system::error_code ec,
                          const std::vector<std::string>& storageList) {
@@ -107,7 +109,8 @@ inline void requestRoutesStorage(App& app)
                 std::array<const char*, 1>{
                     "xyz.openbmc_project.Inventory.Item.Drive"});
 
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                asyncResp,
                 [asyncResp,
                  health](const boost::system::error_code ec,
                          const crow::openbmc_mapper::GetSubTreeType& subtree) {
@@ -159,7 +162,8 @@ inline void requestRoutesStorage(App& app)
                         storageController["MemberId"] = id;
                         storageController["Status"]["State"] = "Enabled";
 
-                        crow::connections::systemBus->async_method_call(
+                        dbus::utility::asyncMethodCall(
+                            asyncResp,
                             [asyncResp,
                              index](const boost::system::error_code ec2,
                                     const std::variant<bool> present) {
@@ -190,7 +194,8 @@ inline void requestRoutesStorage(App& app)
                             "org.freedesktop.DBus.Properties", "Get",
                             "xyz.openbmc_project.Inventory.Item", "Present");
 
-                        crow::connections::systemBus->async_method_call(
+                        dbus::utility::asyncMethodCall(
+                            asyncResp,
                             [asyncResp, index](
                                 const boost::system::error_code ec2,
                                 const std::vector<std::pair<
@@ -273,7 +278,8 @@ inline void requestRoutesDrive(App& app)
                                               const std::shared_ptr<
                                                   bmcweb::AsyncResp>& asyncResp,
                                               const std::string& driveId) {
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                asyncResp,
                 [asyncResp,
                  driveId](const boost::system::error_code ec,
                           const crow::openbmc_mapper::GetSubTreeType& subtree) {
@@ -331,7 +337,8 @@ inline void requestRoutesDrive(App& app)
 
                     const std::string& connectionName =
                         connectionNames[0].first;
-                    crow::connections::systemBus->async_method_call(
+                    dbus::utility::asyncMethodCall(
+                        asyncResp,
                         [asyncResp](
                             const boost::system::error_code ec2,
                             const std::vector<std::pair<
@@ -383,7 +390,8 @@ inline void requestRoutesDrive(App& app)
                     health->inventory.emplace_back(path);
                     health->populate();
 
-                    crow::connections::systemBus->async_method_call(
+                    dbus::utility::asyncMethodCall(
+                        asyncResp,
                         [asyncResp, path](const boost::system::error_code ec2,
                                           const std::variant<bool> present) {
                             // this interface isn't necessary, only check it if
@@ -408,7 +416,8 @@ inline void requestRoutesDrive(App& app)
                         connectionName, path, "org.freedesktop.DBus.Properties",
                         "Get", "xyz.openbmc_project.Inventory.Item", "Present");
 
-                    crow::connections::systemBus->async_method_call(
+                    dbus::utility::asyncMethodCall(
+                        asyncResp,
                         [asyncResp](const boost::system::error_code ec2,
                                     const std::variant<bool> rebuilding) {
                             // this interface isn't necessary, only check it if
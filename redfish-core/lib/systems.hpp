@@ -22,6 +22,8 @@
 
 #include <app.hpp>
 #include <boost/container/flat_map.hpp>
+#include <dbus_query_plan.hpp>
+#include <dbus_utility.hpp>
 #include <registries/privilege_registry.hpp>
 #include <utils/fw_utils.hpp>
 #include <utils/json_utils.hpp>
@@ -41,7 +43,7 @@ namespace redfish
  */
 inline void
     updateDimmProperties(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                         const std::variant<bool>& dimmState)
+                         const dbus::utility::DbusVariantType& dimmState)
 {
     const bool* isDimmFunctional = std::get_if<bool>(&dimmState);
     if (isDimmFunctional == nullptr)
@@ -74,9 +76,9 @@ inline void
  *
  * @return None.
  */
-inline void
-    modifyCpuPresenceState(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                           const std::variant<bool>& cpuPresenceState)
+inline void modifyCpuPresenceState(
+    const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+    const dbus::utility::DbusVariantType& cpuPresenceState)
 {
     const bool* isCpuPresent = std::get_if<bool>(&cpuPresenceState);
 
@@ -110,9 +112,9 @@ inline void
  *
  * @return None.
  */
-inline void
-    modifyCpuFunctionalState(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
-                             const std::variant<bool>& cpuFunctionalState)
+inline void modifyCpuFunctionalState(
+    const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+    const dbus::utility::DbusVariantType& cpuFunctionalState)
 {
     const bool* isCpuFunctional = std::get_if<bool>(&cpuFunctionalState);
 
@@ -139,9 +141,248 @@ inline void
     }
 }
 
+/**
+ * @brief Declares the reads for the memory summary of one DIMM
+ *
+ * @param[in] plan           Query plan the reads are added to
+ * @param[in] aResp          Shared pointer for completing asynchronous calls
+ * @param[in] totalMemoryKiB Running total of the size of all DIMMs
+ * @param[in] service        D-Bus service of the DIMM
+ * @param[in] path           D-Bus object path of the DIMM
+ *
+ * @return None.
+ */
+inline void getDimmSummary(dbus::utility::QueryPlan& plan,
+                           const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                           const std::shared_ptr<uint64_t>& totalMemoryKiB,
+                           const std::string& service, const std::string& path)
+{
+    plan.getAllProperties(
+        service, path, "xyz.openbmc_project.Inventory.Item.Dimm",
+        [aResp, totalMemoryKiB, service,
+         path](const boost::system::error_code ec,
+               const dbus::utility::DBusPropertiesMap& properties,
+               dbus::utility::QueryPlan& dimmPlan) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "DBUS response error " << ec;
+                messages::internalError(aResp->res);
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Got " << properties.size()
+                             << " Dimm properties.";
+
+            if (properties.size() == 0)
+            {
+                // Without a size, fall back to whether the DIMM works
+                dimmPlan.getProperty(
+                    service, path,
+                    "xyz.openbmc_project.State.Decorator.OperationalStatus",
+                    "Functional",
+                    [aResp](const boost::system::error_code ec2,
+                            const dbus::utility::DbusVariantType& dimmState,
+                            dbus::utility::QueryPlan&) {
+                        if (ec2)
+                        {
+                            BMCWEB_LOG_ERROR << "DBUS response error " << ec2;
+                            return;
+                        }
+                        updateDimmProperties(aResp, dimmState);
+                    });
+                return;
+            }
+
+            for (const auto& [name, value] : properties)
+            {
+                if (name != "MemorySizeInKB")
+                {
+                    continue;
+                }
+                const uint32_t* memorySize = std::get_if<uint32_t>(&value);
+                if (memorySize == nullptr)
+                {
+                    BMCWEB_LOG_DEBUG << "Find incorrect type of MemorySize";
+                    continue;
+                }
+                *totalMemoryKiB += *memorySize;
+                aResp->res.jsonValue["MemorySummary"]["Status"]["State"] =
+                    "Enabled";
+            }
+        });
+}
+
+/**
+ * @brief Declares the reads for the processor summary of one CPU
+ *
+ * @param[in] plan     Query plan the reads are added to
+ * @param[in] aResp    Shared pointer for completing asynchronous calls
+ * @param[in] service  D-Bus service of the CPU
+ * @param[in] path     D-Bus object path of the CPU
+ *
+ * @return None.
+ */
+inline void getCpuSummary(dbus::utility::QueryPlan& plan,
+                          const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                          const std::string& service, const std::string& path)
+{
+    // Get the Presence of CPU
+    plan.getProperty(
+        service, path, "xyz.openbmc_project.Inventory.Item", "Present",
+        [aResp](const boost::system::error_code ec,
+                const dbus::utility::DbusVariantType& cpuPresenceCheck,
+                dbus::utility::QueryPlan&) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "DBUS response error " << ec;
+                return;
+            }
+            modifyCpuPresenceState(aResp, cpuPresenceCheck);
+        });
+
+    // Get the Functional State
+    plan.getProperty(
+        service, path, "xyz.openbmc_project.State.Decorator.OperationalStatus",
+        "Functional",
+        [aResp](const boost::system::error_code ec,
+                const dbus::utility::DbusVariantType& cpuFunctionalCheck,
+                dbus::utility::QueryPlan&) {
+            if (ec)
+            {
+                BMCWEB_LOG_ERROR << "DBUS response error " << ec;
+                return;
+            }
+            modifyCpuFunctionalState(aResp, cpuFunctionalCheck);
+        });
+
+    // Get the MODEL from xyz.openbmc_project.Inventory.Decorator.Asset
+    // support it later as Model  is Empty currently.
+}
+
+/**
+ * @brief Declares the read of the system UUID
+ *
+ * @param[in] plan     Query plan the reads are added to
+ * @param[in] aResp    Shared pointer for completing asynchronous calls
+ * @param[in] service  D-Bus service of the UUID object
+ * @param[in] path     D-Bus object path of the UUID object
+ *
+ * @return None.
+ */
+inline void getSystemUuid(dbus::utility::QueryPlan& plan,
+                          const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                          const std::string& service, const std::string& path)
+{
+    plan.getAllProperties(
+        service, path, "xyz.openbmc_project.Common.UUID",
+        [aResp](const boost::system::error_code ec,
+                const dbus::utility::DBusPropertiesMap& properties,
+                dbus::utility::QueryPlan&) {
+            if (ec)
+            {
+                BMCWEB_LOG_DEBUG << "DBUS response error " << ec;
+                messages::internalError(aResp->res);
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Got " << properties.size()
+                             << " UUID properties.";
+            for (const auto& [name, value] : properties)
+            {
+                if (name != "UUID")
+                {
+                    continue;
+                }
+                const std::string* uuid = std::get_if<std::string>(&value);
+                if (uuid == nullptr)
+                {
+                    continue;
+                }
+                std::string valueStr = *uuid;
+                if (valueStr.size() == 32)
+                {
+                    valueStr.insert(8, 1, '-');
+                    valueStr.insert(13, 1, '-');
+                    valueStr.insert(18, 1, '-');
+                    valueStr.insert(23, 1, '-');
+                }
+                BMCWEB_LOG_DEBUG << "UUID = " << valueStr;
+                aResp->res.jsonValue["UUID"] = valueStr;
+            }
+        });
+}
+
+/**
+ * @brief Declares the reads of the asset data of the system object
+ *
+ * @param[in] plan     Query plan the reads are added to
+ * @param[in] aResp    Shared pointer for completing asynchronous calls
+ * @param[in] service  D-Bus service of the system object
+ * @param[in] path     D-Bus object path of the system object
+ *
+ * @return None.
+ */
+inline void getSystemAsset(dbus::utility::QueryPlan& plan,
+                           const std::shared_ptr<bmcweb::AsyncResp>& aResp,
+                           const std::string& service, const std::string& path)
+{
+    plan.getAllProperties(
+        service, path, "xyz.openbmc_project.Inventory.Decorator.Asset",
+        [aResp](const boost::system::error_code ec,
+                const dbus::utility::DBusPropertiesMap& propertiesList,
+                dbus::utility::QueryPlan&) {
+            if (ec)
+            {
+                // doesn't have to include this interface
+                return;
+            }
+            BMCWEB_LOG_DEBUG << "Got " << propertiesList.size()
+                             << " properties for system";
+            for (const auto& [propertyName, value] : propertiesList)
+            {
+                if ((propertyName == "PartNumber") ||
+                    (propertyName == "SerialNumber") ||
+                    (propertyName == "Manufacturer") ||
+                    (propertyName == "Model") || (propertyName == "SubModel"))
+                {
+                    const std::string* asset = std::get_if<std::string>(&value);
+                    if (asset != nullptr)
+                    {
+                        aResp->res.jsonValue[propertyName] = *asset;
+                    }
+                }
+            }
+        });
+
+    plan.getProperty(
+        service, path, "xyz.openbmc_project.Inventory.Decorator.AssetTag",
+        "AssetTag",
+        [aResp](const boost::system::error_code ec,
+                const dbus::utility::DbusVariantType& property,
+                dbus::utility::QueryPlan&) {
+            if (ec)
+            {
+                // doesn't have to include this interface
+                return;
+            }
+
+            const std::string* value = std::get_if<std::string>(&property);
+            if (value != nullptr)
+            {
+                aResp->res.jsonValue["AssetTag"] = *value;
+            }
+        });
+
+    // Grab the bios version, which doesn't depend on the asset data
+    fw_util::populateFirmwareInformation(aResp, fw_util::biosPurpose,
+                                         "BiosVersion", false);
+}
+
 /*
  * @brief Retrieves computer system properties over dbus
  *
+ * The reads are declared on a query plan: the inventory subtree first, then,
+ * from its reply, the reads for every DIMM, CPU, UUID and system object it
+ * lists, which all run in parallel.
+ *
  * @param[in] aResp Shared pointer for completing asynchronous calls
  * @param[in] systemHealth  Shared HealthPopulate pointer
  *
@@ -153,13 +394,22 @@ inline void
 {
     BMCWEB_LOG_DEBUG << "Get available system components.";
 
-    crow::connections::systemBus->async_method_call(
-        [aResp, systemHealth](
-            const boost::system::error_code ec,
-            const std::vector<std::pair<
-                std::string,
-                std::vector<std::pair<std::string, std::vector<std::string>>>>>&
-                subtree) {
+    using dbus::utility::QueryPlan;
+    auto plan = std::make_shared<QueryPlan>(aResp);
+    // Summed over all DIMMs, and converted to GiB once they are all in
+    auto totalMemoryKiB = std::make_shared<uint64_t>(0);
+
+    plan->getSubTree(
+        "/xyz/openbmc_project/inventory", 0,
+        {"xyz.openbmc_project.Inventory.Decorator.Asset",
+         "xyz.openbmc_project.Inventory.Item.Cpu",
+         "xyz.openbmc_project.Inventory.Item.Dimm",
+         "xyz.openbmc_project.Inventory.Item.System",
+         "xyz.openbmc_project.Common.UUID"},
+        [aResp, systemHealth,
+         totalMemoryKiB](const boost::system::error_code ec,
+                         const crow::mapper_mirror::GetSubTreeType& subtree,
+                         QueryPlan& subtreePlan) {
             if (ec)
             {
                 BMCWEB_LOG_DEBUG << "DBUS response error";
@@ -167,16 +417,9 @@ inline void
                 return;
             }
             // Iterate over all retrieved ObjectPaths.
-            for (const std::pair<std::string,
-                                 std::vector<std::pair<
-                                     std::string, std::vector<std::string>>>>&
-                     object : subtree)
+            for (const auto& [path, connectionNames] : subtree)
             {
-                const std::string& path = object.first;
                 BMCWEB_LOG_DEBUG << "Got path: " << path;
-                const std::vector<
-                    std::pair<std::string, std::vector<std::string>>>&
-                    connectionNames = object.second;
                 if (connectionNames.size() < 1)
                 {
                     continue;
@@ -193,114 +436,17 @@ inline void
 
                 // This is not system, so check if it's cpu, dimm, UUID or
                 // BiosVer
-                for (const auto& connection : connectionNames)
+                for (const auto& [service, interfaces] : connectionNames)
                 {
-                    for (const auto& interfaceName : connection.second)
+                    for (const std::string& interfaceName : interfaces)
                     {
                         if (interfaceName ==
                             "xyz.openbmc_project.Inventory.Item.Dimm")
                         {
                             BMCWEB_LOG_DEBUG
                                 << "Found Dimm, now get its properties.";
-
-                            crow::connections::systemBus->async_method_call(
-                                [aResp, service{connection.first},
-                                 path](const boost::system::error_code ec2,
-                                       const std::vector<
-                                           std::pair<std::string, VariantType>>&
-                                           properties) {
-                                    if (ec2)
-                                    {
-                                        BMCWEB_LOG_ERROR
-                                            << "DBUS response error " << ec2;
-                                        messages::internalError(aResp->res);
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG << "Got "
-                                                     << properties.size()
-                                                     << " Dimm properties.";
-
-                                    if (properties.size() > 0)
-                                    {
-                                        for (const std::pair<std::string,
-                                                             VariantType>&
-                                                 property : properties)
-                                        {
-                                            if (property.first !=
-                                                "MemorySizeInKB")
-                                            {
-                                                continue;
-                                            }
-                                            const uint32_t* value =
-                                                std::get_if<uint32_t>(
-                                                    &property.second);
-                                            if (value == nullptr)
-                                            {
-                                                BMCWEB_LOG_DEBUG
-                                                    << "Find incorrect type of "
-                                                       "MemorySize";
-                                                continue;
-                                            }
-                                            nlohmann::json& totalMemory =
-                                                aResp->res
-                                                    .jsonValue["MemorySummar"
-                                                               "y"]
-                                                              ["TotalSystemMe"
-                                                               "moryGiB"];
-                                            uint64_t* preValue =
-                                                totalMemory
-                                                    .get_ptr<uint64_t*>();
-                                            if (preValue == nullptr)
-                                            {
-                                                continue;
-                                            }
-                                            aResp->res
-                                                .jsonValue["MemorySummary"]
-                                                          ["TotalSystemMemoryGi"
-                                                           "B"] =
-                                                *value / (1024 * 1024) +
-                                                *preValue;
-                                            aResp->res
-                                                .jsonValue["MemorySummary"]
-                                                          ["Status"]["State"] =
-                                                "Enabled";
-                                        }
-                                    }
-                                    else
-                                    {
-                                        auto getDimmProperties =
-                                            [aResp](
-                                                const boost::system::error_code
-                                                    ec3,
-                                                const std::variant<bool>&
-                                                    dimmState) {
-                                                if (ec3)
-                                                {
-                                                    BMCWEB_LOG_ERROR
-                                                        << "DBUS response "
-                                                           "error "
-                                                        << ec3;
-                                                    return;
-                                                }
-                                                updateDimmProperties(aResp,
-                                                                     dimmState);
-                                            };
-                                        crow::connections::systemBus
-                                            ->async_method_call(
-                                                std::move(getDimmProperties),
-                                                service, path,
-                                                "org.freedesktop.DBus."
-                                                "Properties",
-                                                "Get",
-                                                "xyz.openbmc_project.State."
-                                                "Decorator.OperationalStatus",
-                                                "Functional");
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Item.Dimm");
-
+                            getDimmSummary(subtreePlan, aResp, totalMemoryKiB,
+                                           service, path);
                             memoryHealth->inventory.emplace_back(path);
                         }
                         else if (interfaceName ==
@@ -308,90 +454,7 @@ inline void
                         {
                             BMCWEB_LOG_DEBUG
                                 << "Found Cpu, now get its properties.";
-
-                            crow::connections::systemBus->async_method_call(
-                                [aResp, service{connection.first},
-                                 path](const boost::system::error_code ec2,
-                                       const std::vector<
-                                           std::pair<std::string, VariantType>>&
-                                           properties) {
-                                    if (ec2)
-                                    {
-                                        BMCWEB_LOG_ERROR
-                                            << "DBUS response error " << ec2;
-                                        messages::internalError(aResp->res);
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG << "Got "
-                                                     << properties.size()
-                                                     << " Cpu properties.";
-
-                                    auto getCpuPresenceState =
-                                        [aResp](
-                                            const boost::system::error_code ec3,
-                                            const std::variant<bool>&
-                                                cpuPresenceCheck) {
-                                            if (ec3)
-                                            {
-                                                BMCWEB_LOG_ERROR
-                                                    << "DBUS response error "
-                                                    << ec3;
-                                                return;
-                                            }
-                                            modifyCpuPresenceState(
-                                                aResp, cpuPresenceCheck);
-                                        };
-
-                                    auto getCpuFunctionalState =
-                                        [aResp](
-                                            const boost::system::error_code ec3,
-                                            const std::variant<bool>&
-                                                cpuFunctionalCheck) {
-                                            if (ec3)
-                                            {
-                                                BMCWEB_LOG_ERROR
-                                                    << "DBUS response error "
-                                                    << ec3;
-                                                return;
-                                            }
-                                            modifyCpuFunctionalState(
-                                                aResp, cpuFunctionalCheck);
-                                        };
-
-                                    // Get the Presence of CPU
-                                    crow::connections::systemBus
-                                        ->async_method_call(
-                                            std::move(getCpuPresenceState),
-                                            service, path,
-                                            "org.freedesktop.DBus."
-                                            "Properties",
-                                            "Get",
-                                            "xyz.openbmc_project.Inventory."
-                                            "Item",
-                                            "Present");
-
-                                    // Get the Functional State
-                                    crow::connections::systemBus
-                                        ->async_method_call(
-                                            std::move(getCpuFunctionalState),
-                                            service, path,
-                                            "org.freedesktop.DBus."
-                                            "Properties",
-                                            "Get",
-                                            "xyz.openbmc_project.State."
-                                            "Decorator."
-                                            "OperationalStatus",
-                                            "Functional");
-
-                                    // Get the MODEL from
-                                    // xyz.openbmc_project.Inventory.Decorator.Asset
-                                    // support it later as Model  is Empty
-                                    // currently.
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Item.Cpu");
-
+                            getCpuSummary(subtreePlan, aResp, service, path);
                             cpuHealth->inventory.emplace_back(path);
                         }
                         else if (interfaceName ==
@@ -399,146 +462,23 @@ inline void
                         {
                             BMCWEB_LOG_DEBUG
                                 << "Found UUID, now get its properties.";
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec3,
-                                    const std::vector<
-                                        std::pair<std::string, VariantType>>&
-                                        properties) {
-                                    if (ec3)
-                                    {
-                                        BMCWEB_LOG_DEBUG
-                                            << "DBUS response error " << ec3;
-                                        messages::internalError(aResp->res);
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG << "Got "
-                                                     << properties.size()
-                                                     << " UUID properties.";
-                                    for (const std::pair<std::string,
-                                                         VariantType>&
-                                             property : properties)
-                                    {
-                                        if (property.first == "UUID")
-                                        {
-                                            const std::string* value =
-                                                std::get_if<std::string>(
-                                                    &property.second);
-
-                                            if (value != nullptr)
-                                            {
-                                                std::string valueStr = *value;
-                                                if (valueStr.size() == 32)
-                                                {
-                                                    valueStr.insert(8, 1, '-');
-                                                    valueStr.insert(13, 1, '-');
-                                                    valueStr.insert(18, 1, '-');
-                                                    valueStr.insert(23, 1, '-');
-                                                }
-                                                BMCWEB_LOG_DEBUG << "UUID = "
-                                                                 << valueStr;
-                                                aResp->res.jsonValue["UUID"] =
-                                                    valueStr;
-                                            }
-                                        }
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Common.UUID");
+                            getSystemUuid(subtreePlan, aResp, service, path);
                         }
                         else if (interfaceName ==
                                  "xyz.openbmc_project.Inventory.Item.System")
                         {
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec2,
-                                    const std::vector<
-                                        std::pair<std::string, VariantType>>&
-                                        propertiesList) {
-                                    if (ec2)
-                                    {
-                                        // doesn't have to include this
-                                        // interface
-                                        return;
-                                    }
-                                    BMCWEB_LOG_DEBUG
-                                        << "Got " << propertiesList.size()
-                                        << " properties for system";
-                                    for (const std::pair<std::string,
-                                                         VariantType>&
-                                             property : propertiesList)
-                                    {
-                                        const std::string& propertyName =
-                                            property.first;
-                                        if ((propertyName == "PartNumber") ||
-                                            (propertyName == "SerialNumber") ||
-                                            (propertyName == "Manufacturer") ||
-                                            (propertyName == "Model") ||
-                                            (propertyName == "SubModel"))
-                                        {
-                                            const std::string* value =
-                                                std::get_if<std::string>(
-                                                    &property.second);
-                                            if (value != nullptr)
-                                            {
-                                                aResp->res
-                                                    .jsonValue[propertyName] =
-                                                    *value;
-                                            }
-                                        }
-                                    }
-
-                                    // Grab the bios version
-                                    fw_util::populateFirmwareInformation(
-                                        aResp, fw_util::biosPurpose,
-                                        "BiosVersion", false);
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "GetAll",
-                                "xyz.openbmc_project.Inventory.Decorator."
-                                "Asset");
-
-                            crow::connections::systemBus->async_method_call(
-                                [aResp](
-                                    const boost::system::error_code ec2,
-                                    const std::variant<std::string>& property) {
-                                    if (ec2)
-                                    {
-                                        // doesn't have to include this
-                                        // interface
-                                        return;
-                                    }
-
-                                    const std::string* value =
-                                        std::get_if<std::string>(&property);
-                                    if (value != nullptr)
-                                    {
-                                        aResp->res.jsonValue["AssetTag"] =
-                                            *value;
-                                    }
-                                },
-                                connection.first, path,
-                                "org.freedesktop.DBus.Properties", "Get",
-                                "xyz.openbmc_project.Inventory.Decorator."
-                                "AssetTag",
-                                "AssetTag");
+                            getSystemAsset(subtreePlan, aResp, service, path);
                         }
                     }
                 }
             }
-        },
-        "xyz.openbmc_project.ObjectMapper",
-        "/xyz/openbmc_project/object_mapper",
-        "xyz.openbmc_project.ObjectMapper", "GetSubTree",
-        "/xyz/openbmc_project/inventory", int32_t(0),
-        std::array<const char*, 5>{
-            "xyz.openbmc_project.Inventory.Decorator.Asset",
-            "xyz.openbmc_project.Inventory.Item.Cpu",
-            "xyz.openbmc_project.Inventory.Item.Dimm",
-            "xyz.openbmc_project.Inventory.Item.System",
-            "xyz.openbmc_project.Common.UUID",
         });
+
+    plan->execute([aResp, totalMemoryKiB]() {
+        BMCWEB_LOG_DEBUG << "Got all system components.";
+        aResp->res.jsonValue["MemorySummary"]["TotalSystemMemoryGiB"] =
+            *totalMemoryKiB / (1024 * 1024);
+    });
 }
 
 /**
@@ -551,7 +491,8 @@ inline void
 inline void getHostState(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
     BMCWEB_LOG_DEBUG << "Get host information.";
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<std::string>& hostState) {
             if (ec)
@@ -755,7 +696,8 @@ inline int assignBootParameters(const std::shared_ptr<bmcweb::AsyncResp>& aResp,
  */
 inline void getBootProgress(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<std::string>& bootProgress) {
             if (ec)
@@ -858,7 +800,8 @@ inline void getBootProgress(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 
 inline void getBootOverrideType(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<std::string>& bootType) {
             if (ec)
@@ -907,7 +850,8 @@ inline void getBootOverrideType(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 
 inline void getBootOverrideMode(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<std::string>& bootMode) {
             if (ec)
@@ -960,7 +904,8 @@ inline void getBootOverrideMode(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 inline void
     getBootOverrideSource(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<std::string>& bootSource) {
             if (ec)
@@ -1019,7 +964,8 @@ inline void
 
     // If boot source override is enabled, we need to check 'one_time'
     // property to set a correct value for the "BootSourceOverrideEnabled"
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<bool>& oneTime) {
             if (ec)
@@ -1067,7 +1013,8 @@ inline void
 inline void
     getBootOverrideEnable(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::variant<bool>& bootOverrideEnable) {
             if (ec)
@@ -1126,7 +1073,8 @@ inline void getLastResetTime(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
     BMCWEB_LOG_DEBUG << "Getting System Last Reset Time";
 
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 std::variant<uint64_t>& lastResetTime) {
             if (ec)
@@ -1169,7 +1117,8 @@ inline void getAutomaticRetry(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
     BMCWEB_LOG_DEBUG << "Get Automatic Retry policy";
 
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 std::variant<bool>& autoRebootEnabled) {
             if (ec)
@@ -1194,7 +1143,8 @@ inline void getAutomaticRetry(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
                     "RetryAttempts";
                 // If AutomaticRetry (AutoReboot) is enabled see how many
                 // attempts are left
-                crow::connections::systemBus->async_method_call(
+                dbus::utility::asyncMethodCall(
+                    aResp,
                     [aResp](const boost::system::error_code ec2,
                             std::variant<uint32_t>& autoRebootAttemptsLeft) {
                         if (ec2)
@@ -1261,7 +1211,8 @@ inline void
 {
     BMCWEB_LOG_DEBUG << "Get power restore policy";
 
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 std::variant<std::string>& policy) {
             if (ec)
@@ -1319,7 +1270,8 @@ inline void getTrustedModuleRequiredToBoot(
 {
     BMCWEB_LOG_DEBUG << "Get TPM required to boot.";
 
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](
             const boost::system::error_code ec,
             std::vector<std::pair<
@@ -1365,7 +1317,8 @@ inline void getTrustedModuleRequiredToBoot(
             const std::string& serv = subtree[0].second.begin()->first;
 
             // Valid TPM Enable object found, now reading the current value
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                aResp,
                 [aResp](const boost::system::error_code ec,
                         std::variant<bool>& tpmRequired) {
                     if (ec)
@@ -1926,7 +1879,8 @@ inline void
 inline void getProvisioningStatus(std::shared_ptr<bmcweb::AsyncResp> aResp)
 {
     BMCWEB_LOG_DEBUG << "Get OEM information.";
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 const std::vector<std::pair<std::string, VariantType>>&
                     propertiesList) {
@@ -2041,7 +1995,8 @@ inline void getPowerMode(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
     BMCWEB_LOG_DEBUG << "Get power mode.";
 
     // Get Power Mode object path:
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](
             const boost::system::error_code ec,
             const std::vector<std::pair<
@@ -2087,7 +2042,8 @@ inline void getPowerMode(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
                 return;
             }
             // Valid Power Mode object found, now read the current value
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                aResp,
                 [aResp](const boost::system::error_code ec,
                         const std::variant<std::string>& pmode) {
                     if (ec)
@@ -2317,7 +2273,8 @@ inline void
     getHostWatchdogTimer(const std::shared_ptr<bmcweb::AsyncResp>& aResp)
 {
     BMCWEB_LOG_DEBUG << "Get host watchodg";
-    crow::connections::systemBus->async_method_call(
+    dbus::utility::asyncMethodCall(
+        aResp,
         [aResp](const boost::system::error_code ec,
                 PropertiesType& properties) {
             if (ec)
@@ -2723,7 +2680,8 @@ inline void requestRoutesSystems(App& app)
                 "xyz.openbmc_project.Inventory.Item.StorageController"};
 
             auto health = std::make_shared<HealthPopulate>(asyncResp);
-            crow::connections::systemBus->async_method_call(
+            dbus::utility::asyncMethodCall(
+                asyncResp,
                 [health](const boost::system::error_code ec,
                          std::vector<std::string>& resp) {
                     if (ec)
@@ -266,7 +266,7 @@ struct TaskData : std::enable_shared_from_this<TaskData>
             return;
         }
         match = std::make_unique<sdbusplus::bus::match::match>(
-            static_cast<sdbusplus::bus::bus&>(*crow::connections::systemBus),
+            static_cast<sdbusplus::bus::bus&>(*crow::connections::signalBus),
             matchStr,
             [self = shared_from_this()](sdbusplus::message::message& message) {
                 boost::system::error_code ec;
@@ -28,7 +28,7 @@ inline void requestRoutesThermal(App& app)
     BMCWEB_ROUTE(app, "/redfish/v1/Chassis/<str>/Thermal/")
         .privileges(redfish::privileges::getThermal)
         .methods(boost::beast::http::verb::get)(
-            [](const crow::Request&,
+            [](const crow::Request& req,
                const std::shared_ptr<bmcweb::AsyncResp>& asyncResp,
                const std::string& chassisName) {
                 auto thermalPaths =
@@ -41,7 +41,11 @@ inline void requestRoutesThermal(App& app)
 
                 auto sensorAsyncResp = std::make_shared<SensorsAsyncResp>(
                     asyncResp, chassisName, thermalPaths->second,
-                    sensors::node::thermal);
+                    sensors::node::thermal, req.query);
+                if (serveSensorModel(sensorAsyncResp))
+                {
+                    return;
+                }
 
                 // TODO Need to get Chassis Redundancy information.
                 getChassisData(sensorAsyncResp);
@@ -309,13 +309,13 @@ static void monitorForSoftwareAvailable(
     fwUpdateInProgress = true;
 
     fwUpdateMatcher = std::make_unique<sdbusplus::bus::match::match>(
-        *crow::connections::systemBus,
+        *crow::connections::signalBus,
         "interface='org.freedesktop.DBus.ObjectManager',type='signal',"
         "member='InterfacesAdded',path='/xyz/openbmc_project/software'",
         callback);
 
     fwUpdateErrorMatcher = std::make_unique<sdbusplus::bus::match::match>(
-        *crow::connections::systemBus,
+        *crow::connections::signalBus,
         "type='signal',member='PropertiesChanged',path_namespace='/xyz/"
         "openbmc_project/logging/entry',"
         "arg0='xyz.openbmc_project.Logging.Entry'",
@@ -0,0 +1,215 @@
+#include <event_log_index.hpp>
+
+#include "gmock/gmock.h"
+
+using redfish::EntryIDState;
+using redfish::EventLogIndex;
+
+namespace
+{
+
+constexpr const char* first = "2021-01-01T00:00:00+00:00 OpenBMC.0.1.A,1";
+constexpr const char* second = "2021-01-01T00:00:00+00:00 OpenBMC.0.1.B,2";
+constexpr const char* third = "2021-01-01T00:00:05+00:00 OpenBMC.0.1.C,3";
+constexpr const char* fourth = "2021-01-01T00:00:09+00:00 OpenBMC.0.1.D,4";
+
+class EventLogIndexTest : public testing::Test
+{
+  protected:
+    EventLogIndexTest()
+    {
+        std::string pattern =
+            (std::filesystem::temp_directory_path() / "eventlogXXXXXX")
+                .string();
+        if (mkdtemp(pattern.data()) != nullptr)
+        {
+            dir = pattern;
+        }
+    }
+
+    ~EventLogIndexTest() override
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+
+    std::filesystem::path log(int rotation = 0) const
+    {
+        if (rotation == 0)
+        {
+            return dir / "redfish";
+        }
+        return dir / ("redfish." + std::to_string(rotation));
+    }
+
+    static void append(const std::filesystem::path& path,
+                       const std::string& text)
+    {
+        std::ofstream file(path, std::ios::app);
+        file << text;
+    }
+
+    static uint64_t inodeOf(const std::filesystem::path& path)
+    {
+        struct stat st = {};
+        EXPECT_EQ(stat(path.c_str(), &st), 0);
+        return st.st_ino;
+    }
+
+    // The IDs of lines, numbered from the start of a log as the routes do
+    static std::vector<std::string> ids(const std::vector<std::string>& lines)
+    {
+        std::vector<std::string> result;
+        EntryIDState state;
+        for (const std::string& line : lines)
+        {
+            std::string id;
+            redfish::getUniqueEntryID(line, id, state);
+            result.push_back(id);
+        }
+        return result;
+    }
+
+    // The lines of the entries from the one numbered firstEntry
+    std::vector<std::string> lines(uint64_t firstEntry, uint64_t count) const
+    {
+        std::vector<std::string> result;
+        EXPECT_TRUE(index.forEach(
+            firstEntry, count,
+            [&result](const EventLogIndex::File&, const EventLogIndex::Entry&,
+                      const std::string& line,
+                      uint64_t) { result.push_back(line); }));
+        return result;
+    }
+
+    void refresh()
+    {
+        std::vector<std::filesystem::path> paths;
+        for (int rotation : {0, 1, 2})
+        {
+            if (std::filesystem::exists(log(rotation)))
+            {
+                paths.push_back(log(rotation));
+            }
+        }
+        index.refresh(paths);
+    }
+
+    std::filesystem::path dir;
+    EventLogIndex index;
+};
+
+} // namespace
+
+TEST_F(EventLogIndexTest, IndexesCompleteLines)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(), std::string(first) + "\n" + second + "\n" + third);
+    refresh();
+    // The last line has no newline yet
+    EXPECT_EQ(index.size(), 2U);
+    EXPECT_EQ(lines(0, 2), (std::vector<std::string>{first, second}));
+
+    append(log(), "\n");
+    refresh();
+    EXPECT_EQ(index.size(), 3U);
+    EXPECT_EQ(lines(1, 5), (std::vector<std::string>{second, third}));
+}
+
+TEST_F(EventLogIndexTest, FindsEntriesById)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(), std::string(first) + "\n" + second + "\n" + third + "\n");
+    refresh();
+
+    std::vector<std::string> entryIds = ids({first, second, third});
+    // Entries of the same second are numbered apart
+    EXPECT_EQ(entryIds[1], entryIds[0] + "_1");
+    EXPECT_EQ(index.find(entryIds[0]), 0U);
+    EXPECT_EQ(index.find(entryIds[1]), 1U);
+    EXPECT_EQ(index.find(entryIds[2]), 2U);
+
+    EXPECT_EQ(index.find(""), std::nullopt);
+    EXPECT_EQ(index.find("abc"), std::nullopt);
+    EXPECT_EQ(index.find(entryIds[0] + "_"), std::nullopt);
+    EXPECT_EQ(index.find(entryIds[0] + "_0"), std::nullopt);
+    EXPECT_EQ(index.find(entryIds[0] + "_2"), std::nullopt);
+    EXPECT_EQ(index.find(entryIds[0] + "x"), std::nullopt);
+}
+
+TEST_F(EventLogIndexTest, FindsEntriesByInodeAndOffset)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(), std::string(first) + "\n" + second + "\n");
+    refresh();
+    uint64_t inode = inodeOf(log());
+    uint64_t secondOffset = std::string(first).size() + 1;
+
+    EXPECT_EQ(index.find(inode, 0), 0U);
+    EXPECT_EQ(index.find(inode, secondOffset), 1U);
+    // The end of the file is where the next entry will be
+    EXPECT_EQ(index.find(inode, secondOffset + std::string(second).size() + 1),
+              2U);
+    EXPECT_EQ(index.find(inode, 1), std::nullopt);
+    EXPECT_EQ(index.find(inode + 1, 0), std::nullopt);
+}
+
+TEST_F(EventLogIndexTest, FollowsRotation)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(), std::string(first) + "\n" + second + "\n");
+    refresh();
+    uint64_t inode = inodeOf(log());
+
+    std::filesystem::rename(log(), log(1));
+    append(log(), std::string(third) + "\n" + fourth + "\n");
+    refresh();
+
+    EXPECT_EQ(index.size(), 4U);
+    EXPECT_EQ(lines(0, 4),
+              (std::vector<std::string>{first, second, third, fourth}));
+    // The rotated file keeps its entries under its inode
+    EXPECT_EQ(index.find(inode, std::string(first).size() + 1), 1U);
+    EXPECT_EQ(index.find(inodeOf(log()), 0), 2U);
+
+    std::vector<std::string> oldIds = ids({first, second});
+    std::vector<std::string> newIds = ids({third, fourth});
+    EXPECT_EQ(index.find(oldIds[1]), 1U);
+    EXPECT_EQ(index.find(newIds[1]), 3U);
+
+    // The oldest file rotated away takes its entries with it
+    std::filesystem::remove(log(1));
+    refresh();
+    EXPECT_EQ(index.size(), 2U);
+    EXPECT_EQ(index.find(oldIds[0]), std::nullopt);
+    EXPECT_EQ(index.find(newIds[0]), 0U);
+    EXPECT_EQ(index.find(inode, 0), std::nullopt);
+}
+
+TEST_F(EventLogIndexTest, OldestEntryOfAnIdWins)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(1), std::string(first) + "\n");
+    append(log(), std::string(first) + "\n");
+    refresh();
+
+    std::vector<std::string> entryIds = ids({first});
+    EXPECT_EQ(index.find(entryIds[0]), 0U);
+}
+
+TEST_F(EventLogIndexTest, RereadsTruncatedFile)
+{
+    ASSERT_FALSE(dir.empty());
+    append(log(), std::string(first) + "\n" + second + "\n");
+    refresh();
+    EXPECT_EQ(index.size(), 2U);
+
+    // As copytruncate does, the file keeps its inode
+    std::filesystem::resize_file(log(), 0);
+    append(log(), std::string(third) + "\n");
+    refresh();
+    EXPECT_EQ(index.size(), 1U);
+    EXPECT_EQ(lines(0, 1), (std::vector<std::string>{third}));
+    EXPECT_EQ(index.find(ids({first})[0]), std::nullopt);
+    EXPECT_EQ(index.find(ids({third})[0]), 0U);
+}
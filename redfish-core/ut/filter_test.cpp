@@ -0,0 +1,61 @@
+#include "utils/filter.hpp"
+
+#include <gmock/gmock.h>
+
+using namespace redfish::filter;
+using namespace testing;
+
+TEST(Filter, Parse)
+{
+    EXPECT_TRUE(Filter::parse("Severity eq 'Critical'"));
+    EXPECT_TRUE(Filter::parse("not (A lt 1 or B ge 2.5) and C ne null"));
+    EXPECT_TRUE(Filter::parse("Status/Health eq 'OK'"));
+    EXPECT_TRUE(Filter::parse("Name eq 'it''s'"));
+
+    EXPECT_FALSE(Filter::parse(""));
+    EXPECT_FALSE(Filter::parse("Severity eq"));
+    EXPECT_FALSE(Filter::parse("Severity is 'Critical'"));
+    EXPECT_FALSE(Filter::parse("Severity eq 'Critical"));
+    EXPECT_FALSE(Filter::parse("(A eq 1"));
+    EXPECT_FALSE(Filter::parse("A eq 1 and"));
+    EXPECT_FALSE(Filter::parse("A eq 1x"));
+    EXPECT_FALSE(Filter::parse(std::string(100, '(') + "A eq 1" +
+                               std::string(100, ')')));
+}
+
+TEST(Filter, Matches)
+{
+    nlohmann::json member = {{"Severity", "Critical"},
+                             {"Created", "2021-06-02T10:00:00+00:00"},
+                             {"Reading", 42},
+                             {"Enabled", true},
+                             {"Status", {{"Health", "OK"}}}};
+
+    EXPECT_TRUE(Filter::parse("Severity eq 'Critical'")->matches(member));
+    EXPECT_FALSE(Filter::parse("Severity ne 'Critical'")->matches(member));
+    EXPECT_TRUE(Filter::parse("Reading gt 41.5 and Reading le 42")
+                    ->matches(member));
+    EXPECT_TRUE(Filter::parse("Created ge '2021-06-01T00:00:00+00:00'")
+                    ->matches(member));
+    EXPECT_TRUE(Filter::parse("Enabled eq true")->matches(member));
+    EXPECT_FALSE(Filter::parse("Enabled gt false")->matches(member));
+    EXPECT_TRUE(Filter::parse("Status/Health eq 'OK'")->matches(member));
+    EXPECT_TRUE(Filter::parse("Missing eq null")->matches(member));
+    EXPECT_FALSE(Filter::parse("Reading eq '42'")->matches(member));
+    EXPECT_TRUE(
+        Filter::parse("Reading lt 0 or not (Severity eq 'OK')")->matches(
+            member));
+}
+
+TEST(Filter, PartialEvaluation)
+{
+    std::optional<Filter> filter =
+        Filter::parse("Severity eq 'Critical' and Message eq 'x'");
+    ASSERT_TRUE(filter);
+    std::vector<std::string_view> known = {"Severity"};
+    EXPECT_EQ(filter->evaluate({{"Severity", "OK"}}, known), Result::False);
+    EXPECT_EQ(filter->evaluate({{"Severity", "Critical"}}, known),
+              Result::Unknown);
+
+    EXPECT_THAT(filter->properties(), ElementsAre("Severity", "Message"));
+}
@@ -0,0 +1,115 @@
+#include <health_rollup.hpp>
+
+#include "gmock/gmock.h"
+
+using redfish::health_rollup::Index;
+using redfish::health_rollup::Level;
+
+namespace
+{
+
+constexpr const char* chassisPath =
+    "/xyz/openbmc_project/inventory/system/chassis";
+constexpr const char* cpuPath =
+    "/xyz/openbmc_project/inventory/system/chassis/motherboard/cpu0";
+constexpr const char* dimmPath =
+    "/xyz/openbmc_project/inventory/system/chassis/motherboard/dimm0";
+constexpr const char* bmcPath = "/xyz/openbmc_project/inventory/system/bmc";
+
+std::pair<Level, Level> ofSelf(const Index& index, const std::string& path)
+{
+    return index.evaluate(path, {}, false);
+}
+
+std::pair<Level, Level> ofInventory(const Index& index,
+                                    const std::vector<std::string>& inventory)
+{
+    return index.evaluate(std::nullopt, inventory, false);
+}
+
+} // namespace
+
+TEST(HealthRollupIndex, NothingIsOk)
+{
+    Index index;
+    EXPECT_EQ(ofSelf(index, cpuPath), std::make_pair(Level::ok, Level::ok));
+    EXPECT_EQ(index.evaluate(std::nullopt, {}, true),
+              std::make_pair(Level::ok, Level::ok));
+}
+
+TEST(HealthRollupIndex, NonfunctionalIsCritical)
+{
+    Index index;
+    index.setFunctional(cpuPath, false);
+    EXPECT_EQ(ofSelf(index, cpuPath),
+              std::make_pair(Level::critical, Level::critical));
+    // Containing items roll it up without being unhealthy themselves
+    EXPECT_EQ(ofInventory(index, {chassisPath}),
+              std::make_pair(Level::ok, Level::critical));
+    EXPECT_EQ(ofSelf(index, dimmPath), std::make_pair(Level::ok, Level::ok));
+
+    index.setFunctional(cpuPath, true);
+    EXPECT_EQ(ofSelf(index, cpuPath), std::make_pair(Level::ok, Level::ok));
+    EXPECT_EQ(ofInventory(index, {chassisPath}),
+              std::make_pair(Level::ok, Level::ok));
+}
+
+TEST(HealthRollupIndex, CriticalTakesPrecedenceOverWarning)
+{
+    Index index;
+    index.setAssociation(std::string(cpuPath) + "/warning", {dimmPath});
+    EXPECT_EQ(ofSelf(index, cpuPath),
+              std::make_pair(Level::warning, Level::warning));
+    // The endpoint rolls it up
+    EXPECT_EQ(ofInventory(index, {dimmPath}),
+              std::make_pair(Level::ok, Level::warning));
+
+    index.setAssociation(std::string(cpuPath) + "/critical", {dimmPath});
+    EXPECT_EQ(ofSelf(index, cpuPath),
+              std::make_pair(Level::critical, Level::critical));
+    EXPECT_EQ(ofInventory(index, {dimmPath}),
+              std::make_pair(Level::ok, Level::critical));
+
+    index.setAssociation(std::string(cpuPath) + "/critical", {});
+    EXPECT_EQ(ofSelf(index, cpuPath),
+              std::make_pair(Level::warning, Level::warning));
+}
+
+TEST(HealthRollupIndex, NonfunctionalTakesPrecedenceOverWarning)
+{
+    Index index;
+    index.setAssociation(std::string(cpuPath) + "/warning", {dimmPath});
+    index.setFunctional(dimmPath, false);
+    EXPECT_EQ(ofInventory(index, {chassisPath}),
+              std::make_pair(Level::ok, Level::critical));
+    EXPECT_EQ(ofSelf(index, dimmPath),
+              std::make_pair(Level::critical, Level::critical));
+}
+
+TEST(HealthRollupIndex, GlobalItemSetsHealth)
+{
+    Index index;
+    index.setGlobal(std::string(chassisPath));
+    index.setFunctional(cpuPath, false);
+    EXPECT_EQ(ofInventory(index, {chassisPath}),
+              std::make_pair(Level::critical, Level::critical));
+    EXPECT_EQ(ofInventory(index, {bmcPath}),
+              std::make_pair(Level::ok, Level::ok));
+
+    // The manager is made of all the inventory
+    EXPECT_EQ(index.evaluate(std::nullopt, {bmcPath}, true),
+              std::make_pair(Level::critical, Level::critical));
+}
+
+TEST(HealthRollupIndex, ClearDropsSources)
+{
+    Index index;
+    index.setAssociation(std::string(cpuPath) + "/critical", {dimmPath});
+    index.setFunctional(dimmPath, false);
+    index.clearAssociations();
+    EXPECT_EQ(ofSelf(index, cpuPath), std::make_pair(Level::ok, Level::ok));
+    EXPECT_EQ(ofSelf(index, dimmPath),
+              std::make_pair(Level::critical, Level::critical));
+    index.clearFunctional();
+    EXPECT_EQ(ofSelf(index, dimmPath), std::make_pair(Level::ok, Level::ok));
+}
@@ -0,0 +1,305 @@
+#include "utils/query_param.hpp"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+
+using namespace redfish::query_param;
+using namespace testing;
+
+TEST(QueryParam, ExpandType)
+{
+    Query query;
+    EXPECT_TRUE(getExpandType(".", query));
+    EXPECT_EQ(query.expandType, ExpandType::NotLinks);
+    EXPECT_EQ(query.expandLevel, 1);
+    EXPECT_TRUE(getExpandType("*($levels=3)", query));
+    EXPECT_EQ(query.expandType, ExpandType::Both);
+    EXPECT_EQ(query.expandLevel, 3);
+    EXPECT_TRUE(getExpandType("~", query));
+    EXPECT_EQ(query.expandType, ExpandType::Links);
+
+    EXPECT_FALSE(getExpandType("", query));
+    EXPECT_FALSE(getExpandType("x", query));
+    EXPECT_FALSE(getExpandType(".($levels=0)", query));
+    EXPECT_FALSE(getExpandType(".($levels=7)", query));
+    EXPECT_FALSE(getExpandType(".($levels=1", query));
+    EXPECT_FALSE(getExpandType(".($top=1)", query));
+}
+
+TEST(QueryParam, Select)
+{
+    Query query;
+    EXPECT_TRUE(query.isSelected("Anything"));
+    ASSERT_TRUE(getSelect("Reading,Status/Health", query));
+    EXPECT_TRUE(query.isSelected("Reading"));
+    EXPECT_TRUE(query.isSelected("Status"));
+    EXPECT_TRUE(query.isSelected("Status/Health"));
+    EXPECT_FALSE(query.isSelected("Status/State"));
+    EXPECT_FALSE(query.isSelected("Name"));
+
+    Query invalid;
+    EXPECT_FALSE(getSelect("", invalid));
+    EXPECT_FALSE(getSelect("Reading,", invalid));
+    EXPECT_FALSE(getSelect("Status//Health", invalid));
+    EXPECT_FALSE(getSelect("Rea ding", invalid));
+}
+
+TEST(QueryParam, ApplySelect)
+{
+    Query query;
+    ASSERT_TRUE(getSelect("Reading,Status/Health", query));
+
+    nlohmann::json sensor = {
+        {"@odata.id", "/redfish/v1/Chassis/c/Sensors/s"},
+        {"Name", "s"},
+        {"Reading", 42},
+        {"Status", {{"Health", "OK"}, {"State", "Enabled"}}}};
+    applySelect(sensor, *query.select);
+    EXPECT_EQ(sensor, nlohmann::json({{"@odata.id",
+                                        "/redfish/v1/Chassis/c/Sensors/s"},
+                                       {"Reading", 42},
+                                       {"Status", {{"Health", "OK"}}}}));
+
+    nlohmann::json collection = {
+        {"@odata.id", "/redfish/v1/Chassis/c/Sensors"},
+        {"Name", "Sensors"},
+        {"Members", {{{"@odata.id", "/redfish/v1/Chassis/c/Sensors/s"},
+                      {"Name", "s"},
+                      {"Reading", 42}}}},
+        {"Members@odata.count", 1}};
+    applySelect(collection, *query.select);
+    EXPECT_EQ(collection,
+              nlohmann::json(
+                  {{"@odata.id", "/redfish/v1/Chassis/c/Sensors"},
+                   {"Members",
+                    {{{"@odata.id", "/redfish/v1/Chassis/c/Sensors/s"},
+                      {"Reading", 42}}}},
+                   {"Members@odata.count", 1}}));
+}
+
+TEST(QueryParam, BudgetVisitsEachResourceOnce)
+{
+    Budget budget;
+    EXPECT_TRUE(budget.visit("/redfish/v1/Chassis/c"));
+    EXPECT_FALSE(budget.visit("/redfish/v1/Chassis/c"));
+    EXPECT_FALSE(budget.visit("/redfish/v1/Chassis/c/"));
+    EXPECT_TRUE(budget.visit("/redfish/v1/Chassis"));
+}
+
+namespace
+{
+
+// Serves resources out of a map, holding on to each response until the test
+// releases it
+class Resources
+{
+  public:
+    Handler handler()
+    {
+        return [this](crow::Request& req,
+                      const std::shared_ptr<bmcweb::AsyncResp>& asyncResp) {
+            requests++;
+            auto resource = resources.find(std::string(req.url));
+            if (resource == resources.end())
+            {
+                asyncResp->res.result(boost::beast::http::status::not_found);
+            }
+            else
+            {
+                asyncResp->res.jsonValue = resource->second;
+            }
+            held.push_back(asyncResp);
+            mostHeld = std::max(mostHeld, held.size());
+        };
+    }
+
+    // Answers the requests held, and those they lead to
+    void releaseAll()
+    {
+        while (!held.empty())
+        {
+            // Answering a request can start more of them
+            std::shared_ptr<bmcweb::AsyncResp> asyncResp =
+                std::move(held.front());
+            held.erase(held.begin());
+            asyncResp = nullptr;
+        }
+    }
+
+    std::map<std::string, nlohmann::json> resources;
+    std::vector<std::shared_ptr<bmcweb::AsyncResp>> held;
+    size_t requests = 0;
+    size_t mostHeld = 0;
+};
+
+// Expands the resource at uri, returning the expanded resource
+nlohmann::json expand(Resources& resources, const std::string& uri,
+                      ExpandType type, uint8_t levels,
+                      const std::shared_ptr<Budget>& budget,
+                      const std::shared_ptr<const Query>& query = nullptr)
+{
+    crow::Request req(boost::beast::http::request<
+                      boost::beast::http::string_body>(
+        boost::beast::http::verb::get, uri, 11));
+    req.url = req.target();
+    req.query = query;
+    budget->visit(req.url);
+
+    crow::Response parent;
+    nlohmann::json expanded;
+    auto expansion = std::make_shared<Expansion>(
+        resources.handler(), type, levels, budget,
+        [&expanded](crow::Response& res) {
+            expanded = std::move(res.jsonValue);
+        });
+    expansion->run(req, parent);
+    expansion = nullptr;
+    resources.releaseAll();
+    return expanded;
+}
+
+} // namespace
+
+TEST(QueryParam, ExpandStopsAtCycles)
+{
+    Resources resources;
+    resources.resources["/redfish/v1/Chassis/c"] = {
+        {"@odata.id", "/redfish/v1/Chassis/c"},
+        {"Links",
+         {{"ManagedBy", {{{"@odata.id", "/redfish/v1/Managers/m"}}}}}}};
+    resources.resources["/redfish/v1/Managers/m"] = {
+        {"@odata.id", "/redfish/v1/Managers/m"},
+        {"Links",
+         {{"ManagerForChassis", {{{"@odata.id", "/redfish/v1/Chassis/c"}}}}}}};
+
+    auto budget = std::make_shared<Budget>();
+    nlohmann::json chassis = expand(resources, "/redfish/v1/Chassis/c",
+                                    ExpandType::Both, 6, budget);
+
+    EXPECT_EQ(resources.requests, 2U);
+    EXPECT_FALSE(budget->isExceeded());
+    EXPECT_EQ(chassis["Links"]["ManagedBy"][0]["Links"]["ManagerForChassis"],
+              nlohmann::json({{{"@odata.id", "/redfish/v1/Chassis/c"}}}));
+}
+
+TEST(QueryParam, ExpandBoundsSubrequests)
+{
+    Resources resources;
+    nlohmann::json::array_t members;
+    for (size_t i = 0; i < maxSubrequests + 10; i++)
+    {
+        std::string uri = "/redfish/v1/Chassis/" + std::to_string(i);
+        resources.resources[uri] = {{"@odata.id", uri}};
+        members.push_back({{"@odata.id", uri}});
+    }
+    resources.resources["/redfish/v1/Chassis"] = {
+        {"@odata.id", "/redfish/v1/Chassis"}, {"Members", members}};
+
+    auto budget = std::make_shared<Budget>();
+    nlohmann::json collection = expand(resources, "/redfish/v1/Chassis",
+                                       ExpandType::NotLinks, 1, budget);
+
+    EXPECT_TRUE(budget->isExceeded());
+    // Subrequests queued once the request is bound to fail aren't run
+    EXPECT_EQ(resources.requests, maxConcurrentSubrequests + 1);
+    EXPECT_LE(resources.mostHeld, maxConcurrentSubrequests);
+    EXPECT_EQ(budget->runningCount(), 0U);
+    EXPECT_EQ(collection["Members"].size(), maxSubrequests + 10);
+}
+
+TEST(QueryParam, ExpandLimitsConcurrentSubrequests)
+{
+    Resources resources;
+    nlohmann::json::array_t members;
+    for (size_t i = 0; i < 50; i++)
+    {
+        std::string uri = "/redfish/v1/Chassis/" + std::to_string(i);
+        resources.resources[uri] = {{"@odata.id", uri}, {"Id", i}};
+        members.push_back({{"@odata.id", uri}});
+    }
+    resources.resources["/redfish/v1/Chassis"] = {
+        {"@odata.id", "/redfish/v1/Chassis"}, {"Members", members}};
+
+    auto budget = std::make_shared<Budget>();
+    nlohmann::json collection = expand(resources, "/redfish/v1/Chassis",
+                                       ExpandType::NotLinks, 1, budget);
+
+    EXPECT_FALSE(budget->isExceeded());
+    EXPECT_EQ(resources.requests, 51U);
+    EXPECT_LE(resources.mostHeld, maxConcurrentSubrequests);
+    ASSERT_EQ(collection["Members"].size(), 50U);
+    EXPECT_EQ(collection["Members"][49]["Id"], 49);
+}
+
+TEST(QueryParam, FilterCountsMatchesOfWholeCollections)
+{
+    Resources resources;
+    nlohmann::json::array_t members;
+    for (int i = 0; i < 5; i++)
+    {
+        members.push_back({{"@odata.id", "/redfish/v1/Chassis/c/Memory/" +
+                                             std::to_string(i)},
+                           {"Id", i}});
+    }
+    resources.resources["/redfish/v1/Chassis/c/Memory"] = {
+        {"@odata.id", "/redfish/v1/Chassis/c/Memory"},
+        {"Members", members},
+        {"Members@odata.count", 5}};
+    resources.resources["/redfish/v1/Chassis/c/Memory/page"] = {
+        {"@odata.id", "/redfish/v1/Chassis/c/Memory"},
+        {"Members", members},
+        {"Members@odata.count", 12},
+        {"Members@odata.nextLink",
+         "/redfish/v1/Chassis/c/Memory?$skiptoken=NQ"}};
+
+    auto query = std::make_shared<Query>();
+    query->filter = redfish::filter::Filter::parse("Id lt 2");
+    ASSERT_TRUE(query->filter);
+
+    nlohmann::json whole =
+        expand(resources, "/redfish/v1/Chassis/c/Memory", ExpandType::None, 0,
+               std::make_shared<Budget>(), query);
+    EXPECT_EQ(whole["Members"].size(), 2U);
+    EXPECT_EQ(whole["Members@odata.count"], 2);
+
+    // A page can't count the matches on the pages after it
+    nlohmann::json page =
+        expand(resources, "/redfish/v1/Chassis/c/Memory/page",
+               ExpandType::None, 0, std::make_shared<Budget>(), query);
+    EXPECT_EQ(page["Members"].size(), 2U);
+    EXPECT_EQ(page["Members@odata.count"], 12);
+}
+
+TEST(QueryParam, HandleQuerySelectsWithoutSubrequests)
+{
+    Resources resources;
+    resources.resources["/redfish/v1/Chassis/c"] = {
+        {"@odata.id", "/redfish/v1/Chassis/c"},
+        {"Name", "c"},
+        {"Links",
+         {{"ManagedBy", {{{"@odata.id", "/redfish/v1/Managers/m"}}}}}}};
+
+    crow::Request req(
+        boost::beast::http::request<boost::beast::http::string_body>(
+            boost::beast::http::verb::get, "/redfish/v1/Chassis/c?$select=Name",
+            11));
+    req.urlView = boost::urls::url_view(req.target());
+    req.url = req.urlView.encoded_path();
+    req.urlParams = req.urlView.params();
+
+    crow::Response res;
+    ASSERT_TRUE(handleQuery(req, std::make_shared<bmcweb::AsyncResp>(res),
+                            resources.handler()));
+    resources.releaseAll();
+
+    EXPECT_EQ(resources.requests, 1U);
+    EXPECT_EQ(res.result(), boost::beast::http::status::ok);
+    EXPECT_EQ(res.jsonValue,
+              nlohmann::json({{"@odata.id", "/redfish/v1/Chassis/c"},
+                              {"Name", "c"}}));
+}
@@ -0,0 +1,177 @@
+#include <sensor_model.hpp>
+
+#include "gmock/gmock.h"
+
+using redfish::sensor_model::markReading;
+using redfish::sensor_model::readingsKey;
+using redfish::sensor_model::Sources;
+using redfish::sensor_model::Views;
+
+namespace
+{
+
+constexpr const char* chassisPath =
+    "/xyz/openbmc_project/inventory/system/chassis";
+constexpr const char* cpuPath =
+    "/xyz/openbmc_project/sensors/temperature/cpu";
+constexpr const char* fanPath = "/xyz/openbmc_project/sensors/fan_tach/fan0";
+
+nlohmann::json thermal()
+{
+    nlohmann::json json;
+    json["Name"] = "Thermal";
+    nlohmann::json cpu;
+    cpu["Name"] = "cpu";
+    cpu["ReadingCelsius"] = 40.0;
+    markReading(cpu, cpuPath, nlohmann::json::json_pointer("/ReadingCelsius"),
+                0, false);
+    json["Temperatures"].push_back(std::move(cpu));
+    nlohmann::json fan;
+    fan["Name"] = "fan0";
+    fan["Reading"] = 3000;
+    markReading(fan, fanPath, nlohmann::json::json_pointer("/Reading"), -3,
+                true);
+    json["Fans"].push_back(std::move(fan));
+    return json;
+}
+
+Sources sources(const std::string& path, const std::string& service)
+{
+    Sources result;
+    result.paths.insert(path);
+    result.services.insert(service);
+    return result;
+}
+
+void store(Views& views, const std::string& chassisId,
+           const Sources& viewSources)
+{
+    nlohmann::json json = thermal();
+    views.store(chassisId, "Thermal", json, viewSources, views.build());
+}
+
+} // namespace
+
+TEST(SensorModelViews, StoreTakesReadings)
+{
+    Views views;
+    nlohmann::json json = thermal();
+    views.store("chassis", "Thermal", json, Sources(), views.build());
+    EXPECT_FALSE(json["Temperatures"][0].contains(readingsKey));
+    EXPECT_FALSE(json["Fans"][0].contains(readingsKey));
+
+    const nlohmann::json* view = views.find("chassis", "Thermal");
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(*view, json);
+    EXPECT_EQ(views.find("chassis", "Power"), nullptr);
+    EXPECT_EQ(views.find("other", "Thermal"), nullptr);
+}
+
+TEST(SensorModelViews, AbandonTakesReadings)
+{
+    Views views;
+    nlohmann::json json = thermal();
+    views.build();
+    EXPECT_TRUE(views.active());
+    views.abandon(json);
+    EXPECT_FALSE(json["Temperatures"][0].contains(readingsKey));
+    EXPECT_FALSE(views.active());
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+}
+
+TEST(SensorModelViews, SetValueAppliesScale)
+{
+    Views views;
+    store(views, "chassis", Sources());
+    views.setValue(cpuPath, 41.5);
+    views.setValue(fanPath, 3250000.0);
+
+    const nlohmann::json* view = views.find("chassis", "Thermal");
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ((*view)["Temperatures"][0]["ReadingCelsius"], 41.5);
+    const nlohmann::json& reading = (*view)["Fans"][0]["Reading"];
+    EXPECT_TRUE(reading.is_number_integer());
+    EXPECT_EQ(reading, 3250);
+}
+
+TEST(SensorModelViews, SetValueOfOtherSensorChangesNothing)
+{
+    Views views;
+    store(views, "chassis", Sources());
+    views.setValue("/xyz/openbmc_project/sensors/temperature/dimm", 50.0);
+
+    const nlohmann::json* view = views.find("chassis", "Thermal");
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ((*view)["Temperatures"][0]["ReadingCelsius"], 40.0);
+    EXPECT_EQ((*view)["Fans"][0]["Reading"], 3000);
+}
+
+TEST(SensorModelViews, ValueSetWhileBuildingIsApplied)
+{
+    Views views;
+    nlohmann::json json = thermal();
+    uint64_t generation = views.build();
+    views.setValue(cpuPath, 45.0);
+    views.store("chassis", "Thermal", json, Sources(), generation);
+
+    const nlohmann::json* view = views.find("chassis", "Thermal");
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ((*view)["Temperatures"][0]["ReadingCelsius"], 45.0);
+}
+
+TEST(SensorModelViews, DropPathDropsOnlyViewsBuiltFromIt)
+{
+    Views views;
+    store(views, "chassis", sources(chassisPath, "xyz.openbmc_project.EM"));
+    store(views, "other",
+          sources("/xyz/openbmc_project/inventory/system/other",
+                  "xyz.openbmc_project.EM"));
+
+    // A path that only shares a prefix with the chassis
+    views.dropPath(std::string(chassisPath) + "2");
+    EXPECT_NE(views.find("chassis", "Thermal"), nullptr);
+
+    // The association of the chassis to its sensors
+    views.dropPath(std::string(chassisPath) + "/all_sensors");
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+    EXPECT_NE(views.find("other", "Thermal"), nullptr);
+
+    // The readings are sources too
+    views.dropPath(cpuPath);
+    EXPECT_EQ(views.find("other", "Thermal"), nullptr);
+}
+
+TEST(SensorModelViews, DropServiceDropsOnlyViewsBuiltFromIt)
+{
+    Views views;
+    store(views, "chassis", sources(chassisPath, "xyz.openbmc_project.A"));
+    store(views, "other", sources(chassisPath, "xyz.openbmc_project.B"));
+
+    views.dropService("xyz.openbmc_project.A");
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+    EXPECT_NE(views.find("other", "Thermal"), nullptr);
+}
+
+TEST(SensorModelViews, DropWhileBuildingIsApplied)
+{
+    Views views;
+    nlohmann::json json = thermal();
+    uint64_t generation = views.build();
+    views.dropPath(fanPath);
+    views.store("chassis", "Thermal", json, Sources(), generation);
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+
+    json = thermal();
+    generation = views.build();
+    views.dropService("xyz.openbmc_project.B");
+    views.store("chassis", "Thermal", json,
+                sources(chassisPath, "xyz.openbmc_project.A"), generation);
+    EXPECT_NE(views.find("chassis", "Thermal"), nullptr);
+
+    json = thermal();
+    generation = views.build();
+    views.dropAll();
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+    views.store("chassis", "Thermal", json, Sources(), generation);
+    EXPECT_EQ(views.find("chassis", "Thermal"), nullptr);
+}
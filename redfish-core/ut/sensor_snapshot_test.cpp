@@ -0,0 +1,89 @@
+#include <sensor_snapshot_store.hpp>
+
+#include "gmock/gmock.h"
+
+using redfish::sensor_snapshot::fillSnapshot;
+using redfish::sensor_snapshot::parseSince;
+using redfish::sensor_snapshot::Row;
+using redfish::sensor_snapshot::Table;
+
+namespace
+{
+
+// Rows built at sequence 10, of which fan0 changed at 12
+Table table()
+{
+    Table result;
+    result.base = 10;
+    for (const char* name : {"fan_tach/fan0", "temperature/cpu",
+                             "voltage/p12v"})
+    {
+        Row row;
+        row.path = std::string("/xyz/openbmc_project/sensors/") + name;
+        row.value = 1.0;
+        row.sequence = result.base;
+        result.rows.push_back(std::move(row));
+    }
+    result.rows[0].value = 3000.0;
+    result.rows[0].sequence = 12;
+    return result;
+}
+
+nlohmann::json snapshot(std::optional<uint64_t> since)
+{
+    crow::Response res;
+    fillSnapshot(res, "chassis", table(), since);
+    return res.jsonValue;
+}
+
+} // namespace
+
+TEST(SensorSnapshot, FullWithoutSince)
+{
+    nlohmann::json json = snapshot(std::nullopt);
+    EXPECT_EQ(json["Sequence"], 12);
+    EXPECT_EQ(json["Full"], true);
+    EXPECT_EQ(json["Names"], nlohmann::json({"fan_tach/fan0",
+                                             "temperature/cpu",
+                                             "voltage/p12v"}));
+    EXPECT_EQ(json["Readings"], nlohmann::json({3000.0, 1.0, 1.0}));
+    EXPECT_FALSE(json.contains("Indexes"));
+}
+
+TEST(SensorSnapshot, DeltaHasOnlyChangedRows)
+{
+    nlohmann::json json = snapshot(10);
+    EXPECT_EQ(json["Full"], false);
+    EXPECT_EQ(json["Since"], 10);
+    EXPECT_EQ(json["Indexes"], nlohmann::json({0}));
+    EXPECT_EQ(json["Readings"], nlohmann::json({3000.0}));
+    EXPECT_FALSE(json.contains("Names"));
+}
+
+TEST(SensorSnapshot, DeltaSinceSequenceIsEmpty)
+{
+    nlohmann::json json = snapshot(12);
+    EXPECT_EQ(json["Full"], false);
+    EXPECT_EQ(json["Indexes"], nlohmann::json::array());
+    EXPECT_EQ(json["Readings"], nlohmann::json::array());
+}
+
+TEST(SensorSnapshot, SinceOutsideTableIsFull)
+{
+    // Before the table was built
+    EXPECT_EQ(snapshot(9)["Full"], true);
+    // Ahead of the sequence, from before a restart
+    EXPECT_EQ(snapshot(13)["Full"], true);
+}
+
+TEST(SensorSnapshot, ParseSince)
+{
+    EXPECT_EQ(parseSince("42"), 42);
+    EXPECT_EQ(parseSince("0"), 0);
+    EXPECT_EQ(parseSince(""), std::nullopt);
+    EXPECT_EQ(parseSince("-1"), std::nullopt);
+    EXPECT_EQ(parseSince("+1"), std::nullopt);
+    EXPECT_EQ(parseSince("12a"), std::nullopt);
+    EXPECT_EQ(parseSince(" 12"), std::nullopt);
+    EXPECT_EQ(parseSince("18446744073709551616"), std::nullopt);
+}
@@ -256,6 +256,15 @@ with open(metadata_index_path, 'w') as metadata_index:
         "        <edmx:Include Namespace=\"OemSession.v1_0_0\"/>\n")
     metadata_index.write("    </edmx:Reference>\n")
 
+    metadata_index.write(
+        "    <edmx:Reference Uri=\""
+        "/redfish/v1/schema/OemSensorSnapshot_v1.xml\">\n")
+    metadata_index.write(
+        "        <edmx:Include Namespace=\"OemSensorSnapshot\"/>\n")
+    metadata_index.write(
+        "        <edmx:Include Namespace=\"OemSensorSnapshot.v1_0_0\"/>\n")
+    metadata_index.write("    </edmx:Reference>\n")
+
     metadata_index.write("</edmx:Edmx>\n")
 
 schema_files = {}
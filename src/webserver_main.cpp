@@ -12,6 +12,8 @@
 #include <image_upload.hpp>
 #include <kvm_websocket.hpp>
 #include <login_routes.hpp>
+#include <mapper_mirror.hpp>
+#include <metrics_routes.hpp>
 #include <obmc_console.hpp>
 #include <openbmc_dbus_rest.hpp>
 #include <redfish.hpp>
@@ -23,6 +25,7 @@
 #include <ssl_key_handler.hpp>
 #include <vm_websocket.hpp>
 #include <webassets.hpp>
+#include <worker_thread.hpp>
 
 #include <memory>
 #include <string>
@@ -36,15 +39,43 @@ constexpr int defaultPort = 18080;
 inline void setupSocket(crow::App& app)
 {
     int listenFd = sd_listen_fds(0);
+    int inetFd = SD_LISTEN_FDS_START;
+#ifdef BMCWEB_ENABLE_UNIX_SOCKET
+    // systemd may hand us the local UNIX socket alongside the network one;
+    // pick it out so the remaining logic only ever sees the inet socket.
+    bool unixSocketFound = false;
+    for (int fd = SD_LISTEN_FDS_START; fd < SD_LISTEN_FDS_START + listenFd;
+         fd++)
+    {
+        if (sd_is_socket_unix(fd, SOCK_STREAM, 1, nullptr, 0) > 0)
+        {
+            BMCWEB_LOG_INFO << "Starting local webserver on socket handle "
+                            << fd;
+            app.unixSocket(fd);
+            unixSocketFound = true;
+            if (fd == inetFd)
+            {
+                inetFd++;
+            }
+            listenFd--;
+            break;
+        }
+    }
+    if (!unixSocketFound)
+    {
+        BMCWEB_LOG_INFO << "Starting local webserver on "
+                        << bmcwebUnixSocketPath;
+        app.unixSocketPath(bmcwebUnixSocketPath);
+    }
+#endif
     if (1 == listenFd)
     {
         BMCWEB_LOG_INFO << "attempting systemd socket activation";
-        if (sd_is_socket_inet(SD_LISTEN_FDS_START, AF_UNSPEC, SOCK_STREAM, 1,
-                              0))
+        if (sd_is_socket_inet(inetFd, AF_UNSPEC, SOCK_STREAM, 1, 0))
         {
             BMCWEB_LOG_INFO << "Starting webserver on socket handle "
-                            << SD_LISTEN_FDS_START;
-            app.socket(SD_LISTEN_FDS_START);
+                            << inetFd;
+            app.socket(inetFd);
         }
         else
         {
@@ -69,7 +100,13 @@ int main(int /*argc*/, char** /*argv*/)
     App app(io);
 
     crow::connections::systemBus =
-        std::make_shared<sdbusplus::asio::connection>(*io);
+        std::make_shared<crow::connections::Bus>(*io);
+    crow::connections::signalBus =
+        std::make_shared<crow::connections::Bus>(*io);
+
+#ifdef BMCWEB_ENABLE_MAPPER_MIRROR
+    crow::mapper_mirror::Mirror::getInstance().start();
+#endif
 
     // Static assets need to be initialized before Authorization, because auth
     // needs to build the whitelist from the static routes
@@ -120,6 +157,10 @@ int main(int /*argc*/, char** /*argv*/)
 
     crow::login_routes::requestRoutes(app);
 
+#ifdef BMCWEB_ENABLE_METRICS
+    crow::metrics::requestRoutes(app);
+#endif
+
     setupSocket(app);
 
 #ifdef BMCWEB_ENABLE_VM_NBDPROXY
@@ -143,6 +184,11 @@ int main(int /*argc*/, char** /*argv*/)
     app.run();
     io->run();
 
+#ifdef BMCWEB_ENABLE_REDFISH_JOURNAL_WORKER
+    // The worker reads its eventfd on io
+    crow::worker_thread::Worker::getInstance().stop();
+#endif
+    crow::connections::signalBus.reset();
     crow::connections::systemBus.reset();
     return 0;
 }